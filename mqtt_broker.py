@@ -0,0 +1,303 @@
+#!/usr/bin/env python3
+"""
+Broker MQTT 3.1.1 minimal intégré (sans dépendance externe)
+
+Suffisant pour les tests et benchmarks locaux de l'ESP32 IO Controller
+quand Mosquitto n'est pas disponible :
+- CONNECT / CONNACK, DISCONNECT, PINGREQ / PINGRESP
+- PUBLISH QoS 0 et 1 (PUBACK), messages retenus
+- SUBSCRIBE / UNSUBSCRIBE avec jokers '+' et '#'
+- Last Will
+- Sessions persistantes (cleanSession=0) : abonnements conservés et messages
+  QoS 1 mis en file pendant la déconnexion, remis à la reconnexion
+
+Les messages sont redistribués au QoS min(publication, abonnement), sans
+retransmission des QoS 1 non acquittés sur une connexion active.
+
+Utilisation :
+    python mqtt_broker.py --port 1883
+ou depuis un script :
+    broker = EmbeddedBroker(port=1883)
+    broker.start()   # thread en arrière-plan
+"""
+
+import argparse
+import asyncio
+import collections
+import struct
+import threading
+
+# Types de paquets MQTT
+CONNECT, CONNACK, PUBLISH, PUBACK = 1, 2, 3, 4
+SUBSCRIBE, SUBACK, UNSUBSCRIBE, UNSUBACK = 8, 9, 10, 11
+PINGREQ, PINGRESP, DISCONNECT = 12, 13, 14
+
+# Messages QoS 1 conservés par session persistante hors ligne
+OFFLINE_QUEUE_MAX = 1000
+
+
+def topic_matches(topic_filter, topic):
+    """Vérifie si un topic correspond à un filtre avec jokers MQTT"""
+    filter_parts = topic_filter.split('/')
+    topic_parts = topic.split('/')
+    for i, part in enumerate(filter_parts):
+        if part == '#':
+            return True
+        if i >= len(topic_parts):
+            return False
+        if part != '+' and part != topic_parts[i]:
+            return False
+    return len(filter_parts) == len(topic_parts)
+
+
+def encode_remaining_length(length):
+    out = bytearray()
+    while True:
+        byte = length % 128
+        length //= 128
+        if length > 0:
+            byte |= 0x80
+        out.append(byte)
+        if length == 0:
+            return bytes(out)
+
+
+def encode_string(value):
+    data = value.encode() if isinstance(value, str) else value
+    return struct.pack('!H', len(data)) + data
+
+
+def build_packet(packet_type, flags, body):
+    return bytes([(packet_type << 4) | flags]) + encode_remaining_length(len(body)) + body
+
+
+class ClientSession:
+    def __init__(self, broker, reader, writer):
+        self.broker = broker
+        self.reader = reader
+        self.writer = writer
+        self.client_id = None
+        self.subscriptions = {}  # filtre -> QoS accordé
+        self.will = None
+        self.clean_session = True
+        self.next_packet_id = 0
+
+    async def read_packet(self):
+        header = await self.reader.readexactly(1)
+        multiplier, length = 1, 0
+        while True:
+            byte = (await self.reader.readexactly(1))[0]
+            length += (byte & 0x7F) * multiplier
+            if not byte & 0x80:
+                break
+            multiplier *= 128
+        body = await self.reader.readexactly(length) if length else b''
+        return header[0] >> 4, header[0] & 0x0F, body
+
+    def send(self, packet):
+        if not self.writer.is_closing():
+            self.writer.write(packet)
+
+    def deliver(self, topic, payload, retain=False, qos=0):
+        body = encode_string(topic)
+        if qos > 0:
+            self.next_packet_id = self.next_packet_id % 0xFFFF + 1
+            body += struct.pack('!H', self.next_packet_id)
+        body += payload
+        self.send(build_packet(PUBLISH, (0x01 if retain else 0x00) | (qos << 1), body))
+
+    def matching_qos(self, topic):
+        """QoS accordé le plus élevé parmi les abonnements correspondants (None si aucun)"""
+        granted = [q for f, q in self.subscriptions.items() if topic_matches(f, topic)]
+        return max(granted) if granted else None
+
+    async def run(self):
+        clean_exit = False
+        try:
+            while True:
+                packet_type, flags, body = await self.read_packet()
+                if packet_type == CONNECT:
+                    self.handle_connect(body)
+                elif packet_type == PUBLISH:
+                    self.handle_publish(flags, body)
+                elif packet_type == SUBSCRIBE:
+                    self.handle_subscribe(body)
+                elif packet_type == UNSUBSCRIBE:
+                    self.handle_unsubscribe(body)
+                elif packet_type == PINGREQ:
+                    self.send(build_packet(PINGRESP, 0, b''))
+                elif packet_type == DISCONNECT:
+                    clean_exit = True
+                    break
+                await self.writer.drain()
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            self.broker.remove_session(self)
+            if not clean_exit and self.will:
+                self.broker.route(*self.will)
+            self.writer.close()
+
+    def handle_connect(self, body):
+        pos = 2 + struct.unpack('!H', body[0:2])[0]   # Nom du protocole
+        pos += 1                                        # Niveau de protocole
+        connect_flags = body[pos]
+        pos += 3                                        # Flags + keep alive
+
+        def read_field():
+            nonlocal pos
+            size = struct.unpack('!H', body[pos:pos + 2])[0]
+            value = body[pos + 2:pos + 2 + size]
+            pos += 2 + size
+            return value
+
+        self.client_id = read_field().decode(errors='replace')
+        if connect_flags & 0x04:
+            will_topic = read_field().decode()
+            will_payload = read_field()
+            self.will = (will_topic, will_payload, bool(connect_flags & 0x20), (connect_flags >> 3) & 0x03)
+        self.clean_session = bool(connect_flags & 0x02)
+        stored = self.broker.resume_session(self.client_id, self.clean_session)
+        if stored:
+            self.subscriptions = stored.subscriptions
+        self.broker.add_session(self)
+        self.send(build_packet(CONNACK, 0, bytes([1 if stored else 0, 0])))
+        if stored:
+            for topic, payload, qos in stored.queue:
+                self.deliver(topic, payload, qos=qos)
+
+    def handle_publish(self, flags, body):
+        qos = (flags >> 1) & 0x03
+        retain = bool(flags & 0x01)
+        topic_len = struct.unpack('!H', body[0:2])[0]
+        topic = body[2:2 + topic_len].decode()
+        pos = 2 + topic_len
+        if qos > 0:
+            packet_id = body[pos:pos + 2]
+            pos += 2
+            self.send(build_packet(PUBACK, 0, packet_id))
+        self.broker.route(topic, body[pos:], retain, qos)
+
+    def handle_subscribe(self, body):
+        packet_id = body[0:2]
+        pos = 2
+        granted = bytearray()
+        new_filters = []
+        while pos < len(body):
+            size = struct.unpack('!H', body[pos:pos + 2])[0]
+            topic_filter = body[pos + 2:pos + 2 + size].decode()
+            requested_qos = body[pos + 2 + size]
+            pos += 3 + size
+            self.subscriptions[topic_filter] = min(requested_qos, 1)
+            new_filters.append(topic_filter)
+            granted.append(min(requested_qos, 1))
+        self.send(build_packet(SUBACK, 0, packet_id + bytes(granted)))
+        # Messages retenus correspondant aux nouveaux abonnements
+        for topic, payload in list(self.broker.retained.items()):
+            if any(topic_matches(f, topic) for f in new_filters):
+                self.deliver(topic, payload, retain=True)
+
+    def handle_unsubscribe(self, body):
+        packet_id = body[0:2]
+        pos = 2
+        while pos < len(body):
+            size = struct.unpack('!H', body[pos:pos + 2])[0]
+            self.subscriptions.pop(body[pos + 2:pos + 2 + size].decode(), None)
+            pos += 2 + size
+        self.send(build_packet(UNSUBACK, 0, packet_id))
+
+
+class StoredSession:
+    def __init__(self, subscriptions):
+        self.subscriptions = subscriptions
+        self.queue = collections.deque(maxlen=OFFLINE_QUEUE_MAX)
+
+
+class EmbeddedBroker:
+    def __init__(self, host='0.0.0.0', port=1883, verbose=False):
+        self.host = host
+        self.port = port
+        self.verbose = verbose
+        self.sessions = set()
+        self.offline = {}  # client_id -> StoredSession (cleanSession=0 déconnectés)
+        self.retained = {}
+        self.loop = None
+        self.ready = threading.Event()
+
+    def add_session(self, session):
+        # Même client ID déjà connecté : l'ancienne connexion est fermée (MQTT 3.1.1 §3.1.4)
+        for other in [s for s in self.sessions if s.client_id == session.client_id]:
+            self.sessions.discard(other)
+            other.writer.close()
+        self.sessions.add(session)
+        if self.verbose:
+            print(f"[broker] + {session.client_id}")
+
+    def remove_session(self, session):
+        if session not in self.sessions:
+            return
+        self.sessions.discard(session)
+        if not session.clean_session:
+            self.offline[session.client_id] = StoredSession(session.subscriptions)
+        if self.verbose:
+            print(f"[broker] - {session.client_id}")
+
+    def resume_session(self, client_id, clean_session):
+        """Session persistante à reprendre (None si absente ou cleanSession=1)"""
+        stored = self.offline.pop(client_id, None)
+        return None if clean_session else stored
+
+    def route(self, topic, payload, retain=False, qos=0):
+        if retain:
+            if payload:
+                self.retained[topic] = payload
+            else:
+                self.retained.pop(topic, None)
+        for session in list(self.sessions):
+            granted = session.matching_qos(topic)
+            if granted is not None:
+                session.deliver(topic, payload, qos=min(qos, granted))
+        if qos > 0:
+            for stored in self.offline.values():
+                granted = max((q for f, q in stored.subscriptions.items() if topic_matches(f, topic)), default=None)
+                if granted:
+                    stored.queue.append((topic, payload, min(qos, granted)))
+
+    async def handle_client(self, reader, writer):
+        await ClientSession(self, reader, writer).run()
+
+    async def serve(self):
+        server = await asyncio.start_server(self.handle_client, self.host, self.port)
+        self.ready.set()
+        async with server:
+            await server.serve_forever()
+
+    def start(self):
+        """Démarre le broker dans un thread en arrière-plan"""
+        def runner():
+            self.loop = asyncio.new_event_loop()
+            asyncio.set_event_loop(self.loop)
+            self.loop.run_until_complete(self.serve())
+
+        threading.Thread(target=runner, daemon=True).start()
+        self.ready.wait(timeout=5)
+        return self
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Broker MQTT minimal pour les tests locaux")
+    parser.add_argument('--host', default='0.0.0.0')
+    parser.add_argument('--port', type=int, default=1883)
+    parser.add_argument('-v', '--verbose', action='store_true')
+    args = parser.parse_args()
+
+    broker = EmbeddedBroker(args.host, args.port, args.verbose)
+    print(f"✓ Broker MQTT à l'écoute sur {args.host}:{args.port} (Ctrl+C pour arrêter)")
+    try:
+        asyncio.run(broker.serve())
+    except KeyboardInterrupt:
+        print("\n👋 Broker arrêté")
+
+
+if __name__ == "__main__":
+    main()
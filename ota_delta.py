@@ -0,0 +1,338 @@
+#!/usr/bin/env python3
+"""
+Mises à jour différentielles du firmware (OTA delta)
+
+Au lieu de l'image complète, chaque appareil reçoit un patch compressé entre
+l'image qu'il exécute et l'image cible ; il le reconstruit au fil de l'eau dans
+la partition OTA inactive (src/delta_patch.h pour le format) puis vérifie le
+SHA-256 de l'image obtenue avant de la rendre amorçable.
+
+Exemples :
+    python ota_delta.py make firmware_v1.bin firmware_v2.bin -o v1_to_v2.edlt
+    python ota_delta.py apply firmware_v1.bin v1_to_v2.edlt -o check.bin
+    python ota_delta.py push v1_to_v2.edlt --hosts 192.168.1.31,192.168.1.32
+
+Le patch ne s'applique que sur l'image source exacte (SHA-256 contrôlé par
+l'appareil) : une flotte à mettre à jour doit exécuter la même version.
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+import time
+import urllib.error
+import urllib.request
+import uuid
+from concurrent.futures import ThreadPoolExecutor
+
+MAGIC = b"EDLT"
+VERSION = 1
+HEADER = struct.Struct("<4sB3xII32s32s")  # 80 octets
+
+# LZSS : doit rester identique à src/delta_patch.h
+WINDOW_SIZE = 4096
+MIN_MATCH = 3
+LEN_EXTENDED = 15
+MAX_CHAIN = 32            # Candidats examinés par position (compromis vitesse / taux)
+
+# Recherche des correspondances entre images
+SEED_LEN = 8              # Octets identiques pour amorcer une correspondance
+MIN_ADD_LEN = 16          # Plus court : recopié tel quel
+MISMATCH_SLACK = 32       # Différences tolérées au-delà du meilleur score (relocations)
+
+
+# ===== COMPRESSION LZSS =====
+
+def lzss_compress(data):
+    """Compresse data au format LZSS du firmware (drapeaux LSB d'abord)"""
+    out = bytearray()
+    heads = {}
+    n = len(data)
+    pos = 0
+    flag_index = -1
+    flag_bit = 8
+
+    def start_token():
+        nonlocal flag_index, flag_bit
+        if flag_bit == 8:
+            flag_index = len(out)
+            out.append(0)
+            flag_bit = 0
+
+    while pos < n:
+        best_len, best_dist = 0, 0
+        if pos + MIN_MATCH <= n:
+            # Plage répétée (zéros des ADD) : distance 1, sans parcourir les chaînes
+            if pos > 0 and data[pos - 1] == data[pos]:
+                run = pos
+                limit = n
+                while run < limit and data[run] == data[pos - 1]:
+                    run += 1
+                best_len, best_dist = run - pos, 1
+            key = data[pos:pos + MIN_MATCH]
+            chain = heads.get(key)
+            if chain and best_len < 64:
+                for cand in reversed(chain[-MAX_CHAIN:]):
+                    dist = pos - cand
+                    if dist > WINDOW_SIZE:
+                        break
+                    length = MIN_MATCH
+                    while pos + length < n and data[cand + length] == data[pos + length] and length < 65536:
+                        length += 1
+                    if length > best_len:
+                        best_len, best_dist = length, dist
+        start_token()
+        if best_len >= MIN_MATCH:
+            d = best_dist - 1
+            nib = best_len - MIN_MATCH
+            if nib < LEN_EXTENDED:
+                out += bytes((d & 0xFF, ((d >> 8) << 4) | nib))
+            else:
+                out += bytes((d & 0xFF, ((d >> 8) << 4) | LEN_EXTENDED))
+                ext = best_len - MIN_MATCH - LEN_EXTENDED
+                while ext >= 255:
+                    out.append(255)
+                    ext -= 255
+                out.append(ext)
+            step = best_len
+        else:
+            out[flag_index] |= 1 << flag_bit
+            out.append(data[pos])
+            step = 1
+        flag_bit += 1
+        # Index des positions couvertes (les longues plages ne sont indexées qu'au début)
+        for i in range(pos, min(pos + min(step, 64), n - MIN_MATCH + 1)):
+            heads.setdefault(data[i:i + MIN_MATCH], []).append(i)
+        pos += step
+    return bytes(out)
+
+
+def lzss_decompress(data):
+    out = bytearray()
+    i = 0
+    n = len(data)
+    while i < n:
+        flags = data[i]
+        i += 1
+        for bit in range(8):
+            if i >= n:
+                break
+            if flags & (1 << bit):
+                out.append(data[i])
+                i += 1
+                continue
+            b0, b1 = data[i], data[i + 1]
+            i += 2
+            dist = (b0 | ((b1 >> 4) << 8)) + 1
+            length = (b1 & 0x0F) + MIN_MATCH
+            if (b1 & 0x0F) == LEN_EXTENDED:
+                while True:
+                    ext = data[i]
+                    i += 1
+                    length += ext
+                    if ext != 255:
+                        break
+            for _ in range(length):
+                out.append(out[-dist])
+    return bytes(out)
+
+
+# ===== DIFFÉRENCE ENTRE IMAGES (à la bsdiff) =====
+
+def varint(value):
+    out = bytearray()
+    while True:
+        b = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def zigzag(value):
+    return value << 1 if value >= 0 else ((-value) << 1) - 1
+
+
+def extend_match(old, o, new, n):
+    """Longueur de la correspondance approchée old[o:] ~ new[n:] (score bsdiff)"""
+    limit = min(len(old) - o, len(new) - n)
+    i = 0
+    score = best_score = best_len = 0
+    while i < limit:
+        # Tronçons identiques comparés d'un bloc
+        if old[o + i:o + i + 64] == new[n + i:n + i + 64] and i + 64 <= limit:
+            i += 64
+            score += 64
+        else:
+            score += 1 if old[o + i] == new[n + i] else -1
+            i += 1
+        if score > best_score:
+            best_score, best_len = score, i
+        elif score < best_score - MISMATCH_SLACK:
+            break
+    return best_len
+
+
+def make_records(old, new):
+    """Enregistrements (addLen, seek, insertLen, diff, extra) couvrant new"""
+    index = {}
+    for i in range(len(old) - SEED_LEN, -1, -1):
+        index[old[i:i + SEED_LEN]] = i  # Première occurrence
+
+    records = bytearray()
+    src_pos = 0        # Position source après le dernier ADD (côté appareil)
+    pending = None     # (pos dans new, pos dans old, longueur) en attente de son insert
+    lit_start = 0
+    pos = 0
+    while pos + SEED_LEN <= len(new):
+        # Continuité d'abord : la suite de la source, décalée comme le bloc précédent
+        cand = None
+        if pending is not None:
+            expected = pending[1] + (pos - pending[0])
+            if expected + SEED_LEN <= len(old) and old[expected:expected + SEED_LEN] == new[pos:pos + SEED_LEN]:
+                cand = expected
+        if cand is None:
+            cand = index.get(new[pos:pos + SEED_LEN])
+        length = extend_match(old, cand, new, pos) if cand is not None else 0
+        if length < MIN_ADD_LEN:
+            pos += 1
+            continue
+
+        if pending is not None:
+            src_pos = emit_record(records, old, new, pending, src_pos, new[lit_start:pos])
+        elif pos > 0:
+            records += varint(0) + varint(0) + varint(pos) + new[:pos]
+        pending = (pos, cand, length)
+        pos += length
+        lit_start = pos
+
+    if pending is not None:
+        emit_record(records, old, new, pending, src_pos, new[lit_start:])
+    elif new:
+        records += varint(0) + varint(0) + varint(len(new)) + new
+    return bytes(records)
+
+
+def emit_record(records, old, new, match, src_pos, extra):
+    npos, opos, length = match
+    diff = bytes((new[npos + i] - old[opos + i]) & 0xFF for i in range(length))
+    records += varint(length) + varint(zigzag(opos - src_pos)) + varint(len(extra)) + diff + extra
+    return opos + length
+
+
+def make_patch(old, new):
+    header = HEADER.pack(MAGIC, VERSION, len(old), len(new),
+                         hashlib.sha256(old).digest(), hashlib.sha256(new).digest())
+    return header + lzss_compress(make_records(old, new))
+
+
+# ===== APPLICATION (référence de l'implémentation du firmware) =====
+
+def apply_patch(old, patch):
+    magic, version, source_size, target_size, source_sha, target_sha = HEADER.unpack_from(patch)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("pas un patch EDLT v%d" % VERSION)
+    if len(old) != source_size or hashlib.sha256(old).digest() != source_sha:
+        raise ValueError("image source différente de celle du patch")
+    stream = lzss_decompress(patch[HEADER.size:])
+    out = bytearray()
+    i = 0
+    src = 0
+
+    def read_varint():
+        nonlocal i
+        value = shift = 0
+        while True:
+            b = stream[i]
+            i += 1
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return value
+
+    while len(out) < target_size:
+        add_len = read_varint()
+        seek = read_varint()
+        src += (seek >> 1) ^ -(seek & 1)
+        insert_len = read_varint()
+        out += bytes((old[src + k] + stream[i + k]) & 0xFF for k in range(add_len))
+        i += add_len
+        src += add_len
+        out += stream[i:i + insert_len]
+        i += insert_len
+    if hashlib.sha256(out).digest() != target_sha:
+        raise ValueError("SHA-256 de l'image reconstruite incorrect")
+    return bytes(out)
+
+
+# ===== ENVOI À LA FLOTTE =====
+
+def push(host, patch, timeout):
+    boundary = uuid.uuid4().hex
+    body = (("--%s\r\nContent-Disposition: form-data; name=\"patch\"; filename=\"update.edlt\"\r\n"
+             "Content-Type: application/octet-stream\r\n\r\n" % boundary).encode()
+            + patch + ("\r\n--%s--\r\n" % boundary).encode())
+    request = urllib.request.Request("http://%s/api/ota/delta" % host, data=body, method="POST",
+                                     headers={"Content-Type": "multipart/form-data; boundary=" + boundary})
+    start = time.time()
+    try:
+        with urllib.request.urlopen(request, timeout=timeout) as response:
+            return host, True, response.read().decode(errors="replace"), time.time() - start
+    except urllib.error.HTTPError as e:
+        return host, False, e.read().decode(errors="replace"), time.time() - start
+    except OSError as e:
+        return host, False, str(e), time.time() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Patchs OTA différentiels pour l'ESP32 IO Controller")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p_make = sub.add_parser("make", help="Produit le patch entre deux images")
+    p_make.add_argument("source", help="Image exécutée par les appareils (.bin)")
+    p_make.add_argument("target", help="Nouvelle image (.bin)")
+    p_make.add_argument("-o", "--output", required=True)
+
+    p_apply = sub.add_parser("apply", help="Applique un patch sur l'hôte (vérification)")
+    p_apply.add_argument("source")
+    p_apply.add_argument("patch")
+    p_apply.add_argument("-o", "--output")
+
+    p_push = sub.add_parser("push", help="Envoie un patch à des appareils (POST /api/ota/delta)")
+    p_push.add_argument("patch")
+    p_push.add_argument("--hosts", required=True, help="Adresses séparées par des virgules")
+    p_push.add_argument("--parallel", type=int, default=4)
+    p_push.add_argument("--timeout", type=float, default=120)
+
+    args = parser.parse_args()
+
+    if args.command == "make":
+        old = open(args.source, "rb").read()
+        new = open(args.target, "rb").read()
+        start = time.time()
+        patch = make_patch(old, new)
+        apply_patch(old, patch)  # Le patch produit doit redonner exactement la cible
+        open(args.output, "wb").write(patch)
+        print("✓ %s : %d octets (%.1f %% de l'image cible de %d octets), %.1f s"
+              % (args.output, len(patch), 100.0 * len(patch) / max(len(new), 1), len(new), time.time() - start))
+    elif args.command == "apply":
+        out = apply_patch(open(args.source, "rb").read(), open(args.patch, "rb").read())
+        if args.output:
+            open(args.output, "wb").write(out)
+        print("✓ Image reconstruite : %d octets, SHA-256 %s" % (len(out), hashlib.sha256(out).hexdigest()))
+    else:
+        patch = open(args.patch, "rb").read()
+        hosts = [h.strip() for h in args.hosts.split(",") if h.strip()]
+        failed = 0
+        with ThreadPoolExecutor(max_workers=max(1, args.parallel)) as pool:
+            for host, ok, message, elapsed in pool.map(lambda h: push(h, patch, args.timeout), hosts):
+                failed += 0 if ok else 1
+                print("%s %s (%.1f s) %s" % ("✓" if ok else "✗", host, elapsed, message.strip()))
+        sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
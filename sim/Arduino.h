@@ -0,0 +1,190 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+// Couche Arduino minimale pour compiler le firmware en processus Linux (simulateur).
+// Seules les API utilisées par src/ sont fournies ; les GPIO sont virtuelles
+// (voir sim_gpio.h) et l'horloge murale est propre à chaque instance (sys/time.h).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+
+#include <sys/time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT          0x01
+#define OUTPUT         0x03
+#define INPUT_PULLUP   0x05
+#define INPUT_PULLDOWN 0x09
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define DEC 10
+#define HEX 16
+
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define F(s) (s)
+
+typedef enum {
+    ADC_0db,
+    ADC_2_5db,
+    ADC_6db,
+    ADC_11db
+} adc_attenuation_t;
+
+// strlcpy / strlcat n'existent dans la glibc qu'à partir de la 2.38
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+size_t strlcpy(char* dst, const char* src, size_t size);
+size_t strlcat(char* dst, const char* src, size_t size);
+#endif
+
+// ===== String =====
+class String {
+public:
+    String(const char* s = "") : s_(s ? s : "") {}
+    String(const std::string& s) : s_(s) {}
+    explicit String(char c) : s_(1, c) {}
+    String(int value, unsigned char base = DEC) { fromInteger((long long)value, base); }
+    String(unsigned int value, unsigned char base = DEC) { fromUnsigned(value, base); }
+    String(long value, unsigned char base = DEC) { fromInteger(value, base); }
+    String(unsigned long value, unsigned char base = DEC) { fromUnsigned(value, base); }
+    String(long long value, unsigned char base = DEC) { fromInteger(value, base); }
+    String(unsigned long long value, unsigned char base = DEC) { fromUnsigned(value, base); }
+    String(double value, unsigned int decimals = 2);
+
+    const char* c_str() const { return s_.c_str(); }
+    unsigned int length() const { return (unsigned int)s_.length(); }
+    bool isEmpty() const { return s_.empty(); }
+    char charAt(unsigned int i) const { return i < s_.length() ? s_[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+
+    bool equals(const String& o) const { return s_ == o.s_; }
+    bool equals(const char* o) const { return s_ == (o ? o : ""); }
+    bool startsWith(const String& p) const { return s_.compare(0, p.s_.length(), p.s_) == 0; }
+    bool endsWith(const String& p) const {
+        return s_.length() >= p.s_.length() && s_.compare(s_.length() - p.s_.length(), p.s_.length(), p.s_) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& str, unsigned int from = 0) const;
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const;
+    long toInt() const { return atol(s_.c_str()); }
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    String& operator+=(const String& o) { s_ += o.s_; return *this; }
+    String& operator+=(const char* o) { s_ += (o ? o : ""); return *this; }
+    String& operator+=(char c) { s_ += c; return *this; }
+    String& operator+=(int v) { s_ += String(v).s_; return *this; }
+    String& operator+=(unsigned int v) { s_ += String(v).s_; return *this; }
+    String& operator+=(long v) { s_ += String(v).s_; return *this; }
+    String& operator+=(unsigned long v) { s_ += String(v).s_; return *this; }
+    bool concat(const String& o) { s_ += o.s_; return true; }
+
+    bool operator==(const String& o) const { return s_ == o.s_; }
+    bool operator==(const char* o) const { return equals(o); }
+    bool operator!=(const String& o) const { return s_ != o.s_; }
+    bool operator!=(const char* o) const { return !equals(o); }
+    bool operator<(const String& o) const { return s_ < o.s_; }
+
+    const std::string& std() const { return s_; }
+
+private:
+    void fromInteger(long long value, unsigned char base);
+    void fromUnsigned(unsigned long long value, unsigned char base);
+    std::string s_;
+};
+
+// Type intermédiaire des concaténations (comme WString.h, reconnu par ArduinoJson)
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& s) : String(s) {}
+};
+
+inline StringSumHelper operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline StringSumHelper operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline StringSumHelper operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline StringSumHelper operator+(const String& a, char b) { String r(a); r += b; return r; }
+inline StringSumHelper operator+(const String& a, int b) { String r(a); r += b; return r; }
+inline StringSumHelper operator+(const String& a, unsigned int b) { String r(a); r += b; return r; }
+inline StringSumHelper operator+(const String& a, long b) { String r(a); r += b; return r; }
+inline StringSumHelper operator+(const String& a, unsigned long b) { String r(a); r += b; return r; }
+
+// ===== Serial =====
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void setQuiet(bool quiet) { quiet_ = quiet; }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char* s);
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t print(char c);
+    size_t print(int n, int base = DEC) { return print(String(n, (unsigned char)base)); }
+    size_t print(unsigned int n, int base = DEC) { return print(String(n, (unsigned char)base)); }
+    size_t print(long n, int base = DEC) { return print(String(n, (unsigned char)base)); }
+    size_t print(unsigned long n, int base = DEC) { return print(String(n, (unsigned char)base)); }
+    size_t print(double n, int digits = 2) { return print(String(n, (unsigned int)digits)); }
+
+    size_t println() { return print("\n"); }
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+
+private:
+    bool quiet_ = false;
+};
+
+extern HardwareSerial Serial;
+
+// ===== Temps =====
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// ===== GPIO virtuelles =====
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+void analogSetPinAttenuation(uint8_t pin, adc_attenuation_t attenuation);
+
+#define digitalPinToInterrupt(p) (p)
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+// ===== Divers =====
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+// Tas : statistiques de l'allocateur glibc (indicatives, le tas Linux grandit à la demande)
+class EspClass {
+public:
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+};
+
+extern EspClass ESP;
+
+#endif // SIM_ARDUINO_H
@@ -0,0 +1,319 @@
+#include "AsyncMqttClient.h"
+#include "sim_wifi.h"
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#define MQTTCONNECT     0x10
+#define MQTTCONNACK     0x20
+#define MQTTPUBLISH     0x30
+#define MQTTPUBACK      0x40
+#define MQTTSUBSCRIBE   0x82
+#define MQTTUNSUBSCRIBE 0xA2
+#define MQTTPINGREQ     0xC0
+#define MQTTDISCONNECT  0xE0
+
+// Taille des morceaux livrés à onMessage (MSS TCP typique de l'ESP32)
+#define SIM_ASYNC_CHUNK 1436
+
+static void appendString(std::vector<uint8_t>& buf, const char* s, size_t len) {
+    buf.push_back((uint8_t)(len >> 8));
+    buf.push_back((uint8_t)(len & 0xFF));
+    buf.insert(buf.end(), s, s + len);
+}
+
+static void appendString(std::vector<uint8_t>& buf, const char* s) {
+    appendString(buf, s, strlen(s));
+}
+
+static int openSocket(const char* host, uint16_t port) {
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    char portStr[8];
+    snprintf(portStr, sizeof(portStr), "%u", port);
+
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host, portStr, &hints, &result) != 0) return -1;
+    int fd = -1;
+    for (struct addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+    if (fd >= 0) {
+        int flag = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    }
+    return fd;
+}
+
+AsyncMqttClient& AsyncMqttClient::setWill(const char* topic, uint8_t qos, bool retain, const char* payload,
+                                          size_t length) {
+    willTopic_ = topic;
+    willQos_ = qos;
+    willRetain_ = retain;
+    willPayload_ = payload;
+    willLength_ = payload != nullptr && length == 0 ? strlen(payload) : length;
+    return *this;
+}
+
+void AsyncMqttClient::connect() {
+    // Une seule connexion à la fois, comme AsyncClient
+    bool expected = false;
+    if (host_ == nullptr || !running_.compare_exchange_strong(expected, true)) return;
+
+    std::thread([this]() {
+        int fd = simWifiLinkUp() ? openSocket(host_, port_) : -1;
+        if (fd < 0) {
+            running_ = false;
+            for (auto& callback : onDisconnect_) callback(AsyncMqttClientDisconnectReason::TCP_DISCONNECTED);
+            return;
+        }
+        fd_ = fd;
+        run(fd);
+    }).detach();
+}
+
+void AsyncMqttClient::disconnect(bool force) {
+    int fd = fd_;
+    if (fd < 0) return;
+    if (!force && connected_) {
+        sendPacket(MQTTDISCONNECT, std::vector<uint8_t>());
+    }
+    // Le thread de réception voit la fermeture et appelle onDisconnect
+    shutdown(fd, SHUT_RDWR);
+}
+
+uint16_t AsyncMqttClient::subscribe(const char* topic, uint8_t qos) {
+    if (!connected_) return 0;
+    uint16_t id = nextPacketId();
+    std::vector<uint8_t> body = { (uint8_t)(id >> 8), (uint8_t)(id & 0xFF) };
+    appendString(body, topic);
+    body.push_back(qos);
+    return sendPacket(MQTTSUBSCRIBE, body) ? id : 0;
+}
+
+uint16_t AsyncMqttClient::unsubscribe(const char* topic) {
+    if (!connected_) return 0;
+    uint16_t id = nextPacketId();
+    std::vector<uint8_t> body = { (uint8_t)(id >> 8), (uint8_t)(id & 0xFF) };
+    appendString(body, topic);
+    return sendPacket(MQTTUNSUBSCRIBE, body) ? id : 0;
+}
+
+uint16_t AsyncMqttClient::publish(const char* topic, uint8_t qos, bool retain, const char* payload, size_t length,
+                                  bool dup, uint16_t message_id) {
+    if (!connected_) return 0;
+    if (payload != nullptr && length == 0) length = strlen(payload);
+
+    std::vector<uint8_t> body;
+    appendString(body, topic);
+    uint16_t id = 1;  // QoS 0 : 1 signifie "envoyé"
+    if (qos > 0) {
+        id = message_id != 0 ? message_id : nextPacketId();
+        body.push_back((uint8_t)(id >> 8));
+        body.push_back((uint8_t)(id & 0xFF));
+    }
+    if (length > 0) body.insert(body.end(), payload, payload + length);
+
+    uint8_t header = MQTTPUBLISH | (uint8_t)((qos & 0x03) << 1) | (retain ? 0x01 : 0x00) | (dup ? 0x08 : 0x00);
+    return sendPacket(header, body) ? id : 0;
+}
+
+bool AsyncMqttClient::sendPacket(uint8_t header, const std::vector<uint8_t>& body) {
+    std::vector<uint8_t> packet;
+    packet.reserve(body.size() + 5);
+    packet.push_back(header);
+    size_t len = body.size();
+    do {
+        uint8_t digit = len % 128;
+        len /= 128;
+        if (len > 0) digit |= 0x80;
+        packet.push_back(digit);
+    } while (len > 0);
+    packet.insert(packet.end(), body.begin(), body.end());
+
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    int fd = fd_;
+    if (fd < 0) return false;
+    size_t sent = 0;
+    while (sent < packet.size()) {
+        ssize_t n = send(fd, packet.data() + sent, packet.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        sent += (size_t)n;
+    }
+    lastOutMs_ = millis();
+    return true;
+}
+
+// Boucle de réception : l'équivalent de la tâche async_tcp pour cette connexion
+void AsyncMqttClient::run(int fd) {
+    std::vector<uint8_t> body;
+    appendString(body, "MQTT");
+    body.push_back(4);  // MQTT 3.1.1
+    bool hasUser = username_ != nullptr && username_[0] != '\0';
+    bool hasPass = hasUser && password_ != nullptr;
+    bool hasWill = willTopic_ != nullptr && willTopic_[0] != '\0';
+    uint8_t flags = 0;
+    if (cleanSession_) flags |= 0x02;
+    if (hasWill) flags |= 0x04 | ((willQos_ & 0x03) << 3) | (willRetain_ ? 0x20 : 0);
+    if (hasUser) flags |= 0x80;
+    if (hasPass) flags |= 0x40;
+    body.push_back(flags);
+    body.push_back((uint8_t)(keepAlive_ >> 8));
+    body.push_back((uint8_t)(keepAlive_ & 0xFF));
+    appendString(body, clientId_);
+    if (hasWill) {
+        appendString(body, willTopic_);
+        appendString(body, willPayload_ ? willPayload_ : "", willLength_);
+    }
+    if (hasUser) appendString(body, username_);
+    if (hasPass) appendString(body, password_);
+
+    AsyncMqttClientDisconnectReason reason = AsyncMqttClientDisconnectReason::TCP_DISCONNECTED;
+    std::vector<uint8_t> rx;
+    uint32_t lastInMs = millis();
+    bool pingOutstanding = false;
+    if (!sendPacket(MQTTCONNECT, body)) {
+        closeConnection(reason);
+        return;
+    }
+
+    for (;;) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, 100);
+        if (ready < 0 && errno != EINTR) break;
+        if (!simWifiLinkUp()) break;  // Lien WiFi perdu
+
+        uint32_t keepAliveMs = (uint32_t)keepAlive_ * 1000UL;
+        uint32_t now = millis();
+        if (connected_ && keepAliveMs > 0 && now - lastOutMs_ > keepAliveMs / 2) {
+            if (pingOutstanding && now - lastInMs > keepAliveMs) break;
+            sendPacket(MQTTPINGREQ, std::vector<uint8_t>());
+            pingOutstanding = true;
+        }
+        if (ready <= 0) continue;
+
+        uint8_t buf[4096];
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n == 0 || (n < 0 && errno != EINTR)) break;
+        if (n < 0) continue;
+        rx.insert(rx.end(), buf, buf + n);
+        lastInMs = millis();
+        pingOutstanding = false;
+
+        // Paquets complets du tampon
+        for (;;) {
+            size_t pos = 1;
+            size_t len = 0;
+            size_t multiplier = 1;
+            bool complete = false;
+            while (pos < rx.size() && pos <= 4) {
+                uint8_t digit = rx[pos++];
+                len += (digit & 0x7F) * multiplier;
+                multiplier *= 128;
+                if ((digit & 0x80) == 0) {
+                    complete = true;
+                    break;
+                }
+            }
+            if (!complete || rx.size() < pos + len) break;
+
+            uint8_t header = rx[0];
+            std::vector<uint8_t> packet(rx.begin() + pos, rx.begin() + pos + len);
+            rx.erase(rx.begin(), rx.begin() + pos + len);
+
+            if ((header & 0xF0) == MQTTCONNACK) {
+                if (packet.size() < 2 || packet[1] != 0) {
+                    reason = packet.size() >= 2 ? (AsyncMqttClientDisconnectReason)packet[1]
+                                                : AsyncMqttClientDisconnectReason::TCP_DISCONNECTED;
+                    closeConnection(reason);
+                    return;
+                }
+                connected_ = true;
+                for (auto& callback : onConnect_) callback(packet[0] & 0x01);
+            } else {
+                handlePacket(header, packet);
+            }
+        }
+    }
+    closeConnection(reason);
+}
+
+void AsyncMqttClient::handlePacket(uint8_t header, const std::vector<uint8_t>& body) {
+    switch (header & 0xF0) {
+        case MQTTPUBLISH: {
+            if (body.size() < 2) return;
+            uint16_t topicLen = (uint16_t)((body[0] << 8) | body[1]);
+            size_t pos = 2 + topicLen;
+            AsyncMqttClientMessageProperties properties;
+            properties.qos = (header >> 1) & 0x03;
+            properties.dup = (header & 0x08) != 0;
+            properties.retain = (header & 0x01) != 0;
+            uint16_t msgId = 0;
+            if (properties.qos > 0) {
+                if (body.size() < pos + 2) return;
+                msgId = (uint16_t)((body[pos] << 8) | body[pos + 1]);
+                pos += 2;
+            }
+            if (body.size() < pos) return;
+
+            std::string topic((const char*)&body[2], topicLen);
+            std::vector<char> payload(body.begin() + pos, body.end());
+            size_t total = payload.size();
+            for (auto& callback : onMessage_) {
+                if (total == 0) {
+                    callback(&topic[0], nullptr, properties, 0, 0, 0);
+                }
+                for (size_t index = 0; index < total; index += SIM_ASYNC_CHUNK) {
+                    size_t len = total - index < SIM_ASYNC_CHUNK ? total - index : SIM_ASYNC_CHUNK;
+                    callback(&topic[0], payload.data() + index, properties, len, index, total);
+                }
+            }
+            if (properties.qos == 1) {
+                std::vector<uint8_t> ack = { (uint8_t)(msgId >> 8), (uint8_t)(msgId & 0xFF) };
+                sendPacket(MQTTPUBACK, ack);
+            }
+            break;
+        }
+        case MQTTPUBACK:
+            if (body.size() >= 2) {
+                for (auto& callback : onPublish_) callback((uint16_t)((body[0] << 8) | body[1]));
+            }
+            break;
+        default:
+            // SUBACK, UNSUBACK, PINGRESP : rien à faire
+            break;
+    }
+}
+
+void AsyncMqttClient::closeConnection(AsyncMqttClientDisconnectReason reason) {
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        int fd = fd_.exchange(-1);
+        if (fd >= 0) close(fd);
+    }
+    connected_ = false;
+    running_ = false;
+    for (auto& callback : onDisconnect_) callback(reason);
+}
+
+uint16_t AsyncMqttClient::nextPacketId() {
+    uint16_t id = ++packetId_;
+    if (id == 0) id = ++packetId_;
+    return id;
+}
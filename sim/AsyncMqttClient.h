@@ -0,0 +1,107 @@
+#ifndef SIM_ASYNCMQTTCLIENT_H
+#define SIM_ASYNCMQTTCLIENT_H
+
+// Client MQTT 3.1.1 événementiel du simulateur, compatible avec l'API
+// d'AsyncMqttClient (marvinroger/async-mqtt-client 0.9) utilisée par
+// src/mqtt_transport_async.cpp. Un thread par connexion joue le rôle de la
+// tâche async_tcp : les callbacks sont appelés depuis ce thread, et les
+// messages plus grands qu'un segment TCP sont livrés en plusieurs morceaux.
+// Comme la bibliothèque réelle, les pointeurs passés aux setters sont conservés,
+// et onConnect/onDisconnect/onPublish/onMessage ajoutent un callback à une
+// liste (chacun est appelé) au lieu de remplacer le précédent.
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+enum class AsyncMqttClientDisconnectReason : uint8_t {
+    TCP_DISCONNECTED = 0,
+    MQTT_UNACCEPTABLE_PROTOCOL_VERSION = 1,
+    MQTT_IDENTIFIER_REJECTED = 2,
+    MQTT_SERVER_UNAVAILABLE = 3,
+    MQTT_MALFORMED_CREDENTIALS = 4,
+    MQTT_NOT_AUTHORIZED = 5,
+    ESP8266_NOT_ENOUGH_SPACE = 6,
+    TLS_BAD_FINGERPRINT = 7
+};
+
+struct AsyncMqttClientMessageProperties {
+    uint8_t qos;
+    bool dup;
+    bool retain;
+};
+
+class AsyncMqttClient {
+public:
+    typedef std::function<void(bool sessionPresent)> OnConnectUserCallback;
+    typedef std::function<void(AsyncMqttClientDisconnectReason reason)> OnDisconnectUserCallback;
+    typedef std::function<void(uint16_t packetId)> OnPublishUserCallback;
+    typedef std::function<void(char* topic, char* payload, AsyncMqttClientMessageProperties properties,
+                               size_t len, size_t index, size_t total)> OnMessageUserCallback;
+
+    AsyncMqttClient() {}
+    AsyncMqttClient(const AsyncMqttClient&) = delete;
+    AsyncMqttClient& operator=(const AsyncMqttClient&) = delete;
+
+    AsyncMqttClient& setKeepAlive(uint16_t keepAlive) { keepAlive_ = keepAlive; return *this; }
+    AsyncMqttClient& setClientId(const char* clientId) { clientId_ = clientId; return *this; }
+    AsyncMqttClient& setCleanSession(bool cleanSession) { cleanSession_ = cleanSession; return *this; }
+    AsyncMqttClient& setCredentials(const char* username, const char* password = nullptr) {
+        username_ = username;
+        password_ = password;
+        return *this;
+    }
+    AsyncMqttClient& setWill(const char* topic, uint8_t qos, bool retain, const char* payload = nullptr,
+                             size_t length = 0);
+    AsyncMqttClient& setServer(const char* host, uint16_t port) { host_ = host; port_ = port; return *this; }
+
+    AsyncMqttClient& onConnect(OnConnectUserCallback callback) { onConnect_.push_back(callback); return *this; }
+    AsyncMqttClient& onDisconnect(OnDisconnectUserCallback callback) { onDisconnect_.push_back(callback); return *this; }
+    AsyncMqttClient& onPublish(OnPublishUserCallback callback) { onPublish_.push_back(callback); return *this; }
+    AsyncMqttClient& onMessage(OnMessageUserCallback callback) { onMessage_.push_back(callback); return *this; }
+
+    bool connected() const { return connected_; }
+    void connect();
+    void disconnect(bool force = false);
+    uint16_t subscribe(const char* topic, uint8_t qos);
+    uint16_t unsubscribe(const char* topic);
+    uint16_t publish(const char* topic, uint8_t qos, bool retain, const char* payload = nullptr, size_t length = 0,
+                     bool dup = false, uint16_t message_id = 0);
+
+private:
+    void run(int fd);
+    bool sendPacket(uint8_t header, const std::vector<uint8_t>& body);
+    void handlePacket(uint8_t header, const std::vector<uint8_t>& body);
+    void closeConnection(AsyncMqttClientDisconnectReason reason);
+    uint16_t nextPacketId();
+
+    const char* host_ = nullptr;
+    uint16_t port_ = 1883;
+    const char* clientId_ = "";
+    const char* username_ = nullptr;
+    const char* password_ = nullptr;
+    const char* willTopic_ = nullptr;
+    const char* willPayload_ = nullptr;
+    size_t willLength_ = 0;
+    uint8_t willQos_ = 0;
+    bool willRetain_ = false;
+    bool cleanSession_ = true;
+    uint16_t keepAlive_ = 15;
+
+    // Enregistrés au démarrage, avant toute connexion (lus ensuite sans verrou)
+    std::vector<OnConnectUserCallback> onConnect_;
+    std::vector<OnDisconnectUserCallback> onDisconnect_;
+    std::vector<OnPublishUserCallback> onPublish_;
+    std::vector<OnMessageUserCallback> onMessage_;
+
+    std::mutex writeMutex_;
+    std::atomic<int> fd_{-1};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> connected_{false};
+    std::atomic<uint16_t> packetId_{0};
+    std::atomic<uint32_t> lastOutMs_{0};
+};
+
+#endif // SIM_ASYNCMQTTCLIENT_H
@@ -0,0 +1,324 @@
+#include "PubSubClient.h"
+
+#define MQTTCONNECT     0x10
+#define MQTTCONNACK     0x20
+#define MQTTPUBLISH     0x30
+#define MQTTPUBACK      0x40
+#define MQTTSUBSCRIBE   0x82
+#define MQTTUNSUBSCRIBE 0xA2
+#define MQTTPINGREQ     0xC0
+#define MQTTPINGRESP    0xD0
+#define MQTTDISCONNECT  0xE0
+
+static void appendString(std::vector<uint8_t>& buf, const char* s) {
+    size_t len = strlen(s);
+    buf.push_back((uint8_t)(len >> 8));
+    buf.push_back((uint8_t)(len & 0xFF));
+    buf.insert(buf.end(), s, s + len);
+}
+
+PubSubClient::PubSubClient(WiFiClient& client) : client_(client) {}
+
+PubSubClient& PubSubClient::setServer(const char* domain, uint16_t port) {
+    domain_ = domain ? domain : "";
+    port_ = port;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+    callback_ = callback;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setKeepAlive(uint16_t keepAlive) {
+    keepAlive_ = keepAlive;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setSocketTimeout(uint16_t timeout) {
+    socketTimeout_ = timeout;
+    return *this;
+}
+
+boolean PubSubClient::setBufferSize(uint16_t size) {
+    if (size == 0) return false;
+    bufferSize_ = size;
+    return true;
+}
+
+boolean PubSubClient::connect(const char* id) {
+    return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr, true);
+}
+
+boolean PubSubClient::connect(const char* id, const char* user, const char* pass) {
+    return connect(id, user, pass, nullptr, 0, false, nullptr, true);
+}
+
+boolean PubSubClient::connect(const char* id, const char* willTopic, uint8_t willQos, boolean willRetain,
+                              const char* willMessage) {
+    return connect(id, nullptr, nullptr, willTopic, willQos, willRetain, willMessage, true);
+}
+
+boolean PubSubClient::connect(const char* id, const char* user, const char* pass, const char* willTopic,
+                              uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession) {
+    if (connected()) return true;
+    rx_.clear();
+    pingOutstanding_ = false;
+
+    if (!client_.connect(domain_.c_str(), port_)) {
+        state_ = MQTT_CONNECT_FAILED;
+        return false;
+    }
+    client_.setNoDelay(true);
+
+    // Un identifiant, un mot de passe ou un topic vides valent "absent" (comme PubSubClient)
+    bool hasUser = user != nullptr && user[0] != '\0';
+    bool hasPass = hasUser && pass != nullptr && pass[0] != '\0';
+    bool hasWill = willTopic != nullptr && willTopic[0] != '\0';
+
+    std::vector<uint8_t> body;
+    appendString(body, "MQTT");
+    body.push_back(4);  // MQTT 3.1.1
+    uint8_t flags = 0;
+    if (cleanSession) flags |= 0x02;
+    if (hasWill) flags |= 0x04 | ((willQos & 0x03) << 3) | (willRetain ? 0x20 : 0);
+    if (hasUser) flags |= 0x80;
+    if (hasPass) flags |= 0x40;
+    body.push_back(flags);
+    body.push_back((uint8_t)(keepAlive_ >> 8));
+    body.push_back((uint8_t)(keepAlive_ & 0xFF));
+    appendString(body, id);
+    if (hasWill) {
+        appendString(body, willTopic);
+        appendString(body, willMessage ? willMessage : "");
+    }
+    if (hasUser) appendString(body, user);
+    if (hasPass) appendString(body, pass);
+
+    if (!sendPacket(MQTTCONNECT, body)) {
+        state_ = MQTT_CONNECT_FAILED;
+        return false;
+    }
+
+    // Attente du CONNACK (bloquante, comme la bibliothèque réelle)
+    uint32_t start = millis();
+    uint8_t header;
+    std::vector<uint8_t> ack;
+    while (!nextPacket(&header, ack)) {
+        if (millis() - start > (uint32_t)socketTimeout_ * 1000UL || !readAvailable()) {
+            state_ = MQTT_CONNECTION_TIMEOUT;
+            client_.stop();
+            return false;
+        }
+        delay(1);
+    }
+    if ((header & 0xF0) != MQTTCONNACK || ack.size() < 2 || ack[1] != 0) {
+        state_ = ack.size() >= 2 ? ack[1] : MQTT_CONNECT_FAILED;
+        client_.stop();
+        return false;
+    }
+    lastInMs_ = millis();
+    state_ = MQTT_CONNECTED;
+    return true;
+}
+
+void PubSubClient::disconnect() {
+    if (client_.connected()) {
+        sendPacket(MQTTDISCONNECT, std::vector<uint8_t>());
+    }
+    state_ = MQTT_DISCONNECTED;
+    client_.stop();
+    rx_.clear();
+}
+
+boolean PubSubClient::publish(const char* topic, const char* payload) {
+    return publish(topic, (const uint8_t*)payload, payload ? strlen(payload) : 0, false);
+}
+
+boolean PubSubClient::publish(const char* topic, const char* payload, boolean retained) {
+    return publish(topic, (const uint8_t*)payload, payload ? strlen(payload) : 0, retained);
+}
+
+boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength) {
+    return publish(topic, payload, plength, false);
+}
+
+boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained) {
+    if (!connected()) return false;
+    // Même plafond que PubSubClient : le paquet complet doit tenir dans le tampon
+    if (bufferSize_ < MQTT_MAX_HEADER_SIZE + 2 + strlen(topic) + plength) return false;
+
+    std::vector<uint8_t> body;
+    appendString(body, topic);
+    if (plength > 0) body.insert(body.end(), payload, payload + plength);
+    return sendPacket(MQTTPUBLISH | (retained ? 0x01 : 0x00), body);
+}
+
+boolean PubSubClient::subscribe(const char* topic, uint8_t qos) {
+    if (!connected() || qos > 1) return false;
+    if (bufferSize_ < 9 + strlen(topic)) return false;
+    std::vector<uint8_t> body;
+    uint16_t id = nextMsgId();
+    body.push_back((uint8_t)(id >> 8));
+    body.push_back((uint8_t)(id & 0xFF));
+    appendString(body, topic);
+    body.push_back(qos);
+    return sendPacket(MQTTSUBSCRIBE, body);
+}
+
+boolean PubSubClient::unsubscribe(const char* topic) {
+    if (!connected()) return false;
+    std::vector<uint8_t> body;
+    uint16_t id = nextMsgId();
+    body.push_back((uint8_t)(id >> 8));
+    body.push_back((uint8_t)(id & 0xFF));
+    appendString(body, topic);
+    return sendPacket(MQTTUNSUBSCRIBE, body);
+}
+
+boolean PubSubClient::loop() {
+    if (!connected()) return false;
+
+    uint32_t now = millis();
+    uint32_t keepAliveMs = (uint32_t)keepAlive_ * 1000UL;
+    if (keepAliveMs > 0 && (now - lastInMs_ > keepAliveMs || now - lastOutMs_ > keepAliveMs)) {
+        if (pingOutstanding_) {
+            state_ = MQTT_CONNECTION_TIMEOUT;
+            client_.stop();
+            return false;
+        }
+        sendPacket(MQTTPINGREQ, std::vector<uint8_t>());
+        lastOutMs_ = now;
+        lastInMs_ = now;
+        pingOutstanding_ = true;
+    }
+
+    if (!readAvailable()) return false;
+
+    uint8_t header;
+    std::vector<uint8_t> body;
+    while (nextPacket(&header, body)) {
+        lastInMs_ = millis();
+        handlePacket(header, body);
+    }
+    return connected();
+}
+
+boolean PubSubClient::connected() {
+    if (state_ != MQTT_CONNECTED) return false;
+    if (!client_.connected()) {
+        state_ = MQTT_CONNECTION_LOST;
+        return false;
+    }
+    return true;
+}
+
+bool PubSubClient::sendPacket(uint8_t header, const std::vector<uint8_t>& body) {
+    std::vector<uint8_t> packet;
+    packet.reserve(body.size() + MQTT_MAX_HEADER_SIZE);
+    packet.push_back(header);
+    size_t len = body.size();
+    do {
+        uint8_t digit = len % 128;
+        len /= 128;
+        if (len > 0) digit |= 0x80;
+        packet.push_back(digit);
+    } while (len > 0);
+    packet.insert(packet.end(), body.begin(), body.end());
+
+    bool ok = client_.write(packet.data(), packet.size()) == packet.size();
+    lastOutMs_ = millis();
+    return ok;
+}
+
+// Lit tout ce que la socket a reçu ; false si la connexion est perdue
+bool PubSubClient::readAvailable() {
+    uint8_t buf[512];
+    int avail;
+    while ((avail = client_.available()) > 0) {
+        int n = client_.read(buf, avail < (int)sizeof(buf) ? avail : sizeof(buf));
+        if (n < 0) {
+            state_ = MQTT_CONNECTION_LOST;
+            return false;
+        }
+        rx_.insert(rx_.end(), buf, buf + n);
+    }
+    return client_.connected();
+}
+
+// Extrait un paquet complet du tampon de réception
+bool PubSubClient::nextPacket(uint8_t* header, std::vector<uint8_t>& body) {
+    size_t pos = 1;
+    size_t len = 0;
+    size_t multiplier = 1;
+    for (;;) {
+        if (pos >= rx_.size()) return false;
+        uint8_t digit = rx_[pos++];
+        len += (digit & 0x7F) * multiplier;
+        multiplier *= 128;
+        if ((digit & 0x80) == 0) break;
+        if (pos > 4) {
+            // Longueur invalide : flux corrompu
+            state_ = MQTT_CONNECTION_LOST;
+            client_.stop();
+            rx_.clear();
+            return false;
+        }
+    }
+    if (rx_.size() < pos + len) return false;
+
+    *header = rx_[0];
+    body.assign(rx_.begin() + pos, rx_.begin() + pos + len);
+    rx_.erase(rx_.begin(), rx_.begin() + pos + len);
+
+    // Paquet plus grand que le tampon : ignoré, comme PubSubClient
+    if (pos + len > bufferSize_) {
+        body.clear();
+        *header = 0;
+    }
+    return true;
+}
+
+void PubSubClient::handlePacket(uint8_t header, const std::vector<uint8_t>& body) {
+    switch (header & 0xF0) {
+        case MQTTPUBLISH: {
+            if (body.size() < 2) return;
+            uint16_t topicLen = (uint16_t)((body[0] << 8) | body[1]);
+            size_t pos = 2 + topicLen;
+            uint8_t qos = (header >> 1) & 0x03;
+            uint16_t msgId = 0;
+            if (qos > 0) {
+                if (body.size() < pos + 2) return;
+                msgId = (uint16_t)((body[pos] << 8) | body[pos + 1]);
+                pos += 2;
+            }
+            if (body.size() < pos) return;
+
+            std::string topic((const char*)&body[2], topicLen);
+            std::vector<uint8_t> payload(body.begin() + pos, body.end());
+            payload.push_back('\0');  // Le callback reçoit la longueur ; sentinelle pour les lectures en chaîne
+            if (callback_) {
+                callback_(&topic[0], payload.data(), (unsigned int)(payload.size() - 1));
+            }
+            if (qos == 1) {
+                std::vector<uint8_t> ack = { (uint8_t)(msgId >> 8), (uint8_t)(msgId & 0xFF) };
+                sendPacket(MQTTPUBACK, ack);
+            }
+            break;
+        }
+        case MQTTPINGRESP:
+            pingOutstanding_ = false;
+            break;
+        case MQTTPINGREQ:
+            sendPacket(MQTTPINGRESP, std::vector<uint8_t>());
+            break;
+        default:
+            // SUBACK, UNSUBACK, PUBACK : rien à faire en QoS 0
+            break;
+    }
+}
+
+uint16_t PubSubClient::nextMsgId() {
+    if (++msgId_ == 0) msgId_ = 1;
+    return msgId_;
+}
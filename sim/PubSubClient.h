@@ -0,0 +1,85 @@
+#ifndef SIM_PUBSUBCLIENT_H
+#define SIM_PUBSUBCLIENT_H
+
+// Client MQTT 3.1.1 du simulateur, compatible avec l'API de PubSubClient
+// (knolleary/PubSubClient 2.8) utilisée par src/mqtt.cpp. Mêmes limites que
+// la bibliothèque réelle : QoS 0 en émission, paquets plafonnés à
+// getBufferSize() octets, pas réentrant (le firmware sérialise les appels).
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define MQTT_MAX_PACKET_SIZE 256
+#define MQTT_KEEPALIVE 15
+#define MQTT_SOCKET_TIMEOUT 15
+#define MQTT_MAX_HEADER_SIZE 5
+
+#define MQTT_CONNECTION_TIMEOUT     -4
+#define MQTT_CONNECTION_LOST        -3
+#define MQTT_CONNECT_FAILED         -2
+#define MQTT_DISCONNECTED           -1
+#define MQTT_CONNECTED               0
+#define MQTT_CONNECT_BAD_PROTOCOL    1
+#define MQTT_CONNECT_BAD_CLIENT_ID   2
+#define MQTT_CONNECT_UNAVAILABLE     3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED    5
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+class PubSubClient {
+public:
+    explicit PubSubClient(WiFiClient& client);
+
+    PubSubClient& setServer(const char* domain, uint16_t port);
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+    PubSubClient& setKeepAlive(uint16_t keepAlive);
+    PubSubClient& setSocketTimeout(uint16_t timeout);
+    boolean setBufferSize(uint16_t size);
+    uint16_t getBufferSize() const { return bufferSize_; }
+
+    boolean connect(const char* id);
+    boolean connect(const char* id, const char* user, const char* pass);
+    boolean connect(const char* id, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage);
+    boolean connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos,
+                    boolean willRetain, const char* willMessage, boolean cleanSession = true);
+    void disconnect();
+
+    boolean publish(const char* topic, const char* payload);
+    boolean publish(const char* topic, const char* payload, boolean retained);
+    boolean publish(const char* topic, const uint8_t* payload, unsigned int plength);
+    boolean publish(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained);
+
+    boolean subscribe(const char* topic, uint8_t qos = 0);
+    boolean unsubscribe(const char* topic);
+
+    boolean loop();
+    boolean connected();
+    int state() const { return state_; }
+
+private:
+    bool sendPacket(uint8_t header, const std::vector<uint8_t>& body);
+    bool readAvailable();
+    bool nextPacket(uint8_t* header, std::vector<uint8_t>& body);
+    void handlePacket(uint8_t header, const std::vector<uint8_t>& body);
+    uint16_t nextMsgId();
+
+    WiFiClient& client_;
+    std::string domain_;
+    uint16_t port_ = 1883;
+    std::function<void(char*, uint8_t*, unsigned int)> callback_;
+    uint16_t keepAlive_ = MQTT_KEEPALIVE;
+    uint16_t socketTimeout_ = MQTT_SOCKET_TIMEOUT;
+    uint16_t bufferSize_ = MQTT_MAX_PACKET_SIZE;
+    int state_ = MQTT_DISCONNECTED;
+    uint16_t msgId_ = 0;
+    uint32_t lastOutMs_ = 0;
+    uint32_t lastInMs_ = 0;
+    bool pingOutstanding_ = false;
+    std::vector<uint8_t> rx_;
+};
+
+#endif // SIM_PUBSUBCLIENT_H
@@ -0,0 +1,47 @@
+#ifndef SIM_WIFI_H
+#define SIM_WIFI_H
+
+// Réseau simulé : le lien WiFi suit le point d'accès de sim_wifi.h et
+// WiFiClient est une socket TCP POSIX (transport du client MQTT du simulateur).
+
+#include <Arduino.h>
+#include "sim_wifi.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class WiFiClass {
+public:
+    wl_status_t status() const { return simWifiLinkUp() ? WL_CONNECTED : WL_DISCONNECTED; }
+    int RSSI() const { return -40; }
+};
+
+extern WiFiClass WiFi;
+
+class WiFiClient {
+public:
+    WiFiClient() {}
+    ~WiFiClient() { stop(); }
+    WiFiClient(const WiFiClient&) = delete;
+    WiFiClient& operator=(const WiFiClient&) = delete;
+
+    int connect(const char* host, uint16_t port);
+    size_t write(const uint8_t* buf, size_t size);
+    int available();
+    int read();
+    int read(uint8_t* buf, size_t size);
+    uint8_t connected();
+    void stop();
+    int setNoDelay(bool nodelay);
+
+private:
+    int fd_ = -1;
+};
+
+#endif // SIM_WIFI_H
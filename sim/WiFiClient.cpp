@@ -0,0 +1,105 @@
+#include <WiFi.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiClass WiFi;
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    stop();
+    if (!simWifiLinkUp()) return 0;
+
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    char portStr[8];
+    snprintf(portStr, sizeof(portStr), "%u", port);
+
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host, portStr, &hints, &result) != 0) {
+        return 0;
+    }
+    for (struct addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+        int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            fd_ = fd;
+            break;
+        }
+        close(fd);
+    }
+    freeaddrinfo(result);
+    return fd_ >= 0 ? 1 : 0;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+    if (fd_ < 0) return 0;
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t n = send(fd_, buf + sent, size - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            stop();
+            return sent;
+        }
+        sent += (size_t)n;
+    }
+    return sent;
+}
+
+int WiFiClient::available() {
+    if (fd_ < 0) return 0;
+    int count = 0;
+    if (ioctl(fd_, FIONREAD, &count) < 0) return 0;
+    return count;
+}
+
+int WiFiClient::read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+    if (fd_ < 0) return -1;
+    ssize_t n = recv(fd_, buf, size, 0);
+    if (n <= 0) {
+        if (n < 0 && errno == EINTR) return 0;
+        stop();
+        return -1;
+    }
+    return (int)n;
+}
+
+uint8_t WiFiClient::connected() {
+    if (fd_ < 0) return 0;
+    // Lien WiFi perdu : la connexion TCP ne survit pas
+    if (!simWifiLinkUp()) {
+        stop();
+        return 0;
+    }
+    // Fermeture par le broker : recv() non bloquant renvoie 0
+    uint8_t b;
+    ssize_t n = recv(fd_, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiClient::stop() {
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+int WiFiClient::setNoDelay(bool nodelay) {
+    if (fd_ < 0) return -1;
+    int flag = nodelay ? 1 : 0;
+    return setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
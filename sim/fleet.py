@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""
+Lance une flotte de firmwares simulés (sim/sim_main.cpp) contre un broker local
+et mesure l'écart de commutation entre appareils à partir des fronts GPIO
+journalisés par chaque instance.
+
+Exemples :
+    pio run -e native_sim
+    python sim/fleet.py --count 20 --bursts 30
+    python sim/fleet.py --count 10 --hold      # puis test_mqtt.py --bench --devices ...
+"""
+
+import argparse
+import csv
+import json
+import os
+import random
+import subprocess
+import sys
+import threading
+import time
+
+import paho.mqtt.client as mqtt
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.insert(0, REPO_ROOT)
+
+from mqtt_broker import EmbeddedBroker  # noqa: E402
+from test_mqtt import summarize  # noqa: E402
+
+DEFAULT_BINARY = os.path.join(REPO_ROOT, ".pio", "build", "native_sim", "program")
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="Flotte de firmwares ESP32 simulés")
+    parser.add_argument("--binary", default=DEFAULT_BINARY, help="Exécutable du simulateur")
+    parser.add_argument("--count", type=int, default=10, help="Nombre d'instances")
+    parser.add_argument("--prefix", default="sim", help="Préfixe des noms d'appareils")
+    parser.add_argument("--broker", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=18830)
+    parser.add_argument("--external-broker", action="store_true", help="Ne pas démarrer le broker intégré")
+    parser.add_argument("--group", default="fleet", help="Groupe de diffusion rejoint par toutes les instances")
+    parser.add_argument("--per-device", action="store_true",
+                        help="Une publication par appareil au lieu d'une seule sur le topic du groupe")
+    parser.add_argument("--relay", default="RelaisK1", help="Relais commuté pendant les rafales")
+    parser.add_argument("--gpio", type=int, default=32, help="GPIO du relais commuté")
+    parser.add_argument("--skew-ms", type=float, default=500.0, help="Décalage d'horloge initial max (±ms)")
+    parser.add_argument("--drift-ppm", type=int, default=40, help="Dérive d'horloge max (±ppm)")
+    parser.add_argument("--syncs", type=int, default=3, help="Synchronisations de l'heure avant les rafales")
+    parser.add_argument("--bursts", type=int, default=20, help="Rafales de commandes programmées")
+    parser.add_argument("--lead-ms", type=int, default=500, help="Avance des commandes programmées (ms)")
+    parser.add_argument("--spacing-ms", type=int, default=300, help="Espacement des rafales (ms)")
+    parser.add_argument("--out", default="sim_out", help="Répertoire des journaux et fronts")
+    parser.add_argument("--output", default=None, help="Fichier JSON des résultats (défaut: <out>/fleet_results.json)")
+    parser.add_argument("--hold", action="store_true", help="Garder la flotte en marche (Ctrl+C pour arrêter)")
+    parser.add_argument("--seed", type=int, default=None, help="Graine des décalages d'horloge")
+    return parser.parse_args()
+
+
+def launch_fleet(args, names):
+    """Démarre une instance par appareil, avec horloge décalée et journal de fronts"""
+    rng = random.Random(args.seed)
+    procs = []
+    for name in names:
+        skew_us = int(rng.uniform(-args.skew_ms, args.skew_ms) * 1000)
+        drift = rng.randint(-args.drift_ppm, args.drift_ppm)
+        cmd = [args.binary, "--name", name, "--broker", args.broker, "--port", str(args.port),
+               "--groups", args.group, "--edges", os.path.join(args.out, f"{name}.csv"),
+               "--skew-us", str(skew_us), "--drift-ppm", str(drift)]
+        log = open(os.path.join(args.out, f"{name}.log"), "w")
+        procs.append((name, subprocess.Popen(cmd, stdin=subprocess.PIPE, stdout=log, stderr=subprocess.STDOUT), log))
+    return procs
+
+
+def stop_fleet(procs):
+    for _, proc, _ in procs:
+        try:
+            proc.stdin.write(b"quit\n")
+            proc.stdin.flush()
+        except (BrokenPipeError, OSError):
+            pass
+    for _, proc, log in procs:
+        try:
+            proc.wait(timeout=3)
+        except subprocess.TimeoutExpired:
+            proc.kill()
+        log.close()
+
+
+def wait_online(client, names, timeout):
+    """Attend la disponibilité 'online' de chaque instance"""
+    online = set()
+    done = threading.Event()
+
+    def on_message(c, userdata, msg):
+        device = msg.topic.split('/')[0]
+        if msg.payload == b"online" and device in names:
+            online.add(device)
+            if len(online) == len(names):
+                done.set()
+
+    client.on_message = on_message
+    client.subscribe("+/availability")
+    done.wait(timeout)
+    return online
+
+
+def publish_time_sync(client):
+    now = time.time()
+    seconds = int(now)
+    client.publish("esp32/time/sync", json.dumps({"seconds": seconds, "us": int((now - seconds) * 1000000)}), qos=1)
+
+
+def run_bursts(client, args, names):
+    """Rafales de commandes programmées ; retourne l'échéance (heure hôte, µs) de chaque rafale"""
+    targets = []
+    for b in range(args.bursts):
+        exec_at_us = int((time.time() + args.lead_ms / 1000.0) * 1000000)
+        state = (b + 1) % 2  # Les relais démarrent à 0 : chaque rafale produit un front
+        payload = {"state": state, "exec_at": exec_at_us // 1000000, "exec_at_us": exec_at_us % 1000000,
+                   "id": f"fleet-{b}"}
+        if args.per_device:
+            for name in names:
+                client.publish(f"{name}/control/{args.relay}/set", json.dumps(payload), qos=1)
+        else:
+            # Une seule publication : le broker la distribue à chaque membre du groupe
+            client.publish(f"esp32/group/{args.group}/control/{args.relay}/set", json.dumps(payload), qos=1)
+        targets.append(exec_at_us)
+        time.sleep(args.spacing_ms / 1000.0)
+    return targets
+
+
+def load_edges(path, gpio):
+    with open(path) as f:
+        return [int(row["host_us"]) for row in csv.DictReader(f) if int(row["gpio"]) == gpio]
+
+
+def analyze(args, names, targets):
+    """Écart de commutation entre appareils par rafale, à partir des fronts horodatés par l'hôte"""
+    edges = {name: load_edges(os.path.join(args.out, f"{name}.csv"), args.gpio) for name in names}
+    skews, lateness = [], []
+    missing = 0
+    for k, target in enumerate(targets):
+        times = [edges[name][k] for name in names if k < len(edges[name])]
+        missing += len(names) - len(times)
+        if times:
+            lateness.extend((t - target) / 1000.0 for t in times)
+        if len(times) > 1:
+            skews.append((max(times) - min(times)) / 1000.0)
+    return {
+        "timestamp": int(time.time()),
+        "devices": len(names),
+        "bursts": len(targets),
+        "params": {"skew_ms": args.skew_ms, "drift_ppm": args.drift_ppm, "syncs": args.syncs,
+                   "lead_ms": args.lead_ms, "spacing_ms": args.spacing_ms,
+                   "fanout": "device" if args.per_device else f"group:{args.group}"},
+        "switch_skew_ms": summarize(skews),
+        "switch_lateness_ms": summarize(lateness),
+        "missing_edges": missing,
+    }
+
+
+def main():
+    args = parse_args()
+    if not os.path.exists(args.binary):
+        print(f"❌ Simulateur introuvable: {args.binary} (compiler avec: pio run -e native_sim)")
+        return 2
+    os.makedirs(args.out, exist_ok=True)
+    names = [f"{args.prefix}{i + 1:02d}" for i in range(args.count)]
+
+    if not args.external_broker:
+        EmbeddedBroker(host=args.broker, port=args.port).start()
+        print(f"✓ Broker intégré démarré sur {args.broker}:{args.port}")
+
+    procs = launch_fleet(args, names)
+    client = mqtt.Client(mqtt.CallbackAPIVersion.VERSION2, client_id=f"ESP32_Fleet_{os.getpid()}")
+    try:
+        client.connect(args.broker, args.port, 60)
+        client.loop_start()
+
+        online = wait_online(client, names, timeout=10 + args.count * 0.1)
+        print(f"✓ {len(online)}/{len(names)} instance(s) en ligne")
+        if len(online) < len(names):
+            print(f"⚠ Hors ligne: {', '.join(sorted(set(names) - online))}")
+
+        if args.hold:
+            print("Flotte en marche. Exemple de benchmark:")
+            print(f"  python test_mqtt.py --bench --port {args.port} --devices {','.join(names)}")
+            print("Ctrl+C pour arrêter.")
+            while True:
+                time.sleep(1)
+
+        for _ in range(args.syncs):
+            publish_time_sync(client)
+            time.sleep(1)
+
+        fanout = "par appareil" if args.per_device else f"groupe '{args.group}'"
+        print(f"🗓️  {args.bursts} rafale(s) sur {len(names)} appareil(s), {fanout}")
+        targets = run_bursts(client, args, names)
+        time.sleep(args.lead_ms / 1000.0 + 1.0)
+    except KeyboardInterrupt:
+        targets = None
+    finally:
+        client.loop_stop()
+        client.disconnect()
+        stop_fleet(procs)
+
+    if not targets:
+        return 0
+
+    results = analyze(args, names, targets)
+    output = args.output or os.path.join(args.out, "fleet_results.json")
+    with open(output, "w") as f:
+        json.dump(results, f, indent=2)
+        f.write("\n")
+    print(json.dumps(results, indent=2))
+    print(f"✓ Résultats écrits dans {output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,20 @@
+#ifndef SIM_FREERTOS_TASK_H
+#define SIM_FREERTOS_TASK_H
+
+// Tâches FreeRTOS simulées par des threads POSIX (cœur et priorité ignorés)
+
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                                   void* params, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t coreId);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelete(TaskHandle_t task);
+// Pile jamais utilisée (octets, comme ESP-IDF). Non mesurée : les threads ont la
+// pile Linux par défaut, la taille demandée à la création est retournée.
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+#endif // SIM_FREERTOS_TASK_H
@@ -0,0 +1,79 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <pthread.h>
+#include <stdio.h>
+
+// ===== Tâches =====
+struct SimTask {
+    TaskFunction_t fn;
+    void* params;
+};
+
+static std::mutex stackSizesMutex;
+static std::map<TaskHandle_t, uint32_t> stackSizes;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                                   void* params, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t coreId) {
+    (void)priority;
+    (void)coreId;
+    std::thread thread(task, params);
+#if defined(__linux__)
+    // Nom visible dans top -H / gdb (15 caractères max)
+    char shortName[16];
+    snprintf(shortName, sizeof(shortName), "%s", name);
+    pthread_setname_np(thread.native_handle(), shortName);
+#else
+    (void)name;
+#endif
+    {
+        std::lock_guard<std::mutex> lock(stackSizesMutex);
+        stackSizes[(TaskHandle_t)thread.native_handle()] = stackDepth;
+    }
+    if (handle != nullptr) {
+        *handle = (TaskHandle_t)thread.native_handle();
+    }
+    thread.detach();
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    std::lock_guard<std::mutex> lock(stackSizesMutex);
+    auto it = stackSizes.find(task != nullptr ? task : (TaskHandle_t)pthread_self());
+    return it != stackSizes.end() ? it->second : 0;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // Seule l'auto-suppression est utilisée par le firmware
+    if (task == nullptr) {
+        pthread_exit(nullptr);
+    }
+}
+
+// ===== Mutex récursif =====
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+    return new std::recursive_timed_mutex();
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks) {
+    auto* mutex = static_cast<std::recursive_timed_mutex*>(sem);
+    if (ticks == portMAX_DELAY) {
+        mutex->lock();
+        return pdTRUE;
+    }
+    return mutex->try_lock_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) {
+    static_cast<std::recursive_timed_mutex*>(sem)->unlock();
+    return pdTRUE;
+}
@@ -0,0 +1,322 @@
+#include <Arduino.h>
+#include <atomic>
+#include <malloc.h>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <chrono>
+#include <time.h>
+#include "sim_gpio.h"
+#include "sim_clock.h"
+
+HardwareSerial Serial;
+
+// ===== String =====
+String::String(double value, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+    s_ = buf;
+}
+
+void String::fromInteger(long long value, unsigned char base) {
+    if (base == DEC) {
+        s_ = std::to_string(value);
+    } else {
+        fromUnsigned((unsigned long long)value, base);
+    }
+}
+
+void String::fromUnsigned(unsigned long long value, unsigned char base) {
+    if (base < 2 || base > 36) base = DEC;
+    char buf[72];
+    int i = sizeof(buf) - 1;
+    buf[i] = '\0';
+    do {
+        int digit = value % base;
+        buf[--i] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value > 0);
+    s_ = &buf[i];
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t pos = s_.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& str, unsigned int from) const {
+    size_t pos = s_.find(str.s_, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) { unsigned int t = from; from = to; to = t; }
+    if (from >= s_.length()) return String();
+    if (to > s_.length()) to = s_.length();
+    return String(s_.substr(from, to - from));
+}
+
+void String::toLowerCase() {
+    for (auto& c : s_) c = (char)tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for (auto& c : s_) c = (char)toupper((unsigned char)c);
+}
+
+void String::trim() {
+    size_t b = s_.find_first_not_of(" \t\r\n");
+    size_t e = s_.find_last_not_of(" \t\r\n");
+    s_ = b == std::string::npos ? std::string() : s_.substr(b, e - b + 1);
+}
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+size_t strlcat(char* dst, const char* src, size_t size) {
+    size_t used = strnlen(dst, size);
+    if (used == size) return size + strlen(src);
+    return used + strlcpy(dst + used, src, size - used);
+}
+#endif
+
+// ===== Serial =====
+// Plusieurs tâches écrivent en parallèle : une ligne ne doit pas en couper une autre
+static std::mutex serialMutex;
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    if (quiet_) return 0;
+    va_list args;
+    va_start(args, format);
+    std::lock_guard<std::mutex> lock(serialMutex);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n > 0 ? n : 0;
+}
+
+size_t HardwareSerial::print(const char* s) {
+    if (quiet_ || s == nullptr) return 0;
+    std::lock_guard<std::mutex> lock(serialMutex);
+    return fputs(s, stdout) >= 0 ? strlen(s) : 0;
+}
+
+size_t HardwareSerial::print(char c) {
+    char s[2] = { c, '\0' };
+    return print(s);
+}
+
+// ===== Temps =====
+// millis()/micros() sont monotones depuis le démarrage, comme sur l'ESP32 :
+// la synchronisation de l'heure murale ne les affecte pas
+static const auto bootTime = std::chrono::steady_clock::now();
+
+uint32_t millis() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+uint32_t micros() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// ===== GPIO virtuelles =====
+struct SimPin {
+    uint8_t mode;
+    int level;
+    uint16_t analog;
+    void (*isr)(void*);
+    void* isrArg;
+    int isrMode;
+    bool relay;           // Sortie reliée à un contact de retour (simGpioLinkRelay)
+    uint8_t relayInput;
+    uint32_t relayOnUs;
+    uint32_t relayOffUs;
+};
+
+static std::mutex gpioMutex;
+static SimPin pins[SIM_GPIO_COUNT];
+static FILE* edgeLog = nullptr;
+
+bool simGpioOpenEdgeLog(const char* path) {
+    std::lock_guard<std::mutex> lock(gpioMutex);
+    edgeLog = fopen(path, "w");
+    if (edgeLog == nullptr) return false;
+    fprintf(edgeLog, "host_us,device_us,gpio,level\n");
+    fflush(edgeLog);
+    return true;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= SIM_GPIO_COUNT) return;
+    std::lock_guard<std::mutex> lock(gpioMutex);
+    pins[pin].mode = mode;
+    // Entrée au repos : niveau imposé par le tirage
+    if (mode == INPUT_PULLUP) pins[pin].level = HIGH;
+    else if (mode == INPUT_PULLDOWN) pins[pin].level = LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin >= SIM_GPIO_COUNT) return;
+    // Horodatage avant le verrou : c'est l'instant de la commande qui est mesuré
+    uint64_t hostUs = simClockHostUs();
+    uint64_t deviceUs = simClockDeviceUs();
+    std::lock_guard<std::mutex> lock(gpioMutex);
+    int level = val ? HIGH : LOW;
+    if (pins[pin].level == level) return;
+    pins[pin].level = level;
+    if (edgeLog != nullptr) {
+        fprintf(edgeLog, "%llu,%llu,%u,%d\n", (unsigned long long)hostUs,
+                (unsigned long long)deviceUs, pin, level);
+        fflush(edgeLog);
+    }
+    if (pins[pin].relay) {
+        uint8_t input = pins[pin].relayInput;
+        uint32_t delayUs = level ? pins[pin].relayOnUs : pins[pin].relayOffUs;
+        // Contact mécanique : le retour bascule plus tard, sans bloquer l'appelant
+        std::thread([input, level, delayUs]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(delayUs));
+            uint64_t contactHostUs = simClockHostUs();
+            uint64_t contactDeviceUs = simClockDeviceUs();
+            {
+                std::lock_guard<std::mutex> lock(gpioMutex);
+                if (edgeLog != nullptr) {
+                    fprintf(edgeLog, "%llu,%llu,%u,%d\n", (unsigned long long)contactHostUs,
+                            (unsigned long long)contactDeviceUs, input, level);
+                    fflush(edgeLog);
+                }
+            }
+            simGpioSetInput(input, level);
+        }).detach();
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= SIM_GPIO_COUNT) return LOW;
+    std::lock_guard<std::mutex> lock(gpioMutex);
+    return pins[pin].level;
+}
+
+uint16_t analogRead(uint8_t pin) {
+    if (pin >= SIM_GPIO_COUNT) return 0;
+    std::lock_guard<std::mutex> lock(gpioMutex);
+    return pins[pin].analog;
+}
+
+void analogSetPinAttenuation(uint8_t pin, adc_attenuation_t attenuation) {
+    (void)pin;
+    (void)attenuation;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    if (pin >= SIM_GPIO_COUNT) return;
+    std::lock_guard<std::mutex> lock(gpioMutex);
+    pins[pin].isr = handler;
+    pins[pin].isrArg = arg;
+    pins[pin].isrMode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin >= SIM_GPIO_COUNT) return;
+    std::lock_guard<std::mutex> lock(gpioMutex);
+    pins[pin].isr = nullptr;
+}
+
+void simGpioSetInput(uint8_t pin, int level) {
+    if (pin >= SIM_GPIO_COUNT) return;
+    void (*isr)(void*) = nullptr;
+    void* arg = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(gpioMutex);
+        int previous = pins[pin].level;
+        pins[pin].level = level ? HIGH : LOW;
+        bool rising = previous == LOW && pins[pin].level == HIGH;
+        bool falling = previous == HIGH && pins[pin].level == LOW;
+        int mode = pins[pin].isrMode;
+        if ((rising && (mode == RISING || mode == CHANGE)) || (falling && (mode == FALLING || mode == CHANGE))) {
+            isr = pins[pin].isr;
+            arg = pins[pin].isrArg;
+        }
+    }
+    // L'ISR est appelée hors verrou, comme une interruption réelle
+    if (isr != nullptr) isr(arg);
+}
+
+void simGpioLinkRelay(uint8_t output, uint8_t input, uint32_t onUs, uint32_t offUs) {
+    if (output >= SIM_GPIO_COUNT || input >= SIM_GPIO_COUNT) return;
+    std::lock_guard<std::mutex> lock(gpioMutex);
+    pins[output].relay = true;
+    pins[output].relayInput = input;
+    pins[output].relayOnUs = onUs;
+    pins[output].relayOffUs = offUs;
+}
+
+void simGpioPulse(uint8_t pin, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        simGpioSetInput(pin, LOW);
+        simGpioSetInput(pin, HIGH);
+    }
+}
+
+void simGpioSetAnalog(uint8_t pin, uint16_t value) {
+    if (pin >= SIM_GPIO_COUNT) return;
+    std::lock_guard<std::mutex> lock(gpioMutex);
+    pins[pin].analog = value;
+}
+
+// ===== Divers =====
+static std::mutex randomMutex;
+static std::mt19937 randomEngine(std::random_device{}());
+
+long random(long howbig) {
+    if (howbig <= 0) return 0;
+    std::lock_guard<std::mutex> lock(randomMutex);
+    return (long)(randomEngine() % (unsigned long)howbig);
+}
+
+long random(long howsmall, long howbig) {
+    if (howsmall >= howbig) return howsmall;
+    return howsmall + random(howbig - howsmall);
+}
+
+// ===== Tas =====
+EspClass ESP;
+static std::atomic<uint32_t> minFreeHeap(UINT32_MAX);
+
+uint32_t EspClass::getHeapSize() {
+    return (uint32_t)mallinfo2().arena;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    uint32_t freeBytes = (uint32_t)mallinfo2().fordblks;
+    uint32_t low = minFreeHeap.load();
+    while (freeBytes < low && !minFreeHeap.compare_exchange_weak(low, freeBytes)) {
+    }
+    return freeBytes;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    getFreeHeap();
+    return minFreeHeap.load();
+}
+
+// Pas d'équivalent glibc du plus grand bloc libre : le sommet libre du tas principal
+uint32_t EspClass::getMaxAllocHeap() {
+    return (uint32_t)mallinfo2().keepcost;
+}
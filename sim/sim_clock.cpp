@@ -0,0 +1,50 @@
+#include "sim_clock.h"
+#include <mutex>
+#include <time.h>
+#include <sys/time.h>
+
+static std::mutex clockMutex;
+static int64_t offsetUs = 0;    // Décalage appliqué à l'ancre
+static int32_t driftPpm = 0;    // Dérive du quartz simulé
+static uint64_t anchorUs = 0;   // Heure hôte du dernier recalage
+
+uint64_t simClockHostUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+// À appeler avec clockMutex verrouillé
+static uint64_t deviceUsAt(uint64_t hostUs) {
+    int64_t elapsed = (int64_t)(hostUs - anchorUs);
+    return (uint64_t)((int64_t)hostUs + offsetUs + elapsed * driftPpm / 1000000);
+}
+
+void simClockInit(int64_t skewUs, int32_t ppm) {
+    std::lock_guard<std::mutex> lock(clockMutex);
+    offsetUs = skewUs;
+    driftPpm = ppm;
+    anchorUs = simClockHostUs();
+}
+
+uint64_t simClockDeviceUs() {
+    std::lock_guard<std::mutex> lock(clockMutex);
+    return deviceUsAt(simClockHostUs());
+}
+
+extern "C" int simGettimeofday(struct timeval* tv, void* tz) {
+    (void)tz;
+    uint64_t us = simClockDeviceUs();
+    tv->tv_sec = us / 1000000ULL;
+    tv->tv_usec = us % 1000000ULL;
+    return 0;
+}
+
+extern "C" int simSettimeofday(const struct timeval* tv, const void* tz) {
+    (void)tz;
+    std::lock_guard<std::mutex> lock(clockMutex);
+    uint64_t targetUs = (uint64_t)tv->tv_sec * 1000000ULL + (uint64_t)tv->tv_usec;
+    anchorUs = simClockHostUs();
+    offsetUs = (int64_t)targetUs - (int64_t)anchorUs;
+    return 0;
+}
@@ -0,0 +1,16 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+
+// Horloge murale simulée d'une carte : heure hôte + décalage initial + dérive.
+// settimeofday() (synchro MQTT) recale le décalage sans toucher à l'hôte.
+void simClockInit(int64_t skewUs, int32_t driftPpm);
+
+// Heure hôte (référence commune à toutes les instances d'une même machine)
+uint64_t simClockHostUs();
+
+// Heure vue par le firmware (gettimeofday)
+uint64_t simClockDeviceUs();
+
+#endif // SIM_CLOCK_H
@@ -0,0 +1,51 @@
+#include "sim_flash.h"
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+static int flashFd = -1;
+static std::vector<uint8_t> flashData;
+
+bool simFlashOpenFile(const char* path, uint32_t size) {
+  flashFd = open(path, O_RDWR | O_CREAT, 0644);
+  if (flashFd < 0) return false;
+  flashData.assign(size, 0xFF);
+  ssize_t n = pread(flashFd, flashData.data(), size, 0);
+  if (n < (ssize_t)size) {
+    // Fichier neuf ou plus court : complété en "effacé"
+    if (n < 0) n = 0;
+    if (pwrite(flashFd, flashData.data() + n, size - n, n) != (ssize_t)(size - n)) return false;
+  }
+  return true;
+}
+
+static bool inRange(uint32_t offset, size_t len) {
+  return flashFd >= 0 && offset + len <= flashData.size();
+}
+
+static bool flashRead(void* ctx, uint32_t offset, void* buf, size_t len) {
+  if (!inRange(offset, len)) return false;
+  memcpy(buf, flashData.data() + offset, len);
+  return true;
+}
+
+static bool flashWrite(void* ctx, uint32_t offset, const void* buf, size_t len) {
+  if (!inRange(offset, len)) return false;
+  for (size_t i = 0; i < len; i++) flashData[offset + i] &= ((const uint8_t*)buf)[i];
+  return pwrite(flashFd, flashData.data() + offset, len, offset) == (ssize_t)len;
+}
+
+static bool flashErase(void* ctx, uint32_t offset, size_t len) {
+  if (!inRange(offset, len) || offset % STATE_JOURNAL_SECTOR_SIZE || len % STATE_JOURNAL_SECTOR_SIZE) return false;
+  memset(flashData.data() + offset, 0xFF, len);
+  return pwrite(flashFd, flashData.data() + offset, len, offset) == (ssize_t)len;
+}
+
+static StateJournalFlash simFlash = { flashRead, flashWrite, flashErase, nullptr };
+
+const StateJournalFlash* simFlashOpen(const char* label, uint8_t* sectors) {
+  if (flashFd < 0) return nullptr;
+  *sectors = flashData.size() / STATE_JOURNAL_SECTOR_SIZE;
+  return &simFlash;
+}
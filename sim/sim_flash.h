@@ -0,0 +1,15 @@
+#ifndef SIM_FLASH_H
+#define SIM_FLASH_H
+
+#include <stdint.h>
+#include "state_journal.h"
+
+// Flash NOR émulée dans un fichier (effacement à 0xFF, écriture en ET bit à
+// bit). Chaque écriture part aussitôt dans le fichier : un kill -9 du
+// simulateur se comporte comme une coupure d'alimentation.
+bool simFlashOpenFile(const char* path, uint32_t size);
+
+// Zone de la partition label (NULL sans --flash)
+const StateJournalFlash* simFlashOpen(const char* label, uint8_t* sectors);
+
+#endif // SIM_FLASH_H
@@ -0,0 +1,22 @@
+#ifndef SIM_GPIO_H
+#define SIM_GPIO_H
+
+#include <stdint.h>
+
+#define SIM_GPIO_COUNT 40
+
+// Journal des fronts des sorties : une ligne CSV par changement de niveau
+// "host_us,device_us,gpio,level" (host_us = référence commune aux instances)
+bool simGpioOpenEdgeLog(const char* path);
+
+// Pilotage des entrées virtuelles (déclenche les ISR attachées)
+void simGpioSetInput(uint8_t pin, int level);
+void simGpioPulse(uint8_t pin, uint32_t count);
+void simGpioSetAnalog(uint8_t pin, uint16_t value);
+
+// Relais virtuel : chaque front de la sortie output recopie son niveau sur
+// l'entrée input après onUs (vers HIGH) ou offUs (vers LOW), comme un contact
+// de retour. Les fronts de l'entrée sont aussi journalisés (instant du contact).
+void simGpioLinkRelay(uint8_t output, uint8_t input, uint32_t onUs, uint32_t offUs);
+
+#endif // SIM_GPIO_H
@@ -0,0 +1,393 @@
+// ===== SIMULATEUR LINUX DU FIRMWARE =====
+// Exécute mqtt_callback, l'exécuteur de commandes (CmdTask), la tâche I/O et la
+// synchronisation de l'heure dans un processus Linux, avec un transport MQTT
+// sur socket TCP et des GPIO virtuelles qui journalisent leurs fronts.
+//
+// Usage : program --name sim01 [--broker 127.0.0.1] [--port 1883]
+//                 [--outputs RelaisK1:32,RelaisK2:33:last] [--inputs Porte:4] [--groups a,b]
+//                 [--edges sim01.csv] [--skew-us N] [--drift-ppm N] [--quiet]
+//                 [--flash sim01.flash]  (journal des sorties ; ":last" = restaurée au démarrage)
+//                 [--relay 32:4:8000:5000,...]  (sortie:entrée de retour:délai on:délai off, µs)
+//
+// Entrée standard (une commande par ligne) : "input <gpio> <0|1>",
+// "pulse <gpio> <n>", "analog <gpio> <valeur>", "every <gpio> <secondes> <état>"
+// (programmation périodique alignée sur l'époque), "calibrate <sortie> <retour>"
+// (calibration du délai de commutation), "config <name|broker|port|groups|
+// timezone> <valeur>" (rechargement à chaud de la configuration), "logs"
+// (journal d'événements en NDJSON sur la sortie standard), "memory" (budget
+// mémoire : arènes JSON, tas, piles), "scan" (profil de carte et durée des
+// passes de la tâche I/O), "wifi" (reconnexions et durée perte de lien -> MQTT
+// en ligne), "wifi drop <ms> [moved|renumbered]" (coupure du point d'accès
+// simulé, qui revient sur un autre canal avec moved, sur un autre sous-réseau
+// avec renumbered), "stats <gpio> [intervalle ms [only]]"
+// (statistiques de fronts d'une entrée ; avec un intervalle : résumé MQTT
+// périodique, "only" supprime la publication de chaque front), "quit".
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <getopt.h>
+#include <string>
+
+#include "config.h"
+#include "mqtt.h"
+#include "command_executor.h"
+#include "io_table.h"
+#include "io_task.h"
+#include "json_pool.h"
+#include "event_log.h"
+#include "schedule_table.h"
+#include "actuation_calibration.h"
+#include "config_reload.h"
+#include "memory_budget.h"
+#include "output_journal.h"
+#include "sim_clock.h"
+#include "sim_gpio.h"
+#include "sim_flash.h"
+#include "sim_wifi.h"
+#include "wifi_link.h"
+
+// ===== GLOBAL OBJECTS =====
+Config config;
+
+unsigned long lastMqttReconnect = 0;
+
+TaskHandle_t ioTaskHandle = NULL;
+TaskHandle_t netTaskHandle = NULL;
+TaskHandle_t cmdTaskHandle = NULL;
+
+// Pas de Preferences : la configuration ne survit pas au processus
+void saveConfig() {}
+void saveIOs() {}
+
+// Pas de LED sur une carte simulée : on évite surtout les delay() de clignotement
+void blinkStatusLED(int times, int delayMs) {
+  (void)times;
+  (void)delayMs;
+}
+
+// Même boucle que networkTask (main.cpp), sans OTA
+static void simNetworkTask(void *pvParameters) {
+  Serial.println("✅ Network task started.");
+
+  for (;;) {
+    uint8_t linkEvent = wifiLinkPoll(millis());
+    if (linkEvent == WIFI_RC_EVENT_LOST) {
+      disconnectMQTT();
+    } else if (linkEvent == WIFI_RC_EVENT_UP) {
+      lastMqttReconnect = 0;
+    }
+    if (WiFi.status() == WL_CONNECTED && mqttEnabled) {
+      if (!mqttConnected()) {
+        long now = millis();
+        if (now - lastMqttReconnect > 5000 || lastMqttReconnect == 0) {
+          lastMqttReconnect = now;
+          reconnectMQTT();
+        }
+      }
+      loopMQTT();
+    }
+    mqttFlushOutbound();
+    outputJournalFlush(millis());
+    vTaskDelay(pdMS_TO_TICKS(1));
+  }
+}
+
+// "Nom:gpio,Nom:gpio:last" -> entrées de la table d'I/O
+static bool parsePinList(const char* list, uint8_t mode, IOTable& table) {
+  std::string s(list);
+  size_t start = 0;
+  while (start < s.size()) {
+    size_t end = s.find(',', start);
+    if (end == std::string::npos) end = s.size();
+    std::string item = s.substr(start, end - start);
+    size_t colon = item.find(':');
+    if (colon == std::string::npos || table.count >= MAX_IOS) return false;
+
+    int gpio = atoi(item.c_str() + colon + 1);
+    if (gpio < 0 || gpio >= MAX_GPIO) return false;
+
+    if (ioNameReserved(item.substr(0, colon).c_str())) return false;
+
+    IOPin& pin = table.pins[table.count++];
+    memset(&pin, 0, sizeof(pin));
+    strlcpy(pin.name, item.substr(0, colon).c_str(), sizeof(pin.name));
+    pin.pin = gpio;
+    pin.mode = mode;
+    pin.inputType = 1;  // INPUT_PULLUP
+    pin.calGain = ANALOG_GAIN_ONE;
+    size_t policy = item.find(':', colon + 1);
+    if (policy != std::string::npos && item.compare(policy + 1, std::string::npos, "last") == 0) {
+      pin.restorePolicy = RESTORE_LAST;
+    }
+    start = end + 1;
+  }
+  return true;
+}
+
+// "32:4:8000:5000,33:5:12000:6000" -> relais virtuels (sortie, entrée de retour, délais en µs)
+static bool parseRelayList(const char* list) {
+  std::string s(list);
+  size_t start = 0;
+  while (start < s.size()) {
+    size_t end = s.find(',', start);
+    if (end == std::string::npos) end = s.size();
+    unsigned output, input, onUs, offUs;
+    if (sscanf(s.substr(start, end - start).c_str(), "%u:%u:%u:%u", &output, &input, &onUs, &offUs) != 4 ||
+        output >= SIM_GPIO_COUNT || input >= SIM_GPIO_COUNT) {
+      return false;
+    }
+    simGpioLinkRelay(output, input, onUs, offUs);
+    start = end + 1;
+  }
+  return true;
+}
+
+static void usage(const char* prog) {
+  fprintf(stderr,
+          "Usage: %s --name NAME [--broker HOST] [--port N] [--outputs Nom:gpio,...]\n"
+          "          [--inputs Nom:gpio,...] [--groups a,b] [--edges FILE] [--skew-us N] [--drift-ppm N] [--quiet]\n"
+          "          [--flash FILE]  (sorties Nom:gpio:last : dernier état restauré au démarrage)\n"
+          "          [--relay sortie:retour:onUs:offUs,...]\n",
+          prog);
+}
+
+int main(int argc, char** argv) {
+  const char* name = "sim";
+  const char* broker = "127.0.0.1";
+  int port = 1883;
+  const char* outputs = "RelaisK1:32,RelaisK2:33,RelaisK3:25,RelaisK4:26";
+  const char* inputs = "";
+  const char* groups = "";
+  const char* edgesPath = nullptr;
+  const char* relays = "";
+  const char* flashPath = nullptr;
+  long long skewUs = 0;
+  int driftPpm = 0;
+  bool quiet = false;
+
+  static const struct option options[] = {
+    { "name", required_argument, nullptr, 'n' },
+    { "broker", required_argument, nullptr, 'b' },
+    { "port", required_argument, nullptr, 'p' },
+    { "outputs", required_argument, nullptr, 'o' },
+    { "inputs", required_argument, nullptr, 'i' },
+    { "groups", required_argument, nullptr, 'g' },
+    { "edges", required_argument, nullptr, 'e' },
+    { "skew-us", required_argument, nullptr, 's' },
+    { "drift-ppm", required_argument, nullptr, 'd' },
+    { "quiet", no_argument, nullptr, 'q' },
+    { "relay", required_argument, nullptr, 'r' },
+    { "flash", required_argument, nullptr, 'f' },
+    { nullptr, 0, nullptr, 0 }
+  };
+  int opt;
+  while ((opt = getopt_long(argc, argv, "", options, nullptr)) != -1) {
+    switch (opt) {
+      case 'n': name = optarg; break;
+      case 'b': broker = optarg; break;
+      case 'p': port = atoi(optarg); break;
+      case 'o': outputs = optarg; break;
+      case 'i': inputs = optarg; break;
+      case 'g': groups = optarg; break;
+      case 'e': edgesPath = optarg; break;
+      case 's': skewUs = atoll(optarg); break;
+      case 'd': driftPpm = atoi(optarg); break;
+      case 'q': quiet = true; break;
+      case 'r': relays = optarg; break;
+      case 'f': flashPath = optarg; break;
+      default: usage(argv[0]); return 2;
+    }
+  }
+
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  Serial.setQuiet(quiet);
+  simClockInit(skewUs, driftPpm);
+  if (edgesPath != nullptr && !simGpioOpenEdgeLog(edgesPath)) {
+    fprintf(stderr, "Cannot open edge log %s\n", edgesPath);
+    return 1;
+  }
+
+  Serial.println("\n\n=== ESP32 Generic IO Controller (simulator) ===");
+  eventLogWrite(EVENT_BOOT, 0, 0, "sim");
+
+  for (int i = 0; i < MAX_SCHEDULED_COMMANDS; i++) {
+    scheduledCommands[i].active = false;
+  }
+  commandQueueInit(COMMAND_QUEUE_DEPTH);
+  outboundQueueInit(OUTBOUND_QUEUE_DEPTH);
+  scheduleTableInit();
+  scheduleTableSetTimezone(SCHEDULE_DEFAULT_TZ, 0);
+
+  // Configuration : pas de Preferences, tout vient de la ligne de commande
+  strlcpy(config.deviceName, name, sizeof(config.deviceName));
+  strlcpy(config.mqttServer, broker, sizeof(config.mqttServer));
+  config.mqttPort = port;
+  snprintf(config.mqttTopic, sizeof(config.mqttTopic), "%s/io", config.deviceName);
+  groupListNormalize(groups, config.groups, sizeof(config.groups));
+
+  bool pinsOk = true;
+  ioTableUpdate([&](IOTable& table) {
+    table.count = 0;
+    pinsOk = parsePinList(outputs, 2, table) && parsePinList(inputs, 1, table);  // OUTPUT / INPUT
+    ioTableApplyBoardProfile(table);
+  });
+  if (!pinsOk || !parseRelayList(relays)) {
+    usage(argv[0]);
+    return 2;
+  }
+  // Zone du journal des sorties : 4 secteurs, comme la partition "outstate"
+  if (flashPath != nullptr && !simFlashOpenFile(flashPath, 4 * STATE_JOURNAL_SECTOR_SIZE)) {
+    fprintf(stderr, "Cannot open flash file %s\n", flashPath);
+    return 1;
+  }
+  outputJournalBegin();
+  applyIOPinModes();
+
+  // Lien simulé déjà établi : cache rempli, reconnexions confiées à NetTask
+  if (!wifiLinkBegin()) wifiLinkConnected();
+
+  setupMQTT();
+  mqttEnabled = true;
+
+  xTaskCreatePinnedToCore(commandTask, "CmdTask", CMD_TASK_STACK, NULL, CMD_TASK_PRIORITY, &cmdTaskHandle, CMD_TASK_CORE);
+  xTaskCreatePinnedToCore(handleIOs, "IOTask", IO_TASK_STACK, NULL, IO_TASK_PRIORITY, &ioTaskHandle, IO_TASK_CORE);
+  xTaskCreatePinnedToCore(simNetworkTask, "NetTask", NET_TASK_STACK, NULL, NET_TASK_PRIORITY, &netTaskHandle, NET_TASK_CORE);
+
+  // Stimuli des entrées virtuelles sur l'entrée standard
+  char line[128];
+  while (fgets(line, sizeof(line), stdin) != nullptr) {
+    char cmd[16];
+    unsigned int gpio = 0;
+    unsigned long value = 0;
+    int n = sscanf(line, "%15s %u %lu", cmd, &gpio, &value);
+    if (n >= 1 && strcmp(cmd, "quit") == 0) break;
+    if (n >= 1 && strcmp(cmd, "logs") == 0) {
+      char json[EVENT_JSON_MAX_LEN];
+      for (uint32_t seq = eventLogOldest(&eventLog); seq < eventLogHead(&eventLog); seq++) {
+        EventRecord rec;
+        if (eventLogRead(&eventLog, seq, &rec) && eventLogFormatJson(&rec, json, sizeof(json)) > 0) {
+          fputs(json, stdout);
+        }
+      }
+      continue;
+    }
+    if (n >= 1 && strcmp(cmd, "memory") == 0) {
+      MemoryReport report;
+      char text[1536];
+      memoryBudgetCollect(&report);
+      memoryReportFormat(&report, text, sizeof(text));
+      fputs(text, stdout);
+      continue;
+    }
+    if (n >= 1 && strcmp(cmd, "scan") == 0) {
+      IOScanStats stats;
+      ioScanGetStats(&stats);
+      printf("board %s (%d fixed pins): %lu passes, avg %lu us, max %lu us\n", BoardProfile::name(),
+             BOARD_FIXED_PIN_COUNT, (unsigned long)stats.passes, (unsigned long)stats.avgUs,
+             (unsigned long)stats.maxUs);
+      continue;
+    }
+    if (n >= 1 && strcmp(cmd, "wifi") == 0) {
+      char action[16] = "";
+      unsigned long ms = 0;
+      char change[16] = "";
+      sscanf(line, "%*s %15s %lu %15s", action, &ms, change);
+      if (strcmp(action, "drop") == 0) {
+        simWifiDrop(ms, strcmp(change, "moved") == 0, strcmp(change, "renumbered") == 0);
+        continue;
+      }
+      WifiLinkStats stats;
+      wifiLinkGetStats(&stats);
+      const WifiReconnectStats& r = stats.reconnect;
+      printf("wifi %s (channel %u): %lu losses, fast %lu ok / %lu failed, %lu addr rejected, "
+             "scan %lu ok / %lu failed, link %lu ms, online %lu ms (avg %lu, max %lu)\n",
+             wifiReconnectStateName(stats.state), stats.channel, (unsigned long)r.losses, (unsigned long)r.fastOk,
+             (unsigned long)r.fastFailed, (unsigned long)r.addrRejected, (unsigned long)r.scanOk,
+             (unsigned long)r.scanFailed, (unsigned long)r.lastLinkMs, (unsigned long)r.lastOnlineMs, (unsigned long)r.avgOnlineMs,
+             (unsigned long)r.maxOnlineMs);
+      continue;
+    }
+    if (n >= 2 && strcmp(cmd, "stats") == 0) {
+      char only[16] = "";
+      sscanf(line, "%*s %*u %*u %15s", only);
+      int index;
+      {
+        IOTableReader io;
+        index = ioTableFindByPin(io.get(), gpio);
+        if (index < 0 || io->pins[index].mode != 1) { // INPUT
+          fprintf(stderr, "stats: GPIO %u is not an input\n", gpio);
+          continue;
+        }
+      }
+      if (n == 3) {
+        ioTableUpdate([&](IOTable& table) {
+          table.pins[index].statsIntervalMs = value;
+          table.pins[index].statsOnly = strcmp(only, "only") == 0;
+          ioTableApplyBoardProfile(table);
+        });
+        continue;
+      }
+      IOTableReader io;
+      EdgeStats stats;
+      PooledJsonDocument doc;
+      if (!inputStatsRead(index, &stats)) continue;
+      char json[640];
+      inputStatsToJson(io->pins[index], stats, doc.to<JsonObject>());
+      serializeJson(doc, json, sizeof(json));
+      puts(json);
+      continue;
+    }
+    if (n >= 1 && strcmp(cmd, "config") == 0) {
+      char key[16];
+      char value[64] = "";
+      if (sscanf(line, "%*s %15s %63s", key, value) < 1) continue;
+      Config next = config;
+      if (strcmp(key, "name") == 0) strlcpy(next.deviceName, value, sizeof(next.deviceName));
+      else if (strcmp(key, "broker") == 0) strlcpy(next.mqttServer, value, sizeof(next.mqttServer));
+      else if (strcmp(key, "port") == 0) next.mqttPort = atoi(value);
+      else if (strcmp(key, "groups") == 0) groupListNormalize(value, next.groups, sizeof(next.groups));
+      else if (strcmp(key, "timezone") == 0) strlcpy(next.timezone, value, sizeof(next.timezone));
+      uint16_t changes = configDiff(&config, &next);
+      if (configApplyLevel(changes) == CONFIG_APPLY_RESTART) {
+        fprintf(stderr, "config: %s requires a restart\n", key);
+      } else {
+        configApply(&next, changes);
+      }
+      continue;
+    }
+    if (n >= 1 && strcmp(cmd, "every") == 0) {
+      ScheduleEntry entries[MAX_SCHEDULES];
+      Schedule list[MAX_SCHEDULES];
+      unsigned int state = 1;
+      if (sscanf(line, "%*s %u %lu %u", &gpio, &value, &state) < 2 || value == 0) continue;
+      int count = scheduleTableGet(entries);
+      if (count >= MAX_SCHEDULES) continue;
+      for (int i = 0; i < count; i++) list[i] = entries[i].schedule;
+      Schedule& s = list[count++];
+      memset(&s, 0, sizeof(Schedule));
+      s.kind = SCHEDULE_INTERVAL;
+      s.enabled = 1;
+      s.pin = gpio;
+      s.state = state ? 1 : 0;
+      s.interval = value;
+      scheduleTableSet(list, count);
+      continue;
+    }
+    if (n != 3 || gpio >= SIM_GPIO_COUNT) continue;
+    if (strcmp(cmd, "input") == 0) simGpioSetInput(gpio, value ? HIGH : LOW);
+    else if (strcmp(cmd, "pulse") == 0) simGpioPulse(gpio, value);
+    else if (strcmp(cmd, "analog") == 0) simGpioSetAnalog(gpio, (uint16_t)value);
+    else if (strcmp(cmd, "calibrate") == 0 && !calibrationStart(gpio, (int)value, CALIBRATION_DEFAULT_CYCLES, true)) {
+      fprintf(stderr, "calibrate: GPIO %u must be an output and GPIO %lu an input\n", gpio, value);
+    }
+  }
+
+  // stdin fermé sans "quit" (lancement en arrière-plan) : tourner jusqu'au signal
+  if (feof(stdin)) {
+    for (;;) delay(1000);
+  }
+  outputJournalFlush(millis(), true);  // Arrêt propre : rien en attente n'est perdu
+  mqttEnabled = false;  // Sinon NetTask se reconnecte aussitôt
+  disconnectMQTT();
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include "sim_wifi.h"
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+
+static const uint8_t AP_BSSID[6] = { 0x02, 0x51, 0x4D, 0x00, 0x00, 0x01 };
+// Ordre IPAddress : 192.168.<net>.10, passerelle 192.168.<net>.1
+#define SIM_WIFI_IP(net)      (0x0A00A8C0UL | ((uint32_t)(net) << 16))
+#define SIM_WIFI_GATEWAY(net) (0x0100A8C0UL | ((uint32_t)(net) << 16))
+#define SIM_WIFI_SUBNET       0x00FFFFFFUL
+
+static std::atomic<uint32_t> apDownUntilMs(0);
+static std::atomic<uint8_t> apChannel(6);
+static std::atomic<uint8_t> apNet(1);           // Troisième octet du sous-réseau
+static std::atomic<bool> associated(true);
+
+// Tentative en cours (NetTask seulement)
+enum { ATTEMPT_NONE, ATTEMPT_FAST, ATTEMPT_SCAN };
+static uint8_t attempt = ATTEMPT_NONE;
+static uint32_t attemptStartMs = 0;
+static uint8_t targetChannel = 0;
+static uint32_t targetIp = 0;                   // Adresse imposée par le cache (0 : DHCP)
+
+static bool apUp() {
+  return (int32_t)(millis() - apDownUntilMs.load()) >= 0;
+}
+
+void simWifiDrop(uint32_t ms, bool moved, bool renumbered) {
+  apDownUntilMs.store(millis() + ms);
+  if (moved) apChannel.store(apChannel.load() == 6 ? 11 : 6);
+  if (renumbered) apNet.store(apNet.load() == 1 ? 2 : 1);
+}
+
+bool simWifiLinkUp() {
+  return associated.load() && apUp();
+}
+
+static bool simConnect(void* ctx, const WifiLinkCache* cache) {
+  associated.store(false);
+  attempt = cache != NULL ? ATTEMPT_FAST : ATTEMPT_SCAN;
+  targetChannel = cache != NULL ? cache->channel : 0;
+  targetIp = cache != NULL ? cache->ip : 0;
+  attemptStartMs = millis();
+  return true;
+}
+
+static uint8_t simStatus(void* ctx) {
+  uint32_t elapsed = millis() - attemptStartMs;
+  if (associated.load()) {
+    if (apUp()) return WIFI_LINK_UP;
+    associated.store(false);
+    attempt = ATTEMPT_NONE;
+    return WIFI_LINK_DOWN;
+  }
+  if (attempt == ATTEMPT_FAST) {
+    if (!apUp()) return WIFI_LINK_CONNECTING;            // Pas de réponse du BSSID : délai de FAST
+    if (targetChannel != apChannel.load()) return elapsed > 300 ? WIFI_LINK_FAILED : WIFI_LINK_CONNECTING;
+    if (elapsed < SIM_WIFI_FAST_MS) return WIFI_LINK_CONNECTING;
+    if (targetIp != 0 && targetIp != SIM_WIFI_IP(apNet.load())) {
+      attempt = ATTEMPT_NONE;                            // Associé, mais passerelle injoignable
+      return WIFI_LINK_ADDR_REJECTED;
+    }
+  } else if (attempt == ATTEMPT_SCAN) {
+    if (!apUp()) return elapsed > SIM_WIFI_SCAN_MS ? WIFI_LINK_FAILED : WIFI_LINK_CONNECTING;
+    if (elapsed < SIM_WIFI_SCAN_MS) return WIFI_LINK_CONNECTING;
+  } else {
+    return WIFI_LINK_DOWN;
+  }
+  attempt = ATTEMPT_NONE;
+  associated.store(true);
+  return WIFI_LINK_UP;
+}
+
+static void simDisconnect(void* ctx) {
+  attempt = ATTEMPT_NONE;
+  associated.store(false);
+}
+
+static void simCurrent(void* ctx, WifiLinkCache* out) {
+  memcpy(out->bssid, AP_BSSID, sizeof(out->bssid));
+  out->channel = apChannel.load();
+  uint8_t net = apNet.load();
+  out->ip = SIM_WIFI_IP(net);
+  out->gateway = SIM_WIFI_GATEWAY(net);
+  out->subnet = SIM_WIFI_SUBNET;
+  out->dns = SIM_WIFI_GATEWAY(net);
+}
+
+const WifiReconnectOps simWifiLinkOps = { simConnect, simStatus, simDisconnect, simCurrent, NULL };
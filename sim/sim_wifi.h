@@ -0,0 +1,23 @@
+#ifndef SIM_WIFI_LINK_H
+#define SIM_WIFI_LINK_H
+
+#include <stdint.h>
+#include "wifi_reconnect.h"
+
+// Point d'accès simulé : le lien démarre établi. simWifiDrop() coupe le point
+// d'accès pendant ms millisecondes (commande "wifi drop <ms> [moved|renumbered]") ;
+// moved : il revient sur un autre canal, l'association par le cache échoue ;
+// renumbered : il revient sur un autre sous-réseau (192.168.1.x <-> 192.168.2.x),
+// l'adresse du cache est refusée (WIFI_LINK_ADDR_REJECTED) et DHCP en attribue une autre.
+// Pendant la coupure, les sockets MQTT (WiFiClient, AsyncMqttClient) tombent.
+// Durées d'association : SIM_WIFI_FAST_MS par le cache, SIM_WIFI_SCAN_MS avec scan.
+#define SIM_WIFI_FAST_MS 80
+#define SIM_WIFI_SCAN_MS 1500
+
+void simWifiDrop(uint32_t ms, bool moved, bool renumbered);
+bool simWifiLinkUp();
+
+// Accès au lien pour wifi_link.cpp
+extern const WifiReconnectOps simWifiLinkOps;
+
+#endif // SIM_WIFI_LINK_H
@@ -0,0 +1,24 @@
+#ifndef SIM_SYS_TIME_H
+#define SIM_SYS_TIME_H
+
+// Horloge murale propre à chaque instance simulée : gettimeofday/settimeofday
+// sont redirigés vers sim_clock.cpp pour que la synchronisation MQTT
+// (esp32/time/sync) ne touche jamais l'horloge de la machine hôte.
+
+#include_next <sys/time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int simGettimeofday(struct timeval* tv, void* tz);
+int simSettimeofday(const struct timeval* tv, const void* tz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define gettimeofday simGettimeofday
+#define settimeofday simSettimeofday
+
+#endif // SIM_SYS_TIME_H
@@ -0,0 +1,167 @@
+#include <Arduino.h>
+#include "json_pool.h"
+#include <atomic>
+#include "actuation_calibration.h"
+#include "io_table.h"
+#include "mqtt.h"
+
+extern Config config;
+extern void saveIOs();
+
+#define CAL_TASK_STACK 4096
+
+static CalibrationStatus status;
+static std::atomic<uint8_t> state(CALIBRATION_IDLE);   // Publié en dernier : status est alors complet
+
+// Premier front de l'entrée de retour après l'écriture (micros(), 0 = pas encore vu)
+static volatile uint32_t feedbackEdgeUs = 0;
+
+void IRAM_ATTR onFeedbackISR(void *arg) {
+  (void)arg;
+  if (feedbackEdgeUs == 0) {
+    uint32_t now = micros();
+    feedbackEdgeUs = now != 0 ? now : 1;
+  }
+}
+
+uint32_t calibrationMedian(uint32_t* values, uint8_t n) {
+  if (n == 0) return 0;
+  for (uint8_t i = 1; i < n; i++) {
+    uint32_t v = values[i];
+    int j = i - 1;
+    while (j >= 0 && values[j] > v) {
+      values[j + 1] = values[j];
+      j--;
+    }
+    values[j + 1] = v;
+  }
+  return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+// Bascule la sortie et chronomètre le contact ; 0 si aucun front avant le délai maximal
+static uint32_t measureSwitch(int pin, int target) {
+  feedbackEdgeUs = 0;
+  uint32_t writeUs = micros();
+  executeCommand(pin, target);
+  while (feedbackEdgeUs == 0 && micros() - writeUs < CALIBRATION_TIMEOUT_US) {
+    vTaskDelay(1);
+  }
+  uint32_t edgeUs = feedbackEdgeUs;
+  return edgeUs != 0 ? (edgeUs - writeUs != 0 ? edgeUs - writeUs : 1) : 0;
+}
+
+static void publishResult() {
+  IOTableReader io;
+  int idx = ioTableFindByPin(io.get(), status.outputPin);
+  if (idx < 0 || !mqttEnabled || !mqttConnected()) return;
+
+  char topic[128];
+  snprintf(topic, sizeof(topic), "%s/calibration/%s", config.deviceName, io->pins[idx].name);
+  PooledJsonDocument doc;
+  doc["success"] = status.state == CALIBRATION_DONE;
+  doc["actuationOnUs"] = status.onUs;
+  doc["actuationOffUs"] = status.offUs;
+  doc["onSamples"] = status.onSamples;
+  doc["offSamples"] = status.offSamples;
+  doc["applied"] = status.applied;
+  if (status.error[0] != '\0') doc["error"] = status.error;
+  char payload[192];
+  serializeJson(doc, payload);
+  publishMQTT(topic, payload);
+}
+
+static void calibrationTask(void *pvParameters) {
+  int out = status.outputPin;
+  uint32_t onUs[CALIBRATION_MAX_CYCLES];
+  uint32_t offUs[CALIBRATION_MAX_CYCLES];
+  uint8_t onCount = 0;
+  uint8_t offCount = 0;
+  int initial = out < MAX_GPIO ? pinStates[out] : LOW;
+
+  attachInterruptArg(digitalPinToInterrupt(status.feedbackPin), onFeedbackISR, nullptr, CHANGE);
+  Serial.printf("🔧 Calibrating GPIO %d with feedback GPIO %d (%u cycles)\n", out, status.feedbackPin,
+                status.cycles);
+
+  // Chaque cycle mesure les deux sens, en partant de l'état opposé à l'état courant
+  int level = initial;
+  for (uint8_t c = 0; c < status.cycles; c++) {
+    for (int k = 0; k < 2; k++) {
+      level = !level;
+      uint32_t us = measureSwitch(out, level);
+      if (us != 0) {
+        if (level) onUs[onCount++] = us;
+        else offUs[offCount++] = us;
+      }
+      vTaskDelay(pdMS_TO_TICKS(CALIBRATION_SETTLE_MS));
+    }
+  }
+  detachInterrupt(digitalPinToInterrupt(status.feedbackPin));
+  if (level != initial) executeCommand(out, initial);
+
+  status.onSamples = onCount;
+  status.offSamples = offCount;
+  status.onUs = calibrationMedian(onUs, onCount);
+  status.offUs = calibrationMedian(offUs, offCount);
+  bool ok = onCount > 0 && offCount > 0;
+  if (!ok) {
+    strlcpy(status.error, "Aucun front sur l'entrée de retour", sizeof(status.error));
+  } else if (status.applied) {
+    ioTableUpdate([&](IOTable& table) {
+      int idx = ioTableFindByPin(&table, out);
+      if (idx >= 0) {
+        table.pins[idx].actuationOnUs = status.onUs;
+        table.pins[idx].actuationOffUs = status.offUs;
+      }
+    });
+    saveIOs();
+  }
+  if (!ok) status.applied = false;
+  Serial.printf("🔧 Calibration GPIO %d: on %lu us (%u), off %lu us (%u)%s\n", out, (unsigned long)status.onUs,
+                onCount, (unsigned long)status.offUs, offCount, ok ? "" : " - FAILED");
+
+  status.state = ok ? CALIBRATION_DONE : CALIBRATION_FAILED;
+  state.store(status.state, std::memory_order_release);
+  publishResult();
+  vTaskDelete(NULL);
+}
+
+bool calibrationStart(int outputPin, int feedbackPin, uint8_t cycles, bool apply) {
+  IOTableReader io;
+  int outIdx = ioTableFindByPin(io.get(), outputPin);
+  int fbIdx = ioTableFindByPin(io.get(), feedbackPin);
+  if (outIdx < 0 || io->pins[outIdx].mode != 2 || fbIdx < 0 || io->pins[fbIdx].mode != 1) return false; // OUTPUT / INPUT
+
+  uint8_t expected = state.load();
+  if (expected == CALIBRATION_RUNNING ||
+      !state.compare_exchange_strong(expected, CALIBRATION_RUNNING, std::memory_order_acquire)) {
+    return false;
+  }
+
+  memset(&status, 0, sizeof(status));
+  status.outputPin = outputPin;
+  status.feedbackPin = feedbackPin;
+  status.cycles = cycles == 0 ? CALIBRATION_DEFAULT_CYCLES : cycles > CALIBRATION_MAX_CYCLES ? CALIBRATION_MAX_CYCLES : cycles;
+  status.applied = apply;
+
+  // Juste sous l'exécuteur : la mesure ne doit pas attendre la scrutation des entrées
+  if (xTaskCreatePinnedToCore(calibrationTask, "CalTask", CAL_TASK_STACK, NULL, CMD_TASK_PRIORITY - 1, NULL,
+                              CMD_TASK_CORE) != pdPASS) {
+    state.store(CALIBRATION_IDLE);
+    return false;
+  }
+  return true;
+}
+
+void calibrationGetStatus(CalibrationStatus* out) {
+  uint8_t current = state.load(std::memory_order_acquire);
+  if (current == CALIBRATION_RUNNING) {
+    // Résultat en cours d'écriture : seules les broches sont fiables
+    memset(out, 0, sizeof(CalibrationStatus));
+    out->outputPin = status.outputPin;
+    out->feedbackPin = status.feedbackPin;
+    out->cycles = status.cycles;
+  } else {
+    memcpy(out, &status, sizeof(CalibrationStatus));
+  }
+  out->state = current;
+}
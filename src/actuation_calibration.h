@@ -0,0 +1,55 @@
+#ifndef ACTUATION_CALIBRATION_H
+#define ACTUATION_CALIBRATION_H
+
+#include <stdint.h>
+#include "config.h"
+
+// ===== CALIBRATION DU DÉLAI DE COMMUTATION DES SORTIES =====
+// Un relais mécanique ferme son contact quelques millisecondes après le
+// digitalWrite, avec un délai propre à chaque modèle (et différent à
+// l'ouverture). L'exécuteur écrit la sortie en avance de ce délai
+// (IOPin::actuationOnUs / actuationOffUs) pour que le contact bascule à
+// l'échéance demandée.
+//
+// La calibration bascule la sortie plusieurs fois et chronomètre le premier
+// front d'une entrée de retour (contact auxiliaire, opto sur la charge...) :
+// les médianes deviennent les délais de la sortie. Elle tourne dans une tâche
+// dédiée (CalTask) ; les commandes reçues pour cette sortie pendant la mesure
+// faussent le résultat.
+
+#define CALIBRATION_DEFAULT_CYCLES 5
+#define CALIBRATION_MAX_CYCLES     16
+#define CALIBRATION_TIMEOUT_US     ACTUATION_MAX_US  // Pas de front : câblage ou relais défaillant
+#define CALIBRATION_SETTLE_MS      200               // Rebonds du contact entre deux mesures
+
+enum CalibrationState : uint8_t {
+  CALIBRATION_IDLE = 0,
+  CALIBRATION_RUNNING = 1,
+  CALIBRATION_DONE = 2,
+  CALIBRATION_FAILED = 3
+};
+
+struct CalibrationStatus {
+  uint8_t state;            // CalibrationState
+  uint8_t outputPin;
+  uint8_t feedbackPin;
+  uint8_t cycles;
+  uint8_t onSamples;        // Mesures valides vers HIGH / vers LOW
+  uint8_t offSamples;
+  bool applied;             // Délais enregistrés dans la configuration de la sortie
+  uint32_t onUs;            // Médianes
+  uint32_t offUs;
+  char error[48];
+};
+
+// Lance la calibration de outputPin (OUTPUT) avec feedbackPin (INPUT) ; false
+// si une calibration est déjà en cours ou si les broches ne conviennent pas.
+bool calibrationStart(int outputPin, int feedbackPin, uint8_t cycles, bool apply);
+
+// État de la dernière calibration (copie cohérente une fois terminée)
+void calibrationGetStatus(CalibrationStatus* out);
+
+// Médiane de n mesures (trie values sur place)
+uint32_t calibrationMedian(uint32_t* values, uint8_t n);
+
+#endif // ACTUATION_CALIBRATION_H
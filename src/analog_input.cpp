@@ -0,0 +1,77 @@
+#include "analog_input.h"
+#include <string.h>
+
+void analogChannelReset(AnalogChannel* ch) {
+  memset(ch, 0, sizeof(AnalogChannel));
+}
+
+// Médiane par tri par insertion sur une copie (fenêtre de 5 : quelques comparaisons)
+static int32_t medianOf(const int32_t* values, uint8_t count) {
+  int32_t sorted[ANALOG_MEDIAN_WINDOW];
+  for (uint8_t i = 0; i < count; i++) {
+    int32_t v = values[i];
+    int8_t j = i - 1;
+    while (j >= 0 && sorted[j] > v) {
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = v;
+  }
+  return sorted[count / 2];
+}
+
+int32_t analogFilterSample(AnalogChannel* ch, int32_t raw, uint8_t filterType, uint8_t iirShift) {
+  ch->raw = raw;
+
+  switch (filterType) {
+    case ANALOG_FILTER_IIR: {
+      // Réglage enregistré avant la borne de /api/ios : un décalage >= 32 est indéfini
+      if (iirShift > ANALOG_MAX_FILTER_SHIFT) iirShift = ANALOG_MAX_FILTER_SHIFT;
+      if (!ch->primed) {
+        ch->iirState = raw << 8;
+        ch->primed = true;
+      } else {
+        ch->iirState += ((raw << 8) - ch->iirState) >> iirShift;
+      }
+      // Arrondi au plus proche en repassant de Q8 à l'échelle brute
+      return (ch->iirState + 128) >> 8;
+    }
+
+    case ANALOG_FILTER_MEDIAN: {
+      ch->window[ch->windowPos] = raw;
+      ch->windowPos = (ch->windowPos + 1) % ANALOG_MEDIAN_WINDOW;
+      if (ch->windowFill < ANALOG_MEDIAN_WINDOW) ch->windowFill++;
+      ch->primed = true;
+      return medianOf(ch->window, ch->windowFill);
+    }
+
+    default:
+      ch->primed = true;
+      return raw;
+  }
+}
+
+int32_t analogCalibrate(int32_t filtered, int32_t gainQ16, int32_t offset) {
+  return (int32_t)(((int64_t)filtered * gainQ16) >> 16) + offset;
+}
+
+bool analogShouldPublish(AnalogChannel* ch, int32_t value, uint32_t deadband, uint32_t nowMs, uint32_t heartbeatMs) {
+  ch->value = value;
+
+  bool publish = !ch->hasPublished;
+  if (!publish) {
+    int64_t diff = (int64_t)value - ch->lastPublished;
+    if (diff < 0) diff = -diff;
+    publish = diff > (int64_t)deadband;
+  }
+  if (!publish && heartbeatMs > 0) {
+    publish = (nowMs - ch->lastPublishMs) >= heartbeatMs;
+  }
+
+  if (publish) {
+    ch->lastPublished = value;
+    ch->lastPublishMs = nowMs;
+    ch->hasPublished = true;
+  }
+  return publish;
+}
@@ -0,0 +1,46 @@
+#ifndef ANALOG_INPUT_H
+#define ANALOG_INPUT_H
+
+#include <stdint.h>
+
+// ===== TRAITEMENT DES ENTRÉES ANALOGIQUES =====
+// Logique pure (sans dépendance Arduino), entièrement en virgule fixe :
+// filtre IIR / médiane, calibration linéaire et décision de publication
+// (zone morte + heartbeat). L'échantillonnage ADC est fait par la tâche I/O.
+
+#define ANALOG_FILTER_NONE   0
+#define ANALOG_FILTER_IIR    1
+#define ANALOG_FILTER_MEDIAN 2
+
+#define ANALOG_MEDIAN_WINDOW 5
+#define ANALOG_GAIN_ONE      65536  // Gain de calibration Q16 (1.0)
+#define ANALOG_MAX_FILTER_SHIFT 15    // IIR : alpha = 1/32768 au plus lent
+
+struct AnalogChannel {
+  int32_t iirState;                       // État du filtre IIR (Q8)
+  int32_t window[ANALOG_MEDIAN_WINDOW];   // Fenêtre glissante pour la médiane
+  uint8_t windowPos;
+  uint8_t windowFill;
+  bool primed;                            // Le filtre a reçu au moins un échantillon
+  int32_t raw;                            // Dernier échantillon brut (suréchantillonné)
+  int32_t value;                          // Dernière valeur filtrée et calibrée
+  int32_t lastPublished;
+  bool hasPublished;
+  uint32_t lastPublishMs;
+};
+
+void analogChannelReset(AnalogChannel* ch);
+
+// Applique le filtre sélectionné et retourne la valeur filtrée (même échelle que raw).
+// Pour l'IIR : y += (x - y) / 2^shift, shift borné à ANALOG_MAX_FILTER_SHIFT
+int32_t analogFilterSample(AnalogChannel* ch, int32_t raw, uint8_t filterType, uint8_t iirShift);
+
+// Calibration linéaire : value = filtered * gainQ16 / 65536 + offset
+int32_t analogCalibrate(int32_t filtered, int32_t gainQ16, int32_t offset);
+
+// Retourne true si la valeur doit être publiée : sortie de la zone morte autour de
+// la dernière valeur publiée, ou heartbeat écoulé (heartbeatMs = 0 : désactivé).
+// Met à jour l'état de publication lorsqu'elle retourne true.
+bool analogShouldPublish(AnalogChannel* ch, int32_t value, uint32_t deadband, uint32_t nowMs, uint32_t heartbeatMs);
+
+#endif // ANALOG_INPUT_H
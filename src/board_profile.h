@@ -0,0 +1,125 @@
+#ifndef BOARD_PROFILE_H
+#define BOARD_PROFILE_H
+
+#include <stdint.h>
+
+// ===== PROFILS DE CARTE (broches fixées à la compilation) =====
+// Pour un produit au câblage figé (ex. LilyGo T-Relay 4 relais), le profil
+// choisi par -DBOARD_PROFILE=... décrit les broches sous forme de types : la
+// tâche I/O, la recherche par GPIO et l'application des modes sont générées
+// broche par broche (BoardFixedPins::forEach), avec GPIO et mode constants,
+// sans parcours de table ni test de mode à l'exécution.
+//
+// Les broches fixes occupent les BOARD_FIXED_PIN_COUNT premières entrées de
+// la table des I/O : GPIO, mode et type d'entrée y sont imposés par le profil
+// (ioTableApplyBoardProfile), le reste (nom, état par défaut, publication,
+// délais de commutation) reste modifiable par /api/ios. Des broches
+// configurables à l'exécution peuvent toujours être ajoutées à la suite.
+// BOARD_GENERIC (défaut) : aucune broche fixe, tout est configuré à l'exécution.
+//
+// Écrit en C++11 (le cœur Arduino ESP32 2.x compile en gnu++11) : récursion
+// sur une liste de types plutôt que if constexpr / expressions de repli.
+
+#define BOARD_GENERIC                0
+#define BOARD_FREENOVE_WROVER_2RELAY 1   // Carte d'origine du projet : relais K1 / K2
+#define BOARD_LILYGO_T_RELAY4        2   // LilyGo T-Relay, 4 relais
+
+#ifndef BOARD_PROFILE
+#define BOARD_PROFILE BOARD_GENERIC
+#endif
+
+// Une broche fixe : mode comme IOPin::mode (1 = INPUT, 2 = OUTPUT, 3 = COUNTER,
+// 4 = ANALOG), type d'entrée comme IOPin::inputType (0 = INPUT, 1 = PULLUP, 2 = PULLDOWN)
+template <uint8_t GPIO, uint8_t MODE, uint8_t INPUT_TYPE = 1>
+struct FixedPin {
+  static constexpr uint8_t gpio = GPIO;
+  static constexpr uint8_t mode = MODE;
+  static constexpr uint8_t inputType = INPUT_TYPE;
+};
+
+template <typename... Pins>
+struct FixedPinList {};
+
+// Étiquette de mode pour la surcharge des visiteurs : visit(FixedPinMode<2>()) = sortie
+template <uint8_t MODE>
+struct FixedPinMode {};
+
+// Algorithmes déroulés à la compilation sur une liste de broches. Un visiteur fournit
+//   template <int I, uint8_t GPIO, uint8_t INPUT_TYPE> void visit(FixedPinMode<1>);  // etc.
+// pour chaque mode présent dans le profil ; I est l'index dans la table des I/O.
+template <typename List, int I = 0>
+struct FixedPins;
+
+template <int I>
+struct FixedPins<FixedPinList<>, I> {
+  static constexpr int count = 0;
+  static constexpr int indexOf(int gpio) { return (void)gpio, -1; }
+  static constexpr uint8_t gpioAt(int i) { return (void)i, 0; }
+  static constexpr uint8_t modeAt(int i) { return (void)i, 0; }
+  static constexpr uint8_t inputTypeAt(int i) { return (void)i, 0; }
+  template <typename V>
+  static void forEach(V& visitor) { (void)visitor; }
+};
+
+template <typename P, typename... Rest, int I>
+struct FixedPins<FixedPinList<P, Rest...>, I> {
+  typedef FixedPins<FixedPinList<Rest...>, I + 1> Next;
+  static constexpr int count = 1 + Next::count;
+
+  // Comparaisons en chaîne sur des constantes, sans accès mémoire
+  static constexpr int indexOf(int gpio) { return gpio == P::gpio ? I : Next::indexOf(gpio); }
+  // Description de la broche d'index i (mise en place de la table, hors chemins critiques)
+  static constexpr uint8_t gpioAt(int i) { return i == I ? P::gpio : Next::gpioAt(i); }
+  static constexpr uint8_t modeAt(int i) { return i == I ? P::mode : Next::modeAt(i); }
+  static constexpr uint8_t inputTypeAt(int i) { return i == I ? P::inputType : Next::inputTypeAt(i); }
+
+  template <typename V>
+  static void forEach(V& visitor) {
+    visitor.template visit<I, P::gpio, P::inputType>(FixedPinMode<P::mode>());
+    Next::forEach(visitor);
+  }
+};
+
+// ===== PROFILS =====
+#if BOARD_PROFILE == BOARD_FREENOVE_WROVER_2RELAY
+struct BoardProfile {
+  typedef FixedPinList<
+    FixedPin<16, 2>,   // RelaisK1 (OUTPUT)
+    FixedPin<17, 2>    // RelaisK2 (OUTPUT)
+  > Pins;
+  static const char* name() { return "freenove_wrover_2relay"; }
+  static const char* pinName(int i) {
+    static const char* const names[] = { "RelaisK1", "RelaisK2" };
+    return names[i];
+  }
+};
+#define BOARD_STATUS_LED 23
+
+#elif BOARD_PROFILE == BOARD_LILYGO_T_RELAY4
+struct BoardProfile {
+  typedef FixedPinList<
+    FixedPin<21, 2>,   // Relais1 (OUTPUT)
+    FixedPin<19, 2>,   // Relais2
+    FixedPin<18, 2>,   // Relais3
+    FixedPin<5, 2>     // Relais4
+  > Pins;
+  static const char* name() { return "lilygo_t_relay4"; }
+  static const char* pinName(int i) {
+    static const char* const names[] = { "Relais1", "Relais2", "Relais3", "Relais4" };
+    return names[i];
+  }
+};
+#define BOARD_STATUS_LED 25
+
+#else
+struct BoardProfile {
+  typedef FixedPinList<> Pins;
+  static const char* name() { return "generic"; }
+  static const char* pinName(int i) { return (void)i, ""; }
+};
+#endif
+
+typedef FixedPins<BoardProfile::Pins> BoardFixedPins;
+#define BOARD_FIXED_PIN_COUNT (BoardFixedPins::count)
+
+#endif // BOARD_PROFILE_H
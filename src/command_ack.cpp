@@ -0,0 +1,35 @@
+#include "command_ack.h"
+#include <string.h>
+
+void dedupCacheReset(DedupCache* cache) {
+  memset(cache, 0, sizeof(DedupCache));
+}
+
+uint32_t commandIdHash(const char* id) {
+  uint32_t hash = 2166136261u;
+  while (*id) {
+    hash ^= (uint8_t)*id++;
+    hash *= 16777619u;
+  }
+  return hash ? hash : 1;
+}
+
+bool dedupCacheCheckAndInsert(DedupCache* cache, uint32_t hash) {
+  for (uint8_t i = 0; i < cache->count; i++) {
+    if (cache->hashes[i] == hash) {
+      return true;
+    }
+  }
+
+  cache->hashes[cache->next] = hash;
+  cache->next = (cache->next + 1) % DEDUP_CACHE_SIZE;
+  if (cache->count < DEDUP_CACHE_SIZE) cache->count++;
+  return false;
+}
+
+void dedupCacheRemove(DedupCache* cache, uint32_t hash) {
+  // Case remise à 0 (jamais un hash valide) : l'ordre d'écrasement est conservé
+  for (uint8_t i = 0; i < cache->count; i++) {
+    if (cache->hashes[i] == hash) cache->hashes[i] = 0;
+  }
+}
@@ -0,0 +1,32 @@
+#ifndef COMMAND_ACK_H
+#define COMMAND_ACK_H
+
+#include <stdint.h>
+
+// ===== IDEMPOTENCE DES COMMANDES =====
+// Cache de taille fixe des identifiants de commandes récemment reçus, pour ne
+// pas ré-exécuter une commande redélivrée par le broker (QoS 1, reconnexion...).
+// Les identifiants sont stockés sous forme de hash FNV-1a 32 bits ; le plus
+// ancien est écrasé quand le cache est plein.
+
+#define DEDUP_CACHE_SIZE   32
+#define COMMAND_ID_MAX_LEN 24
+
+struct DedupCache {
+  uint32_t hashes[DEDUP_CACHE_SIZE];
+  uint8_t next;    // Prochaine case à écraser
+  uint8_t count;
+};
+
+void dedupCacheReset(DedupCache* cache);
+
+// Hash d'un identifiant de commande (jamais 0, valeur réservée aux cases vides)
+uint32_t commandIdHash(const char* id);
+
+// Retourne true si l'identifiant a déjà été vu ; sinon l'enregistre et retourne false
+bool dedupCacheCheckAndInsert(DedupCache* cache, uint32_t hash);
+
+// Oublie un identifiant : commande refusée, une nouvelle tentative doit être exécutée
+void dedupCacheRemove(DedupCache* cache, uint32_t hash);
+
+#endif // COMMAND_ACK_H
@@ -0,0 +1,149 @@
+#include <Arduino.h>
+#include <sys/time.h>
+#include "command_executor.h"
+#include "mqtt.h"
+#include "schedule_table.h"
+#include "io_table.h"
+
+ScheduledCommand scheduledCommands[MAX_SCHEDULED_COMMANDS];
+
+bool submitCommand(const CommandMsg* msg) {
+  return commandQueueSend(msg);
+}
+
+// Insère une commande reçue : exécution immédiate ou ajout dans la table
+static void acceptCommand(const CommandMsg& msg) {
+  IOTableReader io;
+  uint32_t actuationUs = ioActuationUs(io.get(), msg.pin, msg.state);
+  if (msg.exec_at_sec == 0) {
+    uint64_t executedUs = getCurrentTimeMicros();
+    executeCommand(msg.pin, msg.state);
+    publishCommandAck(msg.id, msg.state, "executed", msg.received_us, 0, executedUs, actuationUs);
+    return;
+  }
+
+  // exec_at est l'instant du contact : la sortie est écrite actuationUs plus tôt
+  uint64_t scheduledUs = (uint64_t)msg.exec_at_sec * 1000000ULL + msg.exec_at_us;
+  for (int j = 0; j < MAX_SCHEDULED_COMMANDS; j++) {
+    if (!scheduledCommands[j].active) {
+      scheduledCommands[j].pin = msg.pin;
+      scheduledCommands[j].state = msg.state;
+      scheduledCommands[j].exec_at_sec = msg.exec_at_sec;
+      scheduledCommands[j].exec_at_us = msg.exec_at_us;
+      scheduledCommands[j].lead_us = actuationUs;
+      strlcpy(scheduledCommands[j].id, msg.id, sizeof(scheduledCommands[j].id));
+      scheduledCommands[j].received_us = msg.received_us;
+      scheduledCommands[j].active = true;
+      Serial.printf("⏰ Command for pin %d scheduled at %u.%06u\n", msg.pin, msg.exec_at_sec, msg.exec_at_us);
+      publishCommandAck(msg.id, msg.state, "scheduled", msg.received_us, scheduledUs, 0);
+      return;
+    }
+  }
+
+  Serial.println("⚠️ Scheduled command queue is full!");
+  commandIdForget(msg.id);  // Refusée : une nouvelle tentative avec le même id sera exécutée
+  publishCommandAck(msg.id, msg.state, "rejected", msg.received_us, scheduledUs, 0);
+}
+
+// Instant d'écriture de la sortie : l'échéance moins son délai de commutation
+static uint64_t writeTimeUs(const ScheduledCommand& cmd) {
+  uint64_t execTimeUs = (uint64_t)cmd.exec_at_sec * 1000000ULL + (uint64_t)cmd.exec_at_us;
+  return execTimeUs > cmd.lead_us ? execTimeUs - cmd.lead_us : 0;
+}
+
+// Échéance la plus proche parmi les commandes programmées (UINT64_MAX si aucune)
+static uint64_t nextDeadlineUs() {
+  uint64_t next = UINT64_MAX;
+  for (int i = 0; i < MAX_SCHEDULED_COMMANDS; i++) {
+    if (scheduledCommands[i].active) {
+      uint64_t writeUs = writeTimeUs(scheduledCommands[i]);
+      if (writeUs < next) next = writeUs;
+    }
+  }
+  return next;
+}
+
+static void processScheduledCommands() {
+  // Obtenir le temps actuel avec précision microseconde
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  uint64_t currentTimeUs = (uint64_t)tv.tv_sec * 1000000ULL + (uint64_t)tv.tv_usec;
+  
+  for (int i = 0; i < MAX_SCHEDULED_COMMANDS; i++) {
+    if (scheduledCommands[i].active) {
+      // Calculer le temps d'exécution prévu en microsecondes (contact) et l'instant d'écriture
+      uint64_t execTimeUs = ((uint64_t)scheduledCommands[i].exec_at_sec * 1000000ULL) + 
+                             (uint64_t)scheduledCommands[i].exec_at_us;
+      uint64_t writeUs = writeTimeUs(scheduledCommands[i]);
+      
+      // Vérifier si le moment d'exécution est arrivé
+      if (currentTimeUs >= writeUs) {
+        // Calculer le délai d'exécution (peut être négatif si en avance)
+        int64_t delay_us = (int64_t)currentTimeUs - (int64_t)writeUs;
+        
+        // Exécuter la commande
+        executeCommand(scheduledCommands[i].pin, scheduledCommands[i].state);
+        
+        // Désactiver cette commande
+        scheduledCommands[i].active = false;
+
+        // Acquitter l'exécution (commandes identifiées uniquement)
+        publishCommandAck(scheduledCommands[i].id, scheduledCommands[i].state, "executed",
+                          scheduledCommands[i].received_us, execTimeUs, currentTimeUs,
+                          scheduledCommands[i].lead_us);
+        
+        // Afficher le délai en millisecondes avec 3 décimales
+        double delay_ms = delay_us / 1000.0;
+        Serial.printf("⏰ Scheduled command executed (delay: %.3f ms)\n", delay_ms);
+      }
+    }
+  }
+}
+
+void commandTask(void *pvParameters) {
+  Serial.println("✅ Command executor task started.");
+
+  for (;;) {
+    // Dormir sur la file jusqu'à la prochaine échéance (moins la marge d'attente active)
+    uint64_t now = getCurrentTimeMicros();
+    uint64_t deadline = nextDeadlineUs();
+    uint32_t waitUs = COMMAND_IDLE_WAIT_US;
+    if (deadline != UINT64_MAX) {
+      uint64_t remaining = deadline > now ? deadline - now : 0;
+      if (remaining <= COMMAND_SPIN_US) {
+        waitUs = 0;
+      } else if (remaining - COMMAND_SPIN_US < COMMAND_IDLE_WAIT_US) {
+        waitUs = (uint32_t)(remaining - COMMAND_SPIN_US);
+      }
+    }
+
+    CommandMsg msg;
+    if (commandQueueReceive(&msg, waitUs)) {
+      acceptCommand(msg);
+      // Vider la file avant de revenir aux échéances
+      while (commandQueueReceive(&msg, 0)) {
+        acceptCommand(msg);
+      }
+    }
+
+    // Programmations récurrentes : les échéances proches rejoignent la table
+    while (scheduleTableTakeDue((uint32_t)(getCurrentTimeMicros() / 1000000ULL), &msg)) {
+      acceptCommand(msg);
+    }
+
+    // Dernière fraction de tick avant l'échéance : attente active pour ne pas
+    // dépendre de la granularité de l'ordonnanceur. Durée calculée une fois et
+    // mesurée sur micros() (monotone) : un recalage de l'horloge murale pendant
+    // l'attente ne la prolonge pas au-delà de COMMAND_SPIN_US
+    now = getCurrentTimeMicros();
+    deadline = nextDeadlineUs();
+    if (deadline != UINT64_MAX && deadline > now && deadline - now <= COMMAND_SPIN_US) {
+      uint32_t spinUs = (uint32_t)(deadline - now);
+      uint32_t spinStartUs = micros();
+      while (micros() - spinStartUs < spinUs) {
+      }
+    }
+
+    processScheduledCommands();
+  }
+}
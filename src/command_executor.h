@@ -0,0 +1,22 @@
+#ifndef COMMAND_EXECUTOR_H
+#define COMMAND_EXECUTOR_H
+
+#include "config.h"
+#include "command_queue.h"
+
+// ===== EXÉCUTEUR DE COMMANDES (tâche FreeRTOS) =====
+// Seule tâche à écrire les sorties sur commande : elle reçoit les commandes via
+// la file (callback MQTT, API web), tient la table des commandes programmées
+// et les exécute à l'échéance. Les programmations récurrentes (schedule_table.h)
+// y déposent leurs prochaines échéances.
+
+extern ScheduledCommand scheduledCommands[];
+
+// Soumet une commande à l'exécuteur (non bloquant, appelable depuis toute tâche).
+// Retourne false si la file est pleine.
+bool submitCommand(const CommandMsg* msg);
+
+// Point d'entrée de la tâche
+void commandTask(void *pvParameters);
+
+#endif // COMMAND_EXECUTOR_H
@@ -0,0 +1,109 @@
+#include "command_queue.h"
+
+#if defined(ARDUINO)
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+static QueueHandle_t commandQueue = NULL;
+static QueueHandle_t outboundQueue = NULL;
+
+static bool queueSend(QueueHandle_t queue, const void* msg) {
+  return queue != NULL && xQueueSend(queue, msg, 0) == pdTRUE;
+}
+
+static bool queueReceive(QueueHandle_t queue, void* msg, uint32_t timeoutUs) {
+  if (queue == NULL) return false;
+  // Arrondi au tick supérieur : un délai non nul ne devient jamais une attente nulle
+  const uint32_t tickUs = portTICK_PERIOD_MS * 1000UL;
+  TickType_t ticks = (TickType_t)((timeoutUs + tickUs - 1) / tickUs);
+  return xQueueReceive(queue, msg, ticks) == pdTRUE;
+}
+
+bool commandQueueInit(unsigned depth) {
+  commandQueue = xQueueCreate(depth, sizeof(CommandMsg));
+  return commandQueue != NULL;
+}
+
+bool commandQueueSend(const CommandMsg* msg) {
+  return queueSend(commandQueue, msg);
+}
+
+bool commandQueueReceive(CommandMsg* msg, uint32_t timeoutUs) {
+  return queueReceive(commandQueue, msg, timeoutUs);
+}
+
+bool outboundQueueInit(unsigned depth) {
+  outboundQueue = xQueueCreate(depth, sizeof(OutboundMsg));
+  return outboundQueue != NULL;
+}
+
+bool outboundQueueSend(const OutboundMsg* msg) {
+  return queueSend(outboundQueue, msg);
+}
+
+bool outboundQueueReceive(OutboundMsg* msg, uint32_t timeoutUs) {
+  return queueReceive(outboundQueue, msg, timeoutUs);
+}
+
+#else // Hôte : même logique sur std::thread
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+// Anneau de taille fixe protégé par un mutex, réveil du lecteur par condition
+template <typename T>
+class HostQueue {
+public:
+  bool init(unsigned depth) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slots_.assign(depth, T());
+    head_ = 0;
+    count_ = 0;
+    return depth > 0;
+  }
+
+  bool send(const T* msg) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (count_ >= slots_.size()) return false;
+      slots_[(head_ + count_) % slots_.size()] = *msg;
+      count_++;
+    }
+    notEmpty_.notify_one();
+    return true;
+  }
+
+  bool receive(T* msg, uint32_t timeoutUs) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!notEmpty_.wait_for(lock, std::chrono::microseconds(timeoutUs), [this] { return count_ > 0; })) {
+      return false;
+    }
+    *msg = slots_[head_];
+    head_ = (head_ + 1) % slots_.size();
+    count_--;
+    return true;
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable notEmpty_;
+  std::vector<T> slots_;
+  unsigned head_ = 0;
+  unsigned count_ = 0;
+};
+
+static HostQueue<CommandMsg> commandQueue;
+static HostQueue<OutboundMsg> outboundQueue;
+
+bool commandQueueInit(unsigned depth) { return commandQueue.init(depth); }
+bool commandQueueSend(const CommandMsg* msg) { return commandQueue.send(msg); }
+bool commandQueueReceive(CommandMsg* msg, uint32_t timeoutUs) { return commandQueue.receive(msg, timeoutUs); }
+
+bool outboundQueueInit(unsigned depth) { return outboundQueue.init(depth); }
+bool outboundQueueSend(const OutboundMsg* msg) { return outboundQueue.send(msg); }
+bool outboundQueueReceive(OutboundMsg* msg, uint32_t timeoutUs) { return outboundQueue.receive(msg, timeoutUs); }
+
+#endif
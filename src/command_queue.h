@@ -0,0 +1,58 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <stdint.h>
+#include "command_ack.h"
+
+// ===== FILE DE COMMANDES =====
+// File FIFO de taille fixe entre les producteurs (callback MQTT, handlers web)
+// et la tâche d'exécution des commandes. Sur ESP32 elle s'appuie sur une queue
+// FreeRTOS ; sur l'hôte (hors ARDUINO) la même interface est implémentée avec
+// std::mutex / std::condition_variable pour être utilisée depuis des std::thread.
+
+struct CommandMsg {
+  uint8_t pin;
+  uint8_t state;
+  uint32_t exec_at_sec;          // 0 = exécution immédiate
+  uint32_t exec_at_us;
+  char id[COMMAND_ID_MAX_LEN];   // "" si la commande n'est pas identifiée
+  uint64_t received_us;          // Heure de réception (pour l'acquittement)
+};
+
+// Crée la file (à appeler une seule fois, avant le démarrage des tâches)
+bool commandQueueInit(unsigned depth);
+
+// Dépose une commande sans bloquer. Retourne false si la file est pleine.
+bool commandQueueSend(const CommandMsg* msg);
+
+// Attend une commande au plus timeoutUs microsecondes (0 = non bloquant).
+// Sur ESP32 le délai est arrondi au tick FreeRTOS supérieur.
+bool commandQueueReceive(CommandMsg* msg, uint32_t timeoutUs);
+
+// ===== FILE DE PUBLICATION =====
+// Messages produits par CmdTask (état d'une sortie écrite, acquittement) et
+// publiés par NetTask. CmdTask ne prend jamais MqttLock : NetTask le garde
+// pendant tout le connect() bloquant de PubSubClient, une échéance programmée
+// ne doit pas attendre la fin d'une reconnexion. Même implémentation que la
+// file de commandes.
+
+#define OUTBOUND_STATUS 0  // <device>/status/<nom> après l'écriture d'une sortie
+#define OUTBOUND_ACK    1  // <device>/ack
+
+struct OutboundMsg {
+  uint8_t kind;                  // OUTBOUND_STATUS / OUTBOUND_ACK
+  uint8_t pin;
+  uint8_t state;
+  const char* status;            // Acquittement : chaîne littérale ("executed"...)
+  char id[COMMAND_ID_MAX_LEN];
+  uint64_t received_us;
+  uint64_t scheduled_us;
+  uint64_t executed_us;          // Statut : instant de l'écriture
+  uint32_t actuation_us;
+};
+
+bool outboundQueueInit(unsigned depth);
+bool outboundQueueSend(const OutboundMsg* msg);
+bool outboundQueueReceive(OutboundMsg* msg, uint32_t timeoutUs);
+
+#endif // COMMAND_QUEUE_H
@@ -2,41 +2,116 @@
 #define CONFIG_H
 
 #include <Arduino.h>
+#include "command_ack.h"
+#include "group_list.h"
+#include "board_profile.h"
 
 #define MAX_IOS 20
 
 
 // ===== CONFIGURATION PINS =====
-#define RELAY_K1        16
-#define RELAY_K2       17
+// Broches propres à une carte (ex-RELAY_K1 / RELAY_K2 : GPIO 16 / 17) : profils
+// de board_profile.h, choisis par -DBOARD_PROFILE=... ; sinon tout se configure via /api/ios
 
 // ===== STRUCTURES =====
 // Structure for a single configurable I/O pin
 struct IOPin {
   uint8_t pin;
   char name[32];
-  uint8_t mode; // 0 = DISABLED, 1 = INPUT, 2 = OUTPUT
+  uint8_t mode; // 0 = DISABLED, 1 = INPUT, 2 = OUTPUT, 3 = COUNTER, 4 = ANALOG
   uint8_t inputType; // For inputs: 0 = INPUT, 1 = INPUT_PULLUP, 2 = INPUT_PULLDOWN
-  bool state;   // Current state (for outputs) or last read state (for inputs)
+  bool state;   // Unused at runtime (see pinStates in io_table.h), kept for the stored layout
   bool defaultState; // Default state at boot for outputs
+  uint32_t publishIntervalMs; // For counters: aggregation/publish interval (ms). For analog: heartbeat (ms)
+  // Analog inputs only
+  uint8_t oversampleShift; // 2^n ADC samples averaged per reading
+  uint8_t filterType;      // 0 = NONE, 1 = IIR, 2 = MEDIAN (5 samples)
+  uint8_t filterShift;     // IIR coefficient: alpha = 1/2^n
+  int32_t calGain;         // Linear calibration gain, Q16 (65536 = 1.0)
+  int32_t calOffset;       // Offset added after gain
+  uint32_t deadband;       // Minimum change (calibrated units) before publishing
+  // Digital inputs only: publish policy
+  uint16_t minPublishIntervalMs; // Minimum time between publishes, edges in between are coalesced (0 = every edge)
+  bool publishTransitions;       // Publish JSON with the transition count instead of a bare 0/1
+  // Outputs only: mechanical actuation delay (digitalWrite -> contact), see actuation_calibration.h
+  uint32_t actuationOnUs;        // Delay when switching to HIGH (us, 0 = unknown)
+  uint32_t actuationOffUs;       // Delay when switching to LOW
+  // Outputs only: state applied at boot, see output_journal.h
+  uint8_t restorePolicy;         // 0 = defaultState, 1 = last state recorded in the flash journal
+  // Digital inputs only: edge statistics, see edge_stats.h
+  uint32_t statsIntervalMs;      // Periodic MQTT summary on <device>/stats/<name> (0 = off)
+  bool statsOnly;                // Do not publish each edge, statistics only
 };
 
+#define RESTORE_DEFAULT 0
+#define RESTORE_LAST    1
+
+// Upper bound for actuation offsets: beyond this the wiring or the relay is faulty
+#define ACTUATION_MAX_US 500000
+
+// Default publish interval for COUNTER inputs
+#define DEFAULT_COUNTER_INTERVAL_MS 1000
+
+// Analog inputs: background sampling period and defaults
+#define ANALOG_SAMPLE_PERIOD_MS     10
+#define DEFAULT_ANALOG_HEARTBEAT_MS 60000
+#define DEFAULT_ANALOG_OVERSAMPLE   4
+#define DEFAULT_ANALOG_FILTER_SHIFT 3
+#define DEFAULT_ANALOG_DEADBAND     10
 
-struct AccessLog {
-  char timestamp[25];
-  char ip[16];
-  char resource[50];
-};
 
 // Maximum number of scheduled commands
 #define MAX_SCHEDULED_COMMANDS 10
 
+// ===== FreeRTOS TASK TOPOLOGY =====
+// Core, priority and stack of each task (override with -D in build_flags).
+// The WiFi/LwIP stack runs on core 0: the network task sits next to it while the
+// command executor and the IO scanner get core 1 for themselves.
+#ifndef NET_TASK_CORE
+#define NET_TASK_CORE       0
+#endif
+#ifndef NET_TASK_PRIORITY
+#define NET_TASK_PRIORITY   2
+#endif
+#ifndef NET_TASK_STACK
+#define NET_TASK_STACK      8192
+#endif
+
+#ifndef CMD_TASK_CORE
+#define CMD_TASK_CORE       1
+#endif
+#ifndef CMD_TASK_PRIORITY
+#define CMD_TASK_PRIORITY   5   // Highest: scheduled commands must not wait behind IO scans
+#endif
+#ifndef CMD_TASK_STACK
+#define CMD_TASK_STACK      4096
+#endif
+
+#ifndef IO_TASK_CORE
+#define IO_TASK_CORE        1
+#endif
+#ifndef IO_TASK_PRIORITY
+#define IO_TASK_PRIORITY    3
+#endif
+#ifndef IO_TASK_STACK
+#define IO_TASK_STACK       4096
+#endif
+
+// Command executor tuning
+#define COMMAND_QUEUE_DEPTH   16
+#define OUTBOUND_QUEUE_DEPTH  32      // States and acks waiting for NetTask (two per command)
+#define COMMAND_IDLE_WAIT_US  100000  // Max sleep on the queue when no deadline is pending
+#define COMMAND_SPIN_US       2000    // Busy-wait window before a deadline (must exceed one tick)
+
 struct ScheduledCommand {
   bool active;
   int pin;
   int state;
   uint32_t exec_at_sec;  // Unix timestamp en secondes
   uint32_t exec_at_us;   // Microsecondes (0-999999)
+  uint32_t lead_us;      // Avance d'écriture = délai de commutation de la sortie (contact à exec_at)
+  char id[COMMAND_ID_MAX_LEN]; // Identifiant optionnel de la commande ("" si absent)
+  uint64_t received_us;  // Heure de réception (pour l'acquittement)
 };
 
 
@@ -57,11 +132,13 @@ struct Config {
   char mqttUser[32];
   char mqttPassword[32];
   char mqttTopic[32];
+  char groups[GROUP_LIST_MAX_LEN]; // Groupes de diffusion ("salle1,nord"), voir group_list.h
 
   // NTP Settings
   char ntpServer[64];
   long gmtOffset_sec;
   int daylightOffset_sec;
+  char timezone[48];     // Fuseau POSIX TZ des programmations ("" = gmtOffset_sec + daylightOffset_sec)
 
   bool initialized;
 };
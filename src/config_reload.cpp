@@ -0,0 +1,174 @@
+#include <Arduino.h>
+#include <sys/time.h>
+#include <atomic>
+#include "config_reload.h"
+#include "mqtt.h"
+#include "event_log.h"
+#include "schedule_table.h"
+
+extern unsigned long lastMqttReconnect;
+
+static const char* const CONFIG_APPLY_NAMES[CONFIG_APPLY_COUNT] = {
+  "none", "in_place", "reconnect", "restart"
+};
+static const char* const CONFIG_CHANGE_NAMES[CONFIG_CHANGE_COUNT] = {
+  "network", "broker", "device_name", "topic", "groups", "time", "admin", "ios"
+};
+
+#define RESTART_MARKER_MAGIC 0x524C4431UL  // "RLD1"
+
+// Conservé par un reset logiciel (ni effacé ni initialisé au démarrage)
+struct RestartMarker {
+  uint32_t magic;
+  uint32_t changes;
+  uint64_t wallUs;          // Heure murale de la demande de redémarrage
+};
+static RTC_NOINIT_ATTR RestartMarker restartMarker;
+
+static ConfigReloadStats stats[CONFIG_APPLY_COUNT];
+
+// Rechargement en attente de reconnexion : level publié en dernier
+static std::atomic<uint8_t> pendingLevel(CONFIG_APPLY_NONE);
+static uint16_t pendingChanges = 0;
+static uint64_t pendingStartUs = 0;
+
+static uint64_t wallUs() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return (uint64_t)tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+uint16_t configDiff(const Config* current, const Config* next) {
+  uint16_t changes = 0;
+  if (current->useStaticIP != next->useStaticIP || strcmp(current->staticIP, next->staticIP) != 0 ||
+      strcmp(current->staticGateway, next->staticGateway) != 0 ||
+      strcmp(current->staticSubnet, next->staticSubnet) != 0) {
+    changes |= CONFIG_CHANGE_NETWORK;
+  }
+  if (strcmp(current->mqttServer, next->mqttServer) != 0 || current->mqttPort != next->mqttPort ||
+      strcmp(current->mqttUser, next->mqttUser) != 0 || strcmp(current->mqttPassword, next->mqttPassword) != 0) {
+    changes |= CONFIG_CHANGE_BROKER;
+  }
+  if (strcmp(current->deviceName, next->deviceName) != 0) changes |= CONFIG_CHANGE_DEVICE_NAME;
+  if (strcmp(current->mqttTopic, next->mqttTopic) != 0) changes |= CONFIG_CHANGE_TOPIC;
+  if (strcmp(current->groups, next->groups) != 0) changes |= CONFIG_CHANGE_GROUPS;
+  if (strcmp(current->timezone, next->timezone) != 0 || current->gmtOffset_sec != next->gmtOffset_sec ||
+      current->daylightOffset_sec != next->daylightOffset_sec || strcmp(current->ntpServer, next->ntpServer) != 0) {
+    changes |= CONFIG_CHANGE_TIME;
+  }
+  if (strcmp(current->adminPassword, next->adminPassword) != 0) changes |= CONFIG_CHANGE_ADMIN;
+  return changes;
+}
+
+uint8_t configApplyLevel(uint16_t changes) {
+  if (changes == 0) return CONFIG_APPLY_NONE;
+  // L'IP statique n'est appliquée que par WiFiManager, au démarrage
+  if (changes & CONFIG_CHANGE_NETWORK) return CONFIG_APPLY_RESTART;
+  // Client ID, Last Will et préfixe des abonnements changent : nouvelle session
+  if (changes & (CONFIG_CHANGE_BROKER | CONFIG_CHANGE_DEVICE_NAME)) return CONFIG_APPLY_RECONNECT;
+  return CONFIG_APPLY_IN_PLACE;
+}
+
+uint8_t configApply(const Config* next, uint16_t changes) {
+  uint8_t level = configApplyLevel(changes);
+  if (level == CONFIG_APPLY_NONE || level == CONFIG_APPLY_RESTART) return level;
+
+  uint64_t startUs = wallUs();
+  if (level == CONFIG_APPLY_RECONNECT) configReloadBegin(level, changes);
+  if (changes & (CONFIG_CHANGE_BROKER | CONFIG_CHANGE_DEVICE_NAME | CONFIG_CHANGE_TOPIC | CONFIG_CHANGE_GROUPS)) {
+    applyMqttConfig(next, level == CONFIG_APPLY_RECONNECT);
+  }
+  if (changes & CONFIG_CHANGE_TIME) {
+    strlcpy(config.timezone, next->timezone, sizeof(config.timezone));
+    strlcpy(config.ntpServer, next->ntpServer, sizeof(config.ntpServer));
+    config.gmtOffset_sec = next->gmtOffset_sec;
+    config.daylightOffset_sec = next->daylightOffset_sec;
+    // Les échéances sont recalculées dans le nouveau fuseau
+    scheduleTableSetTimezone(config.timezone, config.gmtOffset_sec + config.daylightOffset_sec);
+  }
+  if (changes & CONFIG_CHANGE_ADMIN) {
+    strlcpy(config.adminPassword, next->adminPassword, sizeof(config.adminPassword));
+  }
+
+  if (level == CONFIG_APPLY_RECONNECT) {
+    lastMqttReconnect = 0;  // NetTask n'attend pas les 5 s entre deux tentatives
+  } else {
+    configReloadRecord(level, changes, (uint32_t)((wallUs() - startUs) / 1000));
+  }
+  return level;
+}
+
+void configReloadBegin(uint8_t level, uint16_t changes) {
+  pendingChanges = changes;
+  pendingStartUs = wallUs();
+  pendingLevel.store(level, std::memory_order_release);
+}
+
+void configReloadEnd() {
+  uint8_t level = pendingLevel.exchange(CONFIG_APPLY_NONE, std::memory_order_acq_rel);
+  if (level == CONFIG_APPLY_NONE || level >= CONFIG_APPLY_COUNT) return;
+
+  uint64_t now = wallUs();
+  if (now < pendingStartUs || now - pendingStartUs > (uint64_t)CONFIG_RELOAD_RESTART_MAX_MS * 1000ULL) {
+    Serial.println("⚠️ Config reload: clock stepped, downtime not measured");
+    return;
+  }
+  configReloadRecord(level, pendingChanges, (uint32_t)((now - pendingStartUs) / 1000));
+}
+
+void configReloadRecord(uint8_t level, uint16_t changes, uint32_t downtimeMs) {
+  if (level >= CONFIG_APPLY_COUNT) return;
+  ConfigReloadStats& s = stats[level];
+  s.count++;
+  s.lastMs = downtimeMs;
+  if (downtimeMs > s.maxMs) s.maxMs = downtimeMs;
+  s.lastChanges = changes;
+
+  char names[EVENT_TEXT_LEN];
+  configChangeFormat(changes, names, sizeof(names));
+  eventLogWrite(EVENT_CONFIG_RELOAD, level, downtimeMs, names);
+  Serial.printf("🔄 Config reloaded (%s: %s) - downtime %lu ms\n", configApplyName(level), names,
+                (unsigned long)downtimeMs);
+}
+
+void configReloadMarkRestart(uint16_t changes) {
+  restartMarker.changes = changes;
+  restartMarker.wallUs = wallUs();
+  restartMarker.magic = RESTART_MARKER_MAGIC;
+}
+
+void configReloadResume() {
+  if (restartMarker.magic != RESTART_MARKER_MAGIC) return;
+  restartMarker.magic = 0;
+  // L'horloge murale survit au reset logiciel : la mesure couvre le redémarrage complet
+  pendingChanges = (uint16_t)restartMarker.changes;
+  pendingStartUs = restartMarker.wallUs;
+  pendingLevel.store(CONFIG_APPLY_RESTART, std::memory_order_release);
+}
+
+bool configReloadPending() {
+  return pendingLevel.load(std::memory_order_acquire) != CONFIG_APPLY_NONE;
+}
+
+void configReloadGetStats(uint8_t level, ConfigReloadStats* out) {
+  if (level < CONFIG_APPLY_COUNT) *out = stats[level];
+  else memset(out, 0, sizeof(ConfigReloadStats));
+}
+
+const char* configApplyName(uint8_t level) {
+  return level < CONFIG_APPLY_COUNT ? CONFIG_APPLY_NAMES[level] : "unknown";
+}
+
+size_t configChangeFormat(uint16_t changes, char* out, size_t outSize) {
+  size_t len = 0;
+  if (outSize == 0) return 0;
+  out[0] = '\0';
+  for (int i = 0; i < CONFIG_CHANGE_COUNT; i++) {
+    if (!(changes & (1 << i))) continue;
+    int n = snprintf(out + len, outSize - len, "%s%s", len ? "," : "", CONFIG_CHANGE_NAMES[i]);
+    if (n < 0 || (size_t)n >= outSize - len) break;  // Tronqué sur un nom entier
+    len += n;
+  }
+  out[len] = '\0';
+  return len;
+}
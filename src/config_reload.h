@@ -0,0 +1,84 @@
+#ifndef CONFIG_RELOAD_H
+#define CONFIG_RELOAD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// ===== RECHARGEMENT DE LA CONFIGURATION À CHAUD =====
+// Une nouvelle configuration est comparée champ par champ à la configuration
+// courante ; seul le nécessaire est refait :
+//   IN_PLACE  : groupes (abonnements ajustés), fuseau, mot de passe admin...
+//               la session MQTT et les sorties ne bougent pas.
+//   RECONNECT : nom de l'appareil ou broker : "offline" publié sur l'ancien
+//               topic de disponibilité, déconnexion, reconnexion immédiate.
+//   RESTART   : réseau (IP statique) : appliqué par WiFiManager au démarrage.
+// L'interruption de service de chaque rechargement est mesurée jusqu'à la
+// reconnexion MQTT (à travers le redémarrage pour RESTART, par un marqueur en
+// mémoire RTC conservé par un reset logiciel) et exposée par type.
+//
+//   Config next = config;  ...modifications...
+//   uint16_t changes = configDiff(&config, &next);
+//   if (configApplyLevel(changes) < CONFIG_APPLY_RESTART) configApply(&next, changes);
+
+enum ConfigChange : uint16_t {
+  CONFIG_CHANGE_NETWORK = 1 << 0,      // useStaticIP, staticIP, staticGateway, staticSubnet
+  CONFIG_CHANGE_BROKER = 1 << 1,       // mqttServer, mqttPort, mqttUser, mqttPassword
+  CONFIG_CHANGE_DEVICE_NAME = 1 << 2,  // Préfixe de tous les topics et client ID
+  CONFIG_CHANGE_TOPIC = 1 << 3,        // mqttTopic
+  CONFIG_CHANGE_GROUPS = 1 << 4,
+  CONFIG_CHANGE_TIME = 1 << 5,         // timezone, gmtOffset_sec, daylightOffset_sec, ntpServer
+  CONFIG_CHANGE_ADMIN = 1 << 6,        // adminPassword
+  CONFIG_CHANGE_IOS = 1 << 7           // Table des I/O (/api/ios)
+};
+#define CONFIG_CHANGE_COUNT 8
+
+enum ConfigApply : uint8_t {
+  CONFIG_APPLY_NONE = 0,
+  CONFIG_APPLY_IN_PLACE = 1,
+  CONFIG_APPLY_RECONNECT = 2,
+  CONFIG_APPLY_RESTART = 3
+};
+#define CONFIG_APPLY_COUNT 4
+
+// Redémarrage plus long que ceci : marqueur périmé ou horloge recalée, pas mesuré
+#define CONFIG_RELOAD_RESTART_MAX_MS 600000
+
+struct ConfigReloadStats {
+  uint32_t count;           // Rechargements terminés
+  uint32_t lastMs;          // Interruption du dernier (ms)
+  uint32_t maxMs;
+  uint16_t lastChanges;     // ConfigChange du dernier
+};
+
+// Champs modifiés entre deux configurations (masque de ConfigChange)
+uint16_t configDiff(const Config* current, const Config* next);
+// Niveau d'application requis par un masque de changements
+uint8_t configApplyLevel(uint16_t changes);
+
+// Applique next sur la configuration courante sans redémarrer (niveaux
+// IN_PLACE / RECONNECT) ; la persistance reste à la charge de l'appelant.
+// Retourne le niveau appliqué.
+uint8_t configApply(const Config* next, uint16_t changes);
+
+// Début / fin d'un rechargement avec reconnexion. configReloadEnd() est appelé
+// à la connexion MQTT (onMqttConnected) et n'a d'effet que si un rechargement
+// est en cours.
+void configReloadBegin(uint8_t level, uint16_t changes);
+void configReloadEnd();
+// Rechargement terminé sans attente (IN_PLACE) : statistiques et journal
+void configReloadRecord(uint8_t level, uint16_t changes, uint32_t downtimeMs);
+// Avant ESP.restart() : le marqueur survit au reset logiciel
+void configReloadMarkRestart(uint16_t changes);
+// Au démarrage : reprend la mesure d'un redémarrage demandé par la configuration
+void configReloadResume();
+// true tant qu'un rechargement attend la reconnexion MQTT
+bool configReloadPending();
+
+void configReloadGetStats(uint8_t level, ConfigReloadStats* out);
+
+// Noms pour l'API ("in_place", "broker,groups")
+const char* configApplyName(uint8_t level);
+size_t configChangeFormat(uint16_t changes, char* out, size_t outSize);
+
+#endif // CONFIG_RELOAD_H
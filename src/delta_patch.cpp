@@ -0,0 +1,233 @@
+#include "delta_patch.h"
+#include <string.h>
+
+enum DeltaRecordState : uint8_t {
+  REC_ADD_LEN = 0,
+  REC_SEEK = 1,
+  REC_INSERT_LEN = 2,
+  REC_ADD_DATA = 3,
+  REC_INSERT_DATA = 4
+};
+
+static uint32_t readLe32(const uint8_t* b) {
+  return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+void deltaPatchBegin(DeltaPatch* p, DeltaReadFn readSource, DeltaWriteFn writeTarget, void* ctx,
+                     DeltaHeaderFn onHeader) {
+  memset(p, 0, sizeof(DeltaPatch));
+  p->readSource = readSource;
+  p->writeTarget = writeTarget;
+  p->onHeader = onHeader;
+  p->ctx = ctx;
+  p->status = DELTA_OK;
+}
+
+static int8_t fail(DeltaPatch* p, int8_t status) {
+  p->status = status;
+  return status;
+}
+
+static int8_t flushOutput(DeltaPatch* p) {
+  if (p->outBufLen == 0) return DELTA_OK;
+  if (!p->writeTarget(p->ctx, p->outBuf, p->outBufLen)) return fail(p, DELTA_ERR_WRITE);
+  p->outBufLen = 0;
+  return DELTA_OK;
+}
+
+static int8_t emit(DeltaPatch* p, uint8_t c) {
+  p->outBuf[p->outBufLen++] = c;
+  p->outPos++;
+  if (p->outBufLen < DELTA_IO_CHUNK) return DELTA_OK;
+  return flushOutput(p);
+}
+
+// Octet source à srcPos, lu par blocs de DELTA_IO_CHUNK (les ADD sont séquentiels)
+static int8_t sourceByte(DeltaPatch* p, uint8_t* out) {
+  if (p->srcPos < p->srcBufStart || p->srcPos >= p->srcBufStart + p->srcBufLen) {
+    uint32_t remaining = p->header.sourceSize - p->srcPos;
+    uint16_t len = remaining < DELTA_IO_CHUNK ? (uint16_t)remaining : DELTA_IO_CHUNK;
+    if (!p->readSource(p->ctx, p->srcPos, p->srcBuf, len)) return fail(p, DELTA_ERR_READ);
+    p->srcBufStart = p->srcPos;
+    p->srcBufLen = len;
+  }
+  *out = p->srcBuf[p->srcPos - p->srcBufStart];
+  return DELTA_OK;
+}
+
+static void endRecordData(DeltaPatch* p) {
+  if (p->addLen > 0) p->recordState = REC_ADD_DATA;
+  else if (p->insertLen > 0) p->recordState = REC_INSERT_DATA;
+  else p->recordState = REC_ADD_LEN;
+}
+
+// Un octet du flux décompressé
+static int8_t recordByte(DeltaPatch* p, uint8_t b) {
+  switch (p->recordState) {
+    case REC_ADD_LEN:
+    case REC_SEEK:
+    case REC_INSERT_LEN: {
+      if (p->varintShift > 28) return fail(p, DELTA_ERR_CORRUPT);
+      p->varint |= (uint32_t)(b & 0x7F) << p->varintShift;
+      if (b & 0x80) {
+        p->varintShift += 7;
+        return DELTA_OK;
+      }
+      uint32_t v = p->varint;
+      p->varint = 0;
+      p->varintShift = 0;
+
+      if (p->recordState == REC_ADD_LEN) {
+        p->addLen = v;
+        p->recordState = REC_SEEK;
+      } else if (p->recordState == REC_SEEK) {
+        p->seek = (int32_t)((v >> 1) ^ (0 - (v & 1)));  // zigzag
+        int64_t pos = (int64_t)p->srcPos + p->seek;
+        if (pos < 0 || pos + p->addLen > p->header.sourceSize) return fail(p, DELTA_ERR_SOURCE_RANGE);
+        p->srcPos = (uint32_t)pos;
+        p->recordState = REC_INSERT_LEN;
+      } else {
+        p->insertLen = v;
+        if ((uint64_t)p->outPos + p->addLen + p->insertLen > p->header.targetSize) {
+          return fail(p, DELTA_ERR_TARGET_OVERFLOW);
+        }
+        endRecordData(p);
+      }
+      return DELTA_OK;
+    }
+
+    case REC_ADD_DATA: {
+      uint8_t old;
+      if (sourceByte(p, &old) != DELTA_OK) return p->status;
+      p->srcPos++;
+      p->addLen--;
+      endRecordData(p);
+      return emit(p, (uint8_t)(old + b));
+    }
+
+    case REC_INSERT_DATA:
+      p->insertLen--;
+      endRecordData(p);
+      return emit(p, b);
+  }
+  return fail(p, DELTA_ERR_CORRUPT);
+}
+
+static int8_t decompressed(DeltaPatch* p, uint8_t c) {
+  // Un enregistrement qui commence une fois l'image complète est de trop
+  if (p->outPos == p->header.targetSize && p->recordState == REC_ADD_LEN && p->varintShift == 0) {
+    return fail(p, DELTA_ERR_TARGET_OVERFLOW);
+  }
+  p->window[p->windowPos & (DELTA_WINDOW_SIZE - 1)] = c;
+  p->windowPos++;
+  return recordByte(p, c);
+}
+
+static int8_t copyMatch(DeltaPatch* p) {
+  for (uint32_t k = 0; k < p->matchLen; k++) {
+    uint8_t c = p->window[(p->windowPos - p->matchDist) & (DELTA_WINDOW_SIZE - 1)];
+    if (decompressed(p, c) != DELTA_OK) return p->status;
+  }
+  return DELTA_OK;
+}
+
+static int8_t parseHeader(DeltaPatch* p) {
+  const uint8_t* h = p->headerBuf;
+  if (memcmp(h, DELTA_MAGIC, 4) != 0) return fail(p, DELTA_ERR_MAGIC);
+  p->header.version = h[4];
+  if (p->header.version != DELTA_VERSION) return fail(p, DELTA_ERR_VERSION);
+  p->header.sourceSize = readLe32(h + 8);
+  p->header.targetSize = readLe32(h + 12);
+  memcpy(p->header.sourceSha256, h + 16, 32);
+  memcpy(p->header.targetSha256, h + 48, 32);
+  if (p->onHeader && !p->onHeader(p->ctx, &p->header)) return fail(p, DELTA_ERR_REJECTED);
+  return DELTA_OK;
+}
+
+int8_t deltaPatchFeed(DeltaPatch* p, const uint8_t* data, size_t len) {
+  if (p->status < 0) return p->status;
+  size_t i = 0;
+
+  while (i < len && p->headerLen < DELTA_HEADER_SIZE) {
+    p->headerBuf[p->headerLen++] = data[i++];
+    if (p->headerLen == DELTA_HEADER_SIZE && parseHeader(p) != DELTA_OK) return p->status;
+  }
+
+  for (; i < len; i++) {
+    uint8_t b = data[i];
+    if (p->flagBits == 0) {
+      p->flags = b;
+      p->flagBits = 8;
+      continue;
+    }
+    if (p->flags & 1) {
+      p->flags >>= 1;
+      p->flagBits--;
+      if (decompressed(p, b) != DELTA_OK) return p->status;
+    } else if (p->tokenState == 0) {
+      p->matchDist = b;
+      p->tokenState = 1;
+    } else {
+      if (p->tokenState == 1) {
+        p->matchDist = (p->matchDist | ((uint16_t)(b >> 4) << 8)) + 1;
+        p->matchLen = (b & 0x0F) + DELTA_MIN_MATCH;
+        if ((b & 0x0F) == DELTA_LEN_EXTENDED) {
+          p->tokenState = 2;
+          continue;
+        }
+      } else {
+        p->matchLen += b;
+        if (p->matchLen >= (1UL << 30)) return fail(p, DELTA_ERR_CORRUPT);  // Extension sans fin
+        if (b == 255) continue;
+      }
+      p->tokenState = 0;
+      p->flags >>= 1;
+      p->flagBits--;
+      if (p->matchDist > p->windowPos) return fail(p, DELTA_ERR_CORRUPT);
+      if (copyMatch(p) != DELTA_OK) return p->status;
+    }
+  }
+
+  if (deltaPatchHasHeader(p) && p->outPos == p->header.targetSize && p->recordState == REC_ADD_LEN) {
+    if (flushOutput(p) != DELTA_OK) return p->status;
+    return DELTA_DONE;
+  }
+  return DELTA_OK;
+}
+
+int8_t deltaPatchFinish(DeltaPatch* p) {
+  if (p->status < 0) return p->status;
+  if (!deltaPatchHasHeader(p)) return fail(p, DELTA_ERR_TRUNCATED);
+  if (flushOutput(p) != DELTA_OK) return p->status;
+  if (p->outPos != p->header.targetSize || p->recordState != REC_ADD_LEN || p->varintShift != 0 ||
+      p->tokenState != 0) {
+    return fail(p, DELTA_ERR_TRUNCATED);
+  }
+  p->status = DELTA_DONE;
+  return DELTA_DONE;
+}
+
+bool deltaPatchHasHeader(const DeltaPatch* p) {
+  return p->headerLen == DELTA_HEADER_SIZE;
+}
+
+uint32_t deltaPatchProgress(const DeltaPatch* p) {
+  return p->outPos;
+}
+
+const char* deltaStatusName(int8_t status) {
+  switch (status) {
+    case DELTA_OK: return "ok";
+    case DELTA_DONE: return "done";
+    case DELTA_ERR_MAGIC: return "bad_magic";
+    case DELTA_ERR_VERSION: return "bad_version";
+    case DELTA_ERR_CORRUPT: return "corrupt";
+    case DELTA_ERR_SOURCE_RANGE: return "source_range";
+    case DELTA_ERR_TARGET_OVERFLOW: return "target_overflow";
+    case DELTA_ERR_READ: return "read_failed";
+    case DELTA_ERR_WRITE: return "write_failed";
+    case DELTA_ERR_TRUNCATED: return "truncated";
+    case DELTA_ERR_REJECTED: return "rejected";
+    default: return "unknown";
+  }
+}
@@ -0,0 +1,117 @@
+#ifndef DELTA_PATCH_H
+#define DELTA_PATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ===== MISE À JOUR DIFFÉRENTIELLE (application d'un patch) =====
+// Module pur (sans Arduino) : reconstruit l'image cible à partir de l'image
+// en cours d'exécution et d'un patch produit par ota_delta.py, au fil de
+// l'eau et en mémoire bornée (fenêtre LZSS de 4 Ko + deux tampons de 256 o).
+//
+// Format du patch :
+//   en-tête (80 octets, non compressé) : "EDLT", version, 3 octets réservés,
+//     taille source, taille cible (u32 LE), SHA-256 source, SHA-256 cible ;
+//   corps compressé LZSS (un octet de drapeaux pour 8 éléments, bit à 1 =
+//     littéral, à 0 = référence de 2 octets : distance 1-4096 sur 12 bits,
+//     longueur 3-17 sur 4 bits ; 15 = 18 + octets d'extension additionnés
+//     tant qu'ils valent 255, comme LZ4 : une longue plage nulle tient en peu d'octets),
+//   qui décompressé est une suite d'enregistrements à la bsdiff :
+//     varint addLen, varint zigzag seek, varint insertLen,
+//     addLen octets ajoutés (mod 256) à la source depuis srcPos += seek,
+//     insertLen octets nouveaux recopiés tels quels.
+// Les hachages sont vérifiés par l'appelant (voir ota_delta.cpp).
+//
+//   DeltaPatch p;
+//   deltaPatchBegin(&p, readSource, writeTarget, ctx);
+//   while (... chunk ...) if (deltaPatchFeed(&p, chunk, len) < 0) ...erreur...
+//   if (deltaPatchFinish(&p) == DELTA_DONE) ...image complète...
+
+#define DELTA_MAGIC "EDLT"
+#define DELTA_VERSION 1
+#define DELTA_HEADER_SIZE 80
+#define DELTA_WINDOW_BITS 12
+#define DELTA_WINDOW_SIZE (1 << DELTA_WINDOW_BITS)
+#define DELTA_MIN_MATCH 3
+#define DELTA_LEN_EXTENDED 15                // Longueur sur 4 bits suivie d'octets d'extension
+#define DELTA_IO_CHUNK 256                // Lectures source / écritures cible groupées
+
+enum DeltaStatus : int8_t {
+  DELTA_OK = 0,                           // Données consommées, la suite est attendue
+  DELTA_DONE = 1,                         // Image cible complète
+  DELTA_ERR_MAGIC = -1,                   // Pas un patch
+  DELTA_ERR_VERSION = -2,
+  DELTA_ERR_CORRUPT = -3,                 // Flux compressé ou enregistrement invalide
+  DELTA_ERR_SOURCE_RANGE = -4,            // Référence hors de l'image source
+  DELTA_ERR_TARGET_OVERFLOW = -5,         // Plus de données que la taille cible annoncée
+  DELTA_ERR_READ = -6,                    // Lecture de la source refusée par l'appelant
+  DELTA_ERR_WRITE = -7,                   // Écriture de la cible refusée par l'appelant
+  DELTA_ERR_TRUNCATED = -8,               // Fin du patch avant la fin de l'image
+  DELTA_ERR_REJECTED = -9                 // En-tête refusé par l'appelant (autre image source...)
+};
+
+struct DeltaHeader {
+  uint8_t version;
+  uint32_t sourceSize;
+  uint32_t targetSize;
+  uint8_t sourceSha256[32];
+  uint8_t targetSha256[32];
+};
+
+// Rappels de l'appelant : false interrompt l'application
+typedef bool (*DeltaReadFn)(void* ctx, uint32_t offset, uint8_t* buf, size_t len);
+typedef bool (*DeltaWriteFn)(void* ctx, const uint8_t* buf, size_t len);
+// Appelé une fois l'en-tête reçu, avant toute lecture ou écriture (hachage de
+// la source, ouverture de la partition...) ; false interrompt l'application
+typedef bool (*DeltaHeaderFn)(void* ctx, const DeltaHeader* header);
+
+struct DeltaPatch {
+  DeltaReadFn readSource;
+  DeltaWriteFn writeTarget;
+  DeltaHeaderFn onHeader;
+  void* ctx;
+  int8_t status;
+  DeltaHeader header;
+  uint8_t headerBuf[DELTA_HEADER_SIZE];
+  uint8_t headerLen;
+
+  // Décompression LZSS
+  uint8_t window[DELTA_WINDOW_SIZE];
+  uint32_t windowPos;                     // Octets décompressés au total
+  uint8_t flags;
+  uint8_t flagBits;                       // Éléments restants pour l'octet de drapeaux courant
+  uint8_t tokenState;                     // Référence : 0 = aucune, 1 = 1er octet lu, 2 = extension
+  uint16_t matchDist;
+  uint32_t matchLen;
+
+  // Enregistrements
+  uint8_t recordState;
+  uint32_t varint;
+  uint8_t varintShift;
+  uint32_t addLen;
+  int32_t seek;
+  uint32_t insertLen;
+  uint32_t srcPos;
+  uint32_t outPos;
+
+  uint8_t srcBuf[DELTA_IO_CHUNK];
+  uint32_t srcBufStart;                   // Position source du premier octet de srcBuf
+  uint16_t srcBufLen;
+  uint8_t outBuf[DELTA_IO_CHUNK];
+  uint16_t outBufLen;
+};
+
+void deltaPatchBegin(DeltaPatch* p, DeltaReadFn readSource, DeltaWriteFn writeTarget, void* ctx,
+                     DeltaHeaderFn onHeader = nullptr);
+// Consomme un morceau du patch ; retourne DELTA_OK, DELTA_DONE ou une erreur (< 0)
+int8_t deltaPatchFeed(DeltaPatch* p, const uint8_t* data, size_t len);
+// Fin du patch : vide le tampon de sortie, DELTA_DONE si l'image est complète
+int8_t deltaPatchFinish(DeltaPatch* p);
+// En-tête reçu (les tailles et hachages de p->header sont valides)
+bool deltaPatchHasHeader(const DeltaPatch* p);
+// Octets de l'image cible produits
+uint32_t deltaPatchProgress(const DeltaPatch* p);
+
+const char* deltaStatusName(int8_t status);
+
+#endif // DELTA_PATCH_H
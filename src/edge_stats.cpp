@@ -0,0 +1,86 @@
+#include "edge_stats.h"
+#include <stddef.h>
+#include <string.h>
+
+static_assert(EDGE_STATS_HISTORY <= 32, "EDGE_STATS_HISTORY: one level bit per entry in historyLevels");
+
+static void widthSample(PulseWidthStats* w, uint32_t us) {
+  if (w->count == 0 || us < w->minUs) w->minUs = us;
+  if (us > w->maxUs) w->maxUs = us;
+  w->totalUs += us;
+  w->count++;
+}
+
+void edgeStatsReset(EdgeStats* s, bool level, uint32_t nowUs) {
+  uint32_t seq = s->seq;
+  s->seq = seq + 1;
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  memset((void*)&s->edges, 0, sizeof(EdgeStats) - offsetof(EdgeStats, edges));
+  s->level = level;
+  s->lastEdgeUs = nowUs;
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  s->seq = seq + 2;
+}
+
+void edgeStatsOnEdge(EdgeStats* s, bool level, uint32_t nowUs) {
+  if (level == s->level) return;  // Pas un front
+  uint32_t seq = s->seq;
+  s->seq = seq + 1;
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  // Avant le premier front, le niveau a commencé avant la remise à zéro : durée inconnue
+  if (s->edges > 0) widthSample(s->level ? &s->high : &s->low, nowUs - s->lastEdgeUs);
+  s->edges++;
+  s->level = level;
+  s->lastEdgeUs = nowUs;
+
+  uint32_t bit = 1UL << s->historyPos;
+  s->historyUs[s->historyPos] = nowUs;
+  s->historyLevels = level ? (s->historyLevels | bit) : (s->historyLevels & ~bit);
+  s->historyPos = (s->historyPos + 1) % EDGE_STATS_HISTORY;
+
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  s->seq = seq + 2;
+}
+
+bool edgeStatsRead(const EdgeStats* src, EdgeStats* dst) {
+  for (int attempt = 0; attempt < EDGE_STATS_READ_RETRIES; attempt++) {
+    uint32_t before = src->seq;
+    if (before & 1) continue;  // Mise à jour en cours (quelques instructions)
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    memcpy((void*)dst, (const void*)src, sizeof(EdgeStats));
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (src->seq == before) return true;
+  }
+  return false;
+}
+
+void edgeStatsAssign(EdgeStats* dst, const EdgeStats* src) {
+  uint32_t seq = dst->seq;
+  dst->seq = seq + 1;
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  memcpy((void*)&dst->edges, (const void*)&src->edges, sizeof(EdgeStats) - offsetof(EdgeStats, edges));
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  dst->seq = seq + 2;
+}
+
+uint32_t pulseWidthAvgUs(const PulseWidthStats* w) {
+  return w->count ? (uint32_t)(w->totalUs / w->count) : 0;
+}
+
+uint16_t edgeStatsDutyPermille(const EdgeStats* s) {
+  uint64_t total = s->high.totalUs + s->low.totalUs;
+  return total ? (uint16_t)((s->high.totalUs * 1000 + total / 2) / total) : 0;
+}
+
+int edgeStatsHistory(const EdgeStats* s, uint32_t* timesUs, bool* levels) {
+  int count = s->edges < EDGE_STATS_HISTORY ? (int)s->edges : EDGE_STATS_HISTORY;
+  // Anneau plein : le plus ancien est à historyPos ; sinon l'anneau commence à 0
+  int start = count < EDGE_STATS_HISTORY ? 0 : s->historyPos;
+  for (int k = 0; k < count; k++) {
+    int slot = (start + k) % EDGE_STATS_HISTORY;
+    timesUs[k] = s->historyUs[slot];
+    levels[k] = (s->historyLevels >> slot) & 1;
+  }
+  return count;
+}
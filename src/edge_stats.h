@@ -0,0 +1,66 @@
+#ifndef EDGE_STATS_H
+#define EDGE_STATS_H
+
+#include <stdint.h>
+
+// ===== STATISTIQUES DE FRONTS PAR ENTRÉE =====
+// Module pur (sans Arduino), mis à jour par la tâche I/O à chaque front
+// détecté, en mémoire constante :
+//  - nombre de fronts ;
+//  - durées des niveaux haut et bas : min / max / moyenne (impulsions
+//    complètes uniquement, le niveau en cours n'est compté qu'à son front de fin) ;
+//  - rapport cyclique = temps haut / (temps haut + temps bas) ;
+//  - horodatage (micros()) et niveau des EDGE_STATS_HISTORY derniers fronts.
+//
+// Les durées sont des différences de micros() sur 32 bits : exactes jusqu'à
+// ~71 minutes par niveau. Leur résolution est celle de la scrutation (~1 ms),
+// une impulsion plus courte qu'une passe n'est pas vue.
+//
+// Lecture depuis une autre tâche (serveur web, MQTT) sans verrou : seq est
+// impair pendant une mise à jour, edgeStatsRead() recommence la copie si seq
+// a changé pendant celle-ci (verrou de séquence, l'écrivain n'attend jamais).
+//
+//   edgeStatsReset(&s, digitalRead(pin), micros());
+//   edgeStatsOnEdge(&s, level, micros());          // à chaque changement d'état
+//   EdgeStats copy;
+//   if (edgeStatsRead(&s, &copy)) { edgeStatsDutyPermille(&copy) ... }
+
+#ifndef EDGE_STATS_HISTORY
+#define EDGE_STATS_HISTORY 8          // Derniers fronts horodatés (32 max)
+#endif
+#define EDGE_STATS_READ_RETRIES 16
+
+struct PulseWidthStats {
+  uint32_t count;         // Impulsions complètes mesurées
+  uint32_t minUs;
+  uint32_t maxUs;
+  uint64_t totalUs;
+};
+
+struct EdgeStats {
+  volatile uint32_t seq;  // Verrou de séquence : impair pendant une mise à jour
+  uint32_t edges;         // Fronts depuis la remise à zéro
+  PulseWidthStats high;
+  PulseWidthStats low;
+  bool level;             // Niveau courant
+  uint32_t lastEdgeUs;    // Dernier front (ou remise à zéro tant qu'il n'y en a pas)
+  uint32_t historyUs[EDGE_STATS_HISTORY];
+  uint32_t historyLevels; // Bit n : niveau après le front historyUs[n]
+  uint8_t historyPos;     // Prochain emplacement de l'anneau
+};
+
+void edgeStatsReset(EdgeStats* s, bool level, uint32_t nowUs);
+// Changement de niveau détecté : clôt la durée du niveau précédent
+void edgeStatsOnEdge(EdgeStats* s, bool level, uint32_t nowUs);
+// Copie cohérente depuis une autre tâche (false : mises à jour ininterrompues)
+bool edgeStatsRead(const EdgeStats* src, EdgeStats* dst);
+// Remplace dst par src (écrivain de dst : I/O déplacée dans la table)
+void edgeStatsAssign(EdgeStats* dst, const EdgeStats* src);
+
+uint32_t pulseWidthAvgUs(const PulseWidthStats* w);
+// Rapport cyclique en pour mille (0 sans impulsion complète)
+uint16_t edgeStatsDutyPermille(const EdgeStats* s);
+// Fronts de l'historique, du plus ancien au plus récent ; retourne leur nombre
+int edgeStatsHistory(const EdgeStats* s, uint32_t* timesUs, bool* levels);
+
+#endif // EDGE_STATS_H
@@ -0,0 +1,183 @@
+#include "event_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+EventLog eventLog;
+
+static const char* const EVENT_TYPE_NAMES[] = {
+  "", "boot", "access", "command", "mqtt_connect", "mqtt_disconnect", "wifi", "time_sync", "config_reload",
+  "output_restore"
+};
+#define EVENT_TYPE_COUNT (sizeof(EVENT_TYPE_NAMES) / sizeof(EVENT_TYPE_NAMES[0]))
+
+void eventLogReset(EventLog* log) {
+  log->head.store(0, std::memory_order_relaxed);
+  for (int i = 0; i < EVENT_LOG_SIZE; i++) {
+    log->slots[i].seq.store(0, std::memory_order_relaxed);
+  }
+}
+
+uint32_t eventLogAppend(EventLog* log, uint64_t timeUs, uint8_t type, uint16_t arg, uint32_t value,
+                        const char* text, uint8_t source) {
+  uint32_t seq = log->head.fetch_add(1, std::memory_order_relaxed) + 1;
+  EventSlot& slot = log->slots[(seq - 1) % EVENT_LOG_SIZE];
+
+  // Case invalidée avant d'être réécrite : un lecteur concurrent verra la séquence changer
+  slot.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  EventRecord& rec = slot.record;
+  rec.timeUs = timeUs;
+  rec.seq = seq;
+  rec.value = value;
+  rec.arg = arg;
+  rec.type = type;
+  rec.source = source;
+  memset(rec.text, 0, sizeof(rec.text));
+  if (text != nullptr) {
+    strncpy(rec.text, text, sizeof(rec.text) - 1);
+  }
+
+  slot.seq.store(seq, std::memory_order_release);
+  return seq;
+}
+
+uint32_t eventLogWrite(uint8_t type, uint16_t arg, uint32_t value, const char* text, uint8_t source) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  uint64_t timeUs = (uint64_t)tv.tv_sec * 1000000ULL + (uint64_t)tv.tv_usec;
+  return eventLogAppend(&eventLog, timeUs, type, arg, value, text, source);
+}
+
+uint32_t eventLogHead(const EventLog* log) {
+  return log->head.load(std::memory_order_acquire) + 1;
+}
+
+uint32_t eventLogOldest(const EventLog* log) {
+  uint32_t head = eventLogHead(log);
+  return head > EVENT_LOG_SIZE ? head - EVENT_LOG_SIZE : 1;
+}
+
+bool eventLogRead(const EventLog* log, uint32_t seq, EventRecord* out) {
+  if (seq == 0) return false;
+  const EventSlot& slot = log->slots[(seq - 1) % EVENT_LOG_SIZE];
+  if (slot.seq.load(std::memory_order_acquire) != seq) return false;
+  memcpy(out, &slot.record, sizeof(EventRecord));
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.seq.load(std::memory_order_relaxed) == seq;
+}
+
+const char* eventTypeName(uint8_t type) {
+  return type > 0 && type < EVENT_TYPE_COUNT ? EVENT_TYPE_NAMES[type] : "unknown";
+}
+
+uint8_t eventTypeFromName(const char* name) {
+  for (uint8_t i = 1; i < EVENT_TYPE_COUNT; i++) {
+    if (strcmp(name, EVENT_TYPE_NAMES[i]) == 0) return i;
+  }
+  return 0;
+}
+
+static const char* httpMethodName(uint16_t method) {
+  switch (method) {
+    case 1: return "GET";
+    case 2: return "POST";
+    case 4: return "DELETE";
+    case 8: return "PUT";
+    case 16: return "PATCH";
+    case 32: return "HEAD";
+    case 64: return "OPTIONS";
+    default: return "?";
+  }
+}
+
+static const char* sourceName(uint8_t source) {
+  switch (source) {
+    case EVENT_SOURCE_MQTT: return "mqtt";
+    case EVENT_SOURCE_GROUP: return "group";
+    case EVENT_SOURCE_WEB: return "web";
+    case EVENT_SOURCE_SCHEDULE: return "schedule";
+    default: return "system";
+  }
+}
+
+// Niveaux de config_reload.h (module pur : pas de dépendance à Config)
+static const char* reloadApplyName(uint16_t level) {
+  switch (level) {
+    case 1: return "in_place";
+    case 2: return "reconnect";
+    case 3: return "restart";
+    default: return "none";
+  }
+}
+
+// Texte libre (URL, id) en chaîne JSON : guillemets et antislash échappés,
+// caractères de contrôle remplacés
+static void escapeText(const char* text, char* out, size_t outSize) {
+  size_t n = 0;
+  for (size_t i = 0; i < EVENT_TEXT_LEN && text[i] != '\0' && n + 2 < outSize; i++) {
+    char c = text[i];
+    if (c == '"' || c == '\\') {
+      out[n++] = '\\';
+      out[n++] = c;
+    } else {
+      out[n++] = ((uint8_t)c < 0x20) ? '?' : c;
+    }
+  }
+  out[n] = '\0';
+}
+
+size_t eventLogFormatJson(const EventRecord* rec, char* out, size_t outSize) {
+  char text[EVENT_TEXT_LEN * 2 + 1];
+  escapeText(rec->text, text, sizeof(text));
+
+  int n = snprintf(out, outSize, "{\"seq\":%lu,\"t\":%llu,\"type\":\"%s\"",
+                   (unsigned long)rec->seq, (unsigned long long)rec->timeUs, eventTypeName(rec->type));
+  if (n < 0 || (size_t)n >= outSize) return 0;
+  size_t len = n;
+
+  switch (rec->type) {
+    case EVENT_BOOT:
+      n = snprintf(out + len, outSize - len, ",\"reason\":%u,\"version\":\"%s\"", rec->arg, text);
+      break;
+    case EVENT_ACCESS:
+      n = snprintf(out + len, outSize - len, ",\"method\":\"%s\",\"ip\":\"%u.%u.%u.%u\",\"url\":\"%s\"",
+                   httpMethodName(rec->arg), (unsigned)(rec->value & 0xFF), (unsigned)((rec->value >> 8) & 0xFF),
+                   (unsigned)((rec->value >> 16) & 0xFF), (unsigned)(rec->value >> 24), text);
+      break;
+    case EVENT_COMMAND:
+      n = snprintf(out + len, outSize - len, ",\"source\":\"%s\",\"gpio\":%u,\"state\":%lu,\"id\":\"%s\"",
+                   sourceName(rec->source), rec->arg, (unsigned long)rec->value, text);
+      break;
+    case EVENT_MQTT_CONNECT:
+      n = snprintf(out + len, outSize - len, ",\"backend\":\"%s\"", text);
+      break;
+    case EVENT_MQTT_DISCONNECT:
+      n = snprintf(out + len, outSize - len, ",\"rc\":%ld", (long)(int32_t)rec->value);
+      break;
+    case EVENT_WIFI:
+      n = snprintf(out + len, outSize - len, ",\"connected\":%s,\"rssi\":%ld",
+                   rec->arg ? "true" : "false", (long)(int32_t)rec->value);
+      break;
+    case EVENT_TIME_SYNC:
+      n = snprintf(out + len, outSize - len, ",\"correction_ms\":%ld", (long)(int32_t)rec->value);
+      break;
+    case EVENT_CONFIG_RELOAD:
+      n = snprintf(out + len, outSize - len, ",\"apply\":\"%s\",\"downtime_ms\":%lu,\"changes\":\"%s\"",
+                   reloadApplyName(rec->arg), (unsigned long)rec->value, text);
+      break;
+    case EVENT_OUTPUT_RESTORE:
+      n = snprintf(out + len, outSize - len, ",\"pins\":%u,\"read_us\":%lu", rec->arg, (unsigned long)rec->value);
+      break;
+    default:
+      n = 0;
+      break;
+  }
+  if (n < 0 || len + n + 2 >= outSize) return 0;
+  len += n;
+  out[len++] = '}';
+  out[len++] = '\n';
+  out[len] = '\0';
+  return len;
+}
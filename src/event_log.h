@@ -0,0 +1,96 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// ===== JOURNAL D'ÉVÉNEMENTS =====
+// Anneau binaire de taille fixe (accès web/API, commandes MQTT, connexions,
+// redémarrages), horodaté à la microseconde sur l'horloge murale.
+// Écriture sans verrou depuis n'importe quelle tâche : un fetch_add réserve la
+// case, le numéro de séquence est publié en dernier et valide l'enregistrement.
+// Un lecteur copie la case puis vérifie que la séquence n'a pas bougé ; un
+// enregistrement écrasé pendant la lecture est simplement signalé comme perdu.
+//
+//   eventLogWrite(EVENT_COMMAND, gpio, state, id, EVENT_SOURCE_MQTT);
+//   for (uint32_t seq = eventLogOldest(&eventLog); seq < eventLogHead(&eventLog); seq++) {
+//     EventRecord rec;
+//     if (eventLogRead(&eventLog, seq, &rec)) { ... }
+//   }
+
+#ifndef EVENT_LOG_SIZE
+#define EVENT_LOG_SIZE 256          // Enregistrements en RAM (puissance de 2)
+#endif
+#define EVENT_TEXT_LEN 28
+#define EVENT_JSON_MAX_LEN 192      // Ligne NDJSON la plus longue produite par eventLogFormatJson
+
+enum EventType : uint8_t {
+  EVENT_BOOT = 1,             // arg = raison du reset, text = version
+  EVENT_ACCESS = 2,           // arg = méthode HTTP (codes ESPAsyncWebServer), value = IP cliente, text = URL
+  EVENT_COMMAND = 3,          // arg = GPIO, value = état, text = id de la commande
+  EVENT_MQTT_CONNECT = 4,     // text = backend MQTT
+  EVENT_MQTT_DISCONNECT = 5,  // value = code d'erreur (int32)
+  EVENT_WIFI = 6,             // arg = 1 connecté / 0 perdu, value = RSSI (int32)
+  EVENT_TIME_SYNC = 7,        // value = correction appliquée en ms (int32, saturée)
+  EVENT_CONFIG_RELOAD = 8,    // arg = ConfigApply, value = interruption en ms, text = champs modifiés
+  EVENT_OUTPUT_RESTORE = 9    // arg = GPIO retrouvés dans le journal des sorties, value = durée de lecture en µs
+};
+
+enum EventSource : uint8_t {
+  EVENT_SOURCE_SYSTEM = 0,
+  EVENT_SOURCE_MQTT = 1,      // Topic de l'appareil
+  EVENT_SOURCE_GROUP = 2,     // Topic de groupe
+  EVENT_SOURCE_WEB = 3,
+  EVENT_SOURCE_SCHEDULE = 4   // Programmation récurrente (text = "sched-<n>")
+};
+
+// Format binaire (48 octets), identique en RAM et sur la flash
+struct EventRecord {
+  uint64_t timeUs;
+  uint32_t seq;               // Numéro d'ordre, à partir de 1
+  uint32_t value;
+  uint16_t arg;
+  uint8_t type;
+  uint8_t source;
+  char text[EVENT_TEXT_LEN];
+};
+
+struct EventSlot {
+  std::atomic<uint32_t> seq;  // 0 pendant l'écriture, sinon seq de l'enregistrement
+  EventRecord record;
+};
+
+struct EventLog {
+  std::atomic<uint32_t> head; // Prochain numéro de séquence - 1 (enregistrements réservés)
+  EventSlot slots[EVENT_LOG_SIZE];
+};
+
+extern EventLog eventLog;
+
+void eventLogReset(EventLog* log);
+
+// Ajoute un enregistrement et retourne son numéro de séquence
+uint32_t eventLogAppend(EventLog* log, uint64_t timeUs, uint8_t type, uint16_t arg, uint32_t value,
+                        const char* text, uint8_t source);
+
+// Ajoute au journal global, horodaté avec gettimeofday()
+uint32_t eventLogWrite(uint8_t type, uint16_t arg, uint32_t value, const char* text = nullptr,
+                       uint8_t source = EVENT_SOURCE_SYSTEM);
+
+// Premier numéro de séquence non encore réservé
+uint32_t eventLogHead(const EventLog* log);
+// Plus ancien numéro de séquence encore présent dans l'anneau
+uint32_t eventLogOldest(const EventLog* log);
+
+// Copie l'enregistrement seq ; false s'il est écrasé ou pas encore validé
+bool eventLogRead(const EventLog* log, uint32_t seq, EventRecord* out);
+
+// Ligne NDJSON (terminée par '\n') ; retourne sa longueur, 0 si out est trop petit
+size_t eventLogFormatJson(const EventRecord* rec, char* out, size_t outSize);
+
+// Nom d'un type ("access", "command"...) et inverse (0 si inconnu)
+const char* eventTypeName(uint8_t type);
+uint8_t eventTypeFromName(const char* name);
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,106 @@
+#include "event_log_flash.h"
+#include <SPIFFS.h>
+
+static const char* const EVENT_LOG_FILES[] = { "/events.old", "/events.bin" };
+
+static uint32_t persistedSeq = 0;   // Dernier numéro de séquence écrit sur la flash
+static uint32_t lastFlushMs = 0;
+
+void eventLogFlashBegin() {
+#if EVENT_LOG_PERSIST
+  // Les numéros repartent de 1 à chaque démarrage : l'événement "boot" sépare les sessions
+  persistedSeq = 0;
+  lastFlushMs = millis();
+  File f = SPIFFS.open(EVENT_LOG_FILES[1], FILE_READ);
+  Serial.printf("✓ Event log persisted to SPIFFS (%u records stored)\n",
+                f ? (unsigned)(f.size() / sizeof(EventRecord)) : 0);
+  if (f) f.close();
+#endif
+}
+
+void eventLogFlashPersist(uint32_t nowMs) {
+#if EVENT_LOG_PERSIST
+  uint32_t head = eventLogHead(&eventLog);
+  uint32_t pending = head - 1 - persistedSeq;
+  if (pending == 0) {
+    lastFlushMs = nowMs;
+    return;
+  }
+  // Pages complètes seulement, sauf si la page en cours attend depuis trop longtemps
+  if (pending < EVENT_LOG_PAGE_RECORDS && nowMs - lastFlushMs < EVENT_LOG_FLUSH_MS) return;
+
+  // Enregistrements écrasés dans l'anneau avant d'avoir été écrits : perdus
+  uint32_t oldest = eventLogOldest(&eventLog);
+  if (persistedSeq + 1 < oldest) {
+    Serial.printf("⚠️ Event log: %u records lost before flash write\n", (unsigned)(oldest - 1 - persistedSeq));
+    persistedSeq = oldest - 1;
+  }
+
+  File f = SPIFFS.open(EVENT_LOG_FILES[1], FILE_APPEND);
+  if (!f) return;
+
+  EventRecord page[EVENT_LOG_PAGE_RECORDS];
+  while (persistedSeq + 1 < head) {
+    size_t count = 0;
+    while (count < EVENT_LOG_PAGE_RECORDS && persistedSeq + 1 + count < head &&
+           eventLogRead(&eventLog, persistedSeq + 1 + count, &page[count])) {
+      count++;
+    }
+    if (count == 0) break;  // Écriture en cours ou écrasé : repris au prochain passage
+    f.write((const uint8_t*)page, count * sizeof(EventRecord));
+    persistedSeq += count;
+  }
+  size_t size = f.size();
+  f.close();
+  lastFlushMs = nowMs;
+
+  if (size >= EVENT_LOG_FILE_MAX) {
+    SPIFFS.remove(EVENT_LOG_FILES[0]);
+    SPIFFS.rename(EVENT_LOG_FILES[1], EVENT_LOG_FILES[0]);
+  }
+#else
+  (void)nowMs;
+#endif
+}
+
+void eventLogFlashOpen(EventLogFlashReader* reader, uint8_t typeFilter) {
+  reader->file = File();
+  reader->fileIndex = 0;
+  reader->typeFilter = typeFilter;
+}
+
+size_t eventLogFlashStream(EventLogFlashReader* reader, uint8_t* buffer, size_t maxLen) {
+  size_t len = 0;
+  char line[EVENT_JSON_MAX_LEN];
+
+  while (reader->fileIndex < 2) {
+    if (!reader->file) {
+      if (SPIFFS.exists(EVENT_LOG_FILES[reader->fileIndex])) {
+        reader->file = SPIFFS.open(EVENT_LOG_FILES[reader->fileIndex], FILE_READ);
+      }
+      if (!reader->file) {
+        reader->fileIndex++;
+        continue;
+      }
+    }
+
+    size_t pos = reader->file.position();
+    EventRecord rec;
+    if (reader->file.read((uint8_t*)&rec, sizeof(rec)) != sizeof(rec)) {
+      reader->file.close();
+      reader->file = File();
+      reader->fileIndex++;
+      continue;
+    }
+    if (reader->typeFilter != 0 && rec.type != reader->typeFilter) continue;
+
+    size_t n = eventLogFormatJson(&rec, line, sizeof(line));
+    if (len + n > maxLen) {
+      reader->file.seek(pos);  // Relu au morceau suivant
+      break;
+    }
+    memcpy(buffer + len, line, n);
+    len += n;
+  }
+  return len;
+}
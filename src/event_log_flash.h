@@ -0,0 +1,43 @@
+#ifndef EVENT_LOG_FLASH_H
+#define EVENT_LOG_FLASH_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "event_log.h"
+
+// ===== PERSISTANCE DU JOURNAL SUR SPIFFS =====
+// Optionnelle (-DEVENT_LOG_PERSIST=1) : NetTask recopie les enregistrements de
+// l'anneau par pages de EVENT_LOG_PAGE_RECORDS dans /events.bin, au format
+// binaire EventRecord. Au-delà de EVENT_LOG_FILE_MAX, le fichier devient
+// /events.old (l'ancien est supprimé) : l'historique survit aux redémarrages.
+#ifndef EVENT_LOG_PERSIST
+#define EVENT_LOG_PERSIST 0
+#endif
+#ifndef EVENT_LOG_PAGE_RECORDS
+#define EVENT_LOG_PAGE_RECORDS 16       // 768 octets par écriture
+#endif
+#ifndef EVENT_LOG_FLUSH_MS
+#define EVENT_LOG_FLUSH_MS 60000        // Page incomplète écrite au plus tard après ce délai
+#endif
+#ifndef EVENT_LOG_FILE_MAX
+#define EVENT_LOG_FILE_MAX (64 * 1024)
+#endif
+
+// À appeler après SPIFFS.begin()
+void eventLogFlashBegin();
+// À appeler régulièrement (NetTask) : écrit les pages complètes, ou la page en
+// cours si EVENT_LOG_FLUSH_MS est écoulé
+void eventLogFlashPersist(uint32_t nowMs);
+
+// Lecture en flux de l'historique persisté (/events.old puis /events.bin)
+struct EventLogFlashReader {
+  File file;
+  uint8_t fileIndex;   // 0 = /events.old, 1 = /events.bin, 2 = terminé
+  uint8_t typeFilter;  // 0 = tous les types
+};
+
+void eventLogFlashOpen(EventLogFlashReader* reader, uint8_t typeFilter);
+// Remplit buffer de lignes NDJSON complètes ; 0 quand tout est lu
+size_t eventLogFlashStream(EventLogFlashReader* reader, uint8_t* buffer, size_t maxLen);
+
+#endif // EVENT_LOG_FLASH_H
@@ -0,0 +1,69 @@
+#include "group_list.h"
+#include <string.h>
+
+static bool isValidGroupChar(char c) {
+  return c != '/' && c != '+' && c != '#' && c != ' ' && c != '\t';
+}
+
+int groupListParse(const char* list, char groups[][GROUP_NAME_MAX_LEN], int maxGroups) {
+  int count = 0;
+  const char* p = list;
+  while (p != nullptr && *p != '\0' && count < maxGroups) {
+    // Délimiter l'élément courant et retirer les espaces autour
+    const char* end = strchr(p, ',');
+    if (end == nullptr) end = p + strlen(p);
+    const char* start = p;
+    const char* stop = end;
+    while (start < stop && (*start == ' ' || *start == '\t')) start++;
+    while (stop > start && (stop[-1] == ' ' || stop[-1] == '\t')) stop--;
+    p = *end == ',' ? end + 1 : end;
+
+    size_t len = stop - start;
+    if (len == 0 || len >= GROUP_NAME_MAX_LEN) continue;
+    bool valid = true;
+    for (size_t i = 0; i < len; i++) {
+      if (!isValidGroupChar(start[i])) valid = false;
+    }
+    if (!valid) continue;
+    // Le groupe de diffusion est implicite : inutile de le stocker
+    if (len == strlen(BROADCAST_GROUP) && strncmp(start, BROADCAST_GROUP, len) == 0) continue;
+
+    bool duplicate = false;
+    for (int i = 0; i < count; i++) {
+      if (strlen(groups[i]) == len && strncmp(groups[i], start, len) == 0) duplicate = true;
+    }
+    if (duplicate) continue;
+
+    memcpy(groups[count], start, len);
+    groups[count][len] = '\0';
+    count++;
+  }
+  return count;
+}
+
+void groupListNormalize(const char* list, char* out, size_t outSize) {
+  char groups[MAX_GROUPS][GROUP_NAME_MAX_LEN];
+  int count = groupListParse(list, groups, MAX_GROUPS);
+  size_t pos = 0;
+  if (outSize == 0) return;
+  out[0] = '\0';
+  for (int i = 0; i < count; i++) {
+    size_t len = strlen(groups[i]);
+    // Séparateur + nom + terminateur
+    if (pos + (i > 0 ? 1 : 0) + len + 1 > outSize) break;
+    if (i > 0) out[pos++] = ',';
+    memcpy(out + pos, groups[i], len);
+    pos += len;
+    out[pos] = '\0';
+  }
+}
+
+bool groupListContains(const char* list, const char* group, size_t len) {
+  if (len == strlen(BROADCAST_GROUP) && strncmp(group, BROADCAST_GROUP, len) == 0) return true;
+  char groups[MAX_GROUPS][GROUP_NAME_MAX_LEN];
+  int count = groupListParse(list, groups, MAX_GROUPS);
+  for (int i = 0; i < count; i++) {
+    if (strlen(groups[i]) == len && strncmp(groups[i], group, len) == 0) return true;
+  }
+  return false;
+}
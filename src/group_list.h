@@ -0,0 +1,28 @@
+#ifndef GROUP_LIST_H
+#define GROUP_LIST_H
+
+#include <stddef.h>
+
+// ===== GROUPES DE DIFFUSION =====
+// Un appareil membre du groupe <g> exécute les commandes publiées sur
+// esp32/group/<g>/control/<nom>/set : une seule publication atteint toute la
+// flotte (ou une partie). Le groupe "all" est implicite pour tous les appareils.
+// L'appartenance est une liste séparée par des virgules ("salle1,nord").
+
+#define GROUP_TOPIC_PREFIX "esp32/group/"
+#define BROADCAST_GROUP    "all"
+#define MAX_GROUPS         4
+#define GROUP_NAME_MAX_LEN 16
+#define GROUP_LIST_MAX_LEN (MAX_GROUPS * GROUP_NAME_MAX_LEN)
+
+// Découpe une liste en noms de groupes valides (espaces retirés, doublons,
+// "all" et noms contenant '/', '+' ou '#' ignorés). Retourne le nombre de groupes.
+int groupListParse(const char* list, char groups[][GROUP_NAME_MAX_LEN], int maxGroups);
+
+// Forme canonique d'une liste ("a,b"), pour la stocker et la comparer
+void groupListNormalize(const char* list, char* out, size_t outSize);
+
+// true si <group> (longueur len, non terminé) est dans la liste ou est le groupe de diffusion
+bool groupListContains(const char* list, const char* group, size_t len);
+
+#endif // GROUP_LIST_H
@@ -0,0 +1,81 @@
+#include "io_table.h"
+#include "analog_input.h"
+
+SnapshotBuffer<IOTable> ioTable;
+volatile uint8_t pinStates[MAX_GPIO];
+
+int ioTableFindByName(const IOTable* table, const char* name) {
+  for (int i = 0; i < table->count; i++) {
+    if (strcmp(table->pins[i].name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool ioNameReserved(const char* name) {
+  return strcmp(name, "get") == 0;
+}
+
+int ioTableFindByPin(const IOTable* table, int pin) {
+  // Broches du profil : position connue à la compilation
+  int fixed = BoardFixedPins::indexOf(pin);
+  if (fixed >= 0 && fixed < table->count) return fixed;
+  for (int i = BOARD_FIXED_PIN_COUNT; i < table->count; i++) {
+    if (table->pins[i].pin == pin) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+uint32_t ioActuationUs(const IOTable* table, int pin, int state) {
+  int idx = ioTableFindByPin(table, pin);
+  if (idx < 0 || table->pins[idx].mode != 2) return 0; // OUTPUT
+  return state ? table->pins[idx].actuationOnUs : table->pins[idx].actuationOffUs;
+}
+
+// Réglages par défaut d'une broche fixe absente de la configuration enregistrée
+static void initFixedPin(IOPin& pin, int index) {
+  memset(&pin, 0, sizeof(IOPin));
+  strlcpy(pin.name, BoardProfile::pinName(index), sizeof(pin.name));
+  bool isAnalog = BoardFixedPins::modeAt(index) == 4; // ANALOG
+  pin.publishIntervalMs = isAnalog ? DEFAULT_ANALOG_HEARTBEAT_MS : DEFAULT_COUNTER_INTERVAL_MS;
+  pin.oversampleShift = DEFAULT_ANALOG_OVERSAMPLE;
+  pin.filterType = ANALOG_FILTER_IIR;
+  pin.filterShift = DEFAULT_ANALOG_FILTER_SHIFT;
+  pin.calGain = ANALOG_GAIN_ONE;
+  pin.deadband = DEFAULT_ANALOG_DEADBAND;
+}
+
+void ioTableApplyBoardProfile(IOTable& table) {
+  for (int i = 0; i < BOARD_FIXED_PIN_COUNT; i++) {
+    uint8_t gpio = BoardFixedPins::gpioAt(i);
+    int j = i;
+    while (j < table.count && table.pins[j].pin != gpio) j++;
+    if (j < table.count) {
+      // Déjà configurée : ramenée à sa place, réglages conservés
+      IOPin found = table.pins[j];
+      memmove(&table.pins[i + 1], &table.pins[i], (j - i) * sizeof(IOPin));
+      table.pins[i] = found;
+    } else {
+      // Absente : insérée, la dernière broche configurable est perdue si la table est pleine
+      int last = table.count < MAX_IOS ? table.count : MAX_IOS - 1;
+      memmove(&table.pins[i + 1], &table.pins[i], (last - i) * sizeof(IOPin));
+      initFixedPin(table.pins[i], i);
+      if (table.count < MAX_IOS) table.count++;
+    }
+    table.pins[i].pin = gpio;
+    table.pins[i].mode = BoardFixedPins::modeAt(i);
+    table.pins[i].inputType = BoardFixedPins::inputTypeAt(i);
+  }
+
+  // Une broche configurable ne peut pas reprendre un GPIO du profil
+  int count = BOARD_FIXED_PIN_COUNT;
+  for (int i = BOARD_FIXED_PIN_COUNT; i < table.count; i++) {
+    if (BoardFixedPins::indexOf(table.pins[i].pin) >= 0) continue;
+    if (count != i) table.pins[count] = table.pins[i];
+    count++;
+  }
+  table.count = count;
+}
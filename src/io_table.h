@@ -0,0 +1,61 @@
+#ifndef IO_TABLE_H
+#define IO_TABLE_H
+
+#include "config.h"
+#include "snapshot.h"
+
+// ===== TABLE DES I/O =====
+// La configuration des I/O est publiée en instantanés immuables (voir snapshot.h) :
+// la tâche I/O, le callback MQTT, l'exécuteur et le serveur web la lisent sans
+// verrou pendant que /api/ios la remplace.
+//
+//   IOTableReader io;                 // instantané courant
+//   for (int i = 0; i < io->count; i++) { ... io->pins[i] ... }
+
+#define MAX_GPIO 40
+
+struct IOTable {
+  uint32_t generation;   // Incrémenté à chaque reconfiguration
+  int count;
+  IOPin pins[MAX_IOS];
+};
+
+extern SnapshotBuffer<IOTable> ioTable;
+
+// État courant de chaque GPIO (sortie commandée ou dernière lecture d'entrée).
+// Indexé par numéro de GPIO pour rester valide d'une configuration à l'autre.
+extern volatile uint8_t pinStates[MAX_GPIO];
+
+struct IOTableReader : SnapshotReader<IOTable> {
+  IOTableReader() : SnapshotReader<IOTable>(ioTable) {}
+};
+
+// Remplace la configuration : fn(IOTable&) modifie une copie de la version courante
+template <typename F>
+void ioTableUpdate(F fn) {
+  ioTable.update([&](IOTable& table) {
+    fn(table);
+    table.generation++;
+  });
+}
+
+// Index d'un I/O dans l'instantané (-1 si absent)
+int ioTableFindByName(const IOTable* table, const char* name);
+int ioTableFindByPin(const IOTable* table, int pin);
+
+// Nom refusé pour une I/O : son état serait publié sur <device>/status/get, le
+// topic de demande d'instantané, et en déclencherait un à chaque changement
+bool ioNameReserved(const char* name);
+
+// Impose les broches du profil de carte (board_profile.h) aux BOARD_FIXED_PIN_COUNT
+// premières entrées : réglages existants conservés, broche ajoutée si absente,
+// doublons retirés des broches configurables. À appeler dans chaque ioTableUpdate.
+void ioTableApplyBoardProfile(IOTable& table);
+
+// Entrée fixée par le profil de carte (GPIO et mode non modifiables)
+inline bool ioTableIsFixed(int index) { return index >= 0 && index < BOARD_FIXED_PIN_COUNT; }
+
+// Délai de commutation mécanique de la sortie pin vers state (0 si inconnu)
+uint32_t ioActuationUs(const IOTable* table, int pin, int state);
+
+#endif // IO_TABLE_H
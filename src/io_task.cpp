@@ -0,0 +1,583 @@
+#include <Arduino.h>
+#include <atomic>
+#include "json_pool.h"
+#include "io_task.h"
+#include "io_table.h"
+#include "mqtt.h"
+#include "output_journal.h"
+
+// Compteurs d'impulsions (mode COUNTER) : incrémentés par ISR, agrégés par la tâche I/O
+volatile uint32_t pulseCounts[MAX_IOS];
+PulseCounter pulseCounters[MAX_IOS];
+static uint8_t attachedCounterPins[MAX_IOS];
+static int attachedCounterCount = 0;
+
+// Entrées analogiques (mode ANALOG) : état des filtres, échantillonnées par la tâche I/O
+AnalogChannel analogChannels[MAX_IOS];
+
+// Limiteurs de débit de publication des entrées numériques (mode INPUT)
+PublishLimiter publishLimiters[MAX_IOS];
+
+// Statistiques de fronts des entrées numériques (mode INPUT), lues par le serveur web
+EdgeStats edgeStats[MAX_IOS];
+static uint32_t statsPublishedMs[MAX_IOS];
+// Remises à zéro demandées par les autres tâches, bit n = index n
+static std::atomic<uint32_t> statsResetRequests(0);
+static_assert(MAX_IOS <= 32, "statsResetRequests: one bit per I/O");
+
+// Valeurs des compteurs et entrées analogiques copiées pour les autres tâches
+// (instantané MQTT, /api/status) : verrou de séquence, comme edge_stats.h
+struct IOValuesExport {
+  volatile uint32_t seq;    // Impair pendant une mise à jour
+  uint32_t generation;      // Génération de la table à l'écriture
+  IOValues values;
+};
+static IOValuesExport ioValuesExports[MAX_IOS];
+static uint32_t appliedGeneration = 0;  // Dernière génération appliquée par la tâche I/O
+
+// Tâche I/O : copie les valeurs courantes de l'I/O i pour les lecteurs
+static void exportIOValues(int i) {
+  IOValuesExport* e = &ioValuesExports[i];
+  uint32_t seq = e->seq;
+  e->seq = seq + 1;
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  e->generation = appliedGeneration;
+  e->values.count = pulseCounters[i].total;
+  e->values.rateMilliHz = pulseCounters[i].rateMilliHz;
+  e->values.value = analogChannels[i].value;
+  e->values.raw = analogChannels[i].raw;
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  e->seq = seq + 2;
+}
+
+bool ioValuesRead(int index, uint32_t generation, IOValues* out) {
+  if (index < 0 || index >= MAX_IOS) return false;
+  const IOValuesExport* e = &ioValuesExports[index];
+  for (int attempt = 0; attempt < IO_VALUES_READ_RETRIES; attempt++) {
+    uint32_t before = e->seq;
+    if (before & 1) continue;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    uint32_t exported = e->generation;
+    memcpy(out, (const void*)&e->values, sizeof(IOValues));
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (e->seq == before) return exported == generation;
+  }
+  return false;
+}
+
+// ISR de comptage : un simple incrément, l'agrégation est faite dans handleIOs
+void IRAM_ATTR onPulseISR(void *arg) {
+    (*(volatile uint32_t *)arg)++;
+}
+
+// État de départ d'une sortie : dernier état journalisé (RESTORE_LAST) ou defaultState
+static bool outputStartState(const IOPin& io) {
+    bool state = io.defaultState;
+    if (io.restorePolicy == RESTORE_LAST) outputJournalLastState(io.pin, &state);
+    return state;
+}
+
+// Configuration matérielle d'une broche ; une sortie part de outputStartState
+static void configurePin(const IOPin& io) {
+    if (io.mode == 1 || io.mode == 3) { // INPUT / COUNTER
+        // Apply the selected input type
+        switch (io.inputType) {
+            case 0:
+                pinMode(io.pin, INPUT);
+                Serial.printf("Pin %d (%s) configured as INPUT\n", io.pin, io.name);
+                break;
+            case 1:
+                pinMode(io.pin, INPUT_PULLUP);
+                Serial.printf("Pin %d (%s) configured as INPUT_PULLUP\n", io.pin, io.name);
+                break;
+            case 2:
+                pinMode(io.pin, INPUT_PULLDOWN);
+                Serial.printf("Pin %d (%s) configured as INPUT_PULLDOWN\n", io.pin, io.name);
+                break;
+            default:
+                pinMode(io.pin, INPUT_PULLUP); // Default fallback
+                Serial.printf("Pin %d (%s) configured as INPUT_PULLUP (default)\n", io.pin, io.name);
+                break;
+        }
+    } else if (io.mode == 4) { // ANALOG
+        analogSetPinAttenuation(io.pin, ADC_11db);  // Pleine échelle ~0-3.3V
+        Serial.printf("Pin %d (%s) configured as ANALOG (x%d oversampling, filter %d)\n",
+                      io.pin, io.name, 1 << io.oversampleShift, io.filterType);
+        // L'ADC2 est utilisé par le WiFi : seules les broches ADC1 (32-39) sont fiables
+        if (io.pin < 32 || io.pin > 39) {
+            Serial.printf("⚠️ Pin %d is not an ADC1 pin, readings will fail while WiFi is active\n", io.pin);
+        }
+    } else if (io.mode == 2) { // OUTPUT
+        bool state = outputStartState(io);
+        pinMode(io.pin, OUTPUT);
+        digitalWrite(io.pin, state);
+        pinStates[io.pin] = state;
+        Serial.printf("Pin %d (%s) configured as OUTPUT (%s)\n", io.pin, io.name, state ? "HIGH" : "LOW");
+    }
+}
+
+// Broches du profil de carte : GPIO, mode et type d'entrée sont des constantes,
+// chaque visit() se réduit à ses appels pinMode / digitalWrite
+struct FixedPinConfigurator {
+    const IOTable* io;
+
+    template <int I, uint8_t GPIO, uint8_t INPUT_TYPE>
+    void visit(FixedPinMode<1>) { configureInput<GPIO, INPUT_TYPE>(io->pins[I].name); }  // INPUT
+    template <int I, uint8_t GPIO, uint8_t INPUT_TYPE>
+    void visit(FixedPinMode<3>) { configureInput<GPIO, INPUT_TYPE>(io->pins[I].name); }  // COUNTER (ISR : attachCounters)
+    template <int I, uint8_t GPIO, uint8_t INPUT_TYPE>
+    void visit(FixedPinMode<2>) { // OUTPUT
+        bool state = outputStartState(io->pins[I]);
+        pinMode(GPIO, OUTPUT);
+        digitalWrite(GPIO, state);
+        pinStates[GPIO] = state;
+        Serial.printf("Pin %d (%s) configured as OUTPUT (board profile)\n", GPIO, io->pins[I].name);
+    }
+    template <int I, uint8_t GPIO, uint8_t INPUT_TYPE>
+    void visit(FixedPinMode<4>) { // ANALOG
+        // L'ADC2 est utilisé par le WiFi : vérifié ici à la compilation
+        static_assert(GPIO >= 32 && GPIO <= 39, "board profile: ANALOG pins must be ADC1 (GPIO 32-39)");
+        analogSetPinAttenuation(GPIO, ADC_11db);
+        Serial.printf("Pin %d (%s) configured as ANALOG (board profile)\n", GPIO, io->pins[I].name);
+    }
+
+    template <uint8_t GPIO, uint8_t INPUT_TYPE>
+    static void configureInput(const char* name) {
+        static_assert(INPUT_TYPE <= 2, "board profile: inputType must be 0, 1 or 2");
+        pinMode(GPIO, INPUT_TYPE == 0 ? INPUT : INPUT_TYPE == 2 ? INPUT_PULLDOWN : INPUT_PULLUP);
+        Serial.printf("Pin %d (%s) configured as input type %d (board profile)\n", GPIO, name, INPUT_TYPE);
+    }
+};
+
+// ISR des compteurs : pulseCounts est indexé par position dans la table, les
+// ISR sont donc rattachées à chaque reconfiguration (sans effet sur les sorties)
+static void attachCounters(const IOTable* io) {
+    for (int i = 0; i < attachedCounterCount; i++) {
+        detachInterrupt(digitalPinToInterrupt(attachedCounterPins[i]));
+    }
+    attachedCounterCount = 0;
+
+    for (int i = 0; i < io->count; i++) {
+        if (io->pins[i].mode != 3) continue; // COUNTER
+        // Front descendant : sortie S0 / collecteur ouvert tirée vers le bas
+        attachInterruptArg(digitalPinToInterrupt(io->pins[i].pin), onPulseISR, (void *)&pulseCounts[i], FALLING);
+        attachedCounterPins[attachedCounterCount++] = io->pins[i].pin;
+        Serial.printf("Pin %d (%s) configured as COUNTER (interval %u ms)\n", io->pins[i].pin, io->pins[i].name,
+                      io->pins[i].publishIntervalMs ? io->pins[i].publishIntervalMs : DEFAULT_COUNTER_INTERVAL_MS);
+    }
+}
+
+void applyIOPinModes() {
+
+    pinMode(STATUS_LED, OUTPUT); // LED d'état (GPIO 23 par défaut)
+    IOTableReader io;
+
+    if (io->count >= BOARD_FIXED_PIN_COUNT) {
+        FixedPinConfigurator fixed = { io.get() };
+        BoardFixedPins::forEach(fixed);
+    }
+    for (int i = BOARD_FIXED_PIN_COUNT; i < io->count; i++) {
+        configurePin(io->pins[i]);
+    }
+    attachCounters(io.get());
+    Serial.println("I/O pin modes applied.");
+}
+
+// Même câblage électrique : le reste (nom, filtres, délais...) est lu à chaque usage
+static bool samePinSetup(const IOPin& a, const IOPin& b) {
+    return a.pin == b.pin && a.mode == b.mode && (a.mode == 2 || a.mode == 4 || a.inputType == b.inputType);
+}
+
+IOApplyResult applyIOPinChanges(const IOTable* previous) {
+    IOApplyResult result = {0, 0, 0};
+    uint32_t startUs = micros();
+    IOTableReader io;
+
+    // Broches du profil : câblage figé, déjà configurées au démarrage
+    result.unchanged = io->count >= BOARD_FIXED_PIN_COUNT ? BOARD_FIXED_PIN_COUNT : 0;
+    for (int i = result.unchanged; i < io->count; i++) {
+        int j = ioTableFindByPin(previous, io->pins[i].pin);
+        if (j >= 0 && samePinSetup(previous->pins[j], io->pins[i])) {
+            result.unchanged++;  // Sortie laissée dans son état courant, sans glitch
+        } else {
+            configurePin(io->pins[i]);
+            result.reapplied++;
+        }
+    }
+    attachCounters(io.get());
+    result.durationUs = micros() - startUs;
+    Serial.printf("I/O pin changes applied: %u reapplied, %u unchanged (%lu us)\n", result.reapplied,
+                  result.unchanged, (unsigned long)result.durationUs);
+    return result;
+}
+
+
+// ===== I/O HANDLING (FreeRTOS Task) =====
+// Publie l'état d'une entrée numérique après passage par le limiteur de débit
+void publishInputState(const IOPin& io, bool state, uint32_t transitions) {
+  Serial.printf("Input '%s' (pin %d) changed to %s\n", io.name, io.pin, state ? "HIGH" : "LOW");
+
+  if (!mqttEnabled || !mqttConnected()) return;
+
+  char topic[128];
+  snprintf(topic, sizeof(topic), "%s/status/%s", config.deviceName, io.name);
+
+  if (io.publishTransitions) {
+    uint64_t timeUs = getCurrentTimeMicros();
+    PooledJsonDocument doc;
+    doc["state"] = state ? 1 : 0;
+    doc["transitions"] = transitions;
+    doc["timestamp"] = (uint32_t)(timeUs / 1000000ULL);
+    doc["us"] = (uint32_t)(timeUs % 1000000ULL);
+
+    char payload[128];
+    serializeJson(doc, payload);
+    publishMQTT(topic, payload);
+  } else {
+    char payload[2];
+    snprintf(payload, sizeof(payload), "%d", state ? 1 : 0);
+    publishMQTT(topic, payload);
+  }
+}
+
+// ===== ÉTAT D'EXÉCUTION À LA RECONFIGURATION =====
+// Agrégateurs, filtres, limiteurs et statistiques sont indexés par position
+// dans la table. Seule la tâche I/O les modifie.
+
+// Remet à zéro l'état d'exécution de l'I/O à la position i
+static void resetIORuntimeSlot(const IOPin& pin, int i, uint32_t nowMs) {
+  publishLimiterReset(&publishLimiters[i]);
+  analogChannelReset(&analogChannels[i]);
+  // Repartir de la valeur brute courante : pas de delta parasite
+  pulseCounterReset(&pulseCounters[i], pulseCounts[i], nowMs);
+  if (pin.mode == 1) { // INPUT
+    // État initial lu sans publication : pas de faux changement à la reconfiguration
+    pinStates[pin.pin] = digitalRead(pin.pin);
+  }
+  edgeStatsReset(&edgeStats[i], pinStates[pin.pin], micros());
+  statsPublishedMs[i] = nowMs;
+}
+
+struct IORuntimeSlot {
+  PublishLimiter limiter;
+  AnalogChannel analog;
+  PulseCounter counter;
+  EdgeStats stats;
+  uint32_t statsPublishedMs;
+};
+
+static void saveIORuntimeSlot(IORuntimeSlot* slot, int i) {
+  slot->limiter = publishLimiters[i];
+  slot->analog = analogChannels[i];
+  slot->counter = pulseCounters[i];
+  memcpy(&slot->stats, &edgeStats[i], sizeof(EdgeStats));  // Seul écrivain : lecture directe
+  slot->statsPublishedMs = statsPublishedMs[i];
+}
+
+static void loadIORuntimeSlot(int i, const IORuntimeSlot* slot) {
+  publishLimiters[i] = slot->limiter;
+  analogChannels[i] = slot->analog;
+  pulseCounters[i] = slot->counter;
+  pulseCounters[i].lastRaw = pulseCounts[i];  // ISR rattachée à la nouvelle position : total conservé
+  edgeStatsAssign(&edgeStats[i], &slot->stats);
+  statsPublishedMs[i] = slot->statsPublishedMs;
+}
+
+// Définition des I/O à la reconfiguration précédente (vide au démarrage)
+static IOPin previousPins[MAX_IOS];
+static int previousCount = 0;
+static IORuntimeSlot movingSlot;
+static IORuntimeSlot parkedSlot;
+
+// Nouvelle configuration : seules les I/O dont le câblage a changé (même test
+// samePinSetup que applyIOPinChanges) repartent de zéro. Les autres gardent
+// totaux, filtres, limiteurs et statistiques, déplacés si leur position change.
+static void applyIORuntimeChanges(const IOTable* table, uint32_t nowMs) {
+  const int8_t PARKED = -2;
+  int8_t source[MAX_IOS];    // Position précédente de chaque I/O (-1 : nouvelle ou modifiée)
+  uint32_t pending = 0;      // Déplacements restants
+  uint32_t filterChanged = 0;
+  for (int i = 0; i < table->count; i++) {
+    const IOPin& pin = table->pins[i];
+    source[i] = -1;
+    for (int j = 0; j < previousCount; j++) {
+      if (samePinSetup(previousPins[j], pin)) source[i] = j;
+    }
+    if (source[i] >= 0 && source[i] != i) pending |= 1UL << i;
+    if (source[i] >= 0 && pin.mode == 4 && previousPins[source[i]].filterType != pin.filterType) {
+      filterChanged |= 1UL << i;  // Autre filtre : son état précédent est sans objet
+    }
+  }
+
+  // Un emplacement n'est écrasé qu'une fois lu par l'I/O qui en part ;
+  // un cycle (I/O permutées) est rompu en garant un emplacement
+  while (pending != 0) {
+    bool moved = false;
+    for (int i = 0; i < table->count; i++) {
+      if (!(pending & (1UL << i))) continue;
+      bool stillRead = false;
+      for (int k = 0; k < table->count; k++) {
+        if ((pending & (1UL << k)) && k != i && source[k] == i) stillRead = true;
+      }
+      if (stillRead) continue;
+      if (source[i] == PARKED) {
+        loadIORuntimeSlot(i, &parkedSlot);
+      } else {
+        saveIORuntimeSlot(&movingSlot, source[i]);
+        loadIORuntimeSlot(i, &movingSlot);
+      }
+      pending &= ~(1UL << i);
+      moved = true;
+    }
+    if (!moved) {
+      int first = __builtin_ctz(pending);
+      saveIORuntimeSlot(&parkedSlot, first);
+      for (int k = 0; k < table->count; k++) {
+        if ((pending & (1UL << k)) && source[k] == first) source[k] = PARKED;
+      }
+    }
+  }
+
+  appliedGeneration = table->generation;
+  for (int i = 0; i < table->count; i++) {
+    if (source[i] == -1) resetIORuntimeSlot(table->pins[i], i, nowMs);
+    else if (filterChanged & (1UL << i)) analogChannelReset(&analogChannels[i]);
+    exportIOValues(i);
+  }
+
+  previousCount = table->count;
+  memcpy(previousPins, table->pins, sizeof(IOPin) * table->count);
+}
+
+// ===== STATISTIQUES DE FRONTS =====
+bool inputStatsRead(int index, EdgeStats* out) {
+  if (index < 0 || index >= MAX_IOS) return false;
+  return edgeStatsRead(&edgeStats[index], out);
+}
+
+void inputStatsRequestReset(int index) {
+  if (index >= 0 && index < MAX_IOS) statsResetRequests.fetch_or(1UL << index);
+}
+
+void inputStatsToJson(const IOPin& io, const EdgeStats& stats, JsonObject out) {
+  // Horodatages micros() -> temps absolu : même écart que maintenant
+  uint32_t nowUs = micros();
+  uint64_t timeUs = getCurrentTimeMicros();
+
+  out["name"] = io.name;
+  out["pin"] = io.pin;
+  out["level"] = stats.level ? 1 : 0;
+  out["edges"] = stats.edges;
+  const PulseWidthStats* widths[2] = { &stats.high, &stats.low };
+  const char* keys[2] = { "high", "low" };
+  for (int k = 0; k < 2; k++) {
+    JsonObject w = out[keys[k]].to<JsonObject>();
+    w["count"] = widths[k]->count;
+    w["min_us"] = widths[k]->minUs;
+    w["max_us"] = widths[k]->maxUs;
+    w["avg_us"] = pulseWidthAvgUs(widths[k]);
+  }
+  out["duty"] = edgeStatsDutyPermille(&stats) / 1000.0;
+  out["level_us"] = nowUs - stats.lastEdgeUs;  // Durée du niveau en cours
+
+  // Derniers fronts : [secondes, µs, niveau après le front]
+  uint32_t times[EDGE_STATS_HISTORY];
+  bool levels[EDGE_STATS_HISTORY];
+  int count = edgeStatsHistory(&stats, times, levels);
+  JsonArray history = out["history"].to<JsonArray>();
+  for (int k = 0; k < count; k++) {
+    uint64_t edgeUs = timeUs - (nowUs - times[k]);
+    JsonArray edge = history.add<JsonArray>();
+    edge.add((uint32_t)(edgeUs / 1000000ULL));
+    edge.add((uint32_t)(edgeUs % 1000000ULL));
+    edge.add(levels[k] ? 1 : 0);
+  }
+  out["timestamp"] = (uint32_t)(timeUs / 1000000ULL);
+  out["us"] = (uint32_t)(timeUs % 1000000ULL);
+}
+
+// Résumé périodique : une trame par intervalle au lieu d'une par front
+static void publishInputStats(const IOPin& io, int i) {
+  if (!mqttEnabled || !mqttConnected()) return;
+
+  char topic[128];
+  snprintf(topic, sizeof(topic), "%s/stats/%s", config.deviceName, io.name);
+
+  PooledJsonDocument doc;
+  inputStatsToJson(io, edgeStats[i], doc.to<JsonObject>());  // Tâche I/O : seule à écrire, lecture directe
+  char payload[640];
+  if (serializeJson(doc, payload, sizeof(payload)) >= sizeof(payload)) {
+    Serial.printf("⚠️ Stats '%s': payload too large, not published\n", io.name);
+    return;
+  }
+  publishMQTT(topic, payload);
+}
+
+// ===== SCRUTATION, PAR MODE =====
+// Partagée par la boucle des broches configurables et par FixedPinScanner, qui
+// l'appelle avec un GPIO constant (inliné : digitalRead / analogRead directs)
+static IOScanStats scanStats;
+
+void ioScanGetStats(IOScanStats* stats) {
+  *stats = scanStats;
+}
+
+static inline __attribute__((always_inline)) void scanInput(const IOPin& pin, int i, uint8_t gpio, uint32_t nowMs) {
+  bool currentState = digitalRead(gpio);
+  uint32_t transitions = 0;
+
+  // Détection immédiate du changement d'état (sans debounce)
+  if (currentState != pinStates[gpio]) {
+    pinStates[gpio] = currentState;
+    edgeStatsOnEdge(&edgeStats[i], currentState, micros());
+
+    // Le premier front après une période calme part sans délai
+    if (!pin.statsOnly &&
+        publishLimiterOnChange(&publishLimiters[i], currentState, nowMs, pin.minPublishIntervalMs, &transitions)) {
+      publishInputState(pin, currentState, transitions);
+    }
+  }
+
+  // Fronts fusionnés pendant la fenêtre : publier la dernière valeur à son expiration
+  bool coalescedState;
+  if (!pin.statsOnly && publishLimiterPoll(&publishLimiters[i], nowMs, pin.minPublishIntervalMs,
+                                           !pin.publishTransitions, &coalescedState, &transitions)) {
+    publishInputState(pin, coalescedState, transitions);
+  }
+
+  if (pin.statsIntervalMs && nowMs - statsPublishedMs[i] >= pin.statsIntervalMs) {
+    statsPublishedMs[i] = nowMs;
+    publishInputStats(pin, i);
+  }
+}
+
+static void scanCounter(const IOPin& pin, int i) {
+  uint32_t interval = pin.publishIntervalMs ? pin.publishIntervalMs : DEFAULT_COUNTER_INTERVAL_MS;
+
+  // Publication agrégée : une seule trame par intervalle, quel que soit le nombre de fronts
+  if (pulseCounterSample(&pulseCounters[i], pulseCounts[i], millis(), interval)) {
+    exportIOValues(i);
+    if (mqttEnabled && mqttConnected()) {
+      char topic[128];
+      snprintf(topic, sizeof(topic), "%s/status/%s", config.deviceName, pin.name);
+
+      uint64_t timeUs = getCurrentTimeMicros();
+      PooledJsonDocument doc;
+      doc["count"] = pulseCounters[i].total;
+      doc["delta"] = pulseCounters[i].delta;
+      doc["rate"] = pulseCounters[i].rateMilliHz / 1000.0;  // Hz
+      doc["interval_ms"] = interval;
+      doc["timestamp"] = (uint32_t)(timeUs / 1000000ULL);
+      doc["us"] = (uint32_t)(timeUs % 1000000ULL);
+
+      char payload[192];
+      serializeJson(doc, payload);
+      publishMQTT(topic, payload);
+    }
+  }
+}
+
+static inline __attribute__((always_inline)) void scanAnalog(const IOPin& pin, int i, uint8_t gpio, uint32_t nowMs) {
+  // Suréchantillonnage : moyenne de 2^n lectures
+  uint8_t shift = pin.oversampleShift;
+  int32_t sum = 0;
+  for (int s = 0; s < (1 << shift); s++) {
+    sum += analogRead(gpio);
+  }
+  int32_t raw = sum >> shift;
+
+  int32_t filtered = analogFilterSample(&analogChannels[i], raw, pin.filterType, pin.filterShift);
+  int32_t value = analogCalibrate(filtered, pin.calGain, pin.calOffset);
+  exportIOValues(i);
+
+  // Publication uniquement hors zone morte ou au heartbeat
+  if (analogShouldPublish(&analogChannels[i], value, pin.deadband, nowMs, pin.publishIntervalMs)) {
+    if (mqttEnabled && mqttConnected()) {
+      char topic[128];
+      snprintf(topic, sizeof(topic), "%s/status/%s", config.deviceName, pin.name);
+
+      uint64_t timeUs = getCurrentTimeMicros();
+      PooledJsonDocument doc;
+      doc["value"] = value;
+      doc["raw"] = raw;
+      doc["timestamp"] = (uint32_t)(timeUs / 1000000ULL);
+      doc["us"] = (uint32_t)(timeUs % 1000000ULL);
+
+      char payload[128];
+      serializeJson(doc, payload);
+      publishMQTT(topic, payload);
+    }
+  }
+}
+
+// Une passe sur les broches du profil de carte : un visit() par broche, choisi à la compilation
+struct FixedPinScanner {
+  const IOTable* io;
+  uint32_t nowMs;
+  bool analogTick;
+
+  template <int I, uint8_t GPIO, uint8_t INPUT_TYPE>
+  void visit(FixedPinMode<1>) { scanInput(io->pins[I], I, GPIO, nowMs); }  // INPUT
+  template <int I, uint8_t GPIO, uint8_t INPUT_TYPE>
+  void visit(FixedPinMode<2>) {}                                             // OUTPUT : rien à scruter
+  template <int I, uint8_t GPIO, uint8_t INPUT_TYPE>
+  void visit(FixedPinMode<3>) { scanCounter(io->pins[I], I); }              // COUNTER
+  template <int I, uint8_t GPIO, uint8_t INPUT_TYPE>
+  void visit(FixedPinMode<4>) { if (analogTick) scanAnalog(io->pins[I], I, GPIO, nowMs); }  // ANALOG
+};
+
+void handleIOs(void *pvParameters) {
+  Serial.println("✅ I/O handling task started.");
+  uint32_t lastAnalogSampleMs = 0;
+  uint32_t lastGeneration = 0;
+
+  for (;;) { // Infinite loop for the task
+    uint32_t passStartUs = micros();
+    // Les entrées analogiques sont échantillonnées à une cadence plus lente que la scrutation
+    uint32_t nowMs = millis();
+    bool analogTick = (nowMs - lastAnalogSampleMs) >= ANALOG_SAMPLE_PERIOD_MS;
+    if (analogTick) lastAnalogSampleMs = nowMs;
+
+    // Instantané de la configuration pour toute la passe : une reconfiguration
+    // concurrente ne peut ni bloquer ni corrompre la scrutation
+    IOTableReader io;
+
+    // Nouvelle configuration : réinitialiser l'état d'exécution des I/O modifiées
+    if (io->generation != lastGeneration) {
+      lastGeneration = io->generation;
+      applyIORuntimeChanges(io.get(), nowMs);
+    }
+
+    // Remises à zéro des statistiques demandées (/api/io/<nom>/stats)
+    uint32_t statsResets = statsResetRequests.exchange(0);
+    for (int i = 0; statsResets != 0 && i < io->count; i++) {
+      if (statsResets & (1UL << i)) edgeStatsReset(&edgeStats[i], pinStates[io->pins[i].pin], micros());
+    }
+
+    // Broches du profil de carte : passe déroulée, GPIO et mode constants
+    if (io->count >= BOARD_FIXED_PIN_COUNT) {
+      FixedPinScanner fixed = { io.get(), nowMs, analogTick };
+      BoardFixedPins::forEach(fixed);
+    }
+
+    // Broches configurables à l'exécution
+    for (int i = BOARD_FIXED_PIN_COUNT; i < io->count; i++) {
+      const IOPin& pin = io->pins[i];
+      if (pin.mode == 1) { // INPUT
+        scanInput(pin, i, pin.pin, nowMs);
+      } else if (pin.mode == 3) { // COUNTER
+        scanCounter(pin, i);
+      } else if (pin.mode == 4 && analogTick) { // ANALOG
+        scanAnalog(pin, i, pin.pin, nowMs);
+      }
+    }
+
+    uint32_t passUs = micros() - passStartUs;
+    scanStats.passes++;
+    scanStats.lastUs = passUs;
+    scanStats.avgUs = scanStats.passes == 1 ? passUs : scanStats.avgUs + ((int32_t)(passUs - scanStats.avgUs) >> 4);
+    if (passUs > scanStats.maxUs) scanStats.maxUs = passUs;
+    vTaskDelay(pdMS_TO_TICKS(1)); // Check inputs every 1ms (réactivité maximale)
+  }
+}
+
@@ -0,0 +1,72 @@
+#ifndef IO_TASK_H
+#define IO_TASK_H
+
+#include "config.h"
+#include "io_table.h"
+#include "pulse_counter.h"
+#include "analog_input.h"
+#include "publish_limiter.h"
+#include "edge_stats.h"
+#include <ArduinoJson.h>
+
+// LED d'état (GPIO 23, sauf profil de carte contraire)
+#ifdef BOARD_STATUS_LED
+#define STATUS_LED BOARD_STATUS_LED
+#else
+#define STATUS_LED 23
+#endif
+
+// État d'exécution des I/O, propriété de la tâche I/O. Les autres tâches
+// passent par ioValuesRead() et inputStatsRead()
+extern volatile uint32_t pulseCounts[MAX_IOS];
+extern PulseCounter pulseCounters[MAX_IOS];
+extern AnalogChannel analogChannels[MAX_IOS];
+extern PublishLimiter publishLimiters[MAX_IOS];
+extern EdgeStats edgeStats[MAX_IOS];
+
+struct IOApplyResult {
+  uint8_t reapplied;        // Broches reconfigurées (nouvelles ou câblage modifié)
+  uint8_t unchanged;        // Broches laissées en l'état
+  uint32_t durationUs;
+};
+
+// Durée des passes de scrutation de la tâche I/O (micros(), hors vTaskDelay)
+struct IOScanStats {
+  uint32_t passes;
+  uint32_t lastUs;
+  uint32_t avgUs;           // Moyenne glissante (1/16)
+  uint32_t maxUs;
+};
+
+// Applique la configuration matérielle (pinMode, ISR, ADC) de l'instantané courant
+void applyIOPinModes();
+// Après /api/ios : ne reconfigure que les broches absentes de previous ou dont
+// le mode / type d'entrée a changé ; les sorties inchangées gardent leur état
+IOApplyResult applyIOPinChanges(const IOTable* previous);
+// Tâche FreeRTOS de scrutation des entrées (INPUT, COUNTER, ANALOG)
+void handleIOs(void *pvParameters);
+// Publie l'état d'une entrée numérique (brut "0"/"1" ou JSON avec transitions)
+void publishInputState(const IOPin& io, bool state, uint32_t transitions);
+void ioScanGetStats(IOScanStats* stats);
+
+// Dernières valeurs d'une I/O COUNTER ou ANALOG, copiées par la tâche I/O
+struct IOValues {
+  uint64_t count;           // COUNTER : total d'impulsions
+  uint32_t rateMilliHz;
+  int32_t value;            // ANALOG : valeur filtrée et calibrée
+  int32_t raw;
+};
+#define IO_VALUES_READ_RETRIES 16
+
+// Toute tâche : copie cohérente des valeurs de l'I/O index. false si la tâche
+// I/O n'a pas encore appliqué la table generation (index d'une autre version)
+bool ioValuesRead(int index, uint32_t generation, IOValues* out);
+
+// Statistiques de fronts d'une entrée INPUT (index dans la table), toute tâche
+bool inputStatsRead(int index, EdgeStats* out);
+// Remise à zéro faite par la tâche I/O à sa prochaine passe
+void inputStatsRequestReset(int index);
+// Résumé JSON commun à /api/io/<nom>/stats et à <device>/stats/<nom>
+void inputStatsToJson(const IOPin& io, const EdgeStats& stats, JsonObject out);
+
+#endif // IO_TASK_H
@@ -0,0 +1,193 @@
+#include "json_arena.h"
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_NONE 0xFFFFFFFFu
+#define ARENA_TOTAL (JSON_ARENA_COUNT + JSON_LARGE_ARENA_COUNT)
+
+// En-tête de bloc : taille utile et en-tête du bloc précédent (libération en pile)
+struct ArenaBlock {
+  uint32_t size;
+  uint32_t prev;
+};
+
+static_assert(sizeof(ArenaBlock) == JSON_ARENA_ALIGN, "en-tête de bloc = alignement");
+
+alignas(JSON_ARENA_ALIGN) static uint8_t smallBuffers[JSON_ARENA_COUNT][JSON_ARENA_SIZE];
+alignas(JSON_ARENA_ALIGN) static uint8_t largeBuffers[JSON_LARGE_ARENA_COUNT][JSON_LARGE_ARENA_SIZE];
+static JsonArena arenas[ARENA_TOTAL];        // Petites d'abord, puis grandes
+static std::atomic<bool> leased[ARENA_TOTAL];
+
+static std::atomic<uint32_t> statLeases(0);
+static std::atomic<uint32_t> statBusy(0);
+static std::atomic<uint32_t> statOverflows(0);
+static std::atomic<uint16_t> statInUse(0);
+static std::atomic<uint16_t> statInUseHighWater(0);
+
+static inline uint32_t alignUp(size_t size) {
+  return (uint32_t)((size + JSON_ARENA_ALIGN - 1) & ~(size_t)(JSON_ARENA_ALIGN - 1));
+}
+
+static inline ArenaBlock* blockAt(JsonArena* arena, uint32_t offset) {
+  return (ArenaBlock*)(arena->buf + offset);
+}
+
+static inline uint32_t blockOffset(const JsonArena* arena, const void* ptr) {
+  return (uint32_t)((const uint8_t*)ptr - arena->buf) - sizeof(ArenaBlock);
+}
+
+void jsonArenaInit(JsonArena* arena, uint8_t* buf, uint32_t capacity) {
+  arena->buf = buf;
+  arena->capacity = capacity;
+  arena->top = 0;
+  arena->last = ARENA_NONE;
+  arena->live = 0;
+  arena->highWater = 0;
+}
+
+bool jsonArenaOwns(const JsonArena* arena, const void* ptr) {
+  return arena != nullptr && ptr != nullptr && (const uint8_t*)ptr >= arena->buf &&
+         (const uint8_t*)ptr < arena->buf + arena->capacity;
+}
+
+void* jsonArenaAllocate(JsonArena* arena, size_t size) {
+  uint32_t need = sizeof(ArenaBlock) + alignUp(size);
+  if (size > arena->capacity || need > arena->capacity - arena->top) return nullptr;
+
+  ArenaBlock* block = blockAt(arena, arena->top);
+  block->size = (uint32_t)size;
+  block->prev = arena->last;
+  arena->last = arena->top;
+  arena->top += need;
+  arena->live++;
+  if (arena->top > arena->highWater) arena->highWater = arena->top;
+  return block + 1;
+}
+
+void jsonArenaDeallocate(JsonArena* arena, void* ptr) {
+  if (ptr == nullptr || arena->live == 0) return;
+  uint32_t offset = blockOffset(arena, ptr);
+  // Dernier bloc : rendu tout de suite (les autres attendent la fin du document)
+  if (offset == arena->last) {
+    arena->top = offset;
+    arena->last = blockAt(arena, offset)->prev;
+  }
+  if (--arena->live == 0) {
+    arena->top = 0;
+    arena->last = ARENA_NONE;
+  }
+}
+
+void* jsonArenaReallocate(JsonArena* arena, void* ptr, size_t size) {
+  if (ptr == nullptr) return jsonArenaAllocate(arena, size);
+  uint32_t offset = blockOffset(arena, ptr);
+  ArenaBlock* block = blockAt(arena, offset);
+
+  // Dernier bloc : réduit ou agrandi sur place
+  if (offset == arena->last) {
+    uint32_t end = offset + sizeof(ArenaBlock) + alignUp(size);
+    if (size > arena->capacity || end > arena->capacity) return nullptr;
+    block->size = (uint32_t)size;
+    arena->top = end;
+    if (end > arena->highWater) arena->highWater = end;
+    return ptr;
+  }
+  if (size <= block->size) {
+    block->size = (uint32_t)size;  // Place rendue à la fin du document
+    return ptr;
+  }
+
+  void* moved = jsonArenaAllocate(arena, size);
+  if (moved == nullptr) return nullptr;
+  memcpy(moved, ptr, block->size);
+  jsonArenaDeallocate(arena, ptr);
+  return moved;
+}
+
+// ===== Jeu d'arènes =====
+
+static bool tryLease(int index) {
+  bool expected = false;
+  if (!leased[index].compare_exchange_strong(expected, true)) return false;
+  // Arène à nous seuls : initialisation paresseuse sans course
+  if (arenas[index].buf == nullptr) {
+    if (index < JSON_ARENA_COUNT) {
+      jsonArenaInit(&arenas[index], smallBuffers[index], JSON_ARENA_SIZE);
+    } else {
+      jsonArenaInit(&arenas[index], largeBuffers[index - JSON_ARENA_COUNT], JSON_LARGE_ARENA_SIZE);
+    }
+  }
+  statLeases++;
+  uint16_t inUse = ++statInUse;
+  uint16_t high = statInUseHighWater.load();
+  while (inUse > high && !statInUseHighWater.compare_exchange_weak(high, inUse)) {
+  }
+  return true;
+}
+
+JsonArena* jsonArenaAcquire(bool large) {
+  int first = large ? JSON_ARENA_COUNT : 0;
+  for (int n = 0; n < ARENA_TOTAL; n++) {
+    int i = (first + n) % ARENA_TOTAL;
+    if (tryLease(i)) return &arenas[i];
+  }
+  statBusy++;
+  return nullptr;
+}
+
+void jsonArenaRelease(JsonArena* arena) {
+  if (arena == nullptr) return;
+  // Document détruit : tout doit être libéré, l'arène repart de zéro dans tous les cas
+  arena->top = 0;
+  arena->last = ARENA_NONE;
+  arena->live = 0;
+  statInUse--;
+  leased[arena - arenas].store(false);
+}
+
+void* jsonPoolAllocate(JsonArena* arena, size_t size) {
+  void* ptr = arena != nullptr ? jsonArenaAllocate(arena, size) : nullptr;
+  if (ptr != nullptr) return ptr;
+  statOverflows++;
+  return malloc(size);
+}
+
+void jsonPoolDeallocate(JsonArena* arena, void* ptr) {
+  if (jsonArenaOwns(arena, ptr)) {
+    jsonArenaDeallocate(arena, ptr);
+  } else {
+    free(ptr);
+  }
+}
+
+void* jsonPoolReallocate(JsonArena* arena, void* ptr, size_t size) {
+  if (ptr == nullptr) return jsonPoolAllocate(arena, size);
+  if (!jsonArenaOwns(arena, ptr)) return realloc(ptr, size);
+
+  void* moved = jsonArenaReallocate(arena, ptr, size);
+  if (moved != nullptr) return moved;
+
+  // Plus de place dans l'arène : le bloc part sur le tas
+  statOverflows++;
+  moved = malloc(size);
+  if (moved == nullptr) return nullptr;
+  uint32_t oldSize = blockAt(arena, blockOffset(arena, ptr))->size;
+  memcpy(moved, ptr, oldSize < size ? oldSize : size);
+  jsonArenaDeallocate(arena, ptr);
+  return moved;
+}
+
+void jsonArenaGetStats(JsonArenaStats* stats) {
+  memset(stats, 0, sizeof(JsonArenaStats));
+  stats->leases = statLeases.load();
+  stats->busy = statBusy.load();
+  stats->overflows = statOverflows.load();
+  stats->inUse = statInUse.load();
+  stats->inUseHighWater = statInUseHighWater.load();
+  for (int i = 0; i < ARENA_TOTAL; i++) {
+    uint32_t high = arenas[i].highWater;
+    uint32_t* target = i < JSON_ARENA_COUNT ? &stats->smallHighWater : &stats->largeHighWater;
+    if (high > *target) *target = high;
+  }
+}
@@ -0,0 +1,75 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ===== ARÈNES JSON (documents sans tas) =====
+// Module pur (sans Arduino) : les JsonDocument des chemins de messages (MQTT,
+// acquittements, publications d'IO, API web) prennent leur mémoire dans un
+// jeu d'arènes statiques dimensionnées à la compilation, pas dans le tas.
+//  - Un document loue une arène entière pour sa durée de vie (jsonArenaAcquire),
+//    sans verrou : chaque arène n'a qu'un propriétaire à la fois.
+//  - Allocation en pile : un en-tête de 8 octets par bloc, le dernier bloc
+//    s'agrandit sur place (chaînes en cours de désérialisation), et l'arène
+//    repart de zéro dès que son dernier bloc est libéré.
+//  - Arène pleine ou toutes louées : repli sur le tas, compté dans
+//    overflows / busy. En régime établi ces compteurs doivent rester à zéro ;
+//    sinon augmenter JSON_ARENA_SIZE / JSON_ARENA_COUNT (-D dans build_flags).
+// Voir json_pool.h pour l'allocateur ArduinoJson qui s'appuie dessus.
+
+#ifndef JSON_ARENA_COUNT
+#define JSON_ARENA_COUNT 4            // Petits documents simultanés (NetTask x2 imbriqués, CmdTask, IOTask)
+#endif
+#ifndef JSON_ARENA_SIZE
+#define JSON_ARENA_SIZE 2048
+#endif
+#ifndef JSON_LARGE_ARENA_COUNT
+#define JSON_LARGE_ARENA_COUNT 1      // Réponses de l'API web (liste des IO, statut complet...)
+#endif
+#ifndef JSON_LARGE_ARENA_SIZE
+#define JSON_LARGE_ARENA_SIZE 8192
+#endif
+#define JSON_ARENA_ALIGN 8
+#define JSON_ARENA_POOL_BYTES (JSON_ARENA_COUNT * JSON_ARENA_SIZE + JSON_LARGE_ARENA_COUNT * JSON_LARGE_ARENA_SIZE)
+
+struct JsonArena {
+  uint8_t* buf;
+  uint32_t capacity;
+  uint32_t top;           // Octets occupés
+  uint32_t last;          // En-tête du dernier bloc alloué (UINT32_MAX : aucun)
+  uint16_t live;          // Blocs non libérés
+  uint32_t highWater;     // Plus haut niveau de top
+};
+
+struct JsonArenaStats {
+  uint32_t leases;            // Documents servis par une arène
+  uint32_t busy;              // Documents sans arène libre (tas)
+  uint32_t overflows;         // Allocations reportées sur le tas (arène pleine ou absente)
+  uint16_t inUse;             // Arènes louées en ce moment
+  uint16_t inUseHighWater;
+  uint32_t smallHighWater;    // Octets, toutes petites arènes confondues
+  uint32_t largeHighWater;
+};
+
+// --- Arène seule (aussi utilisable sur un tampon quelconque) ---
+void jsonArenaInit(JsonArena* arena, uint8_t* buf, uint32_t capacity);
+void* jsonArenaAllocate(JsonArena* arena, size_t size);                 // nullptr si pleine
+void jsonArenaDeallocate(JsonArena* arena, void* ptr);
+void* jsonArenaReallocate(JsonArena* arena, void* ptr, size_t size);    // nullptr si pleine (ptr intact)
+bool jsonArenaOwns(const JsonArena* arena, const void* ptr);
+
+// --- Jeu d'arènes statiques ---
+// large : préférence pour une grande arène (repli sur l'autre taille, puis nullptr)
+JsonArena* jsonArenaAcquire(bool large);
+void jsonArenaRelease(JsonArena* arena);
+
+// Allocation pour un document : dans arena si possible, sinon sur le tas.
+// arena peut être nullptr (aucune arène libre) : tout va alors sur le tas.
+void* jsonPoolAllocate(JsonArena* arena, size_t size);
+void jsonPoolDeallocate(JsonArena* arena, void* ptr);
+void* jsonPoolReallocate(JsonArena* arena, void* ptr, size_t size);
+
+void jsonArenaGetStats(JsonArenaStats* stats);
+
+#endif // JSON_ARENA_H
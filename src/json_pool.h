@@ -0,0 +1,48 @@
+#ifndef JSON_POOL_H
+#define JSON_POOL_H
+
+#include <ArduinoJson.h>
+#include "json_arena.h"
+
+// ===== DOCUMENTS JSON SUR ARÈNE =====
+// Remplace JsonDocument sur les chemins de messages :
+//   PooledJsonDocument doc;          // petite arène (messages MQTT)
+//   PooledJsonDocument doc(true);    // grande arène (réponses de l'API web)
+// L'arène est louée à la construction et rendue à la destruction ; sans arène
+// libre le document fonctionne quand même, sur le tas (voir json_arena.h).
+// La taille des blocs d'ArduinoJson suit ARDUINOJSON_POOL_CAPACITY
+// (platformio.ini) : des blocs de 32 variantes tiennent à plusieurs par arène.
+
+class JsonArenaAllocator : public ArduinoJson::Allocator {
+public:
+  explicit JsonArenaAllocator(JsonArena* arena) : arena_(arena) {}
+
+  void* allocate(size_t size) override { return jsonPoolAllocate(arena_, size); }
+  void deallocate(void* ptr) override { jsonPoolDeallocate(arena_, ptr); }
+  void* reallocate(void* ptr, size_t size) override { return jsonPoolReallocate(arena_, ptr, size); }
+
+  JsonArena* arena() const { return arena_; }
+
+private:
+  JsonArena* arena_;
+};
+
+// Bail de l'arène : classe de base construite avant le document, détruite après
+class JsonArenaLease {
+protected:
+  explicit JsonArenaLease(bool large) : allocator_(jsonArenaAcquire(large)) {}
+  ~JsonArenaLease() { jsonArenaRelease(allocator_.arena()); }
+
+  JsonArenaAllocator allocator_;
+};
+
+class PooledJsonDocument : private JsonArenaLease, public JsonDocument {
+public:
+  explicit PooledJsonDocument(bool large = false) : JsonArenaLease(large), JsonDocument(&allocator_) {}
+
+  // Une seule destruction par bail
+  PooledJsonDocument(const PooledJsonDocument&) = delete;
+  PooledJsonDocument& operator=(const PooledJsonDocument&) = delete;
+};
+
+#endif // JSON_POOL_H
@@ -3,49 +3,52 @@
 #include <WiFiManager.h>
 #include <ESPAsyncWebServer.h>
 #include <ElegantOTA.h>
-#include <PubSubClient.h>
 #include <ArduinoJson.h>
 #include <Preferences.h>
 #include <WiFiUdp.h>
 #include <SPIFFS.h>
 #include <time.h>
+#include <esp_system.h>
 
 #include "config.h"
 #include "mqtt.h"
+#include "command_executor.h"
+#include "io_table.h"
+#include "io_task.h"
+#include "event_log.h"
+#include "event_log_flash.h"
+#include "schedule_table.h"
+#include "config_reload.h"
+#include "output_journal.h"
+#include "wifi_link.h"
 
 // ===== GLOBAL OBJECTS =====
 AsyncWebServer server(80);
-// WiFiClient and mqttClient are now defined in src/mqtt.cpp
+// WiFiClient and the MQTT client are defined by the transport (src/mqtt_transport_*.cpp)
 Preferences preferences;
 WiFiManager wifiManager;
 
 Config config;
-IOPin ioPins[MAX_IOS];
-AccessLog accessLogs[100];   // Max 100 logs
-int ioPinCount = 0;
-
-ScheduledCommand scheduledCommands[MAX_SCHEDULED_COMMANDS];
 
 unsigned long lastMqttReconnect = 0;
 
 // Bouton pour reset WiFi (bouton BOOT sur ESP32)
 #define RESET_WIFI_BUTTON 0
-#define STATUS_LED 23
 
 // ===== PROTOTYPES =====
 void loadConfig();
 void saveConfig();
 void loadIOs();
 void saveIOs();
-void applyIOPinModes();
-void handleIOs(void *pvParameters); // Modified for FreeRTOS
 void setupWebServer();
 void blinkStatusLED(int times, int delayMs);
-void processScheduledCommands();
+void networkTask(void *pvParameters);
 void saveConfigCallback();
 
 // ===== FreeRTOS Task Handles =====
 TaskHandle_t ioTaskHandle = NULL;
+TaskHandle_t netTaskHandle = NULL;
+TaskHandle_t cmdTaskHandle = NULL;
 
 // ===== Global WiFiManager parameters (needed for callback) =====
 WiFiManagerParameter* g_custom_use_static_ip = nullptr;
@@ -132,23 +135,36 @@ void saveConfigCallback() {
 
 void setup() {
   Serial.begin(115200);
+  eventLogWrite(EVENT_BOOT, (uint16_t)esp_reset_reason(), 0, "1.0");
+
+  // ===== RESTAURATION DES SORTIES (avant tout le reste) =====
+  // Après une coupure, les sorties RESTORE_LAST reprennent leur dernier état
+  // journalisé dès le démarrage, sans attendre le WiFi ni les commandes du PC
+  preferences.begin("generic-io", false);
+  loadIOs();
+  outputJournalBegin();
+  applyIOPinModes();
+  Serial.println("I/O pin configurations applied.");
+
   delay(1000);
 
-  // Initialize scheduled commands queue
+  // Initialize scheduled commands table and the executor's command queue
   for (int i = 0; i < MAX_SCHEDULED_COMMANDS; i++) {
     scheduledCommands[i].active = false;
   }
+  commandQueueInit(COMMAND_QUEUE_DEPTH);
+  outboundQueueInit(OUTBOUND_QUEUE_DEPTH);
+  scheduleTableInit();
 
   Serial.println("\n\n=== ESP32 Generic IO Controller ===");
   Serial.println("Version 1.0");
+  // Redémarrage demandé par /api/config : interruption mesurée jusqu'à la reconnexion MQTT
+  if (esp_reset_reason() == ESP_RST_SW) configReloadResume();
   Serial.println("Chip ID: " + String((uint32_t)ESP.getEfuseMac(), HEX));
   Serial.println("SDK Version: " + String(ESP.getSdkVersion()));
 
   blinkStatusLED(3, 200);
 
-  // Load configuration from flash
-  preferences.begin("generic-io", false);
-  
   // Check WiFi connection failure counter
   int wifiFailCount = preferences.getInt("wifiFailCount", 0);
   Serial.printf("WiFi failure count: %d/3\n", wifiFailCount);
@@ -157,6 +173,7 @@ void setup() {
     Serial.println("\n⚠️⚠️⚠️ TOO MANY WiFi FAILURES ⚠️⚠️⚠️");
     Serial.println("Resetting WiFi credentials...");
     wifiManager.resetSettings();
+    wifiLinkForget();
     preferences.putInt("wifiFailCount", 0);
     delay(2000);
     Serial.println("WiFi reset complete. Restarting...");
@@ -164,13 +181,12 @@ void setup() {
   }
   
   loadConfig();
-  loadIOs();
+  if (!scheduleTableSetTimezone(config.timezone, config.gmtOffset_sec + config.daylightOffset_sec)) {
+    Serial.printf("⚠️ Invalid timezone '%s', using fixed offset\n", config.timezone);
+  }
+  loadSchedules();
   Serial.println("Configuration and I/O settings loaded.");
   blinkStatusLED(2, 100);
-  // Apply I/O pin configurations
-  applyIOPinModes();
-  Serial.println("I/O pin configurations applied.");
-  blinkStatusLED(2, 100);
 
   // ===== CONFIGURATION WiFi EN PREMIER =====
   // Configuration WiFiManager (AVANT les paramètres WiFi)
@@ -198,6 +214,7 @@ void setup() {
   if (checkTriplePress()) {
     Serial.println("\n⚠⚠⚠ RESETTING WiFi credentials ⚠⚠⚠");
     wifiManager.resetSettings();
+    wifiLinkForget();
     delay(1000);
     Serial.println("Credentials erased. Restarting...");
     delay(2000);
@@ -235,7 +252,9 @@ void setup() {
   // Faire clignoter la LED pendant la tentative de connexion
   blinkStatusLED(5, 100);
   
-  if (!wifiManager.autoConnect((String(config.deviceName) + "-Setup").c_str())) {
+  // Dernier point d'accès connu (BSSID, canal, adresse) d'abord : pas de scan ni de DHCP.
+  // Le portail WiFiManager ne démarre qu'en cas d'échec.
+  if (!wifiLinkBegin() && !wifiManager.autoConnect((String(config.deviceName) + "-Setup").c_str())) {
     Serial.println("\n✗✗✗ WiFiManager failed to connect ✗✗✗");
     
     // Incrémenter le compteur d'échecs
@@ -261,6 +280,7 @@ void setup() {
 
   // Connexion réussie - réinitialiser le compteur d'échecs
   preferences.putInt("wifiFailCount", 0);
+  wifiLinkConnected();  // Cache à jour ; reconnexions confiées à NetTask
   blinkStatusLED(3, 100);  // Signal de succès
   Serial.println("\n✓✓✓ WiFi CONNECTED ✓✓✓");
   Serial.printf("SSID: %s\n", WiFi.SSID().c_str());
@@ -307,6 +327,7 @@ void setup() {
     return;
   }
   Serial.println("SPIFFS mounted successfully.");
+  eventLogFlashBegin();
 
   // Setup MQTT
   setupMQTT();
@@ -316,16 +337,34 @@ void setup() {
     blinkStatusLED(2, 100);  // Signal MQTT activé
   }
 
-  // === DÉMARRAGE TÂCHE I/O ===
-  // Crée la tâche pour gérer les I/O sur le coeur 0, avec une haute priorité
+  // === DÉMARRAGE DES TÂCHES ===
+  // Cœurs et priorités définis dans config.h (NET_/CMD_/IO_TASK_*)
+  xTaskCreatePinnedToCore(
+      commandTask,        // Exécuteur de commandes (immédiates et programmées)
+      "CmdTask",
+      CMD_TASK_STACK,
+      NULL,
+      CMD_TASK_PRIORITY,
+      &cmdTaskHandle,
+      CMD_TASK_CORE);
+
   xTaskCreatePinnedToCore(
-      handleIOs,        // Fonction de la tâche
-      "IOTask",         // Nom de la tâche
-      4096,             // Taille de la pile
-      NULL,             // Paramètres de la tâche
-      1,                // Priorité
-      &ioTaskHandle,    // Handle de la tâche
-      0);               // Cœur 0
+      handleIOs,          // Scrutation des entrées
+      "IOTask",
+      IO_TASK_STACK,
+      NULL,
+      IO_TASK_PRIORITY,
+      &ioTaskHandle,
+      IO_TASK_CORE);
+
+  xTaskCreatePinnedToCore(
+      networkTask,        // MQTT (reconnexion + boucle client) et OTA
+      "NetTask",
+      NET_TASK_STACK,
+      NULL,
+      NET_TASK_PRIORITY,
+      &netTaskHandle,
+      NET_TASK_CORE);
 
   server.begin();
   Serial.println("Web server started and configured.");
@@ -336,63 +375,63 @@ void setup() {
 
 // ===== LOOP =====
 void loop() {
-  // The main loop is now responsible for high-frequency tasks only.
-  // I/O handling is moved to a separate FreeRTOS task.
-
-  processScheduledCommands();
-
-  if (WiFi.status() == WL_CONNECTED) {
-    if (mqttEnabled) {
-      if (!mqttClient.connected()) {
-        long now = millis();
-        // Attempt to reconnect every 5 seconds if disconnected.
-        if (now - lastMqttReconnect > 5000) {
-          lastMqttReconnect = now;
-          reconnectMQTT();
+  // Tout le travail est réparti dans les tâches NetTask / CmdTask / IOTask :
+  // la tâche Arduino n'a plus de rôle et libère sa pile.
+  vTaskDelete(NULL);
+}
+
+// ===== NETWORK TASK =====
+void networkTask(void *pvParameters) {
+  Serial.println("✅ Network task started.");
+  bool wifiWasConnected = WiFi.status() == WL_CONNECTED;
+
+  for (;;) {
+    bool wifiConnected = WiFi.status() == WL_CONNECTED;
+    if (wifiConnected != wifiWasConnected) {
+      wifiWasConnected = wifiConnected;
+      eventLogWrite(EVENT_WIFI, wifiConnected ? 1 : 0, (uint32_t)(wifiConnected ? WiFi.RSSI() : 0));
+    }
+
+    // Reconnexion WiFi sans blocage (cache puis scan). Lien perdu : session MQTT
+    // refermée sans attendre le keepalive ; lien revenu : MQTT relancé aussitôt
+    uint8_t linkEvent = wifiLinkPoll(millis());
+    if (linkEvent == WIFI_RC_EVENT_LOST) {
+      disconnectMQTT();
+    } else if (linkEvent == WIFI_RC_EVENT_UP) {
+      lastMqttReconnect = 0;
+    }
+
+    if (wifiConnected) {
+      if (mqttEnabled) {
+        if (!mqttConnected()) {
+          long now = millis();
+          // Attempt to reconnect every 5 seconds if disconnected.
+          if (now - lastMqttReconnect > 5000 || lastMqttReconnect == 0) {
+            lastMqttReconnect = now;
+            reconnectMQTT();
+          }
         }
+        // Reception des messages : mqtt_callback dépose les commandes dans la file de l'exécuteur
+        loopMQTT();
       }
-      // This should be called as often as possible.
-      mqttClient.loop();
     }
-  }
 
-  // ElegantOTA loop for web updates.
-  ElegantOTA.loop();
+    // États et acquittements de CmdTask : publiés ici, sous MqttLock
+    mqttFlushOutbound();
 
-  // A small delay can be added here if needed to prevent watchdog timeouts,
-  // but it should be as small as possible (e.g., 1ms) or removed entirely
-  // if other tasks yield frequently enough.
-  delay(1);
-}
+    // ElegantOTA loop for web updates.
+    ElegantOTA.loop();
 
-void processScheduledCommands() {
-  // Obtenir le temps actuel avec précision microseconde
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
-  uint64_t currentTimeUs = (uint64_t)tv.tv_sec * 1000000ULL + (uint64_t)tv.tv_usec;
-  
-  for (int i = 0; i < MAX_SCHEDULED_COMMANDS; i++) {
-    if (scheduledCommands[i].active) {
-      // Calculer le temps d'exécution prévu en microsecondes
-      uint64_t execTimeUs = ((uint64_t)scheduledCommands[i].exec_at_sec * 1000000ULL) + 
-                             (uint64_t)scheduledCommands[i].exec_at_us;
-      
-      // Vérifier si le moment d'exécution est arrivé
-      if (currentTimeUs >= execTimeUs) {
-        // Calculer le délai d'exécution (peut être négatif si en avance)
-        int64_t delay_us = (int64_t)currentTimeUs - (int64_t)execTimeUs;
-        
-        // Exécuter la commande
-        executeCommand(scheduledCommands[i].pin, scheduledCommands[i].state);
-        
-        // Désactiver cette commande
-        scheduledCommands[i].active = false;
-        
-        // Afficher le délai en millisecondes avec 3 décimales
-        double delay_ms = delay_us / 1000.0;
-        Serial.printf("⏰ Scheduled command executed (delay: %.3f ms)\n", delay_ms);
-      }
-    }
+    // Journal d'événements : recopie par pages sur SPIFFS (si EVENT_LOG_PERSIST)
+    eventLogFlashPersist(millis());
+
+    // Programmations : dernière échéance exécutée recopiée en flash (espacé pour la flash)
+    if (scheduleTableNeedsSave(millis())) saveSchedules();
+
+    // États des sorties : changements regroupés, une écriture par fenêtre
+    outputJournalFlush(millis());
+
+    vTaskDelay(pdMS_TO_TICKS(1));
   }
 }
 
@@ -433,10 +472,17 @@ void loadConfig() {
   if (strlen(config.mqttTopic) == 0) {
     snprintf(config.mqttTopic, sizeof(config.mqttTopic), "%s/io", config.deviceName);
   }
+  preferences.getString("groups", config.groups, sizeof(config.groups));
 
   // NTP settings are now for display and offset, not for server connection
   config.gmtOffset_sec = preferences.getLong("gmtOffset", 3600);
   config.daylightOffset_sec = preferences.getInt("daylightOff", 3600);
+  // Fuseau des programmations : heure de Paris par défaut, cohérente avec les décalages ci-dessus
+  if (preferences.isKey("timezone")) {
+    preferences.getString("timezone", config.timezone, sizeof(config.timezone));
+  } else {
+    strlcpy(config.timezone, SCHEDULE_DEFAULT_TZ, sizeof(config.timezone));
+  }
 
   config.initialized = preferences.getBool("init", false);
   Serial.println("Configuration loaded.");
@@ -455,93 +501,62 @@ void saveConfig() {
   preferences.putString("mqttUser", config.mqttUser);
   preferences.putString("mqttPass", config.mqttPassword);
   preferences.putString("mqttTop", config.mqttTopic);
+  preferences.putString("groups", config.groups);
   //preferences.putString("ntpSrv", config.ntpServer); // No longer needed
   preferences.putLong("gmtOffset", config.gmtOffset_sec);
   preferences.putInt("daylightOff", config.daylightOffset_sec);
+  preferences.putString("timezone", config.timezone);
   preferences.putBool("init", true);
   Serial.println("Configuration saved.");
 }
 
 void loadIOs() {
-  ioPinCount = preferences.getInt("ioCount", 0);
-  if (ioPinCount > MAX_IOS) ioPinCount = 0;
-  for (int i = 0; i < ioPinCount; i++) {
-    String key = "io" + String(i);
-    preferences.getBytes(key.c_str(), &ioPins[i], sizeof(IOPin));
-  }
-  Serial.printf("Loaded %d I/O pin configurations.\n", ioPinCount);
+  int count = preferences.getInt("ioCount", 0);
+  if (count > MAX_IOS) count = 0;
+  ioTableUpdate([&](IOTable& table) {
+    table.count = count;
+    for (int i = 0; i < count; i++) {
+      String key = "io" + String(i);
+      // Enregistrement plus ancien (plus court) : les champs ajoutés depuis restent à 0
+      memset(&table.pins[i], 0, sizeof(IOPin));
+      preferences.getBytes(key.c_str(), &table.pins[i], sizeof(IOPin));
+    }
+    ioTableApplyBoardProfile(table);
+  });
+  Serial.printf("Loaded %d I/O pin configurations (board %s, %d fixed).\n", count, BoardProfile::name(),
+                BOARD_FIXED_PIN_COUNT);
 }
 
 void saveIOs() {
-  preferences.putInt("ioCount", ioPinCount);
-  for (int i = 0; i < ioPinCount; i++) {
+  IOTableReader io;
+  preferences.putInt("ioCount", io->count);
+  for (int i = 0; i < io->count; i++) {
     String key = "io" + String(i);
-    preferences.putBytes(key.c_str(), &ioPins[i], sizeof(IOPin));
+    preferences.putBytes(key.c_str(), &io->pins[i], sizeof(IOPin));
   }
-  Serial.printf("Saved %d I/O pin configurations.\n", ioPinCount);
+  Serial.printf("Saved %d I/O pin configurations.\n", io->count);
 }
 
-void applyIOPinModes() {
-
-    pinMode(STATUS_LED, OUTPUT); // Définit GPIO 23 comme une sortie
-    for (int i = 0; i < ioPinCount; i++) {
-        if (ioPins[i].mode == 1) { // INPUT
-            // Apply the selected input type
-            switch (ioPins[i].inputType) {
-                case 0:
-                    pinMode(ioPins[i].pin, INPUT);
-                    Serial.printf("Pin %d (%s) configured as INPUT\n", ioPins[i].pin, ioPins[i].name);
-                    break;
-                case 1:
-                    pinMode(ioPins[i].pin, INPUT_PULLUP);
-                    Serial.printf("Pin %d (%s) configured as INPUT_PULLUP\n", ioPins[i].pin, ioPins[i].name);
-                    break;
-                case 2:
-                    pinMode(ioPins[i].pin, INPUT_PULLDOWN);
-                    Serial.printf("Pin %d (%s) configured as INPUT_PULLDOWN\n", ioPins[i].pin, ioPins[i].name);
-                    break;
-                default:
-                    pinMode(ioPins[i].pin, INPUT_PULLUP); // Default fallback
-                    Serial.printf("Pin %d (%s) configured as INPUT_PULLUP (default)\n", ioPins[i].pin, ioPins[i].name);
-                    break;
-            }
-        } else if (ioPins[i].mode == 2) { // OUTPUT
-            pinMode(ioPins[i].pin, OUTPUT);
-            digitalWrite(ioPins[i].pin, ioPins[i].defaultState);
-            Serial.printf("Pin %d (%s) configured as OUTPUT\n", ioPins[i].pin, ioPins[i].name);
-        }
-    }
-    Serial.println("I/O pin modes applied.");
+void loadSchedules() {
+  Schedule list[MAX_SCHEDULES];
+  int count = preferences.getInt("schedCount", 0);
+  if (count < 0 || count > MAX_SCHEDULES ||
+      preferences.getBytes("sched", list, count * sizeof(Schedule)) != count * sizeof(Schedule)) {
+    count = 0;
+  }
+  scheduleTableSet(list, count);
+  Serial.printf("Loaded %d schedules.\n", count);
 }
 
-
-// ===== I/O HANDLING (FreeRTOS Task) =====
-void handleIOs(void *pvParameters) {
-  Serial.println("✅ I/O handling task started.");
-
-  for (;;) { // Infinite loop for the task
-    for (int i = 0; i < ioPinCount; i++) {
-      if (ioPins[i].mode == 1) { // INPUT
-        bool currentState = digitalRead(ioPins[i].pin);
-
-        // Détection immédiate du changement d'état (sans debounce)
-        if (currentState != ioPins[i].state) {
-          ioPins[i].state = currentState;
-          Serial.printf("Input '%s' (pin %d) changed to %s\n", ioPins[i].name, ioPins[i].pin, currentState ? "HIGH" : "LOW");
-          
-          char topic[128];
-          snprintf(topic, sizeof(topic), "%s/status/%s", config.deviceName, ioPins[i].name);
-          char payload[2];
-          snprintf(payload, sizeof(payload), "%d", currentState ? 1 : 0);
-
-          if (mqttEnabled && mqttClient.connected()) {
-            publishMQTT(topic, payload);
-          }
-        }
-      }
-    }
-    vTaskDelay(pdMS_TO_TICKS(1)); // Check inputs every 1ms (réactivité maximale)
-  }
+void saveSchedules() {
+  // Marqué avant la copie : une échéance exécutée pendant l'écriture sera sauvegardée la fois suivante
+  scheduleTableMarkSaved(millis());
+  ScheduleEntry entries[MAX_SCHEDULES];
+  Schedule list[MAX_SCHEDULES];
+  int count = scheduleTableGet(entries);
+  for (int i = 0; i < count; i++) list[i] = entries[i].schedule;
+  preferences.putInt("schedCount", count);
+  preferences.putBytes("sched", list, count * sizeof(Schedule));
 }
 
 // ===== MQTT FUNCTIONS =====
@@ -0,0 +1,63 @@
+#include <Arduino.h>
+#include "memory_budget.h"
+#include "config.h"
+#include "io_table.h"
+#include "event_log.h"
+#include "schedule_table.h"
+#include "command_queue.h"
+#include "command_ack.h"
+#include "pulse_counter.h"
+#include "analog_input.h"
+#include "publish_limiter.h"
+#include "edge_stats.h"
+#include "mqtt_transport.h"
+
+extern TaskHandle_t ioTaskHandle;
+extern TaskHandle_t netTaskHandle;
+extern TaskHandle_t cmdTaskHandle;
+
+// Bornes des segments statiques posées par l'éditeur de liens
+#ifdef ESP_PLATFORM
+extern int _data_start, _data_end, _bss_start, _bss_end;
+#define STATIC_DATA_BYTES ((uint32_t)((char*)&_data_end - (char*)&_data_start))
+#define STATIC_BSS_BYTES ((uint32_t)((char*)&_bss_end - (char*)&_bss_start))
+#else  // Simulateur (glibc)
+extern "C" char __data_start, _edata, __bss_start, _end;
+#define STATIC_DATA_BYTES ((uint32_t)(&_edata - &__data_start))
+#define STATIC_BSS_BYTES ((uint32_t)(&_end - &__bss_start))
+#endif
+
+static void addTask(MemoryReport* report, const char* name, TaskHandle_t handle, uint32_t stackBytes) {
+  if (handle == NULL) return;
+  memoryReportAddTask(report, name, stackBytes, uxTaskGetStackHighWaterMark(handle));
+}
+
+void memoryBudgetCollect(MemoryReport* report) {
+  memoryReportInit(report);
+  report->staticData = STATIC_DATA_BYTES;
+  report->staticBss = STATIC_BSS_BYTES;
+
+  // Gros tampons statiques du firmware (le reste : pile réseau, bibliothèques...)
+  memoryReportAddBuffer(report, "json_arenas", JSON_ARENA_POOL_BYTES);
+  memoryReportAddBuffer(report, "io_table", sizeof(ioTable));
+  memoryReportAddBuffer(report, "io_runtime",
+                        MAX_IOS * (sizeof(PulseCounter) + sizeof(AnalogChannel) + sizeof(PublishLimiter) + sizeof(EdgeStats)));
+  memoryReportAddBuffer(report, "event_log", sizeof(eventLog));
+  memoryReportAddBuffer(report, "schedules", MAX_SCHEDULES * sizeof(ScheduleEntry));
+  memoryReportAddBuffer(report, "scheduled_cmds", MAX_SCHEDULED_COMMANDS * sizeof(ScheduledCommand));
+  memoryReportAddBuffer(report, "command_queue", COMMAND_QUEUE_DEPTH * sizeof(CommandMsg));
+  memoryReportAddBuffer(report, "outbound_queue", OUTBOUND_QUEUE_DEPTH * sizeof(OutboundMsg));
+  memoryReportAddBuffer(report, "command_dedup", sizeof(DedupCache));
+  memoryReportAddBuffer(report, "mqtt_buffer", MQTT_BUFFER_SIZE);  // Alloué une fois au démarrage
+  memoryReportAddBuffer(report, "status_snapshot", MQTT_BUFFER_SIZE);
+
+  report->heapSize = ESP.getHeapSize();
+  report->heapFree = ESP.getFreeHeap();
+  report->heapMinFree = ESP.getMinFreeHeap();
+  report->heapLargestBlock = ESP.getMaxAllocHeap();
+  jsonArenaGetStats(&report->json);
+
+  addTask(report, "NetTask", netTaskHandle, NET_TASK_STACK);
+  addTask(report, "CmdTask", cmdTaskHandle, CMD_TASK_STACK);
+  addTask(report, "IOTask", ioTaskHandle, IO_TASK_STACK);
+}
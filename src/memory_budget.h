@@ -0,0 +1,12 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include "memory_report.h"
+
+// ===== RELEVÉ DU BUDGET MÉMOIRE (appareil) =====
+// Remplit un MemoryReport avec l'état courant : segments statiques (symboles
+// de l'éditeur de liens), tampons du firmware, tas, arènes JSON et marge de
+// pile de NetTask, CmdTask et IOTask (IO_TASK_STACK : 4096 octets par défaut).
+void memoryBudgetCollect(MemoryReport* report);
+
+#endif // MEMORY_BUDGET_H
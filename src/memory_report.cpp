@@ -0,0 +1,79 @@
+#include "memory_report.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+void memoryReportInit(MemoryReport* report) {
+  memset(report, 0, sizeof(MemoryReport));
+}
+
+bool memoryReportAddBuffer(MemoryReport* report, const char* name, uint32_t bytes) {
+  if (report->bufferCount >= MEMORY_REPORT_MAX_BUFFERS) return false;
+  report->buffers[report->bufferCount++] = { name, bytes };
+  return true;
+}
+
+bool memoryReportAddTask(MemoryReport* report, const char* name, uint32_t stackBytes, uint32_t freeMinBytes) {
+  if (report->taskCount >= MEMORY_REPORT_MAX_TASKS) return false;
+  report->tasks[report->taskCount++] = { name, stackBytes, freeMinBytes };
+  return true;
+}
+
+uint32_t memoryReportBuffersTotal(const MemoryReport* report) {
+  uint32_t total = 0;
+  for (int i = 0; i < report->bufferCount; i++) total += report->buffers[i].bytes;
+  return total;
+}
+
+int memoryReportStackWarnings(const MemoryReport* report) {
+  int warnings = 0;
+  for (int i = 0; i < report->taskCount; i++) {
+    if (report->tasks[i].freeMinBytes < MEMORY_STACK_WARN_BYTES) warnings++;
+  }
+  return warnings;
+}
+
+// snprintf cumulatif : s'arrête proprement quand le tampon est plein
+static void append(char* buf, size_t len, size_t* pos, const char* format, ...) __attribute__((format(printf, 4, 5)));
+static void append(char* buf, size_t len, size_t* pos, const char* format, ...) {
+  if (*pos >= len) return;
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(buf + *pos, len - *pos, format, args);
+  va_end(args);
+  if (n > 0) *pos += (size_t)n < len - *pos ? (size_t)n : len - *pos - 1;
+}
+
+size_t memoryReportFormat(const MemoryReport* report, char* buf, size_t len) {
+  size_t pos = 0;
+  if (len == 0) return 0;
+  buf[0] = '\0';
+
+  append(buf, len, &pos, "RAM statique : .data %lu o, .bss %lu o\n", (unsigned long)report->staticData,
+         (unsigned long)report->staticBss);
+  for (int i = 0; i < report->bufferCount; i++) {
+    append(buf, len, &pos, "  %-16s %7lu o\n", report->buffers[i].name, (unsigned long)report->buffers[i].bytes);
+  }
+  append(buf, len, &pos, "  %-16s %7lu o\n", "(total détaillé)", (unsigned long)memoryReportBuffersTotal(report));
+
+  append(buf, len, &pos, "Tas : %lu o libres / %lu (minimum %lu), plus grand bloc %lu o\n",
+         (unsigned long)report->heapFree, (unsigned long)report->heapSize, (unsigned long)report->heapMinFree,
+         (unsigned long)report->heapLargestBlock);
+
+  const JsonArenaStats& json = report->json;
+  append(buf, len, &pos,
+         "Arènes JSON : %d x %d o + %d x %d o, max %lu / %lu o, %u/%u louées (max %u), "
+         "%lu documents, %lu sans arène, %lu débordements\n",
+         JSON_ARENA_COUNT, JSON_ARENA_SIZE, JSON_LARGE_ARENA_COUNT, JSON_LARGE_ARENA_SIZE,
+         (unsigned long)json.smallHighWater, (unsigned long)json.largeHighWater, json.inUse,
+         JSON_ARENA_COUNT + JSON_LARGE_ARENA_COUNT, json.inUseHighWater, (unsigned long)json.leases,
+         (unsigned long)json.busy, (unsigned long)json.overflows);
+
+  append(buf, len, &pos, "Piles :\n");
+  for (int i = 0; i < report->taskCount; i++) {
+    const TaskStackUsage& t = report->tasks[i];
+    append(buf, len, &pos, "  %-16s %5lu o, marge min %5lu o%s\n", t.name, (unsigned long)t.stackBytes,
+           (unsigned long)t.freeMinBytes, t.freeMinBytes < MEMORY_STACK_WARN_BYTES ? "  ⚠️" : "");
+  }
+  return pos;
+}
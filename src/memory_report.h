@@ -0,0 +1,58 @@
+#ifndef MEMORY_REPORT_H
+#define MEMORY_REPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "json_arena.h"
+
+// ===== BUDGET MÉMOIRE =====
+// Module pur (sans Arduino) : relevé de la RAM du firmware, rempli par
+// memoryBudgetCollect() sur l'appareil (memory_budget.h) ou directement par
+// un test hôte, puis exposé par GET /api/memory ou formaté en texte.
+//  - RAM statique : segments .data / .bss complets, et le détail des gros
+//    tampons du firmware (arènes JSON, table des IO, journal...) ;
+//  - tas : libre, minimum atteint, plus grand bloc allouable (fragmentation) ;
+//  - arènes JSON : niveaux atteints et replis sur le tas (json_arena.h) ;
+//  - piles des tâches : taille et marge minimale observée.
+
+#define MEMORY_REPORT_MAX_BUFFERS 12
+#define MEMORY_REPORT_MAX_TASKS 6
+#define MEMORY_STACK_WARN_BYTES 512   // Marge de pile en dessous de laquelle le relevé alerte
+
+struct MemoryBuffer {
+  const char* name;
+  uint32_t bytes;
+};
+
+struct TaskStackUsage {
+  const char* name;
+  uint32_t stackBytes;     // Taille allouée à la création
+  uint32_t freeMinBytes;   // Pile jamais utilisée depuis le démarrage
+};
+
+struct MemoryReport {
+  uint32_t staticData;     // .data
+  uint32_t staticBss;      // .bss
+  uint32_t heapSize;
+  uint32_t heapFree;
+  uint32_t heapMinFree;
+  uint32_t heapLargestBlock;
+  JsonArenaStats json;
+  uint8_t bufferCount;
+  MemoryBuffer buffers[MEMORY_REPORT_MAX_BUFFERS];
+  uint8_t taskCount;
+  TaskStackUsage tasks[MEMORY_REPORT_MAX_TASKS];
+};
+
+void memoryReportInit(MemoryReport* report);
+// Les noms ne sont pas copiés : chaînes littérales attendues
+bool memoryReportAddBuffer(MemoryReport* report, const char* name, uint32_t bytes);
+bool memoryReportAddTask(MemoryReport* report, const char* name, uint32_t stackBytes, uint32_t freeMinBytes);
+// Somme des tampons détaillés
+uint32_t memoryReportBuffersTotal(const MemoryReport* report);
+// Tâches dont la marge de pile est sous MEMORY_STACK_WARN_BYTES
+int memoryReportStackWarnings(const MemoryReport* report);
+// Relevé lisible (console, tests) ; retourne la longueur écrite
+size_t memoryReportFormat(const MemoryReport* report, char* buf, size_t len);
+
+#endif // MEMORY_REPORT_H
@@ -1,18 +1,34 @@
 #include <Arduino.h>
-#include <PubSubClient.h>
 #include "mqtt.h"
-#include <ArduinoJson.h>
+#include "mqtt_transport.h"
+#include "command_executor.h"
+#include "io_table.h"
+#include "group_list.h"
+#include "event_log.h"
+#include "config_reload.h"
+#include "json_pool.h"
+#include "output_journal.h"
+#include "io_task.h"
+#include "wifi_link.h"
+#include <WiFi.h>
 #include <time.h>
 #include <sys/time.h>
+#include <freertos/semphr.h>
 
-#include <WiFi.h>
-
-// define the network client and the MQTT client here (single place)
-WiFiClient wifiClient;
-PubSubClient mqttClient(wifiClient);
 // MQTT active flag (default disabled so web server can be debugged first)
 bool mqttEnabled = false;
 
+// Les clients MQTT ne sont pas réentrants : un mutex récursif sérialise les accès
+// depuis NetTask, CmdTask, IOTask, le serveur web et async_tcp. Récursif car
+// mqtt_callback (appelé depuis mqttTransportLoop() avec PubSubClient) publie
+// lui-même (pong, acquittements).
+static SemaphoreHandle_t mqttMutex = NULL;
+
+struct MqttLock {
+    MqttLock() { if (mqttMutex) xSemaphoreTakeRecursive(mqttMutex, portMAX_DELAY); }
+    ~MqttLock() { if (mqttMutex) xSemaphoreGiveRecursive(mqttMutex); }
+};
+
 // Variables pour synchronisation temporelle précise
 static uint32_t lastSyncSeconds = 0;
 static uint32_t lastSyncMicros = 0;  // micros() au moment de la sync
@@ -25,6 +41,30 @@ struct SyncStats {
     uint32_t last_sync_timestamp = 0;
 } syncStats;
 
+// Connexion établie depuis la dernière tentative (journal des déconnexions)
+static bool mqttWasConnected = false;
+
+// Identifiants des commandes récentes (évite la double exécution sur redélivrance).
+// Consulté à la réception (NetTask), oublié par CmdTask quand la commande est refusée.
+static DedupCache commandDedup;
+static SemaphoreHandle_t dedupMutex = NULL;
+
+struct DedupLock {
+    DedupLock() { if (dedupMutex) xSemaphoreTakeRecursive(dedupMutex, portMAX_DELAY); }
+    ~DedupLock() { if (dedupMutex) xSemaphoreGiveRecursive(dedupMutex); }
+};
+
+static bool commandIdSeen(const char* id) {
+    DedupLock lock;
+    return dedupCacheCheckAndInsert(&commandDedup, commandIdHash(id));
+}
+
+void commandIdForget(const char* id) {
+    if (id == nullptr || id[0] == '\0') return;
+    DedupLock lock;
+    dedupCacheRemove(&commandDedup, commandIdHash(id));
+}
+
 // Obtenir le temps actuel avec précision microseconde
 uint64_t getCurrentTimeMicros() {
     struct timeval tv;
@@ -34,69 +74,224 @@ uint64_t getCurrentTimeMicros() {
 
 // MQTT callback and helpers moved out of main.cpp
 
-// Helper to get current time as string
-String getFormattedTime() {
-  char timeStr[20];
+// Heure courante pour les traces, dans le tampon de l'appelant (pas de String par message)
+static const char* formatTime(char* timeStr, size_t len) {
   time_t now = time(nullptr);
-  strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", localtime(&now));
-  return String(timeStr);
+  struct tm tmNow;
+  strftime(timeStr, len, "%Y-%m-%d %H:%M:%S", localtime_r(&now, &tmNow));
+  return timeStr;
 }
 
+// Écrit la sortie depuis CmdTask ; l'état est publié par NetTask (mqttFlushOutbound)
 void executeCommand(int pin, int state) {
   digitalWrite(pin, state);
-  for (int i = 0; i < ioPinCount; i++) {
-    if (ioPins[i].pin == pin) {
-      ioPins[i].state = state;
-      break;
-    }
+  uint64_t timeUs = getCurrentTimeMicros();
+  if (pin >= 0 && pin < MAX_GPIO) {
+    pinStates[pin] = state;
   }
 
-  // Publish status
-  char topic[128];
-  int pinIndex = -1;
-  for(int i=0; i<ioPinCount; i++) {
-    if(ioPins[i].pin == pin) {
-      pinIndex = i;
-      break;
-    }
+  IOTableReader io;
+  int pinIndex = ioTableFindByPin(io.get(), pin);
+  // Sortie à restaurer après une coupure : état noté pour le journal en flash
+  if (pinIndex != -1 && io->pins[pinIndex].restorePolicy == RESTORE_LAST) {
+    outputJournalRecord(pin, state);
   }
-  if(pinIndex != -1) {
-    snprintf(topic, sizeof(topic), "%s/status/%s", config.deviceName, ioPins[pinIndex].name);
-    
-    // Obtenir le temps avec précision microseconde
-    uint64_t timeUs = getCurrentTimeMicros();
-    uint32_t seconds = timeUs / 1000000ULL;
-    uint32_t us = timeUs % 1000000ULL;
-    
-    JsonDocument doc;
-    doc["state"] = state;
-    doc["timestamp"] = seconds;
-    doc["us"] = us;  // Microsecondes
-    
+  if (pinIndex == -1) return;
+
+  OutboundMsg msg = {};
+  msg.kind = OUTBOUND_STATUS;
+  msg.pin = pin;
+  msg.state = state;
+  msg.executed_us = timeUs;
+  if (!outboundQueueSend(&msg)) {
+    Serial.println("⚠️ Outbound queue is full, status dropped!");
+  }
+}
+
+void publishCommandAck(const char* id, int state, const char* status,
+                       uint64_t received_us, uint64_t scheduled_us, uint64_t executed_us,
+                       uint32_t actuation_us) {
+    if (id == nullptr || id[0] == '\0') return;
+
+    OutboundMsg msg = {};
+    msg.kind = OUTBOUND_ACK;
+    msg.state = state;
+    msg.status = status;
+    strlcpy(msg.id, id, sizeof(msg.id));
+    msg.received_us = received_us;
+    msg.scheduled_us = scheduled_us;
+    msg.executed_us = executed_us;
+    msg.actuation_us = actuation_us;
+    if (!outboundQueueSend(&msg)) {
+        Serial.printf("⚠️ Outbound queue is full, ack '%s' dropped!\n", id);
+    }
+}
+
+// ===== PUBLICATIONS DIFFÉRÉES (NetTask) =====
+static void sendOutputStatus(const OutboundMsg& msg) {
+    char topic[128];
     char payload[128];
-    serializeJson(doc, payload);
+    {
+        IOTableReader io;
+        int pinIndex = ioTableFindByPin(io.get(), msg.pin);
+        if (pinIndex == -1) return;  // Sortie supprimée entre-temps
+        const IOPin& out = io->pins[pinIndex];
+        snprintf(topic, sizeof(topic), "%s/status/%s", config.deviceName, out.name);
 
-    if (mqttEnabled && mqttClient.connected()) {
-      publishMQTT(topic, payload);
+        PooledJsonDocument doc;
+        doc["state"] = msg.state;
+        doc["timestamp"] = (uint32_t)(msg.executed_us / 1000000ULL);
+        doc["us"] = (uint32_t)(msg.executed_us % 1000000ULL);  // Microsecondes
+        // Instant attendu du contact (écriture + délai de commutation calibré)
+        uint64_t contactUs = msg.executed_us + (msg.state ? out.actuationOnUs : out.actuationOffUs);
+        doc["contactTimestamp"] = (uint32_t)(contactUs / 1000000ULL);
+        doc["contactUs"] = (uint32_t)(contactUs % 1000000ULL);
+        serializeJson(doc, payload);
     }
-  }
+    publishMQTT(topic, payload);
+}
+
+// id est passé à part : msg.id, ou l'identifiant trop long d'une commande refusée
+static void sendCommandAck(const char* id, const OutboundMsg& msg) {
+    char ackTopic[128];
+    snprintf(ackTopic, sizeof(ackTopic), "%s/ack", config.deviceName);
+
+    PooledJsonDocument doc;
+    doc["id"] = id;
+    doc["status"] = msg.status;
+    doc["state"] = msg.state;
+    doc["received_us"] = msg.received_us;
+    if (msg.scheduled_us > 0) {
+        doc["scheduled_us"] = msg.scheduled_us;
+    }
+    if (msg.executed_us > 0) {
+        doc["executed_us"] = msg.executed_us;
+        uint64_t contact_us = msg.executed_us + msg.actuation_us;
+        if (msg.actuation_us > 0) {
+            doc["contact_us"] = contact_us;
+        }
+        // Retard du contact par rapport à l'échéance (ou de l'écriture par rapport à la
+        // réception pour une commande immédiate)
+        if (msg.scheduled_us > 0) {
+            doc["lateness_us"] = (int64_t)contact_us - (int64_t)msg.scheduled_us;
+        } else {
+            doc["lateness_us"] = (int64_t)msg.executed_us - (int64_t)msg.received_us;
+        }
+    }
+
+    char ackPayload[256];
+    serializeJson(doc, ackPayload);
+    publishMQTT(ackTopic, ackPayload);
+}
+
+void mqttFlushOutbound() {
+    OutboundMsg msg;
+    while (outboundQueueReceive(&msg, 0)) {
+        // Hors connexion la file est vidée quand même : pas d'états périmés à la reconnexion
+        if (!mqttEnabled || !mqttConnected()) continue;
+        if (msg.kind == OUTBOUND_STATUS) {
+            sendOutputStatus(msg);
+        } else {
+            sendCommandAck(msg.id, msg);
+        }
+    }
+}
+
+// Commande pour une sortie nommée, reçue sur le topic de l'appareil ou d'un groupe
+// (pinName : nameLen caractères pris dans le topic, sans terminaison)
+static void handleControlCommand(const char* pinName, size_t nameLen, byte* payload, unsigned int length,
+                                 const char* message, uint64_t receivedUs, uint8_t source) {
+    // Find the IO pin by name (instantané de la configuration, sans verrou)
+    IOTableReader io;
+    for (int i = 0; i < io->count; i++) {
+        if (strlen(io->pins[i].name) == nameLen && strncmp(io->pins[i].name, pinName, nameLen) == 0) {
+            if (io->pins[i].mode == 2) { // OUTPUT
+                PooledJsonDocument doc;
+                DeserializationError error = deserializeJson(doc, payload, length);
+
+                CommandMsg cmd = {};
+                cmd.pin = io->pins[i].pin;
+                cmd.received_us = receivedUs;
+
+                if (error) {
+                    Serial.print(F("deserializeJson() failed: "));
+                    Serial.println(error.c_str());
+                    // Fallback for simple "0" or "1" commands
+                    cmd.state = atoi(message);
+                    eventLogWrite(EVENT_COMMAND, cmd.pin, cmd.state, nullptr, source);
+                    if (!submitCommand(&cmd)) {
+                        Serial.println("⚠️ Command queue is full!");
+                    }
+                    return;
+                }
+
+                cmd.state = doc["state"];
+                cmd.exec_at_sec = doc["exec_at"] | 0;
+                cmd.exec_at_us = doc["exec_at_us"] | 0;
+
+                // Identifiant trop long : le tronquer fausserait la déduplication et
+                // l'acquittement. Refus acquitté directement avec l'id complet (il ne
+                // tient pas dans la file sortante)
+                const char* id = doc["id"] | "";
+                if (strlen(id) >= sizeof(cmd.id)) {
+                    Serial.printf("⚠️ Command id '%s' too long (max %d characters), rejected\n", id,
+                                  COMMAND_ID_MAX_LEN - 1);
+                    OutboundMsg ack = {};
+                    ack.kind = OUTBOUND_ACK;
+                    ack.state = cmd.state;
+                    ack.status = "rejected";
+                    ack.received_us = receivedUs;
+                    sendCommandAck(id, ack);
+                    return;
+                }
+                strlcpy(cmd.id, id, sizeof(cmd.id));
+                eventLogWrite(EVENT_COMMAND, cmd.pin, cmd.state, cmd.id, source);
+
+                // Commande déjà reçue (redélivrance) : acquitter sans ré-exécuter
+                if (cmd.id[0] != '\0' && commandIdSeen(cmd.id)) {
+                    Serial.printf("↩️ Duplicate command '%s' ignored\n", cmd.id);
+                    publishCommandAck(cmd.id, cmd.state, "duplicate", receivedUs, 0, 0);
+                    return;
+                }
+
+                // Exécution (immédiate ou programmée) déléguée à la tâche CmdTask
+                if (!submitCommand(&cmd)) {
+                    Serial.println("⚠️ Command queue is full!");
+                    commandIdForget(cmd.id);  // Une nouvelle tentative avec le même id sera exécutée
+                    publishCommandAck(cmd.id, cmd.state, "rejected", receivedUs, 0, 0);
+                }
+
+            } else {
+                Serial.printf("Received command for non-output pin '%.*s'\n", (int)nameLen, pinName);
+            }
+            return; // Command handled for this pin
+        }
+    }
+
+    Serial.printf("Received command for unknown pin '%.*s'\n", (int)nameLen, pinName);
 }
 
 void mqtt_callback(char* topic, byte* payload, unsigned int length) {
-    String topicStr = String(topic);
-    String baseTopic = String(config.deviceName);
+    // Horodatage de réception au plus tôt, pour les acquittements
+    uint64_t receivedUs = getCurrentTimeMicros();
+
+    // Sous-topic de l'appareil ("<device>/ping" -> "ping"), nullptr pour les topics communs
+    size_t baseLen = strlen(config.deviceName);
+    const char* deviceTopic = (strncmp(topic, config.deviceName, baseLen) == 0 && topic[baseLen] == '/')
+                                  ? topic + baseLen + 1 : nullptr;
 
     // Convert payload to string for logging and parsing
     char message[length + 1];
     memcpy(message, payload, length);
     message[length] = '\0';
 
-    Serial.printf("[%s] MQTT message arrived on topic [%s]: %s\n", getFormattedTime().c_str(), topic, message);
+    char timeStr[20];
+    Serial.printf("[%s] MQTT message arrived on topic [%s]: %s\n", formatTime(timeStr, sizeof(timeStr)), topic, message);
 
     // Handle time synchronization first, as it's a critical service
     // Le topic de temps est commun à tous les appareils
-    if (topicStr.equals("esp32/time/sync")) {
-        JsonDocument doc;
+    if (strcmp(topic, "esp32/time/sync") == 0) {
+        PooledJsonDocument doc;
         DeserializationError error = deserializeJson(doc, payload, length);
         
         if (!error && doc["seconds"].is<uint32_t>()) {
@@ -106,11 +301,10 @@ void mqtt_callback(char* topic, byte* payload, unsigned int length) {
             // Lire la compensation pour NOTRE device (si disponible)
             if (doc["compensations"].is<JsonObject>()) {
                 JsonObject compensations = doc["compensations"];
-                String deviceName = String(config.deviceName);
                 
                 // Utiliser la méthode moderne is<T>() au lieu de containsKey (deprecated)
-                if (compensations[deviceName].is<uint32_t>()) {
-                    syncStats.estimated_latency_us = compensations[deviceName];
+                if (compensations[config.deviceName].is<uint32_t>()) {
+                    syncStats.estimated_latency_us = compensations[config.deviceName];
                 }
             }
             
@@ -126,7 +320,11 @@ void mqtt_callback(char* topic, byte* payload, unsigned int length) {
             struct timeval tv;
             tv.tv_sec = master_time_us / 1000000ULL;
             tv.tv_usec = master_time_us % 1000000ULL;
+            int64_t correctionMs = ((int64_t)master_time_us - (int64_t)getCurrentTimeMicros()) / 1000;
             settimeofday(&tv, NULL);
+            if (correctionMs > INT32_MAX) correctionMs = INT32_MAX;
+            if (correctionMs < INT32_MIN) correctionMs = INT32_MIN;
+            eventLogWrite(EVENT_TIME_SYNC, 0, (uint32_t)(int32_t)correctionMs);
             
             // Mettre à jour les statistiques
             syncStats.sync_count++;
@@ -137,10 +335,10 @@ void mqtt_callback(char* topic, byte* payload, unsigned int length) {
             // Affichage simplifié
             if (syncStats.sync_count <= 2) {
                 Serial.printf("⏰ Time sync #%u: %u.%06u (initializing)\n", 
-                             syncStats.sync_count, tv.tv_sec, tv.tv_usec);
+                             syncStats.sync_count, (uint32_t)tv.tv_sec, (uint32_t)tv.tv_usec);
             } else {
                 Serial.printf("⏰ Time sync #%u: %u.%06u", 
-                             syncStats.sync_count, tv.tv_sec, tv.tv_usec);
+                             syncStats.sync_count, (uint32_t)tv.tv_sec, (uint32_t)tv.tv_usec);
                 
                 if (syncStats.estimated_latency_us > 0) {
                     Serial.printf(" | Comp: +%.2f ms", 
@@ -164,14 +362,14 @@ void mqtt_callback(char* topic, byte* payload, unsigned int length) {
     }
     
     // Topic pour mesurer la latence réseau (ping/pong) - géré par le PC
-    if (topicStr.equals(String(config.deviceName) + "/ping")) {
+    if (deviceTopic != nullptr && strcmp(deviceTopic, "ping") == 0) {
         // Répondre immédiatement avec pong
         char pongTopic[128];
         snprintf(pongTopic, sizeof(pongTopic), "%s/pong", config.deviceName);
         
         // Renvoyer le payload reçu pour que le PC puisse mesurer le RTT
-        JsonDocument pongDoc;
-        pongDoc["ping_payload"] = String(message);
+        PooledJsonDocument pongDoc;
+        pongDoc["ping_payload"] = (const char*)message;
         
         char pongPayload[128];
         serializeJson(pongDoc, pongPayload);
@@ -179,134 +377,352 @@ void mqtt_callback(char* topic, byte* payload, unsigned int length) {
         return;
     }
 
-    // Check if it's a control topic for a pin
-    String controlTopicPrefix = baseTopic + "/control/";
-    if (!topicStr.startsWith(controlTopicPrefix) || !topicStr.endsWith("/set")) {
+    // Demande d'instantané des états (payload vide, ou {"id": "..."} renvoyé dans la réponse)
+    if ((deviceTopic != nullptr && strcmp(deviceTopic, "status/get") == 0) ||
+        strcmp(topic, STATUS_REQUEST_TOPIC) == 0) {
+        PooledJsonDocument doc;
+        const char* requestId = nullptr;
+        if (length > 0 && !deserializeJson(doc, payload, length)) {
+            requestId = doc["id"] | "";
+        }
+        publishStatusSnapshot("request", requestId);
+        return;
+    }
+
+    // Commande adressée à un groupe : esp32/group/<g>/control/<nom>/set
+    if (strncmp(topic, GROUP_TOPIC_PREFIX, strlen(GROUP_TOPIC_PREFIX)) == 0) {
+        const char* rest = topic + strlen(GROUP_TOPIC_PREFIX);
+        size_t restLen = strlen(rest);
+        const char* slash = strchr(rest, '/');
+        size_t groupLen = slash != nullptr ? (size_t)(slash - rest) : 0;
+        if (groupLen == 0 || restLen <= groupLen + 13 ||
+            strncmp(slash, "/control/", 9) != 0 || strcmp(rest + restLen - 4, "/set") != 0) {
+            return;
+        }
+        // Abonnement encore actif juste après un retrait du groupe : ignorer
+        if (!groupListContains(config.groups, rest, groupLen)) {
+            return;
+        }
+        handleControlCommand(slash + 9, restLen - groupLen - 13, payload, length, message, receivedUs,
+                             EVENT_SOURCE_GROUP);
+        return;
+    }
+
+    // Changement d'appartenance aux groupes : "a,b", {"groups":"a,b"} ou {"groups":["a","b"]}
+    if (deviceTopic != nullptr && strcmp(deviceTopic, "config/groups/set") == 0) {
+        char groups[GROUP_LIST_MAX_LEN];
+        strlcpy(groups, message, sizeof(groups));
+        PooledJsonDocument doc;
+        if (!deserializeJson(doc, payload, length)) {
+            if (doc["groups"].is<const char*>()) {
+                strlcpy(groups, doc["groups"].as<const char*>(), sizeof(groups));
+            } else if (doc["groups"].is<JsonArray>()) {
+                groups[0] = '\0';
+                for (JsonVariant g : doc["groups"].as<JsonArray>()) {
+                    if (groups[0] != '\0') strlcat(groups, ",", sizeof(groups));
+                    strlcat(groups, g.as<const char*>(), sizeof(groups));
+                }
+            }
+        }
+        setMqttGroups(groups);
+        saveConfig();
+        return;
+    }
+
+    // Check if it's a control topic for a pin: <device>/control/<nom>/set
+    size_t subLen = deviceTopic != nullptr ? strlen(deviceTopic) : 0;
+    if (subLen <= 12 || strncmp(deviceTopic, "control/", 8) != 0 || strcmp(deviceTopic + subLen - 4, "/set") != 0) {
         return; // Not a command for us
     }
 
     // Extract pin name
-    String pinName = topicStr.substring(controlTopicPrefix.length(), topicStr.length() - 4);
+    handleControlCommand(deviceTopic + 8, subLen - 12, payload, length, message, receivedUs, EVENT_SOURCE_MQTT);
+}
 
-    // Find the IO pin by name
-    for (int i = 0; i < ioPinCount; i++) {
-        if (String(ioPins[i].name) == pinName) {
-            if (ioPins[i].mode == 2) { // OUTPUT
-                JsonDocument doc;
-                DeserializationError error = deserializeJson(doc, payload, length);
+// Abonnement (ou désabonnement) aux commandes d'un groupe : esp32/group/<g>/control/#
+static void subscribeGroup(const char* group, bool subscribe) {
+  char topic[64];
+  snprintf(topic, sizeof(topic), GROUP_TOPIC_PREFIX "%s/control/#", group);
+  if (subscribe) {
+    mqttTransportSubscribe(topic, MQTT_SUBSCRIBE_QOS);
+    Serial.printf("✓ Abonné à: %s\n", topic);
+  } else {
+    mqttTransportUnsubscribe(topic);
+    Serial.printf("✓ Désabonné de: %s\n", topic);
+  }
+}
 
-                if (error) {
-                    Serial.print(F("deserializeJson() failed: "));
-                    Serial.println(error.c_str());
-                    // Fallback for simple "0" or "1" commands
-                    int state = atoi(message);
-                    executeCommand(ioPins[i].pin, state);
-                    return;
-                }
+// Appartenance courante, publiée en retained pour que le coordinateur la découvre
+static void publishGroups() {
+  char topic[128];
+  snprintf(topic, sizeof(topic), "%s/config/groups", config.deviceName);
 
-                int state = doc["state"];
-                uint32_t exec_at_sec = doc["exec_at"] | 0;
-                uint32_t exec_at_us = doc["exec_at_us"] | 0;
-
-                if (exec_at_sec > 0) {
-                    // Schedule command avec précision microseconde
-                    bool scheduled = false;
-                    for (int j = 0; j < MAX_SCHEDULED_COMMANDS; j++) {
-                        if (!scheduledCommands[j].active) {
-                            scheduledCommands[j].pin = ioPins[i].pin;
-                            scheduledCommands[j].state = state;
-                            scheduledCommands[j].exec_at_sec = exec_at_sec;
-                            scheduledCommands[j].exec_at_us = exec_at_us;
-                            scheduledCommands[j].active = true;
-                            scheduled = true;
-                            Serial.printf("⏰ Command for pin %d scheduled at %u.%06u\n", ioPins[i].pin, exec_at_sec, exec_at_us);
-                            break;
-                        }
-                    }
-                    if (!scheduled) {
-                        Serial.println("⚠️ Scheduled command queue is full!");
-                    }
-                } else {
-                    // Execute immediately
-                    executeCommand(ioPins[i].pin, state);
-                }
+  char groups[MAX_GROUPS][GROUP_NAME_MAX_LEN];
+  int count = groupListParse(config.groups, groups, MAX_GROUPS);
+  PooledJsonDocument doc;
+  JsonArray list = doc["groups"].to<JsonArray>();
+  for (int i = 0; i < count; i++) {
+    list.add(groups[i]);
+  }
 
-            } else {
-                Serial.printf("Received command for non-output pin '%s'\n", pinName.c_str());
-            }
-            return; // Command handled for this pin
-        }
+  char payload[128];
+  serializeJson(doc, payload);
+  publishMQTT(topic, payload, true);
+}
+
+void setMqttGroups(const char* groups) {
+  MqttLock lock;
+  char normalized[GROUP_LIST_MAX_LEN];
+  groupListNormalize(groups, normalized, sizeof(normalized));
+  if (strcmp(normalized, config.groups) == 0) return;
+
+  // Abonnements ajustés à chaud : seuls les groupes ajoutés ou retirés changent
+  if (mqttConnected()) {
+    char oldGroups[MAX_GROUPS][GROUP_NAME_MAX_LEN];
+    char newGroups[MAX_GROUPS][GROUP_NAME_MAX_LEN];
+    int oldCount = groupListParse(config.groups, oldGroups, MAX_GROUPS);
+    int newCount = groupListParse(normalized, newGroups, MAX_GROUPS);
+    for (int i = 0; i < oldCount; i++) {
+      if (!groupListContains(normalized, oldGroups[i], strlen(oldGroups[i]))) subscribeGroup(oldGroups[i], false);
+    }
+    for (int i = 0; i < newCount; i++) {
+      if (!groupListContains(config.groups, newGroups[i], strlen(newGroups[i]))) subscribeGroup(newGroups[i], true);
     }
+  }
 
-    Serial.printf("Received command for unknown pin '%s'\n", pinName.c_str());
+  strlcpy(config.groups, normalized, sizeof(config.groups));
+  Serial.printf("✓ Groupes: %s\n", config.groups[0] ? config.groups : "(aucun)");
+  publishGroups();
 }
 
-void setupMQTT() {
-  mqttClient.setServer(config.mqttServer, config.mqttPort);
-  mqttClient.setCallback(mqtt_callback);
-  Serial.println("MQTT setup.");
+// ===== INSTANTANÉ DES ÉTATS =====
+// Toutes les I/O, l'heure et la santé de l'appareil en un message retenu sur
+// <device>/status : publié à la connexion et sur demande (<device>/status/get ou
+// esp32/status/get pour toute la flotte). seq croît à chaque instantané depuis le
+// démarrage ; une valeur plus petite que la précédente signale un redémarrage.
+static uint32_t snapshotSeq = 0;
+static char snapshotPayload[MQTT_BUFFER_SIZE];  // Sérialisé sous MqttLock (hors pile async_tcp)
+
+void publishStatusSnapshot(const char* reason, const char* requestId) {
+  MqttLock lock;
+  if (!mqttConnected()) return;
+
+  uint64_t timeUs = getCurrentTimeMicros();
+  PooledJsonDocument doc(true);
+  doc["seq"] = ++snapshotSeq;
+  doc["reason"] = reason;
+  if (requestId != nullptr && requestId[0] != '\0') {
+    doc["id"] = requestId;
+  }
+  doc["timestamp"] = (uint32_t)(timeUs / 1000000ULL);
+  doc["us"] = (uint32_t)(timeUs % 1000000ULL);
+
+  // Une entrée compacte par I/O : [nom, GPIO, mode, valeur]. Valeur : état 0/1
+  // (INPUT, OUTPUT), total d'impulsions (COUNTER) ou valeur calibrée (ANALOG)
+  JsonArray ios = doc["ios"].to<JsonArray>();
+  IOTableReader io;
+  for (int i = 0; i < io->count; i++) {
+    const IOPin& pin = io->pins[i];
+    JsonArray entry = ios.add<JsonArray>();
+    entry.add(pin.name);
+    entry.add(pin.pin);
+    entry.add(pin.mode);
+    IOValues values;
+    if (pin.mode == 3 || pin.mode == 4) { // COUNTER, ANALOG
+      JsonVariant value = entry.add<JsonVariant>();  // null : reconfiguration pas encore prise en compte
+      if (ioValuesRead(i, io->generation, &values)) {
+        if (pin.mode == 3) value.set(values.count);
+        else value.set(values.value);
+      }
+    } else {
+      entry.add(pinStates[pin.pin] ? 1 : 0);
+    }
+  }
+
+  IOScanStats scanStats;
+  ioScanGetStats(&scanStats);
+  MqttTransportStats mqttStats;
+  mqttTransportGetStats(&mqttStats);
+  JsonObject health = doc["health"].to<JsonObject>();
+  health["uptime_s"] = millis() / 1000;
+  health["heap_free"] = ESP.getFreeHeap();
+  health["rssi"] = WiFi.RSSI();
+  health["syncs"] = syncStats.sync_count;
+  health["last_sync"] = syncStats.last_sync_timestamp;
+  health["comp_us"] = syncStats.estimated_latency_us;
+  health["publish_failed"] = mqttStats.publishFailed;
+  health["scan_avg_us"] = scanStats.avgUs;
+  WifiLinkStats linkStats;
+  wifiLinkGetStats(&linkStats);
+  health["wifi_losses"] = linkStats.reconnect.losses;
+  health["reconnect_ms"] = linkStats.reconnect.lastOnlineMs;
+
+  // Le paquet (en-tête et topic compris) doit tenir dans le tampon du client
+  char topic[128];
+  snprintf(topic, sizeof(topic), "%s/status", config.deviceName);
+  size_t len = measureJson(doc);
+  if (len + strlen(topic) + 8 > sizeof(snapshotPayload)) {
+    Serial.printf("⚠️ Status snapshot of %u bytes exceeds MQTT_BUFFER_SIZE (%d), not published\n",
+                  (unsigned)len, MQTT_BUFFER_SIZE);
+    return;
+  }
+  serializeJson(doc, snapshotPayload, sizeof(snapshotPayload));
+  publishMQTT(topic, snapshotPayload, true);
+  Serial.printf("📸 Status snapshot #%u (%s, %d I/O, %u bytes)\n", snapshotSeq, reason, io->count, (unsigned)len);
 }
 
-void reconnectMQTT() {
-  Serial.print("Attempting MQTT connection...");
-  String clientId = "ESP32-IO-Controller-";
-  clientId += String(random(0xffff), HEX);
-  if (mqttClient.connect(clientId.c_str(), config.mqttUser, config.mqttPassword)) {
-    Serial.println("connected");
-    blinkStatusLED(2, 100);  // Signal de connexion MQTT réussie
-    Serial.println();
-    Serial.println("========================================");
-    Serial.println("✓ Client MQTT connecté au broker");
-    
-    // Publish availability
+// Session établie : abonnements et états initiaux. Appelé par le transport,
+// dans reconnectMQTT (PubSubClient) ou depuis la tâche async_tcp (async).
+static void onMqttConnected() {
+  MqttLock lock;
+  Serial.println("connected");
+  blinkStatusLED(2, 100);  // Signal de connexion MQTT réussie
+  Serial.println();
+  Serial.println("========================================");
+  Serial.printf("✓ Client MQTT connecté au broker (%s)\n", mqttTransportName());
+  eventLogWrite(EVENT_MQTT_CONNECT, 0, 0, mqttTransportName());
+  mqttWasConnected = true;
+  wifiLinkMqttOnline(millis());  // Fin de la mesure perte de lien -> en ligne
+  configReloadEnd();  // Fin de l'interruption d'un rechargement (reconnexion, redémarrage)
+
+  // Publish availability
+  char availabilityTopic[128];
+  snprintf(availabilityTopic, sizeof(availabilityTopic), "%s/availability", config.deviceName);
+  publishMQTT(availabilityTopic, "online", true);
+
+  // Subscribe to control topics
+  char topic[128];
+  snprintf(topic, sizeof(topic), "%s/control/#", config.deviceName);
+  mqttTransportSubscribe(topic, MQTT_SUBSCRIBE_QOS);
+  Serial.printf("✓ Abonné à: %s\n", topic);
+
+  // Subscribe to time sync topic (commun à tous les ESP32)
+  mqttTransportSubscribe("esp32/time/sync", 0);
+  Serial.printf("✓ Abonné à: esp32/time/sync\n");
+
+  // Subscribe to ping topic for latency measurement (géré par le PC)
+  snprintf(topic, sizeof(topic), "%s/ping", config.deviceName);
+  mqttTransportSubscribe(topic, 0);
+  Serial.printf("✓ Abonné à: %s\n", topic);
+
+  // Groupes de diffusion : "all" pour tous les appareils, plus les groupes configurés
+  subscribeGroup(BROADCAST_GROUP, true);
+  char groups[MAX_GROUPS][GROUP_NAME_MAX_LEN];
+  int groupCount = groupListParse(config.groups, groups, MAX_GROUPS);
+  for (int i = 0; i < groupCount; i++) {
+    subscribeGroup(groups[i], true);
+  }
+  snprintf(topic, sizeof(topic), "%s/config/groups/set", config.deviceName);
+  mqttTransportSubscribe(topic, MQTT_SUBSCRIBE_QOS);
+  Serial.printf("✓ Abonné à: %s\n", topic);
+
+  // Demandes d'instantané : pour cet appareil, ou pour toute la flotte
+  snprintf(topic, sizeof(topic), "%s/status/get", config.deviceName);
+  mqttTransportSubscribe(topic, 0);
+  Serial.printf("✓ Abonné à: %s\n", topic);
+  mqttTransportSubscribe(STATUS_REQUEST_TOPIC, 0);
+  Serial.printf("✓ Abonné à: %s\n", STATUS_REQUEST_TOPIC);
+
+  Serial.println("========================================");
+  Serial.println();
+
+  publishGroups();
+
+  // États de toutes les I/O en un seul message retenu (remplace un message par broche)
+  publishStatusSnapshot("connect");
+}
+
+void applyMqttConfig(const Config* next, bool reconnect) {
+  MqttLock lock;
+  strlcpy(config.mqttTopic, next->mqttTopic, sizeof(config.mqttTopic));
+  if (!reconnect) {
+    setMqttGroups(next->groups);
+    return;
+  }
+
+  if (mqttConnected()) {
+    // Déconnexion volontaire : le Last Will ne part pas, l'ancienne identité est retirée ici
     char availabilityTopic[128];
     snprintf(availabilityTopic, sizeof(availabilityTopic), "%s/availability", config.deviceName);
-    publishMQTT(availabilityTopic, "online", true);
-
-    // Subscribe to control topics
-    String controlTopic = String(config.deviceName) + "/control/#";
-    mqttClient.subscribe(controlTopic.c_str());
-    Serial.printf("✓ Abonné à: %s\n", controlTopic.c_str());
+    publishMQTT(availabilityTopic, "offline", true);
+    mqttTransportDisconnect();
+  }
+  strlcpy(config.deviceName, next->deviceName, sizeof(config.deviceName));
+  strlcpy(config.mqttServer, next->mqttServer, sizeof(config.mqttServer));
+  config.mqttPort = next->mqttPort;
+  strlcpy(config.mqttUser, next->mqttUser, sizeof(config.mqttUser));
+  strlcpy(config.mqttPassword, next->mqttPassword, sizeof(config.mqttPassword));
+  strlcpy(config.groups, next->groups, sizeof(config.groups));  // Abonnés à la connexion
+  mqttTransportBegin(config.mqttServer, config.mqttPort, mqtt_callback, onMqttConnected);
+  mqttEnabled = strlen(config.mqttServer) > 0;
+  Serial.printf("🔄 MQTT reconnecting as %s to %s:%d\n", config.deviceName, config.mqttServer, config.mqttPort);
+}
 
-    // Subscribe to time sync topic (commun à tous les ESP32)
-    mqttClient.subscribe("esp32/time/sync");
-    Serial.printf("✓ Abonné à: esp32/time/sync\n");
-    
-    // Subscribe to ping topic for latency measurement (géré par le PC)
-    String pingTopic = String(config.deviceName) + "/ping";
-    mqttClient.subscribe(pingTopic.c_str());
-    Serial.printf("✓ Abonné à: %s\n", pingTopic.c_str());
-    
-    Serial.println("========================================");
-    Serial.println();
+void setupMQTT() {
+  if (mqttMutex == NULL) {
+    mqttMutex = xSemaphoreCreateRecursiveMutex();
+    dedupMutex = xSemaphoreCreateRecursiveMutex();
+  }
+  MqttLock lock;
+  mqttTransportBegin(config.mqttServer, config.mqttPort, mqtt_callback, onMqttConnected);
+  Serial.printf("MQTT setup (%s, buffer %d, QoS %d).\n", mqttTransportName(), MQTT_BUFFER_SIZE, MQTT_PUBLISH_QOS);
+}
 
-    // Publish current state of all pins as retained messages
-    for (int i = 0; i < ioPinCount; i++) {
-        JsonDocument doc;
-        doc["state"] = ioPins[i].state ? "ON" : "OFF";
-        doc["timestamp"] = time(nullptr);
+void loopMQTT() {
+  MqttLock lock;
+  mqttTransportLoop();
+}
 
-        char jsonBuffer[128];
-        serializeJson(doc, jsonBuffer);
+void disconnectMQTT() {
+  MqttLock lock;
+  mqttTransportDisconnect();
+}
 
-        char statusTopic[128];
-        snprintf(statusTopic, sizeof(statusTopic), "%s/status/%s", config.deviceName, ioPins[i].name);
-        publishMQTT(statusTopic, jsonBuffer, true);
-    }
+// Sans verrou : lecture d'état seule, et le serveur web ne doit pas attendre
+// un connect() PubSubClient bloquant dans NetTask
+bool mqttConnected() {
+  return mqttTransportConnected();
+}
 
+void reconnectMQTT() {
+  MqttLock lock;
+  // Perte de connexion journalisée une fois, pas à chaque tentative
+  if (mqttWasConnected) {
+    mqttWasConnected = false;
+    eventLogWrite(EVENT_MQTT_DISCONNECT, 0, (uint32_t)mqttTransportState());
+  }
+  Serial.print("Attempting MQTT connection...");
+  // Session persistante : le broker retrouve abonnements et commandes QoS 1 par client ID
+  char clientId[64];
+  if (MQTT_PERSISTENT_SESSION) {
+    snprintf(clientId, sizeof(clientId), "ESP32-IO-Controller-%s", config.deviceName);
   } else {
+    snprintf(clientId, sizeof(clientId), "ESP32-IO-Controller-%lx", (unsigned long)random(0xffff));
+  }
+
+  // Last Will : "offline" retenu si la connexion tombe sans DISCONNECT
+  char availabilityTopic[128];
+  snprintf(availabilityTopic, sizeof(availabilityTopic), "%s/availability", config.deviceName);
+
+  if (!mqttTransportConnect(clientId, config.mqttUser, config.mqttPassword,
+                            availabilityTopic, "offline", !MQTT_PERSISTENT_SESSION)) {
     Serial.print("failed, rc=");
-    Serial.print(mqttClient.state());
+    Serial.print(mqttTransportState());
     Serial.println(" try again in 5 seconds");
+  } else if (!mqttTransportConnected()) {
+    Serial.println("pending");  // Connexion asynchrone : suite dans onMqttConnected
   }
 }
 
 void publishMQTT(const char* topic, const char* payload, boolean retained) {
-    if (mqttClient.connected()) {
-        if (mqttClient.publish(topic, payload, retained)) {
-            Serial.printf("[%s] MQTT message published to [%s]: %s\n", getFormattedTime().c_str(), topic, payload);
+    MqttLock lock;
+    if (mqttTransportConnected()) {
+        if (mqttTransportPublish(topic, (const uint8_t*)payload, strlen(payload), retained, MQTT_PUBLISH_QOS)) {
+            char timeStr[20];
+            Serial.printf("[%s] MQTT message published to [%s]: %s\n", formatTime(timeStr, sizeof(timeStr)), topic, payload);
         } else {
-            Serial.printf("[%s] MQTT publish failed to [%s]\n", getFormattedTime().c_str(), topic);
+            char timeStr[20];
+            Serial.printf("[%s] MQTT publish failed to [%s]\n", formatTime(timeStr, sizeof(timeStr)), topic);
         }
     }
 }
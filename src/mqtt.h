@@ -1,31 +1,58 @@
 #ifndef MQTT_H
 #define MQTT_H
 
-#include <WiFi.h>
-#include <PubSubClient.h>
+#include <Arduino.h>
 #include "config.h"
 
+// Demande d'instantané adressée à toute la flotte (voir publishStatusSnapshot)
+#define STATUS_REQUEST_TOPIC "esp32/status/get"
+
 // externs provided by other translation units
-extern WiFiClient wifiClient;
-extern PubSubClient mqttClient;
 extern Config config;
-extern IOPin ioPins[];
-extern int ioPinCount;
-extern ScheduledCommand scheduledCommands[];
 // Control whether MQTT subsystem should be active (can be toggled at runtime)
 extern bool mqttEnabled;
 
 // Fonction pour faire clignoter la LED (définie dans main.cpp)
 void blinkStatusLED(int times, int delayMs);
+// Persistance de la configuration (définie dans main.cpp)
+void saveConfig();
 
 // Fonction pour obtenir le temps avec précision microseconde
 uint64_t getCurrentTimeMicros();
 
 // MQTT API
+// Toutes les fonctions ci-dessous sont protégées par un mutex et peuvent être
+// appelées depuis n'importe quelle tâche (réseau, exécuteur, I/O, serveur web).
 void setupMQTT();
 void reconnectMQTT();
+void loopMQTT();
+void disconnectMQTT();
+bool mqttConnected();
 void publishMQTT(const char* sub_topic, const char* payload, boolean retained = false);
 void mqtt_callback(char* topic, byte* payload, unsigned int length);
+// Écrit la sortie (CmdTask) ; son état est déposé dans la file de publication
 void executeCommand(int pin, int state);
+// Remplace l'appartenance aux groupes de diffusion et met à jour les abonnements
+// sans reconnexion (la persistance reste à la charge de l'appelant)
+void setMqttGroups(const char* groups);
+// Applique à chaud nom, broker, identifiants, topic et groupes de next.
+// reconnect : session refermée ("offline" publié sur l'ancien topic de
+// disponibilité) pour que NetTask se reconnecte avec la nouvelle identité ;
+// sinon seuls les abonnements de groupe sont ajustés (voir config_reload.h)
+void applyMqttConfig(const Config* next, bool reconnect);
+// Acquittement d'une commande identifiée sur <device>/ack (sans effet si id est vide),
+// déposé dans la file de publication : ne prend pas MqttLock.
+// actuation_us : délai de commutation de la sortie, ajoute contact_us (contact attendu)
+void publishCommandAck(const char* id, int state, const char* status,
+                       uint64_t received_us, uint64_t scheduled_us, uint64_t executed_us,
+                       uint32_t actuation_us = 0);
+// NetTask : publie les états et acquittements en attente (file vidée hors connexion)
+void mqttFlushOutbound();
+// Retire l'id du cache d'idempotence : à appeler sur chaque refus ("rejected"),
+// pour que la nouvelle tentative de l'émetteur soit exécutée et non "duplicate"
+void commandIdForget(const char* id);
+// Instantané retenu de toutes les I/O et de la santé sur <device>/status.
+// reason : "connect" ou "request" ; requestId (optionnel) est renvoyé dans "id"
+void publishStatusSnapshot(const char* reason, const char* requestId = nullptr);
 
 #endif // MQTT_H
@@ -0,0 +1,81 @@
+#ifndef MQTT_TRANSPORT_H
+#define MQTT_TRANSPORT_H
+
+#include <Arduino.h>
+
+// ===== MQTT TRANSPORT =====
+// Couche d'accès au broker, choisie à la compilation :
+//   MQTT_BACKEND_ASYNC=0 : PubSubClient, synchrone, interrogé par NetTask (loopMQTT)
+//   MQTT_BACKEND_ASYNC=1 : AsyncMqttClient sur AsyncTCP, piloté par événements ;
+//                          les messages arrivent depuis la tâche async_tcp.
+// mqtt.cpp n'appelle que les fonctions ci-dessous et sérialise les appels (MqttLock).
+#ifndef MQTT_BACKEND_ASYNC
+#define MQTT_BACKEND_ASYNC 0
+#endif
+
+// Taille max d'un paquet (PubSubClient) ou d'un message réassemblé (async)
+#ifndef MQTT_BUFFER_SIZE
+#define MQTT_BUFFER_SIZE 1024
+#endif
+#ifndef MQTT_KEEPALIVE_SEC
+#define MQTT_KEEPALIVE_SEC 15
+#endif
+
+#if MQTT_BACKEND_ASYNC
+#ifndef MQTT_PUBLISH_QOS
+#define MQTT_PUBLISH_QOS 1          // Statuts et acquittements en QoS 1
+#endif
+#ifndef MQTT_SUBSCRIBE_QOS
+#define MQTT_SUBSCRIBE_QOS 1        // Commandes conservées par le broker pendant une coupure
+#endif
+#ifndef MQTT_PERSISTENT_SESSION
+#define MQTT_PERSISTENT_SESSION 1   // Client ID stable + cleanSession=false
+#endif
+#else
+#ifndef MQTT_PUBLISH_QOS
+#define MQTT_PUBLISH_QOS 0          // PubSubClient ne publie qu'en QoS 0
+#endif
+#ifndef MQTT_SUBSCRIBE_QOS
+#define MQTT_SUBSCRIBE_QOS 0
+#endif
+#ifndef MQTT_PERSISTENT_SESSION
+#define MQTT_PERSISTENT_SESSION 0
+#endif
+#endif
+
+// Publications QoS 1 non acquittées au-delà desquelles on repasse en QoS 0
+#ifndef MQTT_MAX_INFLIGHT
+#define MQTT_MAX_INFLIGHT 16
+#endif
+
+typedef void (*MqttMessageHandler)(char* topic, byte* payload, unsigned int length);
+typedef void (*MqttConnectHandler)();
+
+struct MqttTransportStats {
+  uint32_t published;      // Publications acceptées par le client
+  uint32_t publishFailed;  // Refusées (déconnecté, paquet trop grand, tampon TCP plein)
+  uint32_t qos1Acked;      // PUBACK reçus
+  uint32_t qos1Downgraded; // Envoyées en QoS 0 faute de place dans la fenêtre
+  uint32_t inFlight;       // QoS 1 en attente de PUBACK
+  uint32_t received;       // Messages livrés à mqtt_callback
+  uint32_t dropped;        // Messages entrants plus grands que MQTT_BUFFER_SIZE
+};
+
+// onMessage : appelé pour chaque message complet. onConnect : appelé une fois la
+// session établie (dans reconnectMQTT pour PubSubClient, depuis async_tcp sinon).
+void mqttTransportBegin(const char* host, uint16_t port, MqttMessageHandler onMessage, MqttConnectHandler onConnect);
+// Synchrone pour PubSubClient ; pour l'async, lance la connexion et renvoie
+// true si elle a démarré (le résultat arrive par onConnect).
+bool mqttTransportConnect(const char* clientId, const char* user, const char* password,
+                          const char* willTopic, const char* willPayload, bool cleanSession);
+void mqttTransportDisconnect();
+bool mqttTransportConnected();
+void mqttTransportLoop();
+bool mqttTransportPublish(const char* topic, const uint8_t* payload, size_t length, bool retained, uint8_t qos);
+bool mqttTransportSubscribe(const char* topic, uint8_t qos);
+bool mqttTransportUnsubscribe(const char* topic);
+int mqttTransportState();
+const char* mqttTransportName();
+void mqttTransportGetStats(MqttTransportStats* out);
+
+#endif // MQTT_TRANSPORT_H
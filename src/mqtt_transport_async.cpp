@@ -0,0 +1,179 @@
+#include "mqtt_transport.h"
+
+#if MQTT_BACKEND_ASYNC
+
+#include <AsyncMqttClient.h>
+#include <atomic>
+
+// ===== BACKEND ASYNCMQTTCLIENT =====
+// Client piloté par les événements AsyncTCP : pas d'interrogation, un message est
+// remis à mqtt_callback dès son arrivée, depuis la tâche async_tcp. QoS 1 en
+// émission avec une fenêtre de MQTT_MAX_INFLIGHT messages non acquittés.
+
+static AsyncMqttClient mqttClient;
+
+static MqttConnectHandler connectHandler = nullptr;
+static MqttMessageHandler messageHandler = nullptr;
+
+// AsyncMqttClient garde les pointeurs passés à setClientId/setCredentials/setWill
+static char clientIdBuf[48];
+static char userBuf[32];
+static char passwordBuf[32];
+static char willTopicBuf[128];
+static char willPayloadBuf[16];
+
+// Réassemblage des messages livrés en plusieurs segments TCP (tâche async_tcp uniquement)
+static uint8_t rxBuffer[MQTT_BUFFER_SIZE];
+
+static std::atomic<uint32_t> inFlight(0);
+static std::atomic<uint32_t> published(0);
+static std::atomic<uint32_t> publishFailed(0);
+static std::atomic<uint32_t> qos1Acked(0);
+static std::atomic<uint32_t> qos1Downgraded(0);
+static std::atomic<uint32_t> received(0);
+static std::atomic<uint32_t> dropped(0);
+static std::atomic<int> lastDisconnectReason(-1);
+
+static void onAsyncConnect(bool sessionPresent) {
+  lastDisconnectReason = 0;
+  Serial.printf("✓ MQTT session %s\n", sessionPresent ? "resumed" : "created");
+  if (connectHandler) connectHandler();
+}
+
+static void onAsyncDisconnect(AsyncMqttClientDisconnectReason reason) {
+  lastDisconnectReason = (int)reason;
+  // Les PUBACK en attente ne viendront plus : la fenêtre repart de zéro
+  inFlight = 0;
+  Serial.printf("⚠️ MQTT disconnected (reason %d)\n", (int)reason);
+}
+
+static void onAsyncPublish(uint16_t packetId) {
+  (void)packetId;
+  qos1Acked++;
+  if (inFlight > 0) inFlight--;
+}
+
+static void onAsyncMessage(char* topic, char* payload, AsyncMqttClientMessageProperties properties,
+                           size_t len, size_t index, size_t total) {
+  (void)properties;
+  if (total > MQTT_BUFFER_SIZE) {
+    if (index == 0) {
+      dropped++;
+      Serial.printf("⚠️ MQTT message of %u bytes on [%s] dropped (buffer %d)\n", (unsigned)total, topic, MQTT_BUFFER_SIZE);
+    }
+    return;
+  }
+
+  // Cas courant : message entier dans un seul segment, pas de copie
+  if (index == 0 && len == total) {
+    received++;
+    if (messageHandler) messageHandler(topic, (byte*)payload, total);
+    return;
+  }
+
+  memcpy(rxBuffer + index, payload, len);
+  if (index + len == total) {
+    received++;
+    if (messageHandler) messageHandler(topic, rxBuffer, total);
+  }
+}
+
+void mqttTransportBegin(const char* host, uint16_t port, MqttMessageHandler onMessage, MqttConnectHandler onConnect) {
+  messageHandler = onMessage;
+  connectHandler = onConnect;
+  mqttClient.setServer(host, port);
+  mqttClient.setKeepAlive(MQTT_KEEPALIVE_SEC);
+
+  // Rappelé à chaque rechargement de la configuration : les setters on*()
+  // d'AsyncMqttClient ajoutent à une liste, chaque callback doit l'être une fois
+  static bool callbacksRegistered = false;
+  if (callbacksRegistered) return;
+  callbacksRegistered = true;
+  mqttClient.onConnect(onAsyncConnect);
+  mqttClient.onDisconnect(onAsyncDisconnect);
+  mqttClient.onPublish(onAsyncPublish);
+  mqttClient.onMessage(onAsyncMessage);
+}
+
+bool mqttTransportConnect(const char* clientId, const char* user, const char* password,
+                          const char* willTopic, const char* willPayload, bool cleanSession) {
+  if (mqttClient.connected()) return true;
+
+  strlcpy(clientIdBuf, clientId, sizeof(clientIdBuf));
+  mqttClient.setClientId(clientIdBuf);
+  mqttClient.setCleanSession(cleanSession);
+  if (user != nullptr && user[0] != '\0') {
+    strlcpy(userBuf, user, sizeof(userBuf));
+    strlcpy(passwordBuf, password ? password : "", sizeof(passwordBuf));
+    mqttClient.setCredentials(userBuf, passwordBuf[0] ? passwordBuf : nullptr);
+  } else {
+    mqttClient.setCredentials(nullptr);  // Identifiants retirés par un rechargement de la configuration
+  }
+  if (willTopic != nullptr && willTopic[0] != '\0') {
+    strlcpy(willTopicBuf, willTopic, sizeof(willTopicBuf));
+    strlcpy(willPayloadBuf, willPayload ? willPayload : "", sizeof(willPayloadBuf));
+    mqttClient.setWill(willTopicBuf, 1, true, willPayloadBuf);
+  }
+
+  mqttClient.connect();
+  return true;
+}
+
+void mqttTransportDisconnect() {
+  mqttClient.disconnect();
+}
+
+bool mqttTransportConnected() {
+  return mqttClient.connected();
+}
+
+void mqttTransportLoop() {
+  // Rien à interroger : AsyncTCP livre les paquets par événement
+}
+
+bool mqttTransportPublish(const char* topic, const uint8_t* payload, size_t length, bool retained, uint8_t qos) {
+  if (qos > 0 && inFlight >= MQTT_MAX_INFLIGHT) {
+    // Broker lent ou lien saturé : ne pas accumuler de QoS 1 sans fin
+    qos = 0;
+    qos1Downgraded++;
+  }
+  // Compté avant l'envoi : le PUBACK peut arriver avant le retour de publish()
+  if (qos > 0) inFlight++;
+  uint16_t packetId = mqttClient.publish(topic, qos > 0 ? 1 : 0, retained, (const char*)payload, length);
+  if (packetId == 0) {
+    if (qos > 0 && inFlight > 0) inFlight--;
+    publishFailed++;
+    return false;
+  }
+  published++;
+  return true;
+}
+
+bool mqttTransportSubscribe(const char* topic, uint8_t qos) {
+  return mqttClient.subscribe(topic, qos > 1 ? 1 : qos) != 0;
+}
+
+bool mqttTransportUnsubscribe(const char* topic) {
+  return mqttClient.unsubscribe(topic) != 0;
+}
+
+int mqttTransportState() {
+  // 0 une fois connecté, sinon la dernière AsyncMqttClientDisconnectReason (-1 : jamais connecté)
+  return lastDisconnectReason;
+}
+
+const char* mqttTransportName() {
+  return "asyncmqttclient";
+}
+
+void mqttTransportGetStats(MqttTransportStats* out) {
+  out->published = published;
+  out->publishFailed = publishFailed;
+  out->qos1Acked = qos1Acked;
+  out->qos1Downgraded = qos1Downgraded;
+  out->inFlight = inFlight;
+  out->received = received;
+  out->dropped = dropped;
+}
+
+#endif // MQTT_BACKEND_ASYNC
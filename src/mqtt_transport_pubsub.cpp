@@ -0,0 +1,87 @@
+#include "mqtt_transport.h"
+
+#if !MQTT_BACKEND_ASYNC
+
+#include <WiFi.h>
+#include <PubSubClient.h>
+
+// ===== BACKEND PUBSUBCLIENT =====
+// Client synchrone : connect() bloque jusqu'au CONNACK et les messages ne sont
+// reçus que dans mqttTransportLoop(), appelé par NetTask. Tous les appels
+// passent par MqttLock (mqtt.cpp), y compris mqtt_callback qui s'exécute dans loop().
+
+static WiFiClient wifiClient;
+static PubSubClient mqttClient(wifiClient);
+
+static MqttConnectHandler connectHandler = nullptr;
+static MqttMessageHandler messageHandler = nullptr;
+static MqttTransportStats stats;
+
+static void onPubSubMessage(char* topic, byte* payload, unsigned int length) {
+  stats.received++;
+  if (messageHandler) messageHandler(topic, payload, length);
+}
+
+void mqttTransportBegin(const char* host, uint16_t port, MqttMessageHandler onMessage, MqttConnectHandler onConnect) {
+  messageHandler = onMessage;
+  connectHandler = onConnect;
+  mqttClient.setServer(host, port);
+  mqttClient.setCallback(onPubSubMessage);
+  mqttClient.setKeepAlive(MQTT_KEEPALIVE_SEC);
+  if (!mqttClient.setBufferSize(MQTT_BUFFER_SIZE)) {
+    Serial.printf("⚠️ MQTT buffer of %d bytes not allocated, keeping %u\n", MQTT_BUFFER_SIZE, mqttClient.getBufferSize());
+  }
+}
+
+bool mqttTransportConnect(const char* clientId, const char* user, const char* password,
+                          const char* willTopic, const char* willPayload, bool cleanSession) {
+  if (!mqttClient.connect(clientId, user, password, willTopic, 1, true, willPayload, cleanSession)) {
+    return false;
+  }
+  if (connectHandler) connectHandler();
+  return true;
+}
+
+void mqttTransportDisconnect() {
+  mqttClient.disconnect();
+}
+
+bool mqttTransportConnected() {
+  return mqttClient.connected();
+}
+
+void mqttTransportLoop() {
+  mqttClient.loop();
+}
+
+bool mqttTransportPublish(const char* topic, const uint8_t* payload, size_t length, bool retained, uint8_t qos) {
+  (void)qos;  // Publications toujours en QoS 0
+  if (mqttClient.publish(topic, payload, length, retained)) {
+    stats.published++;
+    return true;
+  }
+  stats.publishFailed++;
+  return false;
+}
+
+bool mqttTransportSubscribe(const char* topic, uint8_t qos) {
+  return mqttClient.subscribe(topic, qos > 1 ? 1 : qos);
+}
+
+bool mqttTransportUnsubscribe(const char* topic) {
+  return mqttClient.unsubscribe(topic);
+}
+
+int mqttTransportState() {
+  return mqttClient.state();
+}
+
+const char* mqttTransportName() {
+  return "pubsubclient";
+}
+
+void mqttTransportGetStats(MqttTransportStats* out) {
+  *out = stats;
+}
+
+#endif // !MQTT_BACKEND_ASYNC
@@ -0,0 +1,157 @@
+#include <Arduino.h>
+#include <Update.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <mbedtls/sha256.h>
+#include "ota_delta.h"
+
+static DeltaPatch* patch = nullptr;
+static const void* sessionOwner = nullptr;
+static const esp_partition_t* running = nullptr;
+static mbedtls_sha256_context targetHash;
+static bool updateStarted = false;
+static uint32_t patchBytes = 0;
+static uint32_t startMs = 0;
+static uint32_t lastActivityMs = 0;
+static char lastError[64];
+
+static void closeSession() {
+  if (updateStarted) {
+    Update.abort();
+    updateStarted = false;
+  }
+  mbedtls_sha256_free(&targetHash);
+  free(patch);
+  patch = nullptr;
+  sessionOwner = nullptr;
+}
+
+static bool readRunning(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+  (void)ctx;
+  return esp_partition_read(running, offset, buf, len) == ESP_OK;
+}
+
+static bool writeUpdate(void* ctx, const uint8_t* buf, size_t len) {
+  (void)ctx;
+  mbedtls_sha256_update(&targetHash, buf, len);
+  if (Update.write((uint8_t*)buf, len) != len) {
+    snprintf(lastError, sizeof(lastError), "Écriture flash : %s", Update.errorString());
+    return false;
+  }
+  return true;
+}
+
+// En-tête reçu : le patch doit partir de l'image exacte en cours d'exécution
+static bool checkHeader(void* ctx, const DeltaHeader* header) {
+  (void)ctx;
+  if (header->sourceSize > running->size) {
+    strlcpy(lastError, "Image source plus grande que la partition", sizeof(lastError));
+    return false;
+  }
+
+  uint8_t buf[DELTA_IO_CHUNK];
+  uint8_t digest[32];
+  mbedtls_sha256_context sourceHash;
+  mbedtls_sha256_init(&sourceHash);
+  mbedtls_sha256_starts(&sourceHash, 0);
+  for (uint32_t offset = 0; offset < header->sourceSize; offset += sizeof(buf)) {
+    size_t len = min((uint32_t)sizeof(buf), header->sourceSize - offset);
+    if (esp_partition_read(running, offset, buf, len) != ESP_OK) {
+      mbedtls_sha256_free(&sourceHash);
+      strlcpy(lastError, "Lecture de l'image en cours impossible", sizeof(lastError));
+      return false;
+    }
+    mbedtls_sha256_update(&sourceHash, buf, len);
+  }
+  mbedtls_sha256_finish(&sourceHash, digest);
+  mbedtls_sha256_free(&sourceHash);
+  if (memcmp(digest, header->sourceSha256, sizeof(digest)) != 0) {
+    strlcpy(lastError, "Patch prévu pour une autre version du firmware", sizeof(lastError));
+    return false;
+  }
+
+  if (!Update.begin(header->targetSize, U_FLASH)) {
+    snprintf(lastError, sizeof(lastError), "Update.begin : %s", Update.errorString());
+    return false;
+  }
+  updateStarted = true;
+  mbedtls_sha256_starts(&targetHash, 0);
+  Serial.printf("🔄 Delta OTA: %lu -> %lu bytes, writing %s\n", (unsigned long)header->sourceSize,
+                (unsigned long)header->targetSize, esp_ota_get_next_update_partition(NULL)->label);
+  return true;
+}
+
+bool otaDeltaBegin(const void* owner) {
+  if (patch != nullptr) {
+    if (millis() - lastActivityMs < OTA_DELTA_IDLE_TIMEOUT_MS) return false;
+    Serial.println("⚠️ Delta OTA: stale session aborted");
+    closeSession();
+  }
+
+  running = esp_ota_get_running_partition();
+  patch = (DeltaPatch*)malloc(sizeof(DeltaPatch));
+  if (running == nullptr || patch == nullptr) {
+    free(patch);
+    patch = nullptr;
+    return false;
+  }
+  deltaPatchBegin(patch, readRunning, writeUpdate, nullptr, checkHeader);
+  mbedtls_sha256_init(&targetHash);
+  sessionOwner = owner;
+  updateStarted = false;
+  patchBytes = 0;
+  lastError[0] = '\0';
+  startMs = millis();
+  lastActivityMs = startMs;
+  return true;
+}
+
+bool otaDeltaWrite(const void* owner, const uint8_t* data, size_t len) {
+  if (patch == nullptr || owner != sessionOwner) return false;
+  lastActivityMs = millis();
+  patchBytes += len;
+  return deltaPatchFeed(patch, data, len) >= 0;
+}
+
+void otaDeltaEnd(const void* owner, OtaDeltaResult* result) {
+  memset(result, 0, sizeof(OtaDeltaResult));
+  if (patch == nullptr) {
+    result->status = DELTA_ERR_TRUNCATED;
+    strlcpy(result->message, "Aucun patch reçu", sizeof(result->message));
+    return;
+  }
+  if (owner != sessionOwner) {
+    result->status = DELTA_ERR_REJECTED;
+    strlcpy(result->message, "Une autre mise à jour est en cours", sizeof(result->message));
+    return;
+  }
+
+  result->status = deltaPatchFinish(patch);
+  result->patchBytes = patchBytes;
+  result->targetBytes = deltaPatchProgress(patch);
+  result->durationMs = millis() - startMs;
+
+  if (result->status == DELTA_DONE) {
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&targetHash, digest);
+    if (memcmp(digest, patch->header.targetSha256, sizeof(digest)) != 0) {
+      result->status = DELTA_ERR_CORRUPT;
+      strlcpy(lastError, "SHA-256 de l'image reconstruite incorrect", sizeof(lastError));
+    } else if (!Update.end(true)) {
+      result->status = DELTA_ERR_WRITE;
+      snprintf(lastError, sizeof(lastError), "Update.end : %s", Update.errorString());
+    } else {
+      updateStarted = false;  // Image validée et amorçable : rien à annuler
+    }
+  }
+
+  if (result->status == DELTA_DONE) {
+    strlcpy(result->message, "Image vérifiée, redémarrage...", sizeof(result->message));
+  } else {
+    strlcpy(result->message, lastError[0] ? lastError : deltaStatusName(result->status), sizeof(result->message));
+  }
+  Serial.printf("%s Delta OTA: %s (%lu patch bytes -> %lu image bytes, %lu ms)\n",
+                result->status == DELTA_DONE ? "✓" : "❌", result->message, (unsigned long)result->patchBytes,
+                (unsigned long)result->targetBytes, (unsigned long)result->durationMs);
+  closeSession();
+}
@@ -0,0 +1,35 @@
+#ifndef OTA_DELTA_H
+#define OTA_DELTA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "delta_patch.h"
+
+// ===== MISE À JOUR DIFFÉRENTIELLE (OTA delta) =====
+// Reçoit un patch ota_delta.py par morceaux (POST /api/ota/delta) et reconstruit
+// l'image cible dans la partition OTA inactive (Update) en lisant l'image en
+// cours d'exécution, avec DELTA_IO_CHUNK octets de lecture / écriture à la fois.
+// Contrôles : SHA-256 de l'image en cours avant la première écriture (patch
+// prévu pour une autre version), SHA-256 de l'image reconstruite avant de la
+// rendre amorçable, puis la vérification d'image habituelle d'Update.
+// Une seule mise à jour à la fois ; l'état (~5 Ko) n'est alloué que pendant.
+
+#define OTA_DELTA_IDLE_TIMEOUT_MS 30000   // Envoi interrompu : la session est abandonnée
+
+struct OtaDeltaResult {
+  int8_t status;            // DeltaStatus (DELTA_DONE si l'image est prête)
+  uint32_t patchBytes;      // Octets de patch reçus
+  uint32_t targetBytes;     // Octets d'image écrits
+  uint32_t durationMs;
+  char message[64];
+};
+
+// Ouvre une session pour owner (la requête HTTP) ; false si une autre est en cours
+bool otaDeltaBegin(const void* owner);
+// Morceau suivant du patch ; false dès qu'une erreur est survenue
+bool otaDeltaWrite(const void* owner, const uint8_t* data, size_t len);
+// Fin du patch : vérifie l'image et la rend amorçable si tout est correct.
+// Le redémarrage reste à la charge de l'appelant.
+void otaDeltaEnd(const void* owner, OtaDeltaResult* result);
+
+#endif // OTA_DELTA_H
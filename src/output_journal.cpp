@@ -0,0 +1,136 @@
+#include "output_journal.h"
+#include <atomic>
+#include <freertos/semphr.h>
+#include "event_log.h"
+
+// ===== ACCÈS À LA FLASH =====
+#ifdef ESP_PLATFORM
+#include <esp_partition.h>
+
+static bool partitionRead(void* ctx, uint32_t offset, void* buf, size_t len) {
+  return esp_partition_read((const esp_partition_t*)ctx, offset, buf, len) == ESP_OK;
+}
+
+static bool partitionWrite(void* ctx, uint32_t offset, const void* buf, size_t len) {
+  return esp_partition_write((const esp_partition_t*)ctx, offset, buf, len) == ESP_OK;
+}
+
+static bool partitionErase(void* ctx, uint32_t offset, size_t len) {
+  return esp_partition_erase_range((const esp_partition_t*)ctx, offset, len) == ESP_OK;
+}
+
+static StateJournalFlash partitionFlash = { partitionRead, partitionWrite, partitionErase, NULL };
+
+static const StateJournalFlash* openFlash(uint8_t* sectors) {
+  const esp_partition_t* part =
+      esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, OUTPUT_JOURNAL_PARTITION);
+  if (part == NULL) return NULL;
+  uint32_t count = part->size / STATE_JOURNAL_SECTOR_SIZE;
+  *sectors = count > STATE_JOURNAL_MAX_SECTORS ? STATE_JOURNAL_MAX_SECTORS : count;
+  partitionFlash.ctx = (void*)part;
+  return &partitionFlash;
+}
+#else
+// Simulateur : zone émulée dans un fichier (option --flash)
+#include "sim_flash.h"
+static const StateJournalFlash* openFlash(uint8_t* sectors) {
+  return simFlashOpen(OUTPUT_JOURNAL_PARTITION, sectors);
+}
+#endif
+
+// ===== ÉTAT =====
+// États connus en RAM, bit n = GPIO n, modifiés sans verrou par executeCommand.
+// dirty est levé après la modification : une écriture qui manque un changement
+// laisse dirty levé, le changement part à l'écriture suivante.
+static std::atomic<uint32_t> stateWords[2];
+static std::atomic<uint32_t> knownWords[2];
+static std::atomic<bool> dirty(false);
+static std::atomic<uint32_t> dirtySinceMs(0);
+static std::atomic<uint32_t> recorded(0);
+
+static StateJournal journal;              // Accès flash : NetTask, ou un redémarrage forcé
+static SemaphoreHandle_t journalMutex = NULL;
+static bool available = false;
+static uint8_t restoredPins = 0;
+static uint32_t restoreUs = 0;
+
+struct JournalLock {
+  JournalLock() { xSemaphoreTakeRecursive(journalMutex, portMAX_DELAY); }
+  ~JournalLock() { xSemaphoreGiveRecursive(journalMutex); }
+};
+
+void outputJournalBegin() {
+#if OUTPUT_JOURNAL_ENABLED
+  uint32_t startUs = micros();
+  uint8_t sectors = 0;
+  const StateJournalFlash* flash = openFlash(&sectors);
+  if (flash == NULL || sectors < 2) {
+    Serial.println("⚠️ Output journal: no '" OUTPUT_JOURNAL_PARTITION "' partition, outputs start at defaultState");
+    return;
+  }
+
+  StateSnapshot restored;
+  stateJournalOpen(&journal, flash, sectors, &restored);
+  for (int w = 0; w < 2; w++) {
+    stateWords[w].store((uint32_t)(restored.states >> (32 * w)));
+    knownWords[w].store((uint32_t)(restored.known >> (32 * w)));
+  }
+  restoreUs = micros() - startUs;
+  restoredPins = __builtin_popcountll(restored.known);
+  journalMutex = xSemaphoreCreateRecursiveMutex();
+  available = true;
+
+  Serial.printf("✓ Output journal: %u GPIO states read in %lu us (sector %u/%u, slot %u)\n", restoredPins,
+                (unsigned long)restoreUs, journal.sector, sectors, journal.nextSlot);
+  eventLogWrite(EVENT_OUTPUT_RESTORE, restoredPins, restoreUs);
+#endif
+}
+
+bool outputJournalLastState(uint8_t gpio, bool* state) {
+  if (!available || gpio >= STATE_JOURNAL_GPIO_COUNT) return false;
+  uint32_t bit = 1UL << (gpio & 31);
+  if ((knownWords[gpio >> 5].load() & bit) == 0) return false;
+  *state = (stateWords[gpio >> 5].load() & bit) != 0;
+  return true;
+}
+
+void outputJournalRecord(uint8_t gpio, bool state) {
+  if (!available || gpio >= STATE_JOURNAL_GPIO_COUNT) return;
+  uint32_t bit = 1UL << (gpio & 31);
+  if (state) stateWords[gpio >> 5].fetch_or(bit);
+  else stateWords[gpio >> 5].fetch_and(~bit);
+  knownWords[gpio >> 5].fetch_or(bit);
+  recorded++;
+  // Début de la fenêtre de regroupement : premier changement non écrit
+  if (!dirty.load()) dirtySinceMs.store(millis());
+  dirty.store(true);
+}
+
+void outputJournalFlush(uint32_t nowMs, bool force) {
+  if (!available || !dirty.load()) return;
+  if (!force && nowMs - dirtySinceMs.load() < OUTPUT_JOURNAL_COMMIT_MS) return;
+
+  JournalLock lock;
+  if (!dirty.exchange(false)) return;  // Écrit entre-temps par l'autre appelant
+  StateSnapshot snapshot;
+  snapshot.states = stateWords[0].load() | ((uint64_t)stateWords[1].load() << 32);
+  snapshot.known = knownWords[0].load() | ((uint64_t)knownWords[1].load() << 32);
+  if (!stateJournalCommit(&journal, &snapshot)) {
+    Serial.println("⚠️ Output journal: flash write failed, retrying later");
+    dirtySinceMs.store(nowMs);
+    dirty.store(true);
+  }
+}
+
+void outputJournalGetStats(OutputJournalStats* stats) {
+  stats->available = available;
+  stats->restoredPins = restoredPins;
+  stats->restoreUs = restoreUs;
+  stats->commits = journal.commits;
+  stats->erases = journal.erases;
+  stats->writeErrors = journal.writeErrors;
+  stats->recorded = recorded.load();
+  stats->sectors = journal.sectorCount;
+  stats->sector = journal.sector;
+  stats->slot = journal.nextSlot;
+}
@@ -0,0 +1,52 @@
+#ifndef OUTPUT_JOURNAL_H
+#define OUTPUT_JOURNAL_H
+
+#include <Arduino.h>
+#include "state_journal.h"
+
+// ===== JOURNAL DES SORTIES (restauration après coupure) =====
+// Les changements d'état des sorties RESTORE_LAST (IOPin::restorePolicy) sont
+// notés en RAM par executeCommand. NetTask les regroupe et les écrit en flash
+// (state_journal.h) OUTPUT_JOURNAL_COMMIT_MS après le premier changement non
+// écrit : une rafale de commandes coûte une seule écriture de 16 octets.
+// Au démarrage, le dernier état est relu avant applyIOPinModes, donc avant le
+// WiFi. Les sorties RESTORE_LAST le reprennent, les autres prennent defaultState.
+//
+// Zone : partition de données "outstate" (partitions.csv, 16 Ko = 4 secteurs).
+// Sans elle (ancienne table de partitions), le journal est désactivé et toutes
+// les sorties démarrent à defaultState. Le simulateur l'émule dans un fichier (--flash).
+// Une coupure pendant la fenêtre de regroupement perd les changements non écrits.
+
+#ifndef OUTPUT_JOURNAL_ENABLED
+#define OUTPUT_JOURNAL_ENABLED 1
+#endif
+#ifndef OUTPUT_JOURNAL_COMMIT_MS
+#define OUTPUT_JOURNAL_COMMIT_MS 2000   // Fenêtre de regroupement des changements
+#endif
+#define OUTPUT_JOURNAL_PARTITION "outstate"
+
+struct OutputJournalStats {
+  bool available;          // Zone de flash trouvée
+  uint8_t restoredPins;    // GPIO connus au démarrage
+  uint32_t restoreUs;      // Durée de la relecture au démarrage
+  uint32_t commits;        // Écritures en flash depuis le démarrage
+  uint32_t erases;
+  uint32_t writeErrors;
+  uint32_t recorded;       // Changements notés (regroupés en commits écritures)
+  uint8_t sectors;
+  uint8_t sector;          // Position d'écriture
+  uint16_t slot;
+};
+
+// Une fois, avant applyIOPinModes
+void outputJournalBegin();
+// Dernier état connu d'un GPIO (journal au démarrage, puis commandes reçues)
+bool outputJournalLastState(uint8_t gpio, bool* state);
+// Changement d'état d'une sortie RESTORE_LAST (toute tâche, sans verrou)
+void outputJournalRecord(uint8_t gpio, bool state);
+// NetTask : écrit les changements en attente depuis OUTPUT_JOURNAL_COMMIT_MS,
+// ou tout de suite si force (avant un redémarrage volontaire)
+void outputJournalFlush(uint32_t nowMs, bool force = false);
+void outputJournalGetStats(OutputJournalStats* stats);
+
+#endif // OUTPUT_JOURNAL_H
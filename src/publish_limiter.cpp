@@ -0,0 +1,48 @@
+#include "publish_limiter.h"
+#include <string.h>
+
+void publishLimiterReset(PublishLimiter* pl) {
+  memset(pl, 0, sizeof(PublishLimiter));
+}
+
+static void markPublished(PublishLimiter* pl, bool value, uint32_t nowMs, uint32_t* transitions) {
+  *transitions = pl->transitions;
+  pl->transitions = 0;
+  pl->pending = false;
+  pl->hasPublished = true;
+  pl->lastPublishedValue = value;
+  pl->lastPublishMs = nowMs;
+}
+
+bool publishLimiterOnChange(PublishLimiter* pl, bool value, uint32_t nowMs, uint32_t minIntervalMs, uint32_t* transitions) {
+  pl->transitions++;
+
+  // Front isolé (ou pas de limitation) : aucun délai ajouté
+  if (!pl->hasPublished || minIntervalMs == 0 || (nowMs - pl->lastPublishMs) >= minIntervalMs) {
+    markPublished(pl, value, nowMs, transitions);
+    return true;
+  }
+
+  // Dans la fenêtre : on mémorise seulement la dernière valeur
+  pl->pending = true;
+  pl->pendingValue = value;
+  return false;
+}
+
+bool publishLimiterPoll(PublishLimiter* pl, uint32_t nowMs, uint32_t minIntervalMs, bool suppressUnchanged,
+                        bool* value, uint32_t* transitions) {
+  if (!pl->pending || (nowMs - pl->lastPublishMs) < minIntervalMs) {
+    return false;
+  }
+
+  if (suppressUnchanged && pl->pendingValue == pl->lastPublishedValue) {
+    // Aller-retour complet dans la fenêtre : rien de nouveau à annoncer
+    pl->pending = false;
+    pl->transitions = 0;
+    return false;
+  }
+
+  *value = pl->pendingValue;
+  markPublished(pl, pl->pendingValue, nowMs, transitions);
+  return true;
+}
@@ -0,0 +1,35 @@
+#ifndef PUBLISH_LIMITER_H
+#define PUBLISH_LIMITER_H
+
+#include <stdint.h>
+
+// ===== LIMITATION DU DÉBIT DE PUBLICATION PAR ENTRÉE =====
+// Logique pure (sans dépendance Arduino) placée entre la détection d'un
+// changement d'état et publishMQTT :
+//  - le premier front après une période calme est publié immédiatement ;
+//  - les fronts suivants, dans la fenêtre minIntervalMs, sont fusionnés
+//    (la dernière valeur l'emporte) et publiés à l'expiration de la fenêtre ;
+//  - le nombre de transitions depuis la dernière publication est fourni.
+
+struct PublishLimiter {
+  uint32_t lastPublishMs;
+  bool hasPublished;
+  bool lastPublishedValue;
+  bool pending;           // Une valeur fusionnée attend la fin de la fenêtre
+  bool pendingValue;
+  uint32_t transitions;   // Transitions depuis la dernière publication
+};
+
+void publishLimiterReset(PublishLimiter* pl);
+
+// À appeler à chaque changement d'état détecté. Retourne true si la valeur doit
+// être publiée tout de suite (*transitions reçoit alors le nombre de transitions).
+bool publishLimiterOnChange(PublishLimiter* pl, bool value, uint32_t nowMs, uint32_t minIntervalMs, uint32_t* transitions);
+
+// À appeler à chaque scrutation. Retourne true quand une valeur fusionnée doit
+// être publiée. Si suppressUnchanged est vrai, une valeur revenue à la dernière
+// valeur publiée est abandonnée (utile quand le nombre de transitions n'est pas publié).
+bool publishLimiterPoll(PublishLimiter* pl, uint32_t nowMs, uint32_t minIntervalMs, bool suppressUnchanged,
+                        bool* value, uint32_t* transitions);
+
+#endif // PUBLISH_LIMITER_H
@@ -0,0 +1,27 @@
+#include "pulse_counter.h"
+
+void pulseCounterReset(PulseCounter* pc, uint32_t raw, uint32_t nowMs) {
+  pc->lastRaw = raw;
+  pc->lastSampleMs = nowMs;
+  pc->total = 0;
+  pc->delta = 0;
+  pc->rateMilliHz = 0;
+}
+
+bool pulseCounterSample(PulseCounter* pc, uint32_t raw, uint32_t nowMs, uint32_t intervalMs) {
+  uint32_t elapsedMs = nowMs - pc->lastSampleMs;
+  if (elapsedMs < intervalMs || elapsedMs == 0) {
+    return false;
+  }
+
+  // Différence modulo 2^32 : reste correcte après un débordement du compteur ISR
+  uint32_t delta = raw - pc->lastRaw;
+
+  pc->delta = delta;
+  pc->total += delta;
+  // impulsions * 1000 (ms -> s) * 1000 (Hz -> mHz) / durée en ms
+  pc->rateMilliHz = (uint32_t)(((uint64_t)delta * 1000000ULL) / elapsedMs);
+  pc->lastRaw = raw;
+  pc->lastSampleMs = nowMs;
+  return true;
+}
@@ -0,0 +1,28 @@
+#ifndef PULSE_COUNTER_H
+#define PULSE_COUNTER_H
+
+#include <stdint.h>
+
+// ===== AGRÉGATION DES COMPTEURS D'IMPULSIONS =====
+// Logique pure (sans dépendance Arduino) pour les entrées en mode COUNTER.
+// Le comptage brut est fait par une ISR (onPulseISR, io_task.cpp) qui incrémente un
+// compteur 32 bits ; la tâche I/O échantillonne ce compteur et, à chaque
+// intervalle de publication, calcule le delta et la fréquence.
+
+struct PulseCounter {
+  uint32_t lastRaw;        // Valeur brute du compteur ISR au dernier échantillon
+  uint32_t lastSampleMs;   // millis() au dernier échantillon publié
+  uint64_t total;          // Nombre total d'impulsions depuis la configuration
+  uint32_t delta;          // Impulsions sur le dernier intervalle
+  uint32_t rateMilliHz;    // Fréquence moyenne sur le dernier intervalle (mHz)
+};
+
+// Initialise l'agrégateur à partir de la valeur brute courante
+void pulseCounterReset(PulseCounter* pc, uint32_t raw, uint32_t nowMs);
+
+// Échantillonne le compteur brut. Retourne true quand intervalMs est écoulé :
+// delta, total et rateMilliHz sont alors mis à jour et doivent être publiés.
+// Le débordement du compteur brut est géré par l'arithmétique non signée.
+bool pulseCounterSample(PulseCounter* pc, uint32_t raw, uint32_t nowMs, uint32_t intervalMs);
+
+#endif // PULSE_COUNTER_H
@@ -0,0 +1,293 @@
+#include "schedule.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+const char* const SCHEDULE_WEEKDAY_NAMES[7] = { "sun", "mon", "tue", "wed", "thu", "fri", "sat" };
+
+static const char* const SCHEDULE_KIND_NAMES[] = { "", "daily", "weekly", "interval" };
+#define SCHEDULE_KIND_COUNT (sizeof(SCHEDULE_KIND_NAMES) / sizeof(SCHEDULE_KIND_NAMES[0]))
+
+#define SECONDS_PER_DAY 86400LL
+
+// ===== DATES CIVILES =====
+// Conversions jour <-> date grégorienne sans table ni localtime() : le calcul
+// est le même sur l'ESP32 et sur l'hôte, quel que soit le TZ du processus.
+
+static int64_t floorDiv(int64_t a, int64_t b) {
+  int64_t q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// Jours depuis 1970-01-01 pour (année, mois 1-12, jour 1-31)
+static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+  y -= m <= 2;
+  int64_t era = floorDiv(y, 400);
+  unsigned yoe = (unsigned)(y - era * 400);
+  unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int64_t)doe - 719468;
+}
+
+static int64_t yearFromDays(int64_t days) {
+  days += 719468;
+  int64_t era = floorDiv(days, 146097);
+  unsigned doe = (unsigned)(days - era * 146097);
+  unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  unsigned mp = (5 * doy + 2) / 153;
+  unsigned m = mp < 10 ? mp + 3 : mp - 9;
+  return (int64_t)yoe + era * 400 + (m <= 2);
+}
+
+// 0 = dimanche ; le 1970-01-01 était un jeudi
+static int weekdayFromDays(int64_t days) {
+  return (int)((days % 7 + 11) % 7);
+}
+
+static unsigned daysInMonth(int64_t y, unsigned m) {
+  static const uint8_t DAYS[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+  return m == 2 && leap ? 29 : DAYS[m - 1];
+}
+
+// ===== FUSEAU HORAIRE POSIX =====
+
+// Nom de zone : 3 lettres ou plus, ou forme <...> ("<+03>")
+static const char* parseZoneName(const char* p) {
+  if (*p == '<') {
+    while (*p != '\0' && *p != '>') p++;
+    return *p == '>' ? p + 1 : nullptr;
+  }
+  const char* start = p;
+  while (isalpha((unsigned char)*p)) p++;
+  return p - start >= 3 ? p : nullptr;
+}
+
+// [+-]hh[:mm[:ss]] en secondes
+static const char* parseClock(const char* p, int32_t* out) {
+  int sign = 1;
+  if (*p == '+' || *p == '-') {
+    if (*p == '-') sign = -1;
+    p++;
+  }
+  if (!isdigit((unsigned char)*p)) return nullptr;
+  int32_t fields[3] = { 0, 0, 0 };
+  for (int i = 0; i < 3; i++) {
+    if (!isdigit((unsigned char)*p)) return nullptr;
+    while (isdigit((unsigned char)*p)) fields[i] = fields[i] * 10 + (*p++ - '0');
+    if (*p != ':') break;
+    p++;
+  }
+  *out = sign * (fields[0] * 3600 + fields[1] * 60 + fields[2]);
+  return p;
+}
+
+static const char* parseNumber(const char* p, uint8_t* out, uint8_t minValue, uint8_t maxValue) {
+  if (!isdigit((unsigned char)*p)) return nullptr;
+  int value = 0;
+  while (isdigit((unsigned char)*p)) value = value * 10 + (*p++ - '0');
+  if (value < minValue || value > maxValue) return nullptr;
+  *out = (uint8_t)value;
+  return p;
+}
+
+// Mm.w.d[/time]
+static const char* parseRuleDate(const char* p, TzRuleDate* out) {
+  if (*p++ != 'M') return nullptr;
+  if ((p = parseNumber(p, &out->month, 1, 12)) == nullptr || *p++ != '.') return nullptr;
+  if ((p = parseNumber(p, &out->week, 1, 5)) == nullptr || *p++ != '.') return nullptr;
+  if ((p = parseNumber(p, &out->weekday, 0, 6)) == nullptr) return nullptr;
+  out->time = 2 * 3600;
+  if (*p == '/') p = parseClock(p + 1, &out->time);
+  return p;
+}
+
+bool tzParse(const char* posix, TzRule* out) {
+  memset(out, 0, sizeof(TzRule));
+  int32_t offset;
+  const char* p = parseZoneName(posix);
+  if (p == nullptr || (p = parseClock(p, &offset)) == nullptr) return false;
+  // POSIX compte le décalage vers l'ouest : "CET-1" = UTC+1
+  out->stdOffset = -offset;
+  out->dstOffset = out->stdOffset;
+  if (*p == '\0') return true;
+
+  if ((p = parseZoneName(p)) == nullptr) return false;
+  out->hasDst = true;
+  out->dstOffset = out->stdOffset + 3600;
+  if (*p != '\0' && *p != ',') {
+    if ((p = parseClock(p, &offset)) == nullptr) return false;
+    out->dstOffset = -offset;
+  }
+  if (*p == '\0') {
+    // Règle par défaut de POSIX (États-Unis)
+    out->start = { 3, 2, 0, 2 * 3600 };
+    out->end = { 11, 1, 0, 2 * 3600 };
+    return true;
+  }
+  if (*p++ != ',' || (p = parseRuleDate(p, &out->start)) == nullptr) return false;
+  if (*p++ != ',' || (p = parseRuleDate(p, &out->end)) == nullptr) return false;
+  return *p == '\0';
+}
+
+void tzFixed(TzRule* out, int32_t offsetSec) {
+  memset(out, 0, sizeof(TzRule));
+  out->stdOffset = offsetSec;
+  out->dstOffset = offsetSec;
+}
+
+// Instant local (secondes) du changement d'heure de l'année year
+static int64_t ruleLocalTime(int64_t year, const TzRuleDate* rule) {
+  int64_t first = daysFromCivil(year, rule->month, 1);
+  int day = (rule->weekday - weekdayFromDays(first) + 7) % 7 + (rule->week - 1) * 7;
+  while (day >= (int)daysInMonth(year, rule->month)) day -= 7;  // Semaine 5 = dernière
+  return (first + day) * SECONDS_PER_DAY + rule->time;
+}
+
+int32_t tzOffsetAt(const TzRule* tz, uint32_t utc) {
+  if (!tz->hasDst) return tz->stdOffset;
+  int64_t year = yearFromDays(floorDiv((int64_t)utc + tz->stdOffset, SECONDS_PER_DAY));
+  int64_t start = ruleLocalTime(year, &tz->start) - tz->stdOffset;
+  int64_t end = ruleLocalTime(year, &tz->end) - tz->dstOffset;
+  if (start < end) {
+    return (int64_t)utc >= start && (int64_t)utc < end ? tz->dstOffset : tz->stdOffset;
+  }
+  // Hémisphère sud : l'heure d'été chevauche le changement d'année
+  return (int64_t)utc >= end && (int64_t)utc < start ? tz->stdOffset : tz->dstOffset;
+}
+
+static uint32_t clampUtc(int64_t t) {
+  return t < 0 ? 0 : t > (int64_t)UINT32_MAX ? UINT32_MAX : (uint32_t)t;
+}
+
+uint32_t tzLocalToUtc(const TzRule* tz, int64_t local) {
+  int32_t guess = tzOffsetAt(tz, clampUtc(local - tz->stdOffset));
+  int64_t utc = local - guess;
+  int32_t actual = tzOffsetAt(tz, clampUtc(utc));
+  if (actual == guess) return clampUtc(utc);
+
+  int64_t other = local - actual;
+  if (tzOffsetAt(tz, clampUtc(other)) == actual) return clampUtc(other);
+  // Heure sautée : la plus tardive des deux lectures tombe juste après le saut
+  return clampUtc(other > utc ? other : utc);
+}
+
+// ===== ÉCHÉANCES =====
+
+static uint8_t scheduleDays(const Schedule* s) {
+  if (s->kind == SCHEDULE_DAILY && s->weekdays == 0) return SCHEDULE_ALL_DAYS;
+  return s->weekdays & SCHEDULE_ALL_DAYS;
+}
+
+uint32_t scheduleNextFire(const Schedule* s, const TzRule* tz, uint32_t afterUtc) {
+  if (!s->enabled) return 0;
+
+  if (s->kind == SCHEDULE_INTERVAL) {
+    if (s->interval < SCHEDULE_MIN_INTERVAL_SEC) return 0;
+    if (afterUtc < s->anchor) return s->anchor;
+    uint64_t next = s->anchor + ((uint64_t)(afterUtc - s->anchor) / s->interval + 1) * s->interval;
+    return next > UINT32_MAX ? 0 : (uint32_t)next;
+  }
+
+  if (s->kind != SCHEDULE_DAILY && s->kind != SCHEDULE_WEEKLY) return 0;
+  uint8_t days = scheduleDays(s);
+  if (days == 0) return 0;
+  // La veille est examinée aussi : un décalage positif peut placer son échéance après afterUtc
+  int64_t today = floorDiv((int64_t)afterUtc + tzOffsetAt(tz, afterUtc), SECONDS_PER_DAY);
+  for (int64_t day = today - 1; day <= today + 8; day++) {
+    if ((days & (1 << weekdayFromDays(day))) == 0) continue;
+    uint32_t utc = tzLocalToUtc(tz, day * SECONDS_PER_DAY + s->timeOfDay);
+    if (utc > afterUtc) return utc;
+  }
+  return 0;
+}
+
+uint32_t schedulePrevFire(const Schedule* s, const TzRule* tz, uint32_t atUtc) {
+  if (!s->enabled) return 0;
+
+  if (s->kind == SCHEDULE_INTERVAL) {
+    if (s->interval < SCHEDULE_MIN_INTERVAL_SEC || atUtc < s->anchor) return 0;
+    return s->anchor + (atUtc - s->anchor) / s->interval * s->interval;
+  }
+
+  if (s->kind != SCHEDULE_DAILY && s->kind != SCHEDULE_WEEKLY) return 0;
+  uint8_t days = scheduleDays(s);
+  if (days == 0) return 0;
+  int64_t today = floorDiv((int64_t)atUtc + tzOffsetAt(tz, atUtc), SECONDS_PER_DAY);
+  for (int64_t day = today + 1; day >= today - 8; day--) {
+    if ((days & (1 << weekdayFromDays(day))) == 0) continue;
+    uint32_t utc = tzLocalToUtc(tz, day * SECONDS_PER_DAY + s->timeOfDay);
+    if (utc <= atUtc) return utc;
+  }
+  return 0;
+}
+
+ScheduleAction scheduleEvaluate(Schedule* s, const TzRule* tz, uint32_t nowUtc, uint32_t leadSec,
+                                uint32_t graceSec, uint32_t* nextFire, uint32_t* fireAt) {
+  if (!s->enabled || s->kind == SCHEDULE_NONE) {
+    *nextFire = 0;
+    return SCHEDULE_IDLE;
+  }
+  if (*nextFire == 0) {
+    // Reprise après la dernière échéance traitée ; nouvelle programmation : à partir de maintenant
+    *nextFire = scheduleNextFire(s, tz, s->lastFired != 0 ? s->lastFired : nowUtc);
+    if (*nextFire == 0) return SCHEDULE_IDLE;
+  }
+
+  if ((uint64_t)*nextFire + graceSec < nowUtc) {
+    // Une ou plusieurs échéances manquées : seule la plus récente compte
+    uint32_t latest = schedulePrevFire(s, tz, nowUtc);
+    s->lastFired = latest;
+    *nextFire = scheduleNextFire(s, tz, nowUtc);
+    if (s->missedPolicy == SCHEDULE_MISSED_FIRE_ONCE) {
+      *fireAt = latest;
+      return SCHEDULE_CATCH_UP;
+    }
+    return SCHEDULE_MISSED;
+  }
+
+  if (*nextFire <= (uint64_t)nowUtc + leadSec) {
+    *fireAt = *nextFire;
+    s->lastFired = *fireAt;
+    *nextFire = scheduleNextFire(s, tz, *fireAt);
+    return SCHEDULE_FIRE;
+  }
+  return SCHEDULE_IDLE;
+}
+
+void scheduleRewind(Schedule* s, const TzRule* tz, uint32_t nowUtc) {
+  if (s->lastFired > nowUtc) s->lastFired = schedulePrevFire(s, tz, nowUtc);
+}
+
+const char* scheduleKindName(uint8_t kind) {
+  return kind > 0 && kind < SCHEDULE_KIND_COUNT ? SCHEDULE_KIND_NAMES[kind] : "none";
+}
+
+uint8_t scheduleKindFromName(const char* name) {
+  for (uint8_t i = 1; i < SCHEDULE_KIND_COUNT; i++) {
+    if (strcmp(name, SCHEDULE_KIND_NAMES[i]) == 0) return i;
+  }
+  return SCHEDULE_NONE;
+}
+
+int scheduleWeekdayFromName(const char* name) {
+  for (int i = 0; i < 7; i++) {
+    if (strcmp(name, SCHEDULE_WEEKDAY_NAMES[i]) == 0) return i;
+  }
+  return -1;
+}
+
+bool scheduleParseTimeOfDay(const char* text, uint32_t* out) {
+  unsigned h = 0, m = 0, sec = 0;
+  char extra;
+  int n = sscanf(text, "%u:%u:%u%c", &h, &m, &sec, &extra);
+  if (n < 2 || n > 3 || h > 23 || m > 59 || sec > 59) return false;
+  *out = h * 3600 + m * 60 + sec;
+  return true;
+}
+
+void scheduleFormatTimeOfDay(uint32_t seconds, char* out, size_t outSize) {
+  snprintf(out, outSize, "%02u:%02u:%02u", (unsigned)(seconds / 3600 % 24), (unsigned)(seconds / 60 % 60),
+           (unsigned)(seconds % 60));
+}
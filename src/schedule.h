@@ -0,0 +1,115 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ===== PROGRAMMATIONS RÉCURRENTES (calcul de calendrier) =====
+// Module pur (sans Arduino) : fuseau horaire POSIX, prochaine et dernière
+// échéance d'une programmation quotidienne, hebdomadaire ou périodique, et
+// décision de déclenchement avec la politique de rattrapage des échéances
+// manquées (redémarrage, heure pas encore synchronisée, saut d'horloge).
+// Toutes les heures sont des secondes UTC depuis 1970 ; l'heure locale n'est
+// utilisée que pour poser les heures du jour (DAILY / WEEKLY).
+//
+//   TzRule tz;
+//   tzParse("CET-1CEST,M3.5.0,M10.5.0/3", &tz);
+//   Schedule s = {};  s.kind = SCHEDULE_DAILY;  s.weekdays = SCHEDULE_ALL_DAYS;
+//   s.timeOfDay = 7 * 3600 + 30 * 60;           // 07:30 locale
+//   uint32_t next = scheduleNextFire(&s, &tz, now);
+
+#ifndef MAX_SCHEDULES
+#define MAX_SCHEDULES 16
+#endif
+#define SCHEDULE_ALL_DAYS 0x7F          // bit 0 = dimanche ... bit 6 = samedi
+#define SCHEDULE_MIN_INTERVAL_SEC 1
+
+enum ScheduleKind : uint8_t {
+  SCHEDULE_NONE = 0,                    // Case libre
+  SCHEDULE_DAILY = 1,                   // Chaque jour à timeOfDay (jours filtrés par weekdays)
+  SCHEDULE_WEEKLY = 2,                  // Jours de weekdays à timeOfDay
+  SCHEDULE_INTERVAL = 3                 // anchor + k * interval (UTC, indépendant du fuseau)
+};
+
+enum ScheduleMissedPolicy : uint8_t {
+  SCHEDULE_MISSED_SKIP = 0,             // Échéances manquées ignorées
+  SCHEDULE_MISSED_FIRE_ONCE = 1         // La plus récente est exécutée dès que possible
+};
+
+// Format binaire (24 octets), identique en RAM et en flash (Preferences)
+struct Schedule {
+  uint8_t kind;                         // ScheduleKind
+  uint8_t pin;                          // GPIO de la sortie
+  uint8_t state;
+  uint8_t missedPolicy;                 // ScheduleMissedPolicy
+  uint8_t weekdays;                     // DAILY / WEEKLY
+  uint8_t enabled;
+  uint16_t reserved;
+  uint32_t timeOfDay;                   // Secondes depuis minuit locale (DAILY / WEEKLY)
+  uint32_t interval;                    // Période en secondes (INTERVAL)
+  uint32_t anchor;                      // Première échéance UTC (INTERVAL, 0 = alignée sur l'époque)
+  uint32_t lastFired;                   // Dernière échéance traitée (UTC, 0 = jamais)
+};
+
+// Règle de fuseau horaire au format POSIX TZ ("CET-1CEST,M3.5.0,M10.5.0/3").
+// Seules les dates de changement Mm.w.d sont prises en charge.
+struct TzRuleDate {
+  uint8_t month;                        // 1-12
+  uint8_t week;                         // 1-5 (5 = dernière semaine du mois)
+  uint8_t weekday;                      // 0 = dimanche
+  int32_t time;                         // Heure locale du changement, en secondes
+};
+
+struct TzRule {
+  int32_t stdOffset;                    // Heure locale - UTC en heure d'hiver (s)
+  int32_t dstOffset;                    // Heure locale - UTC en heure d'été (s)
+  bool hasDst;
+  TzRuleDate start;                     // Passage à l'heure d'été (heure locale d'hiver)
+  TzRuleDate end;                       // Retour à l'heure d'hiver (heure locale d'été)
+};
+
+// Analyse une chaîne POSIX TZ ; false si elle n'est pas reconnue
+bool tzParse(const char* posix, TzRule* out);
+// Décalage fixe, sans changement d'heure (gmtOffset_sec + daylightOffset_sec)
+void tzFixed(TzRule* out, int32_t offsetSec);
+// Heure locale - UTC à l'instant utc
+int32_t tzOffsetAt(const TzRule* tz, uint32_t utc);
+// Heure locale -> UTC. Heure inexistante (passage à l'heure d'été) : décalée
+// d'autant vers l'avant ; heure ambiguë (retour à l'heure d'hiver) : la seconde
+uint32_t tzLocalToUtc(const TzRule* tz, int64_t local);
+
+// Première échéance strictement après afterUtc (0 si aucune : désactivée, aucun jour)
+uint32_t scheduleNextFire(const Schedule* s, const TzRule* tz, uint32_t afterUtc);
+// Dernière échéance au plus tard à atUtc (0 si aucune)
+uint32_t schedulePrevFire(const Schedule* s, const TzRule* tz, uint32_t atUtc);
+
+enum ScheduleAction : uint8_t {
+  SCHEDULE_IDLE = 0,                    // Rien à faire pour l'instant
+  SCHEDULE_FIRE = 1,                    // Échéance dans la fenêtre : exécuter à *fireAt
+  SCHEDULE_CATCH_UP = 2,                // Échéance manquée rattrapée : exécuter tout de suite
+  SCHEDULE_MISSED = 3                   // Échéance manquée ignorée (SCHEDULE_MISSED_SKIP)
+};
+
+// Décide du sort de la programmation à l'instant nowUtc. *nextFire est l'index
+// d'échéance tenu par l'appelant (0 = à calculer) ; une échéance au plus
+// leadSec dans le futur est rendue pour être programmée avec précision, une
+// échéance dépassée de plus de graceSec est traitée selon missedPolicy.
+// Met à jour s->lastFired et *nextFire.
+ScheduleAction scheduleEvaluate(Schedule* s, const TzRule* tz, uint32_t nowUtc, uint32_t leadSec,
+                                uint32_t graceSec, uint32_t* nextFire, uint32_t* fireAt);
+
+// Horloge recalée en arrière jusqu'à nowUtc : les échéances déjà traitées
+// après nowUtc repassent avec l'horloge. L'appelant remet son index à 0.
+void scheduleRewind(Schedule* s, const TzRule* tz, uint32_t nowUtc);
+
+// Noms des jours ("mon") et des types ("daily") pour l'API ; inverses à -1 / SCHEDULE_NONE si inconnus
+const char* scheduleKindName(uint8_t kind);
+uint8_t scheduleKindFromName(const char* name);
+int scheduleWeekdayFromName(const char* name);
+extern const char* const SCHEDULE_WEEKDAY_NAMES[7];
+
+// Heure du jour "HH:MM[:SS]" <-> secondes depuis minuit
+bool scheduleParseTimeOfDay(const char* text, uint32_t* out);
+void scheduleFormatTimeOfDay(uint32_t seconds, char* out, size_t outSize);
+
+#endif // SCHEDULE_H
@@ -0,0 +1,115 @@
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "schedule_table.h"
+#include "io_table.h"
+#include "event_log.h"
+#include "mqtt.h"
+
+static ScheduleEntry entries[MAX_SCHEDULES];
+static int entryCount = 0;
+static TzRule scheduleTz;
+static uint32_t lastPollUtc = 0;
+static bool dirty = false;            // lastFired modifié depuis la dernière sauvegarde
+static uint32_t lastSaveMs = 0;
+
+// Sections courtes (copie, évaluation) : CmdTask et le serveur web se partagent la table
+static SemaphoreHandle_t scheduleMutex = NULL;
+
+struct ScheduleLock {
+  ScheduleLock() { if (scheduleMutex) xSemaphoreTakeRecursive(scheduleMutex, portMAX_DELAY); }
+  ~ScheduleLock() { if (scheduleMutex) xSemaphoreGiveRecursive(scheduleMutex); }
+};
+
+static void resetIndex() {
+  for (int i = 0; i < entryCount; i++) entries[i].nextFire = 0;
+}
+
+void scheduleTableInit() {
+  if (scheduleMutex == NULL) {
+    scheduleMutex = xSemaphoreCreateRecursiveMutex();
+  }
+  tzFixed(&scheduleTz, 0);
+}
+
+bool scheduleTableSetTimezone(const char* posixTz, int32_t fallbackOffsetSec) {
+  ScheduleLock lock;
+  bool parsed = posixTz != nullptr && posixTz[0] != '\0' && tzParse(posixTz, &scheduleTz);
+  if (!parsed) tzFixed(&scheduleTz, fallbackOffsetSec);
+  resetIndex();
+  return parsed || posixTz == nullptr || posixTz[0] == '\0';
+}
+
+int scheduleTableGet(ScheduleEntry* out) {
+  ScheduleLock lock;
+  memcpy(out, entries, entryCount * sizeof(ScheduleEntry));
+  return entryCount;
+}
+
+void scheduleTableSet(const Schedule* list, int count) {
+  ScheduleLock lock;
+  if (count > MAX_SCHEDULES) count = MAX_SCHEDULES;
+  for (int i = 0; i < count; i++) {
+    entries[i].schedule = list[i];
+    entries[i].nextFire = 0;
+  }
+  entryCount = count;
+}
+
+bool scheduleTableTakeDue(uint32_t nowUtc, CommandMsg* out) {
+  // Tant que l'heure n'est pas synchronisée, les échéances attendent (rattrapées ensuite)
+  if (nowUtc < SCHEDULE_TIME_VALID_UTC) return false;
+
+  ScheduleLock lock;
+  if (nowUtc + SCHEDULE_GRACE_SEC < lastPollUtc) {
+    // Horloge recalée en arrière : les échéances repassent avec elle
+    for (int i = 0; i < entryCount; i++) scheduleRewind(&entries[i].schedule, &scheduleTz, nowUtc);
+    resetIndex();
+  }
+  lastPollUtc = nowUtc;
+
+  for (int i = 0; i < entryCount; i++) {
+    Schedule& s = entries[i].schedule;
+    uint32_t fireAt = 0;
+    ScheduleAction action = scheduleEvaluate(&s, &scheduleTz, nowUtc, SCHEDULE_LEAD_SEC, SCHEDULE_GRACE_SEC,
+                                             &entries[i].nextFire, &fireAt);
+    if (action == SCHEDULE_IDLE) continue;
+    dirty = true;
+    if (action == SCHEDULE_MISSED) {
+      Serial.printf("⏭ Schedule %d: missed firing at %lu skipped\n", i, (unsigned long)s.lastFired);
+      continue;
+    }
+
+    // La sortie a pu disparaître de la configuration depuis la création de la programmation
+    IOTableReader table;
+    int idx = ioTableFindByPin(table.get(), s.pin);
+    if (idx < 0 || table->pins[idx].mode != 2) { // OUTPUT
+      Serial.printf("⚠️ Schedule %d: GPIO %d is not an output, skipped\n", i, s.pin);
+      continue;
+    }
+
+    memset(out, 0, sizeof(CommandMsg));
+    out->pin = s.pin;
+    out->state = s.state;
+    // Rattrapage : tout de suite ; sinon à la seconde exacte par la table des commandes programmées
+    out->exec_at_sec = action == SCHEDULE_FIRE ? fireAt : 0;
+    snprintf(out->id, sizeof(out->id), "sched-%d", i);
+    out->received_us = getCurrentTimeMicros();
+    eventLogWrite(EVENT_COMMAND, out->pin, out->state, out->id, EVENT_SOURCE_SCHEDULE);
+    if (action == SCHEDULE_CATCH_UP) {
+      Serial.printf("⏰ Schedule %d: catching up missed firing at %lu\n", i, (unsigned long)fireAt);
+    }
+    return true;
+  }
+  return false;
+}
+
+bool scheduleTableNeedsSave(uint32_t nowMs) {
+  return dirty && nowMs - lastSaveMs >= SCHEDULE_SAVE_MIN_INTERVAL_MS;
+}
+
+void scheduleTableMarkSaved(uint32_t nowMs) {
+  ScheduleLock lock;
+  dirty = false;
+  lastSaveMs = nowMs;
+}
@@ -0,0 +1,52 @@
+#ifndef SCHEDULE_TABLE_H
+#define SCHEDULE_TABLE_H
+
+#include "schedule.h"
+#include "command_queue.h"
+
+// ===== TABLE DES PROGRAMMATIONS =====
+// Programmations récurrentes de l'appareil et index de leur prochaine échéance.
+// CmdTask interroge la table à chaque tour (scheduleTableTakeDue) : une
+// échéance à moins de SCHEDULE_LEAD_SEC rejoint la table des commandes
+// programmées avec son heure exacte, l'exécuteur s'occupe de la précision.
+// Le serveur web remplace la liste ; NetTask recopie lastFired en flash au plus
+// toutes les SCHEDULE_SAVE_MIN_INTERVAL_MS (usure de la flash).
+
+#define SCHEDULE_LEAD_SEC 1                 // Avance de mise en table des commandes programmées
+#define SCHEDULE_GRACE_SEC 2                // Retard au-delà duquel une échéance est "manquée"
+#define SCHEDULE_TIME_VALID_UTC 1577836800UL // 2020-01-01 : heure pas encore synchronisée avant
+#ifndef SCHEDULE_SAVE_MIN_INTERVAL_MS
+#define SCHEDULE_SAVE_MIN_INTERVAL_MS 300000
+#endif
+#define SCHEDULE_DEFAULT_TZ "CET-1CEST,M3.5.0,M10.5.0/3"
+
+struct ScheduleEntry {
+  Schedule schedule;
+  uint32_t nextFire;                        // Index : prochaine échéance UTC (0 = à calculer)
+};
+
+// À appeler une fois avant le démarrage des tâches
+void scheduleTableInit();
+
+// Fuseau des heures du jour : chaîne POSIX TZ, ou décalage fixe si elle est
+// vide ou invalide. Retourne false si posixTz n'a pas pu être analysée.
+bool scheduleTableSetTimezone(const char* posixTz, int32_t fallbackOffsetSec);
+
+// Copie de la table (au plus MAX_SCHEDULES entrées) ; retourne le nombre d'entrées
+int scheduleTableGet(ScheduleEntry* out);
+// Remplace toutes les programmations (index recalculé)
+void scheduleTableSet(const Schedule* list, int count);
+
+// CmdTask : prochaine commande à programmer, false s'il n'y en a plus pour ce tour
+bool scheduleTableTakeDue(uint32_t nowUtc, CommandMsg* out);
+
+// NetTask : true si lastFired a changé et que la dernière sauvegarde est assez ancienne
+bool scheduleTableNeedsSave(uint32_t nowMs);
+// À appeler juste avant de copier la table pour la sauvegarder
+void scheduleTableMarkSaved(uint32_t nowMs);
+
+// Sauvegarde / chargement en flash (définis dans main.cpp)
+void loadSchedules();
+void saveSchedules();
+
+#endif // SCHEDULE_TABLE_H
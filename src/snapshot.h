@@ -0,0 +1,86 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// ===== INSTANTANÉS DOUBLE BUFFER (style RCU) =====
+// Une donnée partagée est publiée sous forme d'instantanés immuables :
+//  - les lecteurs n'utilisent aucun verrou : acquire() incrémente un compteur
+//    de lecteurs sur le tampon actif (puis revérifie qu'il est toujours actif) ;
+//  - l'écrivain prépare la nouvelle version dans le tampon inactif, attend
+//    qu'il n'ait plus de lecteurs, puis bascule l'index actif de façon atomique.
+// Un lecteur voit donc toujours une version complète et cohérente, et une
+// reconfiguration ne bloque jamais un lecteur (seul l'écrivain peut attendre).
+// Pas de dépendance Arduino : utilisable tel quel sur l'hôte.
+
+template <typename T>
+class SnapshotBuffer {
+public:
+  SnapshotBuffer() : slots_(), active_(0) {
+    readers_[0].store(0);
+    readers_[1].store(0);
+  }
+
+  // Lecture sans verrou : le pointeur reste valide jusqu'à release()
+  const T* acquire() {
+    for (;;) {
+      int i = active_.load();
+      readers_[i].fetch_add(1);
+      // Si l'écrivain a basculé entre-temps, ce tampon peut être en réécriture
+      if (active_.load() == i) {
+        return &slots_[i];
+      }
+      readers_[i].fetch_sub(1);
+    }
+  }
+
+  void release(const T* snapshot) {
+    readers_[snapshot - slots_].fetch_sub(1);
+  }
+
+  // Écriture : mutate(T&) reçoit une copie de la version active, qui est
+  // publiée atomiquement au retour. Les écrivains sont sérialisés entre eux.
+  template <typename F>
+  void update(F mutate) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    int current = active_.load();
+    int next = 1 - current;
+
+    // Attendre la fin des lectures encore en cours sur l'ancienne version
+    while (readers_[next].load() != 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    slots_[next] = slots_[current];
+    mutate(slots_[next]);
+    active_.store(next);
+  }
+
+private:
+  T slots_[2];
+  std::atomic<int> active_;
+  std::atomic<int> readers_[2];
+  std::mutex writeMutex_;
+};
+
+// Accès RAII à l'instantané courant
+template <typename T>
+class SnapshotReader {
+public:
+  explicit SnapshotReader(SnapshotBuffer<T>& buffer) : buffer_(buffer), snapshot_(buffer.acquire()) {}
+  ~SnapshotReader() { buffer_.release(snapshot_); }
+  SnapshotReader(const SnapshotReader&) = delete;
+  SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+  const T* operator->() const { return snapshot_; }
+  const T* get() const { return snapshot_; }
+
+private:
+  SnapshotBuffer<T>& buffer_;
+  const T* snapshot_;
+};
+
+#endif // SNAPSHOT_H
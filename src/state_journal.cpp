@@ -0,0 +1,180 @@
+#include "state_journal.h"
+#include <string.h>
+
+#define STATE_JOURNAL_RECORD_MARK 0x5A   // Un emplacement vierge (0xFF) n'est jamais un enregistrement valide
+#define GPIO_MASK ((1ULL << STATE_JOURNAL_GPIO_COUNT) - 1)
+
+uint8_t stateJournalCrc8(const uint8_t* data, size_t len) {
+  uint8_t crc = 0;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+static void putLE(uint8_t* p, uint64_t v, int bytes) {
+  for (int i = 0; i < bytes; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint64_t getLE(const uint8_t* p, int bytes) {
+  uint64_t v = 0;
+  for (int i = 0; i < bytes; i++) v |= (uint64_t)p[i] << (8 * i);
+  return v;
+}
+
+// ===== FORMAT =====
+// En-tête : magie, génération, ~génération (u32 LE), 4 octets à 0xFF
+// Enregistrement : seq (u32 LE), états (5 o), connus (5 o), marque, CRC-8 des 15 premiers octets
+
+static void encodeRecord(uint8_t* rec, uint32_t seq, const StateSnapshot* s) {
+  putLE(rec, seq, 4);
+  putLE(rec + 4, s->states & GPIO_MASK, 5);
+  putLE(rec + 9, s->known & GPIO_MASK, 5);
+  rec[14] = STATE_JOURNAL_RECORD_MARK;
+  rec[15] = stateJournalCrc8(rec, 15);
+}
+
+static bool decodeRecord(const uint8_t* rec, uint32_t* seq, StateSnapshot* s) {
+  if (rec[14] != STATE_JOURNAL_RECORD_MARK || rec[15] != stateJournalCrc8(rec, 15)) return false;
+  *seq = (uint32_t)getLE(rec, 4);
+  s->known = getLE(rec + 9, 5);
+  s->states = getLE(rec + 4, 5) & s->known;
+  return true;
+}
+
+static uint32_t sectorOffset(uint8_t sector) {
+  return (uint32_t)sector * STATE_JOURNAL_SECTOR_SIZE;
+}
+
+static uint32_t slotOffset(uint8_t sector, int slot) {
+  return sectorOffset(sector) + STATE_JOURNAL_HEADER_SIZE + (uint32_t)slot * STATE_JOURNAL_RECORD_SIZE;
+}
+
+static bool readHeader(const StateJournal* j, uint8_t sector, uint32_t* generation) {
+  uint8_t h[STATE_JOURNAL_HEADER_SIZE];
+  if (!j->flash->read(j->flash->ctx, sectorOffset(sector), h, sizeof(h))) return false;
+  uint32_t gen = (uint32_t)getLE(h + 4, 4);
+  if (getLE(h, 4) != STATE_JOURNAL_MAGIC || (uint32_t)getLE(h + 8, 4) != (uint32_t)~gen) return false;
+  *generation = gen;
+  return true;
+}
+
+static bool slotBlank(const StateJournal* j, uint8_t sector, int slot) {
+  uint8_t rec[STATE_JOURNAL_RECORD_SIZE];
+  if (!j->flash->read(j->flash->ctx, slotOffset(sector, slot), rec, sizeof(rec))) return false;
+  for (size_t i = 0; i < sizeof(rec); i++) {
+    if (rec[i] != 0xFF) return false;
+  }
+  return true;
+}
+
+// Les enregistrements sont écrits dans l'ordre : premier emplacement vierge par dichotomie
+static int firstBlankSlot(const StateJournal* j, uint8_t sector) {
+  int lo = 0, hi = STATE_JOURNAL_SLOTS;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (slotBlank(j, sector, mid)) hi = mid;
+    else lo = mid + 1;
+  }
+  return lo;
+}
+
+// Dernier enregistrement valide avant end (une écriture interrompue est sautée)
+static bool lastValidRecord(const StateJournal* j, uint8_t sector, int end, uint32_t* seq, StateSnapshot* s) {
+  for (int slot = end - 1; slot >= 0; slot--) {
+    uint8_t rec[STATE_JOURNAL_RECORD_SIZE];
+    if (j->flash->read(j->flash->ctx, slotOffset(sector, slot), rec, sizeof(rec)) && decodeRecord(rec, seq, s)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool stateJournalOpen(StateJournal* j, const StateJournalFlash* flash, uint8_t sectorCount, StateSnapshot* restored) {
+  memset(j, 0, sizeof(StateJournal));
+  memset(restored, 0, sizeof(StateSnapshot));
+  if (sectorCount > STATE_JOURNAL_MAX_SECTORS) sectorCount = STATE_JOURNAL_MAX_SECTORS;
+  j->flash = flash;
+  j->sectorCount = sectorCount;
+  j->sector = sectorCount - 1;      // Zone vierge : la première validation formate le secteur 0
+  j->nextSlot = STATE_JOURNAL_SLOTS;
+
+  // Secteur le plus récent : génération la plus élevée
+  uint32_t generations[STATE_JOURNAL_MAX_SECTORS];
+  bool valid[STATE_JOURNAL_MAX_SECTORS];
+  for (int s = 0; s < sectorCount; s++) {
+    valid[s] = readHeader(j, s, &generations[s]);
+    if (valid[s] && (!j->formatted || (int32_t)(generations[s] - j->generation) > 0)) {
+      j->formatted = true;
+      j->sector = s;
+      j->generation = generations[s];
+    }
+  }
+  if (!j->formatted) return false;
+  j->nextSlot = firstBlankSlot(j, j->sector);
+
+  // Secteur neuf sans enregistrement valide : l'état est dans le précédent (génération - 1)
+  int s = j->sector;
+  int end = j->nextSlot;
+  for (int k = 0; k < sectorCount; k++) {
+    if (!valid[s] || generations[s] != j->generation - k) break;
+    if (lastValidRecord(j, s, end, &j->seq, &j->last)) {
+      *restored = j->last;
+      return true;
+    }
+    s = (s + sectorCount - 1) % sectorCount;
+    end = valid[s] ? firstBlankSlot(j, s) : 0;
+  }
+  return false;
+}
+
+// Efface le secteur suivant (le plus ancien) et y écrit l'en-tête de la génération suivante
+static bool rollover(StateJournal* j) {
+  uint8_t next = j->formatted ? (j->sector + 1) % j->sectorCount : 0;
+  uint32_t generation = j->formatted ? j->generation + 1 : 1;
+  if (!j->flash->erase(j->flash->ctx, sectorOffset(next), STATE_JOURNAL_SECTOR_SIZE)) return false;
+  j->erases++;
+
+  uint8_t h[STATE_JOURNAL_HEADER_SIZE];
+  memset(h, 0xFF, sizeof(h));
+  putLE(h, STATE_JOURNAL_MAGIC, 4);
+  putLE(h + 4, generation, 4);
+  putLE(h + 8, (uint32_t)~generation, 4);
+  if (!j->flash->write(j->flash->ctx, sectorOffset(next), h, sizeof(h))) return false;
+
+  j->sector = next;
+  j->generation = generation;
+  j->nextSlot = 0;
+  j->formatted = true;
+  return true;
+}
+
+bool stateJournalCommit(StateJournal* j, const StateSnapshot* snapshot) {
+  if (j->formatted && ((snapshot->states ^ j->last.states) & snapshot->known & GPIO_MASK) == 0 &&
+      ((snapshot->known ^ j->last.known) & GPIO_MASK) == 0) {
+    return true;  // Rien de nouveau : pas d'usure
+  }
+
+  // Un emplacement refusé (relecture différente) est abandonné, l'écriture refaite au suivant
+  for (int attempt = 0; attempt < 2; attempt++) {
+    if (j->nextSlot >= STATE_JOURNAL_SLOTS && !rollover(j)) {
+      j->writeErrors++;
+      return false;
+    }
+    uint8_t rec[STATE_JOURNAL_RECORD_SIZE];
+    uint8_t check[STATE_JOURNAL_RECORD_SIZE];
+    encodeRecord(rec, j->seq + 1, snapshot);
+    uint32_t offset = slotOffset(j->sector, j->nextSlot++);
+    if (j->flash->write(j->flash->ctx, offset, rec, sizeof(rec)) &&
+        j->flash->read(j->flash->ctx, offset, check, sizeof(check)) && memcmp(rec, check, sizeof(rec)) == 0) {
+      j->seq++;
+      j->last.known = snapshot->known & GPIO_MASK;
+      j->last.states = snapshot->states & j->last.known;
+      j->commits++;
+      return true;
+    }
+    j->writeErrors++;
+  }
+  return false;
+}
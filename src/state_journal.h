@@ -0,0 +1,79 @@
+#ifndef STATE_JOURNAL_H
+#define STATE_JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ===== JOURNAL DES ÉTATS DE SORTIE EN FLASH =====
+// Module pur (sans Arduino) : l'accès à la flash passe par trois fonctions de
+// l'appelant (partition dédiée sur l'ESP32, fichier dans le simulateur).
+//
+// La zone est un anneau de STATE_JOURNAL_SECTOR_SIZE octets par secteur.
+// Chaque secteur commence par un en-tête (magie, numéro de génération), suivi
+// d'enregistrements de 16 octets. Chaque enregistrement est un instantané
+// complet des sorties : états et GPIO connus (40 bits chacun), numéro de
+// séquence et CRC-8.
+//   - Une validation n'écrit qu'un enregistrement, sans relire ni compacter.
+//   - Un secteur plein fait effacer le suivant, le plus ancien : l'usure se
+//     répartit sur tous les secteurs (un effacement tous les
+//     STATE_JOURNAL_SLOTS enregistrements).
+//   - Au démarrage, le dernier enregistrement valide est retrouvé par
+//     dichotomie sur les emplacements vierges du secteur le plus récent :
+//     une dizaine de petites lectures, quelques dizaines de µs.
+//   - Une écriture interrompue laisse un enregistrement au CRC invalide,
+//     ignoré : le précédent fait foi.
+//
+//   StateJournal j;
+//   StateSnapshot last;
+//   stateJournalOpen(&j, &flash, 4, &last);   // true si un état a été retrouvé
+//   ...
+//   stateJournalCommit(&j, &current);         // false si l'écriture a échoué
+
+#define STATE_JOURNAL_SECTOR_SIZE 4096
+#define STATE_JOURNAL_RECORD_SIZE 16
+#define STATE_JOURNAL_HEADER_SIZE STATE_JOURNAL_RECORD_SIZE
+#define STATE_JOURNAL_SLOTS ((STATE_JOURNAL_SECTOR_SIZE - STATE_JOURNAL_HEADER_SIZE) / STATE_JOURNAL_RECORD_SIZE)
+#define STATE_JOURNAL_MAGIC 0x314A534FUL  // "OSJ1"
+#define STATE_JOURNAL_GPIO_COUNT 40       // Bits d'état par enregistrement (GPIO 0-39)
+#define STATE_JOURNAL_MAX_SECTORS 16
+
+// Flash NOR : l'effacement met les octets à 0xFF, l'écriture ne fait passer des bits que de 1 à 0
+struct StateJournalFlash {
+  bool (*read)(void* ctx, uint32_t offset, void* buf, size_t len);
+  bool (*write)(void* ctx, uint32_t offset, const void* buf, size_t len);
+  bool (*erase)(void* ctx, uint32_t offset, size_t len);   // Secteurs entiers
+  void* ctx;
+};
+
+// États des sorties : bit n = GPIO n
+struct StateSnapshot {
+  uint64_t states;
+  uint64_t known;        // GPIO dont l'état a été enregistré au moins une fois
+};
+
+struct StateJournal {
+  const StateJournalFlash* flash;
+  uint8_t sectorCount;
+  uint8_t sector;        // Secteur en cours d'écriture
+  uint16_t nextSlot;     // Prochain emplacement libre (STATE_JOURNAL_SLOTS : secteur plein)
+  bool formatted;        // Au moins un secteur porte un en-tête valide
+  uint32_t generation;   // Génération du secteur en cours
+  uint32_t seq;          // Dernier numéro d'enregistrement écrit
+  StateSnapshot last;    // Dernier instantané écrit ou retrouvé
+  // Statistiques depuis l'ouverture
+  uint32_t commits;
+  uint32_t erases;
+  uint32_t writeErrors;
+};
+
+// Retrouve le dernier instantané (false si la zone est vierge ou illisible).
+// *restored est mis à zéro s'il n'y en a pas. sectorCount : 2 à STATE_JOURNAL_MAX_SECTORS.
+bool stateJournalOpen(StateJournal* j, const StateJournalFlash* flash, uint8_t sectorCount, StateSnapshot* restored);
+
+// Écrit snapshot s'il diffère du dernier enregistré (true sans écriture sinon)
+bool stateJournalCommit(StateJournal* j, const StateSnapshot* snapshot);
+
+// CRC-8 (polynôme 0x07) des enregistrements, exposé pour les tests
+uint8_t stateJournalCrc8(const uint8_t* data, size_t len);
+
+#endif // STATE_JOURNAL_H
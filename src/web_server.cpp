@@ -1,22 +1,67 @@
 #include "web_server.h"
 #include "config.h"
 #include "mqtt.h"
+#include "mqtt_transport.h"
+#include "command_executor.h"
+#include "io_table.h"
+#include "pulse_counter.h"
+#include "analog_input.h"
+#include "event_log.h"
+#include "event_log_flash.h"
+#include "schedule_table.h"
+#include "actuation_calibration.h"
+#include "config_reload.h"
+#include "ota_delta.h"
+#include "io_task.h"
+#include "memory_budget.h"
+#include "output_journal.h"
+#include "wifi_link.h"
+#include "json_pool.h"
 #include <ElegantOTA.h>
-#include <ArduinoJson.h>
 #include <SPIFFS.h>
+#include <WiFi.h>
 #include <ESPAsyncWebServer.h>
+#include <memory>
 
 extern AsyncWebServer server;
 extern Config config;
-extern IOPin ioPins[];
-extern int ioPinCount;
 extern bool mqttEnabled;
 
 extern void saveConfig();
 extern void saveIOs();
-extern void applyIOPinModes();
+
+// Journal des accès : AsyncWebServer évalue les réécritures pour chaque requête
+// dès la fin des en-têtes. Celle-ci ne réécrit rien, elle journalise seulement.
+class AccessLogRewrite : public AsyncWebRewrite {
+public:
+  AccessLogRewrite() : AsyncWebRewrite("", "") {}
+  bool match(AsyncWebServerRequest *request) override {
+    eventLogWrite(EVENT_ACCESS, request->method(), (uint32_t)request->client()->remoteIP(),
+                  request->url().c_str(), EVENT_SOURCE_WEB);
+    return false;
+  }
+};
+
+// Curseur d'un flux /api/logs, partagé entre les appels du remplisseur de réponse
+struct LogStreamCursor {
+  uint32_t next;     // Prochain numéro de séquence à envoyer
+  uint32_t end;      // Tête de l'anneau au début de la requête (flux fini)
+  uint32_t limit;    // Lignes restantes
+  uint8_t typeFilter;
+};
+
+// Réponse JSON : corps réservé d'un bloc à sa taille exacte, sans les
+// réallocations successives d'un String qui grandit pendant la sérialisation
+static void sendJson(AsyncWebServerRequest *request, int code, const JsonDocument& doc) {
+  String response;
+  response.reserve(measureJson(doc));
+  serializeJson(doc, response);
+  request->send(code, "application/json", response);
+}
 
 void setupWebServer() {
+  server.addRewrite(new AccessLogRewrite());
+
   // Servir le fichier index.html depuis SPIFFS
   server.on("/", HTTP_GET, [](AsyncWebServerRequest *request){
     request->send(SPIFFS, "/index.html", "text/html");
@@ -24,12 +69,78 @@ void setupWebServer() {
   
   // API pour le statut système complet
   server.on("/api/status", HTTP_GET, [](AsyncWebServerRequest *request){
-    JsonDocument doc;
+    PooledJsonDocument doc(true);
     doc["deviceName"] = config.deviceName;
     doc["wifi"] = WiFi.status() == WL_CONNECTED;
     doc["ip"] = WiFi.localIP().toString();
-    doc["mqtt"] = mqttClient.connected();
-    
+    doc["mqtt"] = mqttConnected();
+
+    MqttTransportStats mqttStats;
+    mqttTransportGetStats(&mqttStats);
+    JsonObject transport = doc["mqttTransport"].to<JsonObject>();
+    transport["backend"] = mqttTransportName();
+    transport["qos"] = MQTT_PUBLISH_QOS;
+    transport["published"] = mqttStats.published;
+    transport["failed"] = mqttStats.publishFailed;
+    transport["inFlight"] = mqttStats.inFlight;
+    transport["acked"] = mqttStats.qos1Acked;
+    transport["downgraded"] = mqttStats.qos1Downgraded;
+    transport["received"] = mqttStats.received;
+    transport["dropped"] = mqttStats.dropped;
+
+    // Rechargements de configuration : interruption mesurée par niveau d'application
+    JsonObject reload = doc["reload"].to<JsonObject>();
+    reload["pending"] = configReloadPending();
+    for (uint8_t level = CONFIG_APPLY_IN_PLACE; level < CONFIG_APPLY_COUNT; level++) {
+      ConfigReloadStats reloadStats;
+      configReloadGetStats(level, &reloadStats);
+      JsonObject entry = reload[configApplyName(level)].to<JsonObject>();
+      entry["count"] = reloadStats.count;
+      entry["lastMs"] = reloadStats.lastMs;
+      entry["maxMs"] = reloadStats.maxMs;
+    }
+
+    // Profil de carte et durée des passes de la tâche I/O
+    IOScanStats scanStats;
+    ioScanGetStats(&scanStats);
+    JsonObject board = doc["board"].to<JsonObject>();
+    board["profile"] = BoardProfile::name();
+    board["fixedPins"] = BOARD_FIXED_PIN_COUNT;
+    board["scanPasses"] = scanStats.passes;
+    board["scanAvgUs"] = scanStats.avgUs;
+    board["scanMaxUs"] = scanStats.maxUs;
+
+    // Journal des états de sortie (restauration après coupure)
+    OutputJournalStats journalStats;
+    outputJournalGetStats(&journalStats);
+    JsonObject journal = doc["outputJournal"].to<JsonObject>();
+    journal["available"] = journalStats.available;
+    journal["restoredPins"] = journalStats.restoredPins;
+    journal["restoreUs"] = journalStats.restoreUs;
+    journal["recorded"] = journalStats.recorded;
+    journal["commits"] = journalStats.commits;
+    journal["erases"] = journalStats.erases;
+    journal["writeErrors"] = journalStats.writeErrors;
+    journal["sector"] = journalStats.sector;
+    journal["slot"] = journalStats.slot;
+
+    // Reconnexions WiFi : cache BSSID / canal, durée perte de lien -> MQTT en ligne
+    WifiLinkStats linkStats;
+    wifiLinkGetStats(&linkStats);
+    JsonObject wifi = doc["wifi"].to<JsonObject>();
+    wifi["state"] = wifiReconnectStateName(linkStats.state);
+    wifi["cachedChannel"] = linkStats.channel;
+    wifi["losses"] = linkStats.reconnect.losses;
+    wifi["fastOk"] = linkStats.reconnect.fastOk;
+    wifi["fastFailed"] = linkStats.reconnect.fastFailed;
+    wifi["addrRejected"] = linkStats.reconnect.addrRejected;
+    wifi["scanOk"] = linkStats.reconnect.scanOk;
+    wifi["scanFailed"] = linkStats.reconnect.scanFailed;
+    wifi["lastLinkMs"] = linkStats.reconnect.lastLinkMs;
+    wifi["lastOnlineMs"] = linkStats.reconnect.lastOnlineMs;
+    wifi["avgOnlineMs"] = linkStats.reconnect.avgOnlineMs;
+    wifi["maxOnlineMs"] = linkStats.reconnect.maxOnlineMs;
+
     time_t now;
     time(&now);
     struct tm timeinfo;
@@ -39,23 +150,77 @@ void setupWebServer() {
     doc["time"] = timeStr;
     
     JsonArray ios = doc["ios"].to<JsonArray>();
-    for (int i = 0; i < ioPinCount; i++) {
+    IOTableReader table;
+    for (int i = 0; i < table->count; i++) {
+      const IOPin& pin = table->pins[i];
       JsonObject io = ios.add<JsonObject>();
-      io["name"] = ioPins[i].name;
-      io["pin"] = ioPins[i].pin;
-      io["mode"] = ioPins[i].mode;
-      io["state"] = digitalRead(ioPins[i].pin);
+      io["name"] = pin.name;
+      io["pin"] = pin.pin;
+      io["mode"] = pin.mode;
+      io["state"] = digitalRead(pin.pin);
+      IOValues values;
+      if ((pin.mode == 3 || pin.mode == 4) && !ioValuesRead(i, table->generation, &values)) continue;
+      if (pin.mode == 3) { // COUNTER
+        io["count"] = values.count;
+        io["rate"] = values.rateMilliHz / 1000.0;
+      } else if (pin.mode == 4) { // ANALOG
+        io["value"] = values.value;
+        io["raw"] = values.raw;
+      }
     }
     
-    String response;
-    serializeJson(doc, response);
-    request->send(200, "application/json", response);
+    sendJson(request, 200, doc);
   });
-  
+
+  // Budget mémoire : RAM statique, tas, arènes JSON et marge des piles
+  server.on("/api/memory", HTTP_GET, [](AsyncWebServerRequest *request){
+    MemoryReport report;
+    memoryBudgetCollect(&report);
+    PooledJsonDocument doc;
+
+    JsonObject statics = doc["static"].to<JsonObject>();
+    statics["data"] = report.staticData;
+    statics["bss"] = report.staticBss;
+    JsonObject buffers = statics["buffers"].to<JsonObject>();
+    for (int i = 0; i < report.bufferCount; i++) {
+      buffers[report.buffers[i].name] = report.buffers[i].bytes;
+    }
+    statics["buffersTotal"] = memoryReportBuffersTotal(&report);
+
+    JsonObject heap = doc["heap"].to<JsonObject>();
+    heap["size"] = report.heapSize;
+    heap["free"] = report.heapFree;
+    heap["minFree"] = report.heapMinFree;
+    heap["largestBlock"] = report.heapLargestBlock;
+
+    JsonObject json = doc["json"].to<JsonObject>();
+    json["arenas"] = JSON_ARENA_COUNT;
+    json["arenaSize"] = JSON_ARENA_SIZE;
+    json["largeArenas"] = JSON_LARGE_ARENA_COUNT;
+    json["largeArenaSize"] = JSON_LARGE_ARENA_SIZE;
+    json["highWater"] = report.json.smallHighWater;
+    json["largeHighWater"] = report.json.largeHighWater;
+    json["inUse"] = report.json.inUse;
+    json["inUseHighWater"] = report.json.inUseHighWater;
+    json["documents"] = report.json.leases;
+    json["busy"] = report.json.busy;
+    json["overflows"] = report.json.overflows;
+
+    JsonArray tasks = doc["tasks"].to<JsonArray>();
+    for (int i = 0; i < report.taskCount; i++) {
+      JsonObject task = tasks.add<JsonObject>();
+      task["name"] = report.tasks[i].name;
+      task["stack"] = report.tasks[i].stackBytes;
+      task["freeMin"] = report.tasks[i].freeMinBytes;
+    }
+    doc["stackWarnings"] = memoryReportStackWarnings(&report);
+    sendJson(request, 200, doc);
+  });
+
   // API pour contrôler une sortie
   server.on("/api/io/set", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
-      JsonDocument doc;
+      PooledJsonDocument doc;
       if (deserializeJson(doc, (const char*)data) != DeserializationError::Ok) {
         request->send(400, "application/json", "{\"success\":false, \"message\":\"Invalid JSON\"}");
         return;
@@ -64,10 +229,19 @@ void setupWebServer() {
       const char* ioName = doc["name"];
       bool state = doc["state"];
 
-      for (int i = 0; i < ioPinCount; i++) {
-        if (strcmp(ioPins[i].name, ioName) == 0) {
-          if (ioPins[i].mode == 2) { // OUTPUT
-            executeCommand(ioPins[i].pin, state);
+      IOTableReader table;
+      for (int i = 0; i < table->count; i++) {
+        if (strcmp(table->pins[i].name, ioName) == 0) {
+          if (table->pins[i].mode == 2) { // OUTPUT
+            CommandMsg cmd = {};
+            cmd.pin = table->pins[i].pin;
+            cmd.state = state;
+            cmd.received_us = getCurrentTimeMicros();
+            eventLogWrite(EVENT_COMMAND, cmd.pin, cmd.state, nullptr, EVENT_SOURCE_WEB);
+            if (!submitCommand(&cmd)) {
+              request->send(503, "application/json", "{\"success\":false, \"message\":\"File de commandes pleine\"}");
+              return;
+            }
             request->send(200, "application/json", "{\"success\":true, \"message\":\"IO mis à jour\"}");
           } else {
             request->send(400, "application/json", "{\"success\":false, \"message\":\"Cet IO n'est pas une sortie\"}");
@@ -80,21 +254,126 @@ void setupWebServer() {
     }
   );
 
+  // Calibration du délai de commutation d'une sortie à l'aide d'une entrée de retour
+  server.on("/api/io/calibrate", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
+    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+      PooledJsonDocument doc;
+      if (deserializeJson(doc, data, len) != DeserializationError::Ok) {
+        request->send(400, "application/json", "{\"success\":false, \"message\":\"Invalid JSON\"}");
+        return;
+      }
+      IOTableReader table;
+      int out = ioTableFindByName(table.get(), doc["output"] | "");
+      int fb = ioTableFindByName(table.get(), doc["feedback"] | "");
+      if (out < 0 || fb < 0) {
+        request->send(404, "application/json", "{\"success\":false, \"message\":\"IO non trouvé\"}");
+        return;
+      }
+      if (!calibrationStart(table->pins[out].pin, table->pins[fb].pin, constrain(doc["cycles"] | CALIBRATION_DEFAULT_CYCLES, 1, CALIBRATION_MAX_CYCLES),
+                            doc["apply"] | true)) {
+        request->send(409, "application/json",
+                      "{\"success\":false, \"message\":\"Calibration en cours ou IO incompatibles (sortie + entrée)\"}");
+        return;
+      }
+      request->send(202, "application/json", "{\"success\":true, \"message\":\"Calibration lancée\"}");
+    }
+  );
+
+  server.on("/api/io/calibrate", HTTP_GET, [](AsyncWebServerRequest *request){
+    static const char* const STATES[] = { "idle", "running", "done", "failed" };
+    CalibrationStatus cal;
+    calibrationGetStatus(&cal);
+    PooledJsonDocument doc;
+    doc["state"] = STATES[cal.state & 3];
+    doc["outputPin"] = cal.outputPin;
+    doc["feedbackPin"] = cal.feedbackPin;
+    doc["cycles"] = cal.cycles;
+    if (cal.state == CALIBRATION_DONE || cal.state == CALIBRATION_FAILED) {
+      doc["actuationOnUs"] = cal.onUs;
+      doc["actuationOffUs"] = cal.offUs;
+      doc["onSamples"] = cal.onSamples;
+      doc["offSamples"] = cal.offSamples;
+      doc["applied"] = cal.applied;
+      if (cal.error[0] != '\0') doc["error"] = cal.error;
+    }
+    sendJson(request, 200, doc);
+  });
+
+  // Statistiques de fronts d'une entrée : GET /api/io/<nom>/stats, DELETE pour remettre à zéro.
+  // Déclaré après /api/io/set et /api/io/calibrate : "/api/io" reçoit aussi les sous-chemins
+  server.on("/api/io", HTTP_GET | HTTP_DELETE, [](AsyncWebServerRequest *request){
+    String url = request->url();
+    const char* prefix = "/api/io/";
+    const char* suffix = "/stats";
+    if (!url.startsWith(prefix) || !url.endsWith(suffix) || url.length() <= strlen(prefix) + strlen(suffix)) {
+      request->send(404, "application/json", "{\"success\":false, \"message\":\"Not found\"}");
+      return;
+    }
+    String name = url.substring(strlen(prefix), url.length() - strlen(suffix));
+
+    IOTableReader table;
+    int index = ioTableFindByName(table.get(), name.c_str());
+    if (index < 0) {
+      request->send(404, "application/json", "{\"success\":false, \"message\":\"IO non trouvé\"}");
+      return;
+    }
+    if (table->pins[index].mode != 1) { // INPUT
+      request->send(400, "application/json", "{\"success\":false, \"message\":\"Cet IO n'est pas une entrée numérique\"}");
+      return;
+    }
+    if (request->method() == HTTP_DELETE) {
+      inputStatsRequestReset(index);
+      request->send(200, "application/json", "{\"success\":true, \"message\":\"Statistiques remises à zéro\"}");
+      return;
+    }
+    EdgeStats stats;
+    if (!inputStatsRead(index, &stats)) {
+      request->send(503, "application/json", "{\"success\":false, \"message\":\"Statistiques en cours de mise à jour\"}");
+      return;
+    }
+    PooledJsonDocument doc;
+    inputStatsToJson(table->pins[index], stats, doc.to<JsonObject>());
+    doc["statsIntervalMs"] = table->pins[index].statsIntervalMs;
+    doc["statsOnly"] = table->pins[index].statsOnly;
+    sendJson(request, 200, doc);
+  });
+
   // API pour récupérer la config des IOs
   server.on("/api/ios", HTTP_GET, [](AsyncWebServerRequest *request){
-    JsonDocument doc;
+    PooledJsonDocument doc(true);
     JsonArray ios = doc["ios"].to<JsonArray>();
-    for (int i = 0; i < ioPinCount; i++) {
+    IOTableReader table;
+    for (int i = 0; i < table->count; i++) {
+      const IOPin& pin = table->pins[i];
       JsonObject io = ios.add<JsonObject>();
-      io["name"] = ioPins[i].name;
-      io["pin"] = ioPins[i].pin;
-      io["mode"] = ioPins[i].mode;
-      io["inputType"] = ioPins[i].inputType;
-      io["defaultState"] = ioPins[i].defaultState;
-    }
-    String response;
-    serializeJson(doc, response);
-    request->send(200, "application/json", response);
+      io["name"] = pin.name;
+      io["pin"] = pin.pin;
+      io["mode"] = pin.mode;
+      io["inputType"] = pin.inputType;
+      io["defaultState"] = pin.defaultState;
+      io["publishIntervalMs"] = pin.publishIntervalMs;
+      io["minPublishIntervalMs"] = pin.minPublishIntervalMs;
+      io["publishTransitions"] = pin.publishTransitions;
+      if (ioTableIsFixed(i)) io["fixed"] = true;  // Profil de carte : GPIO et mode figés
+      if (pin.mode == 1) { // INPUT
+        io["statsIntervalMs"] = pin.statsIntervalMs;
+        io["statsOnly"] = pin.statsOnly;
+      }
+      if (pin.mode == 2) { // OUTPUT
+        io["restorePolicy"] = pin.restorePolicy;
+        io["actuationOnUs"] = pin.actuationOnUs;
+        io["actuationOffUs"] = pin.actuationOffUs;
+      }
+      if (pin.mode == 4) { // ANALOG
+        io["oversampleShift"] = pin.oversampleShift;
+        io["filterType"] = pin.filterType;
+        io["filterShift"] = pin.filterShift;
+        io["calGain"] = pin.calGain;
+        io["calOffset"] = pin.calOffset;
+        io["deadband"] = pin.deadband;
+      }
+    }
+    sendJson(request, 200, doc);
   });
 
   // API pour enregistrer la config des IOs
@@ -102,31 +381,77 @@ void setupWebServer() {
     [](AsyncWebServerRequest *request){},
     NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
-    JsonDocument doc;
+    PooledJsonDocument doc(true);
     if (deserializeJson(doc, (const char*)data) != DeserializationError::Ok) {
         request->send(400, "application/json", "{\"success\":false, \"message\":\"Invalid JSON\"}");
         return;
     }
     JsonArray newIOs = doc["ios"];
-    ioPinCount = 0;
     for (JsonObject ioData : newIOs) {
-        if (ioPinCount < MAX_IOS) {
-            strlcpy(ioPins[ioPinCount].name, ioData["name"], sizeof(ioPins[ioPinCount].name));
-            ioPins[ioPinCount].pin = ioData["pin"];
-            ioPins[ioPinCount].mode = ioData["mode"];
-            ioPins[ioPinCount].inputType = ioData["inputType"] | 1; // Default to PULLUP if not specified
-            ioPins[ioPinCount].defaultState = ioData["defaultState"];
-            ioPinCount++;
-        }
+      if (ioNameReserved(ioData["name"] | "")) {
+        request->send(400, "application/json", "{\"success\":false, \"message\":\"Nom d'I/O réservé : get\"}");
+        return;
+      }
     }
+    // Copie de la table courante : sert à ne reconfigurer que les broches modifiées
+    std::unique_ptr<IOTable> previous(new IOTable);
+    {
+      IOTableReader current;
+      memcpy(previous.get(), current.get(), sizeof(IOTable));
+    }
+    // Construire la nouvelle table dans le tampon inactif puis la publier d'un coup :
+    // les lecteurs voient soit l'ancienne configuration, soit la nouvelle, jamais un mélange
+    ioTableUpdate([&](IOTable& table) {
+      table.count = 0;
+      for (JsonObject ioData : newIOs) {
+        if (table.count >= MAX_IOS) break;
+        int gpio = ioData["pin"] | -1;
+        if (gpio < 0 || gpio >= MAX_GPIO) continue; // GPIO invalide
+        IOPin& pin = table.pins[table.count];
+        memset(&pin, 0, sizeof(IOPin));
+        strlcpy(pin.name, ioData["name"] | "", sizeof(pin.name));
+        pin.pin = gpio;
+        pin.mode = ioData["mode"];
+        pin.inputType = ioData["inputType"] | 1; // Default to PULLUP if not specified
+        pin.defaultState = ioData["defaultState"];
+        bool isAnalog = pin.mode == 4;
+        pin.publishIntervalMs = ioData["publishIntervalMs"] | (isAnalog ? DEFAULT_ANALOG_HEARTBEAT_MS : DEFAULT_COUNTER_INTERVAL_MS);
+        pin.oversampleShift = ioData["oversampleShift"] | DEFAULT_ANALOG_OVERSAMPLE;
+        if (pin.oversampleShift > 6) pin.oversampleShift = 6; // 64 lectures max
+        pin.filterType = ioData["filterType"] | ANALOG_FILTER_IIR;
+        pin.filterShift = ioData["filterShift"] | DEFAULT_ANALOG_FILTER_SHIFT;
+        if (pin.filterShift > ANALOG_MAX_FILTER_SHIFT) pin.filterShift = ANALOG_MAX_FILTER_SHIFT;
+        pin.calGain = ioData["calGain"] | ANALOG_GAIN_ONE;
+        pin.calOffset = ioData["calOffset"] | 0;
+        pin.deadband = ioData["deadband"] | DEFAULT_ANALOG_DEADBAND;
+        pin.minPublishIntervalMs = ioData["minPublishIntervalMs"] | 0;
+        pin.publishTransitions = ioData["publishTransitions"] | false;
+        pin.actuationOnUs = min((uint32_t)(ioData["actuationOnUs"] | 0), (uint32_t)ACTUATION_MAX_US);
+        pin.actuationOffUs = min((uint32_t)(ioData["actuationOffUs"] | 0), (uint32_t)ACTUATION_MAX_US);
+        pin.restorePolicy = (ioData["restorePolicy"] | RESTORE_DEFAULT) == RESTORE_LAST ? RESTORE_LAST : RESTORE_DEFAULT;
+        pin.statsIntervalMs = ioData["statsIntervalMs"] | 0;
+        pin.statsOnly = ioData["statsOnly"] | false;
+        table.count++;
+      }
+      // Broches du profil de carte : GPIO / mode imposés, réinsérées si supprimées
+      ioTableApplyBoardProfile(table);
+    });
     saveIOs();
-    applyIOPinModes();
-    request->send(200, "application/json", "{\"success\":true, \"message\":\"Configuration I/O enregistrée.\"}");
+    IOApplyResult applied = applyIOPinChanges(previous.get());
+    configReloadRecord(CONFIG_APPLY_IN_PLACE, CONFIG_CHANGE_IOS, applied.durationUs / 1000);
+
+    PooledJsonDocument result;
+    result["success"] = true;
+    result["message"] = "Configuration I/O enregistrée.";
+    result["reapplied"] = applied.reapplied;
+    result["unchanged"] = applied.unchanged;
+    result["applyUs"] = applied.durationUs;
+    sendJson(request, 200, result);
   });
   
   // API pour récupérer la configuration système
   server.on("/api/config", HTTP_GET, [](AsyncWebServerRequest *request){
-    JsonDocument doc;
+    PooledJsonDocument doc(true);
     doc["deviceName"] = config.deviceName;
     doc["useStaticIP"] = config.useStaticIP;
     doc["staticIP"] = config.staticIP;
@@ -136,10 +461,10 @@ void setupWebServer() {
     doc["mqttPort"] = config.mqttPort;
     doc["mqttUser"] = config.mqttUser;
     doc["mqttTopic"] = config.mqttTopic;
+    doc["groups"] = config.groups;
+    doc["timezone"] = config.timezone;
     
-    String response;
-    serializeJson(doc, response);
-    request->send(200, "application/json", response);
+    sendJson(request, 200, doc);
   });
   
   // API pour enregistrer la configuration système
@@ -147,34 +472,191 @@ void setupWebServer() {
     [](AsyncWebServerRequest *request){},
     NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
-      JsonDocument doc;
+      PooledJsonDocument doc;
       if (deserializeJson(doc, (const char*)data) != DeserializationError::Ok) {
         request->send(400, "application/json", "{\"success\":false, \"message\":\"Invalid JSON\"}");
         return;
       }
     
-      if (doc["deviceName"]) strlcpy(config.deviceName, doc["deviceName"], sizeof(config.deviceName));
-      config.useStaticIP = doc["useStaticIP"];
-      if (doc["staticIP"]) strlcpy(config.staticIP, doc["staticIP"], sizeof(config.staticIP));
-      if (doc["staticGateway"]) strlcpy(config.staticGateway, doc["staticGateway"], sizeof(config.staticGateway));
-      if (doc["staticSubnet"]) strlcpy(config.staticSubnet, doc["staticSubnet"], sizeof(config.staticSubnet));
-
-      if (doc["mqttServer"]) strlcpy(config.mqttServer, doc["mqttServer"], sizeof(config.mqttServer));
-      if (doc["mqttPort"]) config.mqttPort = doc["mqttPort"];
-      if (doc["mqttUser"]) strlcpy(config.mqttUser, doc["mqttUser"], sizeof(config.mqttUser));
+      // Nouvelle configuration construite à part, puis comparée à la courante
+      Config next = config;
+      if (doc["deviceName"]) strlcpy(next.deviceName, doc["deviceName"], sizeof(next.deviceName));
+      next.useStaticIP = doc["useStaticIP"] | config.useStaticIP;  // Absent d'un envoi partiel : inchangé
+      if (doc["staticIP"]) strlcpy(next.staticIP, doc["staticIP"], sizeof(next.staticIP));
+      if (doc["staticGateway"]) strlcpy(next.staticGateway, doc["staticGateway"], sizeof(next.staticGateway));
+      if (doc["staticSubnet"]) strlcpy(next.staticSubnet, doc["staticSubnet"], sizeof(next.staticSubnet));
+
+      if (doc["mqttServer"]) strlcpy(next.mqttServer, doc["mqttServer"], sizeof(next.mqttServer));
+      if (doc["mqttPort"]) next.mqttPort = doc["mqttPort"];
+      if (doc["mqttUser"]) strlcpy(next.mqttUser, doc["mqttUser"], sizeof(next.mqttUser));
       if (doc["mqttPassword"] && !doc["mqttPassword"].isNull() && strlen(doc["mqttPassword"]) > 0) {
-        strlcpy(config.mqttPassword, doc["mqttPassword"], sizeof(config.mqttPassword));
+        strlcpy(next.mqttPassword, doc["mqttPassword"], sizeof(next.mqttPassword));
       }
-      if (doc["mqttTopic"]) strlcpy(config.mqttTopic, doc["mqttTopic"], sizeof(config.mqttTopic));
-      
+      if (doc["mqttTopic"]) strlcpy(next.mqttTopic, doc["mqttTopic"], sizeof(next.mqttTopic));
+      if (doc["groups"].is<const char*>()) groupListNormalize(doc["groups"], next.groups, sizeof(next.groups));
+      if (doc["timezone"].is<const char*>()) {
+        TzRule tz;
+        const char* posix = doc["timezone"];
+        if (posix[0] != '\0' && !tzParse(posix, &tz)) {
+          request->send(400, "application/json", "{\"success\":false, \"message\":\"Fuseau horaire invalide\"}");
+          return;
+        }
+        strlcpy(next.timezone, posix, sizeof(next.timezone));
+      }
+
+      uint16_t changes = configDiff(&config, &next);
+      uint8_t level = configApplyLevel(changes);
+      char changeNames[96];
+      configChangeFormat(changes, changeNames, sizeof(changeNames));
+
+      PooledJsonDocument result;
+      result["success"] = true;
+      result["apply"] = configApplyName(level);
+      result["changes"] = changeNames;
+      if (level == CONFIG_APPLY_RESTART) {
+        result["message"] = "Configuration enregistrée, redémarrage...";
+      } else if (level == CONFIG_APPLY_RECONNECT) {
+        result["message"] = "Configuration appliquée, reconnexion MQTT...";
+      } else {
+        result["message"] = "Configuration appliquée.";
+      }
+
+      if (level != CONFIG_APPLY_RESTART) {
+        configApply(&next, changes);
+        if (changes) saveConfig();
+        sendJson(request, 200, result);
+        return;
+      }
+
+      // Réseau modifié : seul WiFiManager l'applique, au démarrage
+      config = next;
       saveConfig();
-      
-      request->send(200, "application/json", "{\"success\":true, \"message\":\"Configuration enregistrée, redémarrage...\"}");
+      sendJson(request, 200, result);
+      configReloadMarkRestart(changes);
+      outputJournalFlush(millis(), true);  // Pas de changement perdu au redémarrage
       delay(1000);
       ESP.restart();
     }
   );
 
+  // API pour changer les groupes de diffusion à chaud (sans redémarrage)
+  server.on("/api/groups", HTTP_POST,
+    [](AsyncWebServerRequest *request){},
+    NULL,
+    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+      PooledJsonDocument doc;
+      if (deserializeJson(doc, data, len) != DeserializationError::Ok || !doc["groups"].is<const char*>()) {
+        request->send(400, "application/json", "{\"success\":false, \"message\":\"Invalid JSON\"}");
+        return;
+      }
+
+      setMqttGroups(doc["groups"]);
+      saveConfig();
+
+      PooledJsonDocument response;
+      response["success"] = true;
+      response["message"] = "Groupes mis à jour.";
+      response["groups"] = config.groups;
+      sendJson(request, 200, response);
+    }
+  );
+
+  // API des programmations récurrentes
+  server.on("/api/schedules", HTTP_GET, [](AsyncWebServerRequest *request){
+    ScheduleEntry entries[MAX_SCHEDULES];
+    int count = scheduleTableGet(entries);
+    IOTableReader table;
+
+    PooledJsonDocument doc(true);
+    doc["timezone"] = config.timezone;
+    doc["now"] = (uint32_t)(getCurrentTimeMicros() / 1000000ULL);
+    JsonArray list = doc["schedules"].to<JsonArray>();
+    for (int i = 0; i < count; i++) {
+      const Schedule& s = entries[i].schedule;
+      JsonObject item = list.add<JsonObject>();
+      int idx = ioTableFindByPin(table.get(), s.pin);
+      item["io"] = idx >= 0 ? table->pins[idx].name : "";
+      item["pin"] = s.pin;
+      item["state"] = s.state;
+      item["kind"] = scheduleKindName(s.kind);
+      if (s.kind == SCHEDULE_INTERVAL) {
+        item["every"] = s.interval;
+        item["anchor"] = s.anchor;
+      } else {
+        char time[9];
+        scheduleFormatTimeOfDay(s.timeOfDay, time, sizeof(time));
+        item["time"] = time;
+        JsonArray days = item["days"].to<JsonArray>();
+        for (int d = 0; d < 7; d++) {
+          if (s.weekdays & (1 << d)) days.add(SCHEDULE_WEEKDAY_NAMES[d]);
+        }
+      }
+      item["missed"] = s.missedPolicy == SCHEDULE_MISSED_FIRE_ONCE ? "fire_once" : "skip";
+      item["enabled"] = s.enabled != 0;
+      item["lastFired"] = s.lastFired;
+      item["nextFire"] = entries[i].nextFire;
+    }
+    sendJson(request, 200, doc);
+  });
+
+  // Remplace toutes les programmations (prise en compte immédiate, sans redémarrage)
+  server.on("/api/schedules", HTTP_POST,
+    [](AsyncWebServerRequest *request){},
+    NULL,
+    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+      PooledJsonDocument doc(true);
+      if (deserializeJson(doc, data, len) != DeserializationError::Ok) {
+        request->send(400, "application/json", "{\"success\":false, \"message\":\"Invalid JSON\"}");
+        return;
+      }
+
+      Schedule list[MAX_SCHEDULES];
+      int count = 0;
+      IOTableReader table;
+      for (JsonObject item : doc["schedules"].as<JsonArray>()) {
+        if (count >= MAX_SCHEDULES) break;
+        Schedule& s = list[count];
+        memset(&s, 0, sizeof(Schedule));
+        int idx = ioTableFindByName(table.get(), item["io"] | "");
+        s.kind = scheduleKindFromName(item["kind"] | "");
+        bool valid = idx >= 0 && table->pins[idx].mode == 2 && s.kind != SCHEDULE_NONE; // OUTPUT
+        if (valid) {
+          s.pin = table->pins[idx].pin;
+          s.state = item["state"] | 0;
+          s.enabled = (item["enabled"] | true) ? 1 : 0;
+          s.missedPolicy = strcmp(item["missed"] | "skip", "fire_once") == 0 ? SCHEDULE_MISSED_FIRE_ONCE
+                                                                             : SCHEDULE_MISSED_SKIP;
+          if (s.kind == SCHEDULE_INTERVAL) {
+            s.interval = item["every"] | 0;
+            s.anchor = item["anchor"] | 0;
+            valid = s.interval >= SCHEDULE_MIN_INTERVAL_SEC;
+          } else {
+            valid = scheduleParseTimeOfDay(item["time"] | "", &s.timeOfDay);
+            for (JsonVariant day : item["days"].as<JsonArray>()) {
+              int d = scheduleWeekdayFromName(day | "");
+              if (d < 0) valid = false;
+              else s.weekdays |= 1 << d;
+            }
+            if (s.kind == SCHEDULE_WEEKLY && s.weekdays == 0) valid = false;
+          }
+        }
+        if (!valid) {
+          PooledJsonDocument response;
+          response["success"] = false;
+          response["message"] = "Programmation invalide";
+          response["index"] = count;
+          sendJson(request, 400, response);
+          return;
+        }
+        count++;
+      }
+
+      scheduleTableSet(list, count);
+      saveSchedules();
+      request->send(200, "application/json", "{\"success\":true, \"message\":\"Programmations enregistrées.\"}");
+    }
+  );
+
   // API pour contrôler la connexion MQTT
   server.on("/api/mqtt/connect", HTTP_POST, [](AsyncWebServerRequest *request){
     mqttEnabled = true;
@@ -184,11 +666,115 @@ void setupWebServer() {
 
   server.on("/api/mqtt/disconnect", HTTP_POST, [](AsyncWebServerRequest *request){
     mqttEnabled = false;
-    mqttClient.disconnect();
+    disconnectMQTT();
     request->send(200, "application/json", "{\"success\":true, \"message\":\"MQTT déconnecté.\"}");
   });
 
-  // ElegantOTA pour les mises à jour
+  // Journal d'événements en NDJSON, envoyé par morceaux : jamais plus d'une ligne
+  // formatée en RAM. ?since=<seq> (suite d'une lecture précédente), ?type=command,
+  // ?limit=N, ?source=flash pour l'historique persisté sur SPIFFS.
+  server.on("/api/logs", HTTP_GET, [](AsyncWebServerRequest *request){
+    uint8_t typeFilter = 0;
+    if (request->hasParam("type")) {
+      typeFilter = eventTypeFromName(request->getParam("type")->value().c_str());
+      if (typeFilter == 0) {
+        request->send(400, "application/json", "{\"success\":false, \"message\":\"Type inconnu\"}");
+        return;
+      }
+    }
+
+    if (request->hasParam("source") && request->getParam("source")->value() == "flash") {
+      if (!EVENT_LOG_PERSIST) {
+        request->send(404, "application/json", "{\"success\":false, \"message\":\"Persistance désactivée (EVENT_LOG_PERSIST)\"}");
+        return;
+      }
+      auto reader = std::make_shared<EventLogFlashReader>();
+      eventLogFlashOpen(reader.get(), typeFilter);
+      request->send(request->beginChunkedResponse("application/x-ndjson",
+        [reader](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          return eventLogFlashStream(reader.get(), buffer, maxLen);
+        }));
+      return;
+    }
+
+    auto cursor = std::make_shared<LogStreamCursor>();
+    cursor->end = eventLogHead(&eventLog);
+    cursor->next = eventLogOldest(&eventLog);
+    if (request->hasParam("since")) {
+      // Un since déjà écrasé produit une ligne "gap" avec le nombre d'événements perdus
+      uint32_t since = request->getParam("since")->value().toInt();
+      if (since > 0) cursor->next = since < cursor->end ? since : cursor->end;
+    }
+    cursor->limit = request->hasParam("limit") ? request->getParam("limit")->value().toInt() : UINT32_MAX;
+    cursor->typeFilter = typeFilter;
+
+    AsyncWebServerResponse *response = request->beginChunkedResponse("application/x-ndjson",
+      [cursor](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+        size_t len = 0;
+        char line[EVENT_JSON_MAX_LEN];
+        while (cursor->next < cursor->end && cursor->limit > 0) {
+          EventRecord rec;
+          if (!eventLogRead(&eventLog, cursor->next, &rec)) {
+            uint32_t oldest = eventLogOldest(&eventLog);
+            if (cursor->next >= oldest) {
+              cursor->next = cursor->end;  // Pas encore validé : fin du flux
+              break;
+            }
+            // Écrasé pendant l'envoi : signaler le trou et reprendre au plus ancien
+            size_t n = snprintf(line, sizeof(line), "{\"type\":\"gap\",\"lost\":%lu}\n",
+                                (unsigned long)(oldest - cursor->next));
+            if (len + n > maxLen) break;
+            memcpy(buffer + len, line, n);
+            len += n;
+            cursor->next = oldest;
+            continue;
+          }
+          if (cursor->typeFilter != 0 && rec.type != cursor->typeFilter) {
+            cursor->next++;
+            continue;
+          }
+          size_t n = eventLogFormatJson(&rec, line, sizeof(line));
+          if (len + n > maxLen) break;
+          memcpy(buffer + len, line, n);
+          len += n;
+          cursor->next++;
+          cursor->limit--;
+        }
+        return len;
+      });
+    // Reprise (sans limit) : ?since=<X-Log-Next> au prochain appel
+    response->addHeader("X-Log-Next", String(cursor->end));
+    request->send(response);
+  });
+
+  // Mise à jour différentielle : patch ota_delta.py appliqué au fil de l'envoi
+  server.on("/api/ota/delta", HTTP_POST,
+    [](AsyncWebServerRequest *request){
+      OtaDeltaResult result;
+      otaDeltaEnd(request, &result);
+      PooledJsonDocument doc;
+      doc["success"] = result.status == DELTA_DONE;
+      doc["status"] = deltaStatusName(result.status);
+      doc["message"] = result.message;
+      doc["patchBytes"] = result.patchBytes;
+      doc["imageBytes"] = result.targetBytes;
+      doc["durationMs"] = result.durationMs;
+      int code = result.status == DELTA_DONE ? 200 : result.status == DELTA_ERR_REJECTED ? 409 : 400;
+      sendJson(request, code, doc);
+      if (result.status == DELTA_DONE) {
+        outputJournalFlush(millis(), true);
+        delay(1000);
+        ESP.restart();
+      }
+    },
+    [](AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final){
+      // Session refusée (autre envoi en cours) : les morceaux sont ignorés, la réponse le signale
+      if (index == 0 && !otaDeltaBegin(request)) return;
+      otaDeltaWrite(request, data, len);
+    }
+  );
+
+  // ElegantOTA pour les mises à jour (image complète)
   ElegantOTA.begin(&server);
   
   server.begin();
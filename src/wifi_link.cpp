@@ -0,0 +1,231 @@
+#include "wifi_link.h"
+#include <freertos/semphr.h>
+#include "config.h"
+
+extern Config config;
+
+// ===== ACCÈS AU WiFi =====
+#ifdef ESP_PLATFORM
+#include <WiFi.h>
+#include <Preferences.h>
+#include <lwip/etharp.h>
+#include <lwip/netif.h>
+#include <lwip/tcpip.h>
+
+extern Preferences preferences;
+
+// Vérification de l'adresse imposée par le cache (NetTask seulement)
+enum { ADDR_CHECK_NONE, ADDR_CHECK_PENDING, ADDR_CHECK_PROBING };
+static uint8_t addrCheck = ADDR_CHECK_NONE;
+static uint32_t addrCheckGateway = 0;
+static uint32_t addrCheckStartMs = 0;
+static uint32_t addrProbeMs = 0;
+static volatile bool gatewayResolved = false;
+
+// Contexte tcpip : passerelle déjà dans la table ARP, sinon nouvelle requête
+static void gatewayProbe(void* arg) {
+  ip4_addr_t gateway;
+  gateway.addr = (uint32_t)(uintptr_t)arg;
+  struct netif* netif;
+  NETIF_FOREACH(netif) {
+    if (!netif_is_up(netif) || !ip4_addr_netcmp(&gateway, netif_ip4_addr(netif), netif_ip4_netmask(netif))) continue;
+    struct eth_addr* mac;
+    const ip4_addr_t* ip;
+    if (etharp_find_addr(netif, &gateway, &mac, &ip) >= 0) gatewayResolved = true;
+    else etharp_request(netif, &gateway);
+  }
+}
+
+// Associé avec l'adresse du cache : lien accepté quand la passerelle répond en
+// ARP. Sans réponse (réseau renuméroté), WIFI_LINK_ADDR_REJECTED et repli DHCP
+static uint8_t checkImposedAddress() {
+  uint32_t now = millis();
+  if (addrCheck == ADDR_CHECK_PENDING) {
+    addrCheck = ADDR_CHECK_PROBING;
+    gatewayResolved = false;
+    addrCheckStartMs = now;
+    addrProbeMs = now - WIFI_ADDR_PROBE_MS;
+  }
+  if (gatewayResolved) {
+    addrCheck = ADDR_CHECK_NONE;
+    return WIFI_LINK_UP;
+  }
+  if (now - addrCheckStartMs >= WIFI_ADDR_CHECK_MS) {
+    addrCheck = ADDR_CHECK_NONE;
+    return WIFI_LINK_ADDR_REJECTED;
+  }
+  if (now - addrProbeMs >= WIFI_ADDR_PROBE_MS) {
+    addrProbeMs = now;
+    tcpip_callback(gatewayProbe, (void*)(uintptr_t)addrCheckGateway);
+  }
+  return WIFI_LINK_CONNECTING;
+}
+
+static bool deviceConnect(void* ctx, const WifiLinkCache* cache) {
+  char ssid[33];
+  char pass[65];
+  preferences.getString("wifiSSID", ssid, sizeof(ssid));
+  preferences.getString("wifiPass", pass, sizeof(pass));
+  if (ssid[0] == '\0') return false;  // Jamais connecté : portail WiFiManager
+
+  // IP statique configurée : déjà appliquée au démarrage, on n'y touche pas
+  addrCheck = ADDR_CHECK_NONE;
+  if (!config.useStaticIP) {
+    if (cache != NULL && WIFI_FAST_REUSE_IP && cache->ip != 0) {
+      WiFi.config(IPAddress(cache->ip), IPAddress(cache->gateway), IPAddress(cache->subnet), IPAddress(cache->dns));
+      addrCheck = ADDR_CHECK_PENDING;
+      addrCheckGateway = cache->gateway;
+    } else {
+      WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));  // DHCP
+    }
+  }
+  wl_status_t status = cache != NULL ? WiFi.begin(ssid, pass, cache->channel, cache->bssid) : WiFi.begin(ssid, pass);
+  return status != WL_CONNECT_FAILED;
+}
+
+static uint8_t deviceStatus(void* ctx) {
+  switch (WiFi.status()) {
+    case WL_CONNECTED: return addrCheck != ADDR_CHECK_NONE ? checkImposedAddress() : WIFI_LINK_UP;
+    case WL_CONNECT_FAILED:
+    case WL_NO_SSID_AVAIL: return WIFI_LINK_FAILED;
+    default: return WIFI_LINK_CONNECTING;
+  }
+}
+
+static void deviceDisconnect(void* ctx) {
+  addrCheck = ADDR_CHECK_NONE;
+  WiFi.disconnect(false, false);  // Radio active, identifiants conservés
+}
+
+static void deviceCurrent(void* ctx, WifiLinkCache* out) {
+  const uint8_t* bssid = WiFi.BSSID();
+  if (bssid == NULL) return;
+  memcpy(out->bssid, bssid, sizeof(out->bssid));
+  out->channel = WiFi.channel();
+  if (!config.useStaticIP) {
+    out->ip = (uint32_t)WiFi.localIP();
+    out->gateway = (uint32_t)WiFi.gatewayIP();
+    out->subnet = (uint32_t)WiFi.subnetMask();
+    out->dns = (uint32_t)WiFi.dnsIP(0);
+  }
+}
+
+static const WifiReconnectOps linkOps = { deviceConnect, deviceStatus, deviceDisconnect, deviceCurrent, NULL };
+
+static void loadCache(WifiLinkCache* cache) {
+  if (preferences.getBytes("wifiCache", cache, sizeof(WifiLinkCache)) != sizeof(WifiLinkCache)) {
+    memset(cache, 0, sizeof(WifiLinkCache));
+  }
+}
+
+static void saveCache(const WifiLinkCache* cache) {
+  preferences.putBytes("wifiCache", cache, sizeof(WifiLinkCache));
+}
+
+static void forgetCache() {
+  preferences.remove("wifiCache");
+}
+
+static void disableSdkReconnect() {
+  WiFi.setAutoReconnect(false);
+}
+#else
+// Simulateur : lien simulé (sim_wifi.h), cache en mémoire
+#include "sim_wifi.h"
+
+static const WifiReconnectOps& linkOps = simWifiLinkOps;
+static WifiLinkCache storedCache;
+
+static void loadCache(WifiLinkCache* cache) { *cache = storedCache; }
+static void saveCache(const WifiLinkCache* cache) { storedCache = *cache; }
+static void forgetCache() { memset(&storedCache, 0, sizeof(storedCache)); }
+static void disableSdkReconnect() {}
+#endif
+
+// ===== ÉTAT =====
+// Machine à états pilotée par NetTask (setup() avant son démarrage). La fin de
+// mesure arrive de la tâche qui établit la session MQTT (async_tcp avec le
+// backend asynchrone) : les accès passent par un mutex, jamais tenu longtemps.
+static WifiReconnect reconnect;
+static bool begunOnline = false;        // Lien établi par wifiLinkBegin (cache déjà rafraîchi)
+static SemaphoreHandle_t linkMutex = NULL;
+
+struct LinkLock {
+  LinkLock() { if (linkMutex) xSemaphoreTakeRecursive(linkMutex, portMAX_DELAY); }
+  ~LinkLock() { if (linkMutex) xSemaphoreGiveRecursive(linkMutex); }
+};
+
+static void saveIfDirty() {
+  if (!reconnect.cacheDirty) return;
+  reconnect.cacheDirty = false;
+  saveCache(&reconnect.cache);
+  Serial.printf("✓ WiFi cache saved (channel %u)\n", reconnect.cache.channel);
+}
+
+bool wifiLinkBegin() {
+  if (linkMutex == NULL) linkMutex = xSemaphoreCreateRecursiveMutex();
+  WifiLinkCache cache;
+  loadCache(&cache);
+  wifiReconnectInit(&reconnect, &cache);
+  if (cache.channel == 0) return false;
+
+  uint32_t startMs = millis();
+  wifiReconnectStart(&reconnect, &linkOps, startMs);
+  Serial.printf("⚡ WiFi fast connect (channel %u)...\n", cache.channel);
+  while (reconnect.state == WIFI_RC_FAST || reconnect.state == WIFI_RC_SCAN) {
+    wifiReconnectPoll(&reconnect, &linkOps, millis());
+    delay(10);
+  }
+  if (reconnect.state != WIFI_RC_ONLINE) {
+    Serial.printf("⚠️ WiFi fast connect failed after %lu ms, starting WiFiManager\n",
+                  (unsigned long)(millis() - startMs));
+    linkOps.disconnect(linkOps.ctx);
+    return false;
+  }
+  Serial.printf("✓ WiFi up in %lu ms (%s)\n", (unsigned long)reconnect.stats.lastLinkMs,
+                reconnect.stats.fastOk ? "cached BSSID" : "scan");
+  begunOnline = true;
+  return true;
+}
+
+void wifiLinkConnected() {
+  LinkLock lock;
+  // Connecté par le portail : cache rempli (premier démarrage) ou corrigé
+  if (!begunOnline) wifiReconnectLinkUp(&reconnect, &linkOps, millis());
+  saveIfDirty();
+  disableSdkReconnect();
+}
+
+uint8_t wifiLinkPoll(uint32_t nowMs) {
+  LinkLock lock;
+  uint8_t previous = reconnect.state;
+  uint32_t rejected = reconnect.stats.addrRejected;
+  uint8_t event = wifiReconnectPoll(&reconnect, &linkOps, nowMs);
+  if (reconnect.stats.addrRejected != rejected) {
+    Serial.println("⚠️ WiFi cached address rejected, retrying with DHCP");
+  }
+  if (event == WIFI_RC_EVENT_LOST) {
+    Serial.printf("📡 WiFi link lost, reconnecting (%s)\n", wifiReconnectStateName(reconnect.state));
+  } else if (event == WIFI_RC_EVENT_UP) {
+    Serial.printf("📡 WiFi link back in %lu ms (%s)\n", (unsigned long)reconnect.stats.lastLinkMs,
+                  previous == WIFI_RC_FAST ? "cached BSSID" : "scan");
+    saveIfDirty();
+  }
+  return event;
+}
+
+void wifiLinkMqttOnline(uint32_t nowMs) {
+  LinkLock lock;
+  wifiReconnectMqttOnline(&reconnect, nowMs);
+}
+
+void wifiLinkForget() {
+  forgetCache();
+}
+
+void wifiLinkGetStats(WifiLinkStats* stats) {
+  LinkLock lock;
+  stats->state = reconnect.state;
+  stats->channel = reconnect.cache.channel;
+  stats->reconnect = reconnect.stats;
+}
@@ -0,0 +1,52 @@
+#ifndef WIFI_LINK_H
+#define WIFI_LINK_H
+
+#include <Arduino.h>
+#include "wifi_reconnect.h"
+
+// ===== LIEN WiFi (reconnexion rapide) =====
+// Branche la machine de wifi_reconnect.h sur le WiFi de l'ESP32 (lien simulé
+// dans le simulateur, commande "wifi"). Le cache (BSSID, canal, adressage) est
+// gardé dans Preferences ("wifiCache") et réécrit seulement s'il change.
+//
+// Démarrage : wifiLinkBegin() tente d'abord l'association par le cache, puis
+// un scan avec les identifiants enregistrés ; le portail WiFiManager n'est
+// lancé qu'en cas d'échec. Ensuite NetTask appelle wifiLinkPoll() à chaque
+// tour : la reconnexion ne bloque ni la tâche I/O ni l'exécuteur.
+//
+// L'adresse du cache est réutilisée sans DHCP (WIFI_FAST_REUSE_IP) sauf en IP
+// statique. Elle n'est acceptée que si la passerelle du cache répond en ARP
+// sous WIFI_ADDR_CHECK_MS : sinon (réseau renuméroté) elle est oubliée et
+// l'association directe recommence avec DHCP. Un bail DHCP réattribué
+// entre-temps à un autre appareil du même réseau n'est pas détecté et
+// provoquerait un conflit : réserver l'adresse sur le routeur, ou compiler avec
+// -DWIFI_FAST_REUSE_IP=0 (association directe, puis DHCP).
+
+#ifndef WIFI_FAST_REUSE_IP
+#define WIFI_FAST_REUSE_IP 1
+#endif
+#ifndef WIFI_ADDR_CHECK_MS
+#define WIFI_ADDR_CHECK_MS 500        // Réponse ARP de la passerelle attendue
+#endif
+#define WIFI_ADDR_PROBE_MS 100        // Intervalle des requêtes ARP
+
+struct WifiLinkStats {
+  uint8_t state;            // WifiReconnectState
+  uint8_t channel;          // Canal du cache (0 : vide)
+  WifiReconnectStats reconnect;
+};
+
+// setup(), avant le portail : true si le lien est établi par le cache ou un scan
+bool wifiLinkBegin();
+// Lien établi (wifiLinkBegin ou portail) : la machine prend la main sur les
+// reconnexions (reconnexion automatique du SDK désactivée)
+void wifiLinkConnected();
+// NetTask : un pas de la machine (WIFI_RC_EVENT_UP : relancer MQTT sans attendre)
+uint8_t wifiLinkPoll(uint32_t nowMs);
+// Session MQTT établie (toute tâche) : clôt la mesure perte de lien -> en ligne
+void wifiLinkMqttOnline(uint32_t nowMs);
+// Oubli du cache (identifiants WiFi effacés)
+void wifiLinkForget();
+void wifiLinkGetStats(WifiLinkStats* stats);
+
+#endif // WIFI_LINK_H
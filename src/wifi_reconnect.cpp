@@ -0,0 +1,155 @@
+#include "wifi_reconnect.h"
+#include <string.h>
+
+static bool fastUsable(const WifiReconnect* rc) {
+  return rc->cache.channel != 0 && rc->fastFailures < WIFI_FAST_MAX_FAILURES;
+}
+
+static void enter(WifiReconnect* rc, uint8_t state, uint32_t nowMs) {
+  rc->state = state;
+  rc->stateSinceMs = nowMs;
+}
+
+static void backoff(WifiReconnect* rc, uint32_t nowMs) {
+  if (rc->backoffMs == 0) rc->backoffMs = WIFI_BACKOFF_MIN_MS;
+  else if (rc->backoffMs < WIFI_BACKOFF_MAX_MS / 2) rc->backoffMs *= 2;
+  else rc->backoffMs = WIFI_BACKOFF_MAX_MS;
+  enter(rc, WIFI_RC_BACKOFF, nowMs);
+}
+
+// Association normale (scan complet) ; refus immédiat : attente puis nouvel essai
+static void startScan(WifiReconnect* rc, const WifiReconnectOps* ops, uint32_t nowMs) {
+  if (ops->connect(ops->ctx, NULL)) {
+    enter(rc, WIFI_RC_SCAN, nowMs);
+  } else {
+    rc->stats.scanFailed++;
+    backoff(rc, nowMs);
+  }
+}
+
+static void startAttempt(WifiReconnect* rc, const WifiReconnectOps* ops, uint32_t nowMs) {
+  if (fastUsable(rc)) {
+    if (ops->connect(ops->ctx, &rc->cache)) {
+      enter(rc, WIFI_RC_FAST, nowMs);
+      return;
+    }
+    rc->stats.fastFailed++;
+    rc->fastFailures++;
+  }
+  startScan(rc, ops, nowMs);
+}
+
+// Lien rétabli : mesure, fin de l'attente, cache rafraîchi s'il a changé
+static void linkUp(WifiReconnect* rc, const WifiReconnectOps* ops, uint32_t nowMs) {
+  if (rc->awaitingOnline) rc->stats.lastLinkMs = nowMs - rc->lostAtMs;
+  rc->fastFailures = 0;
+  rc->backoffMs = 0;
+  enter(rc, WIFI_RC_ONLINE, nowMs);
+
+  WifiLinkCache fresh;
+  memset(&fresh, 0, sizeof(fresh));
+  ops->current(ops->ctx, &fresh);
+  if (fresh.channel != 0 && memcmp(&fresh, &rc->cache, sizeof(fresh)) != 0) {
+    rc->cache = fresh;
+    rc->cacheDirty = true;
+  }
+}
+
+void wifiReconnectInit(WifiReconnect* rc, const WifiLinkCache* cache) {
+  memset(rc, 0, sizeof(WifiReconnect));
+  if (cache != NULL) rc->cache = *cache;
+  rc->state = WIFI_RC_ONLINE;
+}
+
+void wifiReconnectStart(WifiReconnect* rc, const WifiReconnectOps* ops, uint32_t nowMs) {
+  rc->lostAtMs = nowMs;
+  rc->awaitingOnline = true;
+  startAttempt(rc, ops, nowMs);
+}
+
+void wifiReconnectLinkUp(WifiReconnect* rc, const WifiReconnectOps* ops, uint32_t nowMs) {
+  if (rc->state == WIFI_RC_SCAN) rc->stats.scanOk++;
+  linkUp(rc, ops, nowMs);
+}
+
+uint8_t wifiReconnectPoll(WifiReconnect* rc, const WifiReconnectOps* ops, uint32_t nowMs) {
+  uint32_t elapsed = nowMs - rc->stateSinceMs;
+
+  switch (rc->state) {
+    case WIFI_RC_ONLINE:
+      if (ops->status(ops->ctx) == WIFI_LINK_UP) return WIFI_RC_EVENT_NONE;
+      rc->stats.losses++;
+      rc->lostAtMs = nowMs;
+      rc->awaitingOnline = true;
+      startAttempt(rc, ops, nowMs);
+      return WIFI_RC_EVENT_LOST;
+
+    case WIFI_RC_FAST: {
+      uint8_t status = ops->status(ops->ctx);
+      if (status == WIFI_LINK_UP) {
+        rc->stats.fastOk++;
+        linkUp(rc, ops, nowMs);
+        return WIFI_RC_EVENT_UP;
+      }
+      if (status == WIFI_LINK_ADDR_REJECTED && rc->cache.ip != 0) {
+        // Même BSSID / canal, adresse redemandée en DHCP ; le cache est corrigé au retour du lien
+        rc->stats.addrRejected++;
+        rc->cache.ip = 0;
+        rc->cacheDirty = true;
+        ops->disconnect(ops->ctx);
+        if (ops->connect(ops->ctx, &rc->cache)) {
+          enter(rc, WIFI_RC_FAST, nowMs);
+        } else {
+          startScan(rc, ops, nowMs);
+        }
+        return WIFI_RC_EVENT_NONE;
+      }
+      if (status == WIFI_LINK_FAILED || status == WIFI_LINK_ADDR_REJECTED || elapsed >= WIFI_FAST_TIMEOUT_MS) {
+        rc->stats.fastFailed++;
+        rc->fastFailures++;
+        ops->disconnect(ops->ctx);
+        startScan(rc, ops, nowMs);
+      }
+      return WIFI_RC_EVENT_NONE;
+    }
+
+    case WIFI_RC_SCAN: {
+      uint8_t status = ops->status(ops->ctx);
+      if (status == WIFI_LINK_UP) {
+        rc->stats.scanOk++;
+        linkUp(rc, ops, nowMs);
+        return WIFI_RC_EVENT_UP;
+      }
+      if (status == WIFI_LINK_FAILED || elapsed >= WIFI_SCAN_TIMEOUT_MS) {
+        rc->stats.scanFailed++;
+        ops->disconnect(ops->ctx);
+        backoff(rc, nowMs);
+      }
+      return WIFI_RC_EVENT_NONE;
+    }
+
+    default:  // WIFI_RC_BACKOFF
+      if (elapsed >= rc->backoffMs) startAttempt(rc, ops, nowMs);
+      return WIFI_RC_EVENT_NONE;
+  }
+}
+
+void wifiReconnectMqttOnline(WifiReconnect* rc, uint32_t nowMs) {
+  if (!rc->awaitingOnline) return;
+  rc->awaitingOnline = false;
+  WifiReconnectStats* s = &rc->stats;
+  s->lastOnlineMs = nowMs - rc->lostAtMs;
+  if (s->lastOnlineMs > s->maxOnlineMs) s->maxOnlineMs = s->lastOnlineMs;
+  s->avgOnlineMs = s->onlineSamples == 0 ? s->lastOnlineMs
+                                         : (uint32_t)(((uint64_t)s->avgOnlineMs * 7 + s->lastOnlineMs) / 8);
+  s->onlineSamples++;
+}
+
+const char* wifiReconnectStateName(uint8_t state) {
+  switch (state) {
+    case WIFI_RC_ONLINE: return "online";
+    case WIFI_RC_FAST: return "fast";
+    case WIFI_RC_SCAN: return "scan";
+    default: return "backoff";
+  }
+}
@@ -0,0 +1,131 @@
+#ifndef WIFI_RECONNECT_H
+#define WIFI_RECONNECT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ===== RECONNEXION WiFi RAPIDE =====
+// Module pur (sans Arduino) : l'accès au WiFi passe par quatre fonctions de
+// l'appelant (WiFi de l'ESP32, lien simulé, ou simulacre des tests).
+//
+// Le dernier point d'accès connu (BSSID, canal) et l'adressage obtenu sont
+// gardés en cache (Preferences sur l'ESP32). Après une perte de lien :
+//   1. FAST : association directe au BSSID / canal du cache, sans scan,
+//      avec l'adresse du cache (pas d'échange DHCP). Adresse refusée
+//      (WIFI_LINK_ADDR_REJECTED : réseau renuméroté, conflit) : oubliée, et
+//      nouvelle association directe avec DHCP ;
+//   2. SCAN : échec ou délai dépassé, association normale (scan complet, DHCP) ;
+//   3. BACKOFF : échec du scan, nouvel essai après une attente qui double
+//      (WIFI_BACKOFF_MIN_MS à WIFI_BACKOFF_MAX_MS), en repartant de FAST.
+// Après WIFI_FAST_MAX_FAILURES échecs FAST consécutifs (point d'accès
+// déplacé ou remplacé), le cache est ignoré jusqu'à la prochaine connexion.
+//
+// wifiReconnectPoll() ne bloque jamais : NetTask l'appelle à chaque tour, la
+// tâche I/O et l'exécuteur (programmations) continuent pendant la tentative.
+// Mesures : durée perte de lien -> lien rétabli, et perte de lien -> MQTT en
+// ligne (wifiReconnectMqttOnline, appelé à la connexion au broker).
+//
+//   WifiReconnect rc;
+//   wifiReconnectInit(&rc, &cache);
+//   wifiReconnectLinkUp(&rc, &ops, millis());              // lien déjà établi
+//   ...
+//   if (wifiReconnectPoll(&rc, &ops, millis()) == WIFI_RC_EVENT_UP && rc.cacheDirty) { sauver rc.cache }
+
+#ifndef WIFI_FAST_TIMEOUT_MS
+#define WIFI_FAST_TIMEOUT_MS 3000     // Association directe : quelques centaines de ms d'ordinaire
+#endif
+#ifndef WIFI_SCAN_TIMEOUT_MS
+#define WIFI_SCAN_TIMEOUT_MS 15000
+#endif
+#ifndef WIFI_BACKOFF_MIN_MS
+#define WIFI_BACKOFF_MIN_MS 1000
+#endif
+#ifndef WIFI_BACKOFF_MAX_MS
+#define WIFI_BACKOFF_MAX_MS 30000
+#endif
+#ifndef WIFI_FAST_MAX_FAILURES
+#define WIFI_FAST_MAX_FAILURES 3
+#endif
+
+// Dernière connexion réussie. Adresses IPv4 telles que IPAddress -> uint32_t.
+struct WifiLinkCache {
+  uint8_t bssid[6];
+  uint8_t channel;       // 0 : cache vide
+  uint32_t ip;           // 0 : adresse non réutilisable (IP statique configurée, ou inconnue)
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+};
+
+enum WifiLinkStatus {
+  WIFI_LINK_DOWN = 0,
+  WIFI_LINK_CONNECTING,
+  WIFI_LINK_UP,           // Associé, adresse IP attribuée
+  WIFI_LINK_FAILED,       // Tentative refusée (point d'accès absent, authentification)
+  WIFI_LINK_ADDR_REJECTED // Associé, mais l'adresse imposée par le cache n'est pas utilisable
+};
+
+struct WifiReconnectOps {
+  // Lance une association sans attendre. cache non NULL : BSSID, canal et
+  // adresse imposés ; NULL : association normale avec scan et DHCP
+  bool (*connect)(void* ctx, const WifiLinkCache* cache);
+  uint8_t (*status)(void* ctx);                     // WifiLinkStatus
+  void (*disconnect)(void* ctx);                    // Abandon de la tentative en cours
+  void (*current)(void* ctx, WifiLinkCache* out);   // Paramètres du lien établi
+  void* ctx;
+};
+
+enum WifiReconnectState {
+  WIFI_RC_ONLINE = 0,
+  WIFI_RC_FAST,
+  WIFI_RC_SCAN,
+  WIFI_RC_BACKOFF
+};
+
+enum WifiReconnectEvent {
+  WIFI_RC_EVENT_NONE = 0,
+  WIFI_RC_EVENT_LOST,     // Lien perdu, reconnexion lancée
+  WIFI_RC_EVENT_UP        // Lien rétabli (cacheDirty : cache à sauvegarder)
+};
+
+struct WifiReconnectStats {
+  uint32_t losses;        // Pertes de lien
+  uint32_t fastOk;        // Reconnexions par le cache, sans scan
+  uint32_t fastFailed;
+  uint32_t addrRejected;  // Adresses du cache refusées (repli DHCP)
+  uint32_t scanOk;
+  uint32_t scanFailed;
+  uint32_t lastLinkMs;    // Perte -> lien rétabli, dernière reconnexion
+  uint32_t lastOnlineMs;  // Perte -> MQTT en ligne
+  uint32_t maxOnlineMs;
+  uint32_t avgOnlineMs;   // Moyenne glissante (1/8)
+  uint32_t onlineSamples;
+};
+
+struct WifiReconnect {
+  uint8_t state;            // WifiReconnectState
+  WifiLinkCache cache;
+  bool cacheDirty;          // Cache modifié depuis la dernière sauvegarde
+  uint8_t fastFailures;     // Échecs FAST consécutifs
+  uint32_t stateSinceMs;
+  uint32_t lostAtMs;
+  uint32_t backoffMs;
+  bool awaitingOnline;      // Perte mesurée, MQTT pas encore reconnecté
+  WifiReconnectStats stats;
+};
+
+// cache : dernier cache sauvegardé (NULL ou channel 0 : vide). Départ en ONLINE.
+void wifiReconnectInit(WifiReconnect* rc, const WifiLinkCache* cache);
+// Lance une tentative tout de suite (démarrage), FAST si le cache est utilisable.
+// La durée jusqu'au lien puis jusqu'à MQTT est mesurée depuis cet appel.
+void wifiReconnectStart(WifiReconnect* rc, const WifiReconnectOps* ops, uint32_t nowMs);
+// Lien établi hors de la machine (portail WiFiManager au démarrage) : passe en
+// ONLINE et rafraîchit le cache
+void wifiReconnectLinkUp(WifiReconnect* rc, const WifiReconnectOps* ops, uint32_t nowMs);
+// Un pas de la machine à états, sans attente
+uint8_t wifiReconnectPoll(WifiReconnect* rc, const WifiReconnectOps* ops, uint32_t nowMs);
+// Session MQTT établie : clôt la mesure de la dernière perte de lien
+void wifiReconnectMqttOnline(WifiReconnect* rc, uint32_t nowMs);
+const char* wifiReconnectStateName(uint8_t state);
+
+#endif // WIFI_RECONNECT_H
@@ -0,0 +1,57 @@
+// Banc de mesure hôte de la chaîne ANALOG (filtre + calibration + zone morte),
+// en ns par échantillon. Les durées sont affichées, seule une borne large est
+// vérifiée : le but est de comparer les filtres entre eux et d'une version à l'autre.
+#include <unity.h>
+#include <chrono>
+#include <stdio.h>
+#include "analog_input.h"
+
+#define BENCH_SAMPLES 1000000
+#define BENCH_MAX_NS_PER_SAMPLE 2000   // Très au-dessus d'une passe réelle, même sous sanitizers
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Signal ADC 12 bits reproductible : rampe lente + bruit pseudo-aléatoire
+static int32_t adcSample(uint32_t* seed, uint32_t n) {
+  *seed = *seed * 1664525UL + 1013904223UL;
+  return (int32_t)((n >> 8) % 4096 + (*seed >> 28)) & 0xFFF;
+}
+
+static double benchFilter(uint8_t filterType, uint8_t shift, uint32_t* published) {
+  AnalogChannel ch;
+  analogChannelReset(&ch);
+  uint32_t seed = 1;
+  *published = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < BENCH_SAMPLES; n++) {
+    int32_t filtered = analogFilterSample(&ch, adcSample(&seed, n), filterType, shift);
+    int32_t value = analogCalibrate(filtered, ANALOG_GAIN_ONE * 3 / 2, -20);
+    if (analogShouldPublish(&ch, value, 10, n * 10, 60000)) (*published)++;
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+  return elapsed.count() / BENCH_SAMPLES;
+}
+
+static void benchOne(const char* name, uint8_t filterType, uint8_t shift) {
+  uint32_t published;
+  double ns = benchFilter(filterType, shift, &published);
+  char line[128];
+  snprintf(line, sizeof(line), "%-10s %7.1f ns/sample, %lu publications / %d samples", name, ns,
+           (unsigned long)published, BENCH_SAMPLES);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_LESS_THAN(BENCH_MAX_NS_PER_SAMPLE, (long)ns);
+  TEST_ASSERT_GREATER_THAN(0, published);
+}
+
+static void test_bench_none(void) { benchOne("none", ANALOG_FILTER_NONE, 0); }
+static void test_bench_iir(void) { benchOne("iir/8", ANALOG_FILTER_IIR, 3); }
+static void test_bench_median(void) { benchOne("median/5", ANALOG_FILTER_MEDIAN, 0); }
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_bench_none);
+  RUN_TEST(test_bench_iir);
+  RUN_TEST(test_bench_median);
+  return UNITY_END();
+}
@@ -0,0 +1,93 @@
+// Filtres en virgule fixe, calibration et décision de publication des entrées ANALOG
+#include <unity.h>
+#include "analog_input.h"
+
+static AnalogChannel ch;
+
+void setUp(void) { analogChannelReset(&ch); }
+void tearDown(void) {}
+
+static void test_iir_first_sample_primes_state(void) {
+  TEST_ASSERT_EQUAL_INT32(2000, analogFilterSample(&ch, 2000, ANALOG_FILTER_IIR, 3));
+  TEST_ASSERT_EQUAL_INT32(2000, ch.raw);
+}
+
+static void test_iir_step_response(void) {
+  // alpha = 1/8 : après n échantillons, y = x * (1 - (7/8)^n)
+  analogFilterSample(&ch, 0, ANALOG_FILTER_IIR, 3);
+  int32_t y = 0;
+  for (int n = 1; n <= 8; n++) y = analogFilterSample(&ch, 1000, ANALOG_FILTER_IIR, 3);
+  TEST_ASSERT_INT32_WITHIN(2, 656, y);   // 1000 * (1 - 0,875^8) = 656,4
+  for (int n = 0; n < 200; n++) y = analogFilterSample(&ch, 1000, ANALOG_FILTER_IIR, 3);
+  TEST_ASSERT_EQUAL_INT32(1000, y);      // État Q8 : converge sans biais de troncature
+}
+
+static void test_iir_rounds_to_nearest(void) {
+  analogFilterSample(&ch, 0, ANALOG_FILTER_IIR, 1);
+  TEST_ASSERT_EQUAL_INT32(1, analogFilterSample(&ch, 1, ANALOG_FILTER_IIR, 1));  // 0,5 -> 1
+}
+
+static void test_iir_shift_is_bounded(void) {
+  // Un décalage >= 32 serait indéfini : borné à ANALOG_MAX_FILTER_SHIFT
+  analogFilterSample(&ch, 0, ANALOG_FILTER_IIR, 255);
+  for (int n = 0; n < 1000; n++) analogFilterSample(&ch, 4095, ANALOG_FILTER_IIR, 255);
+  AnalogChannel ref;
+  analogChannelReset(&ref);
+  analogFilterSample(&ref, 0, ANALOG_FILTER_IIR, ANALOG_MAX_FILTER_SHIFT);
+  for (int n = 0; n < 1000; n++) analogFilterSample(&ref, 4095, ANALOG_FILTER_IIR, ANALOG_MAX_FILTER_SHIFT);
+  TEST_ASSERT_EQUAL_INT32(ref.iirState, ch.iirState);
+  TEST_ASSERT_GREATER_THAN(0, ch.iirState);
+}
+
+static void test_median_rejects_spikes(void) {
+  const int32_t samples[] = { 100, 4095, 101, 0, 102, 103 };
+  const int32_t expected[] = { 100, 4095, 101, 101, 101, 102 };  // Fenêtre partielle : médiane haute
+  for (int i = 0; i < 6; i++) {
+    TEST_ASSERT_EQUAL_INT32(expected[i], analogFilterSample(&ch, samples[i], ANALOG_FILTER_MEDIAN, 0));
+  }
+}
+
+static void test_median_sliding_window(void) {
+  for (int32_t v = 1; v <= 5; v++) analogFilterSample(&ch, v * 10, ANALOG_FILTER_MEDIAN, 0);
+  // Fenêtre {20,30,40,50,60} après l'éviction du plus ancien
+  TEST_ASSERT_EQUAL_INT32(40, analogFilterSample(&ch, 60, ANALOG_FILTER_MEDIAN, 0));
+  TEST_ASSERT_EQUAL_UINT8(ANALOG_MEDIAN_WINDOW, ch.windowFill);
+}
+
+static void test_no_filter_passes_through(void) {
+  TEST_ASSERT_EQUAL_INT32(1234, analogFilterSample(&ch, 1234, ANALOG_FILTER_NONE, 0));
+}
+
+static void test_calibration_q16(void) {
+  TEST_ASSERT_EQUAL_INT32(1000, analogCalibrate(1000, ANALOG_GAIN_ONE, 0));
+  TEST_ASSERT_EQUAL_INT32(2500 - 40, analogCalibrate(1000, ANALOG_GAIN_ONE * 5 / 2, -40));
+  TEST_ASSERT_EQUAL_INT32(-500, analogCalibrate(1000, -ANALOG_GAIN_ONE / 2, 0));
+  // 4095 * 3300/4095 (mV) : le produit passe par 64 bits
+  TEST_ASSERT_INT32_WITHIN(1, 3300, analogCalibrate(4095, (int32_t)(3300LL * 65536 / 4095), 0));
+}
+
+static void test_deadband_and_heartbeat(void) {
+  TEST_ASSERT_TRUE(analogShouldPublish(&ch, 500, 10, 0, 60000));     // Première valeur
+  TEST_ASSERT_FALSE(analogShouldPublish(&ch, 510, 10, 100, 60000));  // Dans la zone morte
+  TEST_ASSERT_TRUE(analogShouldPublish(&ch, 511, 10, 200, 60000));
+  TEST_ASSERT_FALSE(analogShouldPublish(&ch, 501, 10, 300, 60000));  // Écart mesuré depuis 511
+  TEST_ASSERT_TRUE(analogShouldPublish(&ch, 500, 10, 300, 60000));
+  TEST_ASSERT_FALSE(analogShouldPublish(&ch, 500, 10, 60299, 60000));
+  TEST_ASSERT_TRUE(analogShouldPublish(&ch, 500, 10, 60300, 60000));  // Heartbeat
+  TEST_ASSERT_FALSE(analogShouldPublish(&ch, 500, 10, 999999, 0));    // Heartbeat désactivé
+  TEST_ASSERT_EQUAL_INT32(500, ch.value);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_iir_first_sample_primes_state);
+  RUN_TEST(test_iir_step_response);
+  RUN_TEST(test_iir_rounds_to_nearest);
+  RUN_TEST(test_iir_shift_is_bounded);
+  RUN_TEST(test_median_rejects_spikes);
+  RUN_TEST(test_median_sliding_window);
+  RUN_TEST(test_no_filter_passes_through);
+  RUN_TEST(test_calibration_q16);
+  RUN_TEST(test_deadband_and_heartbeat);
+  return UNITY_END();
+}
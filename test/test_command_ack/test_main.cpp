@@ -0,0 +1,60 @@
+// Cache d'idempotence des identifiants de commande
+#include <unity.h>
+#include <stdio.h>
+#include "command_ack.h"
+
+static DedupCache cache;
+
+void setUp(void) { dedupCacheReset(&cache); }
+void tearDown(void) {}
+
+static void test_second_delivery_is_duplicate(void) {
+  uint32_t h = commandIdHash("cmd-1");
+  TEST_ASSERT_FALSE(dedupCacheCheckAndInsert(&cache, h));
+  TEST_ASSERT_TRUE(dedupCacheCheckAndInsert(&cache, h));
+  TEST_ASSERT_FALSE(dedupCacheCheckAndInsert(&cache, commandIdHash("cmd-2")));
+}
+
+static void test_hash_never_zero(void) {
+  // 0 marque une case vide ou oubliée
+  TEST_ASSERT_TRUE(commandIdHash("") != 0);
+  TEST_ASSERT_TRUE(commandIdHash("a") != 0);
+}
+
+static void test_rejected_id_can_be_retried(void) {
+  uint32_t h = commandIdHash("retry-me");
+  TEST_ASSERT_FALSE(dedupCacheCheckAndInsert(&cache, h));
+  dedupCacheRemove(&cache, h);                              // Commande refusée (file pleine)
+  TEST_ASSERT_FALSE(dedupCacheCheckAndInsert(&cache, h));   // Nouvelle tentative : exécutée
+  TEST_ASSERT_TRUE(dedupCacheCheckAndInsert(&cache, h));    // Puis redélivrance : doublon
+}
+
+static void test_remove_keeps_other_ids(void) {
+  uint32_t a = commandIdHash("a"), b = commandIdHash("b");
+  dedupCacheCheckAndInsert(&cache, a);
+  dedupCacheCheckAndInsert(&cache, b);
+  dedupCacheRemove(&cache, a);
+  dedupCacheRemove(&cache, commandIdHash("unknown"));  // Sans effet
+  TEST_ASSERT_TRUE(dedupCacheCheckAndInsert(&cache, b));
+}
+
+static void test_oldest_evicted_when_full(void) {
+  char id[16];
+  for (int i = 0; i <= DEDUP_CACHE_SIZE; i++) {
+    snprintf(id, sizeof(id), "id-%d", i);
+    TEST_ASSERT_FALSE(dedupCacheCheckAndInsert(&cache, commandIdHash(id)));
+  }
+  TEST_ASSERT_FALSE(dedupCacheCheckAndInsert(&cache, commandIdHash("id-0")));  // Écrasé
+  snprintf(id, sizeof(id), "id-%d", DEDUP_CACHE_SIZE);
+  TEST_ASSERT_TRUE(dedupCacheCheckAndInsert(&cache, commandIdHash(id)));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_second_delivery_is_duplicate);
+  RUN_TEST(test_hash_never_zero);
+  RUN_TEST(test_rejected_id_can_be_retried);
+  RUN_TEST(test_remove_keeps_other_ids);
+  RUN_TEST(test_oldest_evicted_when_full);
+  return UNITY_END();
+}
@@ -0,0 +1,151 @@
+// Files de commandes et de publication, implémentation hôte (std::mutex /
+// std::condition_variable) exercée depuis des std::thread
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "command_queue.h"
+
+static uint64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static CommandMsg command(uint8_t pin, uint64_t seq) {
+  CommandMsg msg = {};
+  msg.pin = pin;
+  msg.received_us = seq;
+  snprintf(msg.id, sizeof(msg.id), "c%u-%llu", pin, (unsigned long long)seq);
+  return msg;
+}
+
+void setUp(void) {
+  commandQueueInit(4);
+  outboundQueueInit(4);
+}
+void tearDown(void) {}
+
+static void test_fifo_order_and_copy(void) {
+  for (uint64_t i = 0; i < 3; i++) {
+    CommandMsg msg = command(5, i);
+    TEST_ASSERT_TRUE(commandQueueSend(&msg));
+  }
+  CommandMsg out;
+  for (uint64_t i = 0; i < 3; i++) {
+    TEST_ASSERT_TRUE(commandQueueReceive(&out, 0));
+    TEST_ASSERT_EQUAL_UINT64(i, out.received_us);
+    char id[COMMAND_ID_MAX_LEN];
+    snprintf(id, sizeof(id), "c5-%llu", (unsigned long long)i);
+    TEST_ASSERT_EQUAL_STRING(id, out.id);
+  }
+  TEST_ASSERT_FALSE(commandQueueReceive(&out, 0));
+}
+
+static void test_full_queue_rejects_without_blocking(void) {
+  CommandMsg msg = command(1, 0);
+  for (int i = 0; i < 4; i++) TEST_ASSERT_TRUE(commandQueueSend(&msg));
+  uint64_t start = nowUs();
+  TEST_ASSERT_FALSE(commandQueueSend(&msg));
+  TEST_ASSERT_LESS_THAN(50000, (int)(nowUs() - start));
+
+  // Une place libérée : l'anneau reboucle
+  CommandMsg out;
+  TEST_ASSERT_TRUE(commandQueueReceive(&out, 0));
+  TEST_ASSERT_TRUE(commandQueueSend(&msg));
+  TEST_ASSERT_FALSE(commandQueueSend(&msg));
+}
+
+static void test_receive_times_out(void) {
+  CommandMsg out;
+  uint64_t start = nowUs();
+  TEST_ASSERT_FALSE(commandQueueReceive(&out, 20000));
+  uint64_t waited = nowUs() - start;
+  TEST_ASSERT_GREATER_OR_EQUAL(20000, (int)waited);
+  TEST_ASSERT_LESS_THAN(1000000, (int)waited);
+}
+
+// Le lecteur bloqué est réveillé par un envoi depuis un autre thread, bien avant son délai
+static void test_blocked_receiver_woken_by_sender(void) {
+  std::thread sender([] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CommandMsg msg = command(7, 42);
+    commandQueueSend(&msg);
+  });
+  CommandMsg out;
+  uint64_t start = nowUs();
+  bool got = commandQueueReceive(&out, 5000000);
+  uint64_t waited = nowUs() - start;
+  sender.join();
+  TEST_ASSERT_TRUE(got);
+  TEST_ASSERT_EQUAL_UINT64(42, out.received_us);
+  TEST_ASSERT_LESS_THAN(2000000, (int)waited);
+}
+
+// Plusieurs producteurs, un consommateur : rien de perdu, ordre conservé par producteur
+static void test_producers_and_consumer_threads(void) {
+  const int producers = 4;
+  const int perProducer = 2000;
+  commandQueueInit(8);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.emplace_back([p] {
+      for (int i = 0; i < perProducer; i++) {
+        CommandMsg msg = command(p, i);
+        while (!commandQueueSend(&msg)) std::this_thread::yield();  // File pleine : réessayer
+      }
+    });
+  }
+
+  uint64_t next[producers] = {};
+  int received = 0;
+  bool ordered = true;
+  CommandMsg out;
+  while (received < producers * perProducer && commandQueueReceive(&out, 2000000)) {
+    if (out.pin >= producers || out.received_us != next[out.pin]) ordered = false;
+    else next[out.pin]++;
+    received++;
+  }
+  for (auto& t : threads) t.join();
+
+  TEST_ASSERT_TRUE(ordered);
+  TEST_ASSERT_EQUAL_INT(producers * perProducer, received);
+  TEST_ASSERT_FALSE(commandQueueReceive(&out, 0));
+}
+
+// File de publication : CmdTask dépose, NetTask vide (même implémentation, file distincte)
+static void test_outbound_queue_is_independent(void) {
+  OutboundMsg ack = {};
+  ack.kind = OUTBOUND_ACK;
+  ack.status = "executed";
+  strncpy(ack.id, "a1", sizeof(ack.id));
+  ack.executed_us = 1234;
+  TEST_ASSERT_TRUE(outboundQueueSend(&ack));
+
+  CommandMsg cmd;
+  TEST_ASSERT_FALSE(commandQueueReceive(&cmd, 0));
+
+  std::atomic<bool> got(false);
+  OutboundMsg out = {};
+  std::thread net([&] { got = outboundQueueReceive(&out, 1000000); });
+  net.join();
+  TEST_ASSERT_TRUE(got);
+  TEST_ASSERT_EQUAL_UINT8(OUTBOUND_ACK, out.kind);
+  TEST_ASSERT_EQUAL_STRING("executed", out.status);
+  TEST_ASSERT_EQUAL_STRING("a1", out.id);
+  TEST_ASSERT_EQUAL_UINT64(1234, out.executed_us);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fifo_order_and_copy);
+  RUN_TEST(test_full_queue_rejects_without_blocking);
+  RUN_TEST(test_receive_times_out);
+  RUN_TEST(test_blocked_receiver_woken_by_sender);
+  RUN_TEST(test_producers_and_consumer_threads);
+  RUN_TEST(test_outbound_queue_is_independent);
+  return UNITY_END();
+}
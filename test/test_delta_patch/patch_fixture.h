@@ -0,0 +1,28 @@
+#ifndef PATCH_FIXTURE_H
+#define PATCH_FIXTURE_H
+
+#include <stdint.h>
+
+// Patch produit par ota_delta.make_patch(base, target), base et cible étant
+// construites par fixtureBase() / fixtureTarget() (test_main.cpp) :
+//   base   : 1500 octets pseudo-aléatoires (x = x * 1103515245 + 12345, octet x >> 16)
+//   cible  : octets 100-109 XOR 0x5A, 40 octets (i * 7) insérés en 700, 300 zéros ajoutés
+// Régénéré à la main si le format du patch change.
+
+static const uint8_t FIXTURE_BASE_SHA256[32] = { 0xf9, 0x8b, 0xf1, 0xcb, 0x38, 0x77, 0x4f, 0xa8, 0x49, 0xf3, 0xe2, 0xc3, 0x99, 0x24, 0x17, 0x01, 0xbd, 0x31, 0x3d, 0xaa, 0xb1, 0xad, 0x2e, 0x91, 0xa3, 0xe4, 0xef, 0x6b, 0x3d, 0xbd, 0x82, 0xec };
+
+static const uint8_t FIXTURE_PATCH[] = {
+  0x45, 0x44, 0x4c, 0x54, 0x01, 0x00, 0x00, 0x00, 0xdc, 0x05, 0x00, 0x00, 0x30, 0x07, 0x00, 0x00,
+  0xf9, 0x8b, 0xf1, 0xcb, 0x38, 0x77, 0x4f, 0xa8, 0x49, 0xf3, 0xe2, 0xc3, 0x99, 0x24, 0x17, 0x01,
+  0xbd, 0x31, 0x3d, 0xaa, 0xb1, 0xad, 0x2e, 0x91, 0xa3, 0xe4, 0xef, 0x6b, 0x3d, 0xbd, 0x82, 0xec,
+  0x01, 0xe8, 0x18, 0x4d, 0xb6, 0x53, 0x49, 0x7d, 0x38, 0x60, 0xd7, 0x4d, 0x5e, 0x4f, 0x2c, 0xbd,
+  0x71, 0x8c, 0x1f, 0xdf, 0xca, 0x5a, 0x7d, 0xeb, 0x8f, 0x45, 0xda, 0x67, 0x7e, 0xc8, 0x9e, 0x6d,
+  0xdf, 0xbc, 0x05, 0x00, 0x28, 0x00, 0x00, 0x0f, 0x51, 0xb6, 0xb6, 0xff, 0xb6, 0x2a, 0x56, 0x26,
+  0xc6, 0x3a, 0xd6, 0x56, 0xfc, 0x4c, 0x0f, 0x31, 0x00, 0x0f, 0xff, 0xfb, 0x07, 0x0e, 0x15, 0x1c,
+  0x23, 0x2a, 0xff, 0x31, 0x38, 0x3f, 0x46, 0x4d, 0x54, 0x5b, 0x62, 0xff, 0x69, 0x70, 0x77, 0x7e,
+  0x85, 0x8c, 0x93, 0x9a, 0xff, 0xa1, 0xa8, 0xaf, 0xb6, 0xbd, 0xc4, 0xcb, 0xd2, 0xff, 0xd9, 0xe0,
+  0xe7, 0xee, 0xf5, 0xfc, 0x03, 0x0a, 0x3f, 0x11, 0xa0, 0x06, 0x00, 0xac, 0x02, 0x17, 0x2f, 0xff,
+  0xdb, 0x00, 0x0f, 0xff, 0xff, 0x50,
+};
+
+#endif // PATCH_FIXTURE_H
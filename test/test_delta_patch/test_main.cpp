@@ -0,0 +1,221 @@
+// Application d'un patch différentiel : reconstruction, patch tronqué ou corrompu,
+// image source refusée
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "delta_patch.h"
+#include "patch_fixture.h"
+
+static std::vector<uint8_t> fixtureBase() {
+  std::vector<uint8_t> out;
+  uint32_t x = 1;
+  for (int i = 0; i < 1500; i++) {
+    x = x * 1103515245u + 12345u;
+    out.push_back((uint8_t)(x >> 16));
+  }
+  return out;
+}
+
+static std::vector<uint8_t> fixtureTarget() {
+  std::vector<uint8_t> t = fixtureBase();
+  for (int i = 100; i < 110; i++) t[i] ^= 0x5A;
+  std::vector<uint8_t> inserted;
+  for (int i = 0; i < 40; i++) inserted.push_back((uint8_t)(i * 7));
+  t.insert(t.begin() + 700, inserted.begin(), inserted.end());
+  t.insert(t.end(), 300, 0);
+  return t;
+}
+
+// Image en cours d'exécution et partition cible simulées
+struct Device {
+  std::vector<uint8_t> source;
+  std::vector<uint8_t> target;
+  const uint8_t* sourceSha256;           // Empreinte de l'image en cours (calculée par ota_delta.cpp)
+  int reads;
+  bool failRead;
+  bool failWrite;
+};
+
+static bool readSource(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+  Device* d = (Device*)ctx;
+  d->reads++;
+  if (d->failRead || offset + len > d->source.size()) return false;
+  memcpy(buf, d->source.data() + offset, len);
+  return true;
+}
+
+static bool writeTarget(void* ctx, const uint8_t* buf, size_t len) {
+  Device* d = (Device*)ctx;
+  if (d->failWrite) return false;
+  d->target.insert(d->target.end(), buf, buf + len);
+  return true;
+}
+
+// Comme ota_delta.cpp : patch refusé s'il a été produit pour une autre image source
+static bool checkHeader(void* ctx, const DeltaHeader* header) {
+  Device* d = (Device*)ctx;
+  return header->sourceSize == d->source.size() && memcmp(header->sourceSha256, d->sourceSha256, 32) == 0;
+}
+
+static DeltaPatch patch;
+static Device device;
+
+static int8_t apply(const uint8_t* data, size_t len, size_t chunk) {
+  deltaPatchBegin(&patch, readSource, writeTarget, &device, checkHeader);
+  for (size_t i = 0; i < len; i += chunk) {
+    size_t n = len - i < chunk ? len - i : chunk;
+    int8_t status = deltaPatchFeed(&patch, data + i, n);
+    if (status < 0) return status;
+  }
+  return deltaPatchFinish(&patch);
+}
+
+// Patch écrit à la main : en-tête puis enregistrements en littéraux LZSS seulement
+static std::vector<uint8_t> literalPatch(uint32_t sourceSize, uint32_t targetSize, const std::vector<uint8_t>& records) {
+  std::vector<uint8_t> p(DELTA_HEADER_SIZE, 0);
+  memcpy(p.data(), DELTA_MAGIC, 4);
+  p[4] = DELTA_VERSION;
+  for (int k = 0; k < 4; k++) {
+    p[8 + k] = (uint8_t)(sourceSize >> (8 * k));
+    p[12 + k] = (uint8_t)(targetSize >> (8 * k));
+  }
+  memcpy(p.data() + 16, FIXTURE_BASE_SHA256, 32);
+  for (size_t i = 0; i < records.size(); i++) {
+    if (i % 8 == 0) p.push_back(0xFF);
+    p.push_back(records[i]);
+  }
+  return p;
+}
+
+void setUp(void) {
+  device = Device();
+  device.source = fixtureBase();
+  device.sourceSha256 = FIXTURE_BASE_SHA256;
+}
+void tearDown(void) {}
+
+static void test_fixture_rebuilds_target(void) {
+  std::vector<uint8_t> expected = fixtureTarget();
+  TEST_ASSERT_EQUAL_INT(DELTA_DONE, apply(FIXTURE_PATCH, sizeof(FIXTURE_PATCH), sizeof(FIXTURE_PATCH)));
+  TEST_ASSERT_EQUAL_UINT32(expected.size(), device.target.size());
+  TEST_ASSERT_EQUAL_MEMORY(expected.data(), device.target.data(), expected.size());
+  TEST_ASSERT_EQUAL_UINT32(expected.size(), deltaPatchProgress(&patch));
+}
+
+static void test_any_chunking_gives_same_image(void) {
+  // Le patch arrive par morceaux HTTP de taille quelconque : l'état est repris octet par octet
+  std::vector<uint8_t> expected = fixtureTarget();
+  const size_t chunks[] = { 1, 3, 79, 81 };
+  for (size_t c : chunks) {
+    setUp();
+    TEST_ASSERT_EQUAL_INT(DELTA_DONE, apply(FIXTURE_PATCH, sizeof(FIXTURE_PATCH), c));
+    TEST_ASSERT_TRUE(device.target == expected);
+  }
+}
+
+static void test_truncated_patch_never_completes(void) {
+  for (size_t cut = 0; cut < sizeof(FIXTURE_PATCH); cut++) {
+    setUp();
+    int8_t status = apply(FIXTURE_PATCH, cut, 16);
+    TEST_ASSERT_EQUAL_INT(DELTA_ERR_TRUNCATED, status);
+    TEST_ASSERT_TRUE(device.target.size() < fixtureTarget().size());
+  }
+}
+
+static void test_base_hash_mismatch_rejected_before_any_io(void) {
+  static const uint8_t otherSha[32] = { 0x01 };
+  device.sourceSha256 = otherSha;          // Appareil sur une autre version du firmware
+  TEST_ASSERT_EQUAL_INT(DELTA_ERR_REJECTED, apply(FIXTURE_PATCH, sizeof(FIXTURE_PATCH), 32));
+  TEST_ASSERT_EQUAL_INT(0, device.reads);
+  TEST_ASSERT_EQUAL_UINT32(0, device.target.size());
+
+  // Même empreinte mais taille source différente : refusé aussi
+  setUp();
+  device.source.pop_back();
+  TEST_ASSERT_EQUAL_INT(DELTA_ERR_REJECTED, apply(FIXTURE_PATCH, sizeof(FIXTURE_PATCH), 32));
+}
+
+static void test_bad_magic_and_version(void) {
+  std::vector<uint8_t> p(FIXTURE_PATCH, FIXTURE_PATCH + sizeof(FIXTURE_PATCH));
+  p[0] = 'X';
+  TEST_ASSERT_EQUAL_INT(DELTA_ERR_MAGIC, apply(p.data(), p.size(), p.size()));
+  p[0] = 'E';
+  p[4] = DELTA_VERSION + 1;
+  TEST_ASSERT_EQUAL_INT(DELTA_ERR_VERSION, apply(p.data(), p.size(), p.size()));
+  TEST_ASSERT_EQUAL_STRING("bad_version", deltaStatusName(patch.status));
+}
+
+static void test_reference_before_window_start(void) {
+  std::vector<uint8_t> p = literalPatch(1500, 4, {});
+  p.push_back(0x00);                       // Drapeaux : références
+  p.push_back(0xFF);                       // Distance 4096 sans aucun octet décompressé
+  p.push_back(0xF0);
+  TEST_ASSERT_EQUAL_INT(DELTA_ERR_CORRUPT, apply(p.data(), p.size(), p.size()));
+}
+
+static void test_seek_outside_source(void) {
+  // addLen 4, seek +1500 (zigzag 3000 = 0xB8 0x17) : au-delà de l'image source
+  std::vector<uint8_t> p = literalPatch(1500, 4, { 0x04, 0xB8, 0x17, 0x00, 1, 2, 3, 4 });
+  TEST_ASSERT_EQUAL_INT(DELTA_ERR_SOURCE_RANGE, apply(p.data(), p.size(), p.size()));
+}
+
+static void test_records_beyond_target_size(void) {
+  // insertLen 5 pour une cible annoncée de 4 octets
+  std::vector<uint8_t> p = literalPatch(1500, 4, { 0x00, 0x00, 0x05, 1, 2, 3, 4, 5 });
+  TEST_ASSERT_EQUAL_INT(DELTA_ERR_TARGET_OVERFLOW, apply(p.data(), p.size(), p.size()));
+
+  // Image complète suivie d'un enregistrement de trop
+  p = literalPatch(1500, 2, { 0x00, 0x00, 0x02, 9, 8, 0x00 });
+  TEST_ASSERT_EQUAL_INT(DELTA_ERR_TARGET_OVERFLOW, apply(p.data(), p.size(), p.size()));
+}
+
+static void test_add_and_insert_records(void) {
+  // 3 octets source + 1 (mod 256) à partir de 10, puis 2 octets insérés
+  std::vector<uint8_t> p = literalPatch(1500, 5, { 0x03, 0x14, 0x02, 1, 1, 1, 0xAA, 0xBB });
+  TEST_ASSERT_EQUAL_INT(DELTA_DONE, apply(p.data(), p.size(), p.size()));
+  const uint8_t expected[] = { (uint8_t)(device.source[10] + 1), (uint8_t)(device.source[11] + 1),
+                               (uint8_t)(device.source[12] + 1), 0xAA, 0xBB };
+  TEST_ASSERT_EQUAL_UINT32(5, device.target.size());
+  TEST_ASSERT_EQUAL_MEMORY(expected, device.target.data(), 5);
+}
+
+static void test_corrupt_body_stays_bounded(void) {
+  // Un octet quelconque altéré : erreur ou image différente (rejetée ensuite par le
+  // SHA-256 cible), mais jamais plus d'octets que la taille annoncée
+  size_t targetSize = fixtureTarget().size();
+  for (size_t i = DELTA_HEADER_SIZE; i < sizeof(FIXTURE_PATCH); i++) {
+    for (uint8_t mask : { 0x01, 0x80, 0xFF }) {
+      std::vector<uint8_t> p(FIXTURE_PATCH, FIXTURE_PATCH + sizeof(FIXTURE_PATCH));
+      p[i] ^= mask;
+      setUp();
+      apply(p.data(), p.size(), 7);
+      TEST_ASSERT_LESS_OR_EQUAL(targetSize, device.target.size());
+    }
+  }
+}
+
+static void test_read_and_write_failures(void) {
+  device.failRead = true;
+  TEST_ASSERT_EQUAL_INT(DELTA_ERR_READ, apply(FIXTURE_PATCH, sizeof(FIXTURE_PATCH), 64));
+  setUp();
+  device.failWrite = true;
+  TEST_ASSERT_EQUAL_INT(DELTA_ERR_WRITE, apply(FIXTURE_PATCH, sizeof(FIXTURE_PATCH), 64));
+  // Erreur mémorisée : la suite du patch est ignorée
+  TEST_ASSERT_EQUAL_INT(DELTA_ERR_WRITE, deltaPatchFeed(&patch, FIXTURE_PATCH, 1));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fixture_rebuilds_target);
+  RUN_TEST(test_any_chunking_gives_same_image);
+  RUN_TEST(test_truncated_patch_never_completes);
+  RUN_TEST(test_base_hash_mismatch_rejected_before_any_io);
+  RUN_TEST(test_bad_magic_and_version);
+  RUN_TEST(test_reference_before_window_start);
+  RUN_TEST(test_seek_outside_source);
+  RUN_TEST(test_records_beyond_target_size);
+  RUN_TEST(test_add_and_insert_records);
+  RUN_TEST(test_corrupt_body_stays_bounded);
+  RUN_TEST(test_read_and_write_failures);
+  return UNITY_END();
+}
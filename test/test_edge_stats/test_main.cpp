@@ -0,0 +1,192 @@
+// Statistiques de fronts : durées haut / bas, rapport cyclique, historique,
+// et lecture par verrou de séquence pendant que l'écrivain tourne (std::thread)
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "edge_stats.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_first_edge_has_no_width_and_same_level_is_ignored(void) {
+  EdgeStats s = {};
+  edgeStatsReset(&s, false, 1000);
+  TEST_ASSERT_EQUAL_UINT32(0, s.seq & 1);
+  uint32_t seq = s.seq;
+
+  edgeStatsOnEdge(&s, false, 1500);        // Même niveau : pas un front
+  TEST_ASSERT_EQUAL_UINT32(seq, s.seq);
+  TEST_ASSERT_EQUAL_UINT32(0, s.edges);
+
+  // Le niveau bas a commencé avant la remise à zéro : pas de durée
+  edgeStatsOnEdge(&s, true, 2000);
+  TEST_ASSERT_EQUAL_UINT32(seq + 2, s.seq);
+  TEST_ASSERT_EQUAL_UINT32(1, s.edges);
+  TEST_ASSERT_EQUAL_UINT32(0, s.low.count + s.high.count);
+  TEST_ASSERT_TRUE(s.level);
+  TEST_ASSERT_EQUAL_UINT32(2000, s.lastEdgeUs);
+  TEST_ASSERT_EQUAL_UINT16(0, edgeStatsDutyPermille(&s));
+  TEST_ASSERT_EQUAL_UINT32(0, pulseWidthAvgUs(&s.high));
+}
+
+static void test_widths_min_max_avg(void) {
+  EdgeStats s = {};
+  edgeStatsReset(&s, false, 0);
+  edgeStatsOnEdge(&s, true, 100);
+  edgeStatsOnEdge(&s, false, 400);         // Haut 300
+  edgeStatsOnEdge(&s, true, 1400);         // Bas 1000
+  edgeStatsOnEdge(&s, false, 1500);        // Haut 100
+  edgeStatsOnEdge(&s, true, 3500);         // Bas 2000
+
+  TEST_ASSERT_EQUAL_UINT32(5, s.edges);
+  TEST_ASSERT_EQUAL_UINT32(2, s.high.count);
+  TEST_ASSERT_EQUAL_UINT32(100, s.high.minUs);
+  TEST_ASSERT_EQUAL_UINT32(300, s.high.maxUs);
+  TEST_ASSERT_EQUAL_UINT32(200, pulseWidthAvgUs(&s.high));
+  TEST_ASSERT_EQUAL_UINT32(2, s.low.count);
+  TEST_ASSERT_EQUAL_UINT32(1000, s.low.minUs);
+  TEST_ASSERT_EQUAL_UINT32(2000, s.low.maxUs);
+  TEST_ASSERT_EQUAL_UINT32(1500, pulseWidthAvgUs(&s.low));
+  // 400 / 3400 = 117,6 ‰
+  TEST_ASSERT_EQUAL_UINT16(118, edgeStatsDutyPermille(&s));
+}
+
+static void test_widths_across_micros_wrap(void) {
+  EdgeStats s = {};
+  edgeStatsReset(&s, false, 0xFFFFFF00UL);
+  edgeStatsOnEdge(&s, true, 0xFFFFFFF0UL);
+  edgeStatsOnEdge(&s, false, 0x00000010UL);   // micros() a rebouclé
+  TEST_ASSERT_EQUAL_UINT32(0x20, s.high.minUs);
+  TEST_ASSERT_EQUAL_UINT32(0x20, s.high.maxUs);
+}
+
+static void test_duty_rounding(void) {
+  EdgeStats s = {};
+  edgeStatsReset(&s, false, 0);
+  edgeStatsOnEdge(&s, true, 0);
+  edgeStatsOnEdge(&s, false, 1);           // Haut 1
+  edgeStatsOnEdge(&s, true, 3);            // Bas 2
+  TEST_ASSERT_EQUAL_UINT16(333, edgeStatsDutyPermille(&s));   // 333,3
+
+  edgeStatsReset(&s, false, 0);
+  edgeStatsOnEdge(&s, true, 0);
+  edgeStatsOnEdge(&s, false, 2);           // Haut 2
+  edgeStatsOnEdge(&s, true, 3);            // Bas 1
+  TEST_ASSERT_EQUAL_UINT16(667, edgeStatsDutyPermille(&s));   // 666,7
+
+  edgeStatsReset(&s, true, 0);
+  edgeStatsOnEdge(&s, false, 0);
+  edgeStatsOnEdge(&s, true, 500);          // Bas seulement
+  TEST_ASSERT_EQUAL_UINT16(0, edgeStatsDutyPermille(&s));
+}
+
+static void test_history_oldest_first_and_wrap(void) {
+  EdgeStats s = {};
+  uint32_t times[EDGE_STATS_HISTORY];
+  bool levels[EDGE_STATS_HISTORY];
+  edgeStatsReset(&s, false, 0);
+  TEST_ASSERT_EQUAL(0, edgeStatsHistory(&s, times, levels));
+
+  // Anneau partiel : commence à l'emplacement 0
+  for (uint32_t k = 1; k <= 3; k++) edgeStatsOnEdge(&s, k & 1, k * 10);
+  TEST_ASSERT_EQUAL(3, edgeStatsHistory(&s, times, levels));
+  for (int i = 0; i < 3; i++) {
+    TEST_ASSERT_EQUAL_UINT32((i + 1) * 10, times[i]);
+    TEST_ASSERT_EQUAL((i + 1) & 1, levels[i]);
+  }
+
+  // Anneau plein et rebouclé : les EDGE_STATS_HISTORY derniers fronts
+  const uint32_t total = EDGE_STATS_HISTORY + 3;
+  for (uint32_t k = 4; k <= total; k++) edgeStatsOnEdge(&s, k & 1, k * 10);
+  TEST_ASSERT_EQUAL(EDGE_STATS_HISTORY, edgeStatsHistory(&s, times, levels));
+  for (int i = 0; i < EDGE_STATS_HISTORY; i++) {
+    uint32_t k = total - EDGE_STATS_HISTORY + 1 + i;
+    TEST_ASSERT_EQUAL_UINT32(k * 10, times[i]);
+    TEST_ASSERT_EQUAL(k & 1, levels[i]);
+  }
+
+  // Remise à zéro : historique vidé
+  edgeStatsReset(&s, true, 5000);
+  TEST_ASSERT_EQUAL(0, edgeStatsHistory(&s, times, levels));
+  TEST_ASSERT_EQUAL_UINT32(0, s.high.count + s.low.count);
+  TEST_ASSERT_EQUAL_UINT32(0, s.historyLevels);
+}
+
+// Écrivain : front k au temps k * 10 µs, niveau haut après les fronts impairs.
+// Toute copie cohérente vérifie donc, pour n = edges > 0 :
+//   lastEdgeUs = 10 n, level = n impair, n - 1 impulsions de 10 µs
+// Rafales de WRITER_BURST fronts, plus longues qu'une tranche de l'ordonnanceur
+// (l'écrivain est préempté en pleine mise à jour, même sur un seul cœur),
+// séparées d'une pause d'1 ms : le lecteur doit réussir pendant l'écriture.
+#define WRITER_BURST (1 << 17)
+#define MIN_CONCURRENT_READS 1000
+
+static void test_seqlock_reader_sees_consistent_copies(void) {
+  static EdgeStats s;
+  edgeStatsReset(&s, false, 0);
+  const uint32_t EDGES = 2000000;
+  std::atomic<bool> done(false);
+
+  std::thread writer([&] {
+    for (uint32_t k = 1; k <= EDGES; k++) {
+      edgeStatsOnEdge(&s, k & 1, k * 10);
+      if (k % WRITER_BURST == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    done.store(true);
+  });
+
+  uint32_t reads = 0, concurrentReads = 0, retriesExhausted = 0, torn = 0, lastEdges = 0;
+  bool writing;
+  do {
+    writing = !done.load();
+    EdgeStats copy;
+    if (!edgeStatsRead(&s, &copy)) {
+      retriesExhausted++;
+      continue;
+    }
+    reads++;
+    if (writing && copy.edges > 0 && copy.edges < EDGES) concurrentReads++;
+    uint32_t n = copy.edges;
+    if (copy.seq & 1) torn++;
+    if (n < lastEdges) torn++;           // Jamais de retour en arrière
+    lastEdges = n;
+    if (n == 0) continue;
+    uint32_t last = (copy.historyPos + EDGE_STATS_HISTORY - 1) % EDGE_STATS_HISTORY;
+    if (copy.lastEdgeUs != n * 10 || copy.level != (bool)(n & 1) ||
+        copy.high.count + copy.low.count != n - 1 ||
+        copy.high.totalUs + copy.low.totalUs != (uint64_t)(n - 1) * 10 ||
+        copy.historyUs[last] != n * 10 || ((copy.historyLevels >> last) & 1) != (n & 1)) {
+      torn++;
+    }
+  } while (writing);
+  writer.join();
+
+  char line[96];
+  snprintf(line, sizeof(line), "%lu reads (%lu during writes), %lu gave up (writer busy)", (unsigned long)reads,
+           (unsigned long)concurrentReads, (unsigned long)retriesExhausted);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_EQUAL_UINT32(0, torn);
+  TEST_ASSERT_GREATER_OR_EQUAL(MIN_CONCURRENT_READS, concurrentReads);
+
+  // Écrivain arrêté : la lecture réussit du premier coup
+  EdgeStats copy;
+  TEST_ASSERT_TRUE(edgeStatsRead(&s, &copy));
+  TEST_ASSERT_EQUAL_UINT32(EDGES, copy.edges);
+  TEST_ASSERT_EQUAL_UINT32(10, copy.high.minUs);
+  TEST_ASSERT_EQUAL_UINT32(10, copy.low.maxUs);
+  TEST_ASSERT_EQUAL_UINT16(500, edgeStatsDutyPermille(&copy));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_edge_has_no_width_and_same_level_is_ignored);
+  RUN_TEST(test_widths_min_max_avg);
+  RUN_TEST(test_widths_across_micros_wrap);
+  RUN_TEST(test_duty_rounding);
+  RUN_TEST(test_history_oldest_first_and_wrap);
+  RUN_TEST(test_seqlock_reader_sees_consistent_copies);
+  return UNITY_END();
+}
@@ -0,0 +1,173 @@
+// Arènes JSON (tailles, niveaux, replis sur le tas) et relevé mémoire
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "json_arena.h"
+#include "memory_report.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_pool_sizes_match_build_flags(void) {
+  JsonArena* leased[JSON_ARENA_COUNT + JSON_LARGE_ARENA_COUNT];
+  uint32_t total = 0;
+  for (int i = 0; i < JSON_ARENA_COUNT; i++) {
+    leased[i] = jsonArenaAcquire(false);
+    TEST_ASSERT_NOT_NULL(leased[i]);
+    TEST_ASSERT_EQUAL_UINT32(JSON_ARENA_SIZE, leased[i]->capacity);
+    total += leased[i]->capacity;
+  }
+  for (int i = 0; i < JSON_LARGE_ARENA_COUNT; i++) {
+    JsonArena* a = jsonArenaAcquire(true);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL_UINT32(JSON_LARGE_ARENA_SIZE, a->capacity);
+    TEST_ASSERT_EQUAL_INT(0, (uintptr_t)a->buf % JSON_ARENA_ALIGN);
+    leased[JSON_ARENA_COUNT + i] = a;
+    total += a->capacity;
+  }
+  TEST_ASSERT_EQUAL_UINT32(JSON_ARENA_POOL_BYTES, total);
+
+  JsonArenaStats stats;
+  jsonArenaGetStats(&stats);
+  TEST_ASSERT_EQUAL_UINT16(JSON_ARENA_COUNT + JSON_LARGE_ARENA_COUNT, stats.inUse);
+  TEST_ASSERT_EQUAL_UINT16(JSON_ARENA_COUNT + JSON_LARGE_ARENA_COUNT, stats.inUseHighWater);
+
+  // Toutes louées : plus d'arène, compté dans busy
+  uint32_t busy = stats.busy;
+  TEST_ASSERT_NULL(jsonArenaAcquire(false));
+  TEST_ASSERT_NULL(jsonArenaAcquire(true));
+  jsonArenaGetStats(&stats);
+  TEST_ASSERT_EQUAL_UINT32(busy + 2, stats.busy);
+
+  for (JsonArena* a : leased) jsonArenaRelease(a);
+  jsonArenaGetStats(&stats);
+  TEST_ASSERT_EQUAL_UINT16(0, stats.inUse);
+}
+
+static void test_large_preference_falls_back_to_small(void) {
+  JsonArena* large[JSON_LARGE_ARENA_COUNT];
+  for (int i = 0; i < JSON_LARGE_ARENA_COUNT; i++) large[i] = jsonArenaAcquire(true);
+  JsonArena* fallback = jsonArenaAcquire(true);
+  TEST_ASSERT_NOT_NULL(fallback);
+  TEST_ASSERT_EQUAL_UINT32(JSON_ARENA_SIZE, fallback->capacity);
+  jsonArenaRelease(fallback);
+  for (JsonArena* a : large) jsonArenaRelease(a);
+}
+
+static void test_block_headers_and_high_water(void) {
+  JsonArena* a = jsonArenaAcquire(false);
+  // En-tête de 8 octets + taille arrondie à 8
+  void* p1 = jsonPoolAllocate(a, 100);
+  TEST_ASSERT_TRUE(jsonArenaOwns(a, p1));
+  TEST_ASSERT_EQUAL_UINT32(8 + 104, a->top);
+  void* p2 = jsonPoolAllocate(a, 1);
+  TEST_ASSERT_EQUAL_UINT32(8 + 104 + 8 + 8, a->top);
+
+  // Dernier bloc agrandi sur place (chaîne en cours de désérialisation)
+  TEST_ASSERT_TRUE(jsonPoolReallocate(a, p2, 200) == p2);
+  TEST_ASSERT_EQUAL_UINT32(8 + 104 + 8 + 200, a->top);
+  uint32_t high = a->top;
+
+  jsonPoolDeallocate(a, p2);
+  TEST_ASSERT_EQUAL_UINT32(8 + 104, a->top);
+  jsonPoolDeallocate(a, p1);
+  TEST_ASSERT_EQUAL_UINT32(0, a->top);
+  TEST_ASSERT_EQUAL_UINT32(high, a->highWater);
+
+  JsonArenaStats stats;
+  jsonArenaGetStats(&stats);
+  TEST_ASSERT_GREATER_OR_EQUAL(high, stats.smallHighWater);
+  TEST_ASSERT_LESS_OR_EQUAL(JSON_ARENA_SIZE, stats.smallHighWater);
+  jsonArenaRelease(a);
+}
+
+static void test_overflow_goes_to_heap_and_is_counted(void) {
+  JsonArenaStats before, after;
+  jsonArenaGetStats(&before);
+  JsonArena* a = jsonArenaAcquire(false);
+
+  // Bloc plus grand que l'arène : tas
+  void* big = jsonPoolAllocate(a, JSON_ARENA_SIZE);
+  TEST_ASSERT_NOT_NULL(big);
+  TEST_ASSERT_FALSE(jsonArenaOwns(a, big));
+  jsonPoolDeallocate(a, big);
+
+  // Bloc de l'arène qui grandit au-delà : recopié sur le tas
+  char* s = (char*)jsonPoolAllocate(a, 16);
+  strcpy(s, "arena");
+  char* moved = (char*)jsonPoolReallocate(a, s, JSON_ARENA_SIZE * 2);
+  TEST_ASSERT_FALSE(jsonArenaOwns(a, moved));
+  TEST_ASSERT_EQUAL_STRING("arena", moved);
+  jsonPoolDeallocate(a, moved);
+  TEST_ASSERT_EQUAL_UINT32(0, a->top);
+
+  // Pas d'arène du tout : tout va sur le tas
+  void* orphan = jsonPoolAllocate(nullptr, 32);
+  jsonPoolDeallocate(nullptr, orphan);
+
+  jsonArenaRelease(a);
+  jsonArenaGetStats(&after);
+  TEST_ASSERT_EQUAL_UINT32(before.overflows + 3, after.overflows);
+}
+
+static void test_report_buffers_and_tasks(void) {
+  MemoryReport report;
+  memoryReportInit(&report);
+  TEST_ASSERT_TRUE(memoryReportAddBuffer(&report, "json_arenas", JSON_ARENA_POOL_BYTES));
+  TEST_ASSERT_TRUE(memoryReportAddBuffer(&report, "mqtt_buffer", 1024));
+  TEST_ASSERT_EQUAL_UINT32(JSON_ARENA_POOL_BYTES + 1024, memoryReportBuffersTotal(&report));
+
+  for (int i = report.bufferCount; i < MEMORY_REPORT_MAX_BUFFERS; i++) {
+    TEST_ASSERT_TRUE(memoryReportAddBuffer(&report, "filler", 1));
+  }
+  TEST_ASSERT_FALSE(memoryReportAddBuffer(&report, "extra", 1000));   // Table pleine : ignoré
+  TEST_ASSERT_EQUAL_UINT8(MEMORY_REPORT_MAX_BUFFERS, report.bufferCount);
+  TEST_ASSERT_EQUAL_UINT32(JSON_ARENA_POOL_BYTES + 1024 + MEMORY_REPORT_MAX_BUFFERS - 2,
+                           memoryReportBuffersTotal(&report));
+
+  TEST_ASSERT_TRUE(memoryReportAddTask(&report, "NetTask", 8192, 2048));
+  TEST_ASSERT_TRUE(memoryReportAddTask(&report, "CmdTask", 4096, MEMORY_STACK_WARN_BYTES - 1));
+  TEST_ASSERT_TRUE(memoryReportAddTask(&report, "IOTask", 4096, MEMORY_STACK_WARN_BYTES));
+  TEST_ASSERT_EQUAL_INT(1, memoryReportStackWarnings(&report));
+}
+
+static void test_report_format(void) {
+  MemoryReport report;
+  memoryReportInit(&report);
+  report.staticData = 1234;
+  report.staticBss = 56789;
+  memoryReportAddBuffer(&report, "json_arenas", JSON_ARENA_POOL_BYTES);
+  memoryReportAddTask(&report, "CmdTask", 4096, 100);
+
+  char text[1024];
+  size_t n = memoryReportFormat(&report, text, sizeof(text));
+  TEST_ASSERT_EQUAL_UINT32(strlen(text), n);
+  TEST_ASSERT_NOT_NULL(strstr(text, ".data 1234 o, .bss 56789 o"));
+  char arenas[96];
+  snprintf(arenas, sizeof(arenas), "Arènes JSON : %d x %d o + %d x %d o", JSON_ARENA_COUNT, JSON_ARENA_SIZE,
+           JSON_LARGE_ARENA_COUNT, JSON_LARGE_ARENA_SIZE);
+  TEST_ASSERT_NOT_NULL(strstr(text, arenas));
+  char line[64];
+  snprintf(line, sizeof(line), "json_arenas      %7u o", (unsigned)JSON_ARENA_POOL_BYTES);
+  TEST_ASSERT_NOT_NULL(strstr(text, line));
+  TEST_ASSERT_NOT_NULL(strstr(text, "⚠️"));
+
+  // Tampon trop court : tronqué mais terminé
+  char small[40];
+  memset(small, 'x', sizeof(small));
+  n = memoryReportFormat(&report, small, sizeof(small));
+  TEST_ASSERT_LESS_THAN(sizeof(small), n);
+  TEST_ASSERT_EQUAL_UINT32(strlen(small), n);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_pool_sizes_match_build_flags);
+  RUN_TEST(test_large_preference_falls_back_to_small);
+  RUN_TEST(test_block_headers_and_high_water);
+  RUN_TEST(test_overflow_goes_to_heap_and_is_counted);
+  RUN_TEST(test_report_buffers_and_tasks);
+  RUN_TEST(test_report_format);
+  return UNITY_END();
+}
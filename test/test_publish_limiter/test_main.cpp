@@ -0,0 +1,124 @@
+// Limitation du débit de publication : premier front immédiat, fusion dans la
+// fenêtre minIntervalMs, nombre de transitions et abandon des allers-retours
+#include <unity.h>
+#include "publish_limiter.h"
+
+static PublishLimiter pl;
+
+void setUp(void) { publishLimiterReset(&pl); }
+void tearDown(void) {}
+
+static void test_first_edge_published_immediately(void) {
+  uint32_t transitions = 0;
+  bool value = false;
+  TEST_ASSERT_TRUE(publishLimiterOnChange(&pl, true, 1000, 500, &transitions));
+  TEST_ASSERT_EQUAL_UINT32(1, transitions);
+  TEST_ASSERT_TRUE(pl.lastPublishedValue);
+  TEST_ASSERT_EQUAL_UINT32(1000, pl.lastPublishMs);
+  TEST_ASSERT_FALSE(publishLimiterPoll(&pl, 5000, 500, false, &value, &transitions));  // Rien en attente
+
+  // Après une période calme plus longue que la fenêtre : de nouveau immédiat
+  TEST_ASSERT_TRUE(publishLimiterOnChange(&pl, false, 1500, 500, &transitions));
+  TEST_ASSERT_EQUAL_UINT32(1, transitions);
+  TEST_ASSERT_FALSE(pl.lastPublishedValue);
+}
+
+static void test_edges_in_window_coalesced_into_final_state(void) {
+  uint32_t transitions = 0;
+  bool value = true;
+  TEST_ASSERT_TRUE(publishLimiterOnChange(&pl, true, 1000, 500, &transitions));
+  TEST_ASSERT_FALSE(publishLimiterOnChange(&pl, false, 1100, 500, &transitions));
+  TEST_ASSERT_FALSE(publishLimiterOnChange(&pl, true, 1200, 500, &transitions));
+  TEST_ASSERT_FALSE(publishLimiterOnChange(&pl, false, 1300, 500, &transitions));
+  TEST_ASSERT_TRUE(pl.pending);
+
+  // Fenêtre pas encore expirée
+  TEST_ASSERT_FALSE(publishLimiterPoll(&pl, 1499, 500, false, &value, &transitions));
+  TEST_ASSERT_TRUE(pl.pending);
+
+  // Expiration : la dernière valeur l'emporte, une seule publication
+  TEST_ASSERT_TRUE(publishLimiterPoll(&pl, 1500, 500, false, &value, &transitions));
+  TEST_ASSERT_FALSE(value);
+  TEST_ASSERT_EQUAL_UINT32(3, transitions);
+  TEST_ASSERT_FALSE(pl.pending);
+  TEST_ASSERT_EQUAL_UINT32(1500, pl.lastPublishMs);
+  TEST_ASSERT_FALSE(publishLimiterPoll(&pl, 3000, 500, false, &value, &transitions));
+}
+
+static void test_transition_count_resets_after_publish(void) {
+  uint32_t transitions = 0;
+  bool value = false;
+  TEST_ASSERT_TRUE(publishLimiterOnChange(&pl, true, 0, 1000, &transitions));
+  TEST_ASSERT_EQUAL_UINT32(1, transitions);
+  for (uint32_t k = 1; k <= 6; k++) {
+    TEST_ASSERT_FALSE(publishLimiterOnChange(&pl, !(k & 1), k * 100, 1000, &transitions));
+  }
+  TEST_ASSERT_EQUAL_UINT32(6, pl.transitions);
+  TEST_ASSERT_TRUE(publishLimiterPoll(&pl, 1000, 1000, false, &value, &transitions));
+  TEST_ASSERT_TRUE(value);
+  TEST_ASSERT_EQUAL_UINT32(6, transitions);
+  TEST_ASSERT_EQUAL_UINT32(0, pl.transitions);
+
+  // Le front suivant, dans la nouvelle fenêtre, repart de un
+  TEST_ASSERT_FALSE(publishLimiterOnChange(&pl, false, 1200, 1000, &transitions));
+  TEST_ASSERT_EQUAL_UINT32(1, pl.transitions);
+}
+
+static void test_suppress_unchanged_drops_round_trip(void) {
+  uint32_t transitions = 0;
+  bool value = false;
+  TEST_ASSERT_TRUE(publishLimiterOnChange(&pl, true, 1000, 500, &transitions));
+  TEST_ASSERT_FALSE(publishLimiterOnChange(&pl, false, 1100, 500, &transitions));
+  TEST_ASSERT_FALSE(publishLimiterOnChange(&pl, true, 1200, 500, &transitions));
+
+  // Revenu à la valeur publiée : abandonné, le compte de transitions aussi
+  TEST_ASSERT_FALSE(publishLimiterPoll(&pl, 1500, 500, true, &value, &transitions));
+  TEST_ASSERT_FALSE(pl.pending);
+  TEST_ASSERT_EQUAL_UINT32(0, pl.transitions);
+  TEST_ASSERT_EQUAL_UINT32(1000, pl.lastPublishMs);
+
+  // Sans suppressUnchanged, le même aller-retour est publié avec ses transitions
+  publishLimiterReset(&pl);
+  TEST_ASSERT_TRUE(publishLimiterOnChange(&pl, true, 1000, 500, &transitions));
+  TEST_ASSERT_FALSE(publishLimiterOnChange(&pl, false, 1100, 500, &transitions));
+  TEST_ASSERT_FALSE(publishLimiterOnChange(&pl, true, 1200, 500, &transitions));
+  TEST_ASSERT_TRUE(publishLimiterPoll(&pl, 1500, 500, false, &value, &transitions));
+  TEST_ASSERT_TRUE(value);
+  TEST_ASSERT_EQUAL_UINT32(2, transitions);
+
+  // Valeur réellement changée : publiée même avec suppressUnchanged
+  TEST_ASSERT_FALSE(publishLimiterOnChange(&pl, false, 1600, 500, &transitions));
+  TEST_ASSERT_TRUE(publishLimiterPoll(&pl, 2000, 500, true, &value, &transitions));
+  TEST_ASSERT_FALSE(value);
+  TEST_ASSERT_EQUAL_UINT32(1, transitions);
+}
+
+static void test_zero_interval_publishes_every_edge(void) {
+  uint32_t transitions = 0;
+  for (uint32_t k = 1; k <= 4; k++) {
+    TEST_ASSERT_TRUE(publishLimiterOnChange(&pl, k & 1, 1000, 0, &transitions));
+    TEST_ASSERT_EQUAL_UINT32(1, transitions);
+  }
+  TEST_ASSERT_FALSE(pl.pending);
+}
+
+static void test_window_across_millis_wrap(void) {
+  uint32_t transitions = 0;
+  bool value = false;
+  TEST_ASSERT_TRUE(publishLimiterOnChange(&pl, true, 0xFFFFFF00UL, 500, &transitions));
+  TEST_ASSERT_FALSE(publishLimiterOnChange(&pl, false, 0x00000010UL, 500, &transitions));  // millis() a rebouclé
+  TEST_ASSERT_FALSE(publishLimiterPoll(&pl, 0x000000F3UL, 500, false, &value, &transitions));
+  TEST_ASSERT_TRUE(publishLimiterPoll(&pl, 0x000000F4UL, 500, false, &value, &transitions));
+  TEST_ASSERT_FALSE(value);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_edge_published_immediately);
+  RUN_TEST(test_edges_in_window_coalesced_into_final_state);
+  RUN_TEST(test_transition_count_resets_after_publish);
+  RUN_TEST(test_suppress_unchanged_drops_round_trip);
+  RUN_TEST(test_zero_interval_publishes_every_edge);
+  RUN_TEST(test_window_across_millis_wrap);
+  return UNITY_END();
+}
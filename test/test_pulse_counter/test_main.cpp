@@ -0,0 +1,82 @@
+// Agrégation des compteurs d'impulsions (mode COUNTER) : l'ISR n'est qu'un
+// incrément, le compteur brut est donc simulé par une simple variable.
+#include <unity.h>
+#include "pulse_counter.h"
+
+static PulseCounter pc;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_no_sample_before_interval(void) {
+  pulseCounterReset(&pc, 100, 5000);
+  TEST_ASSERT_FALSE(pulseCounterSample(&pc, 150, 5999, 1000));
+  TEST_ASSERT_EQUAL_UINT64(0, pc.total);
+  TEST_ASSERT_EQUAL_UINT32(100, pc.lastRaw);  // Rien n'est consommé avant l'échéance
+}
+
+static void test_delta_total_and_rate(void) {
+  pulseCounterReset(&pc, 100, 5000);
+  TEST_ASSERT_TRUE(pulseCounterSample(&pc, 150, 6000, 1000));
+  TEST_ASSERT_EQUAL_UINT32(50, pc.delta);
+  TEST_ASSERT_EQUAL_UINT64(50, pc.total);
+  TEST_ASSERT_EQUAL_UINT32(50000, pc.rateMilliHz);  // 50 Hz
+
+  // Échantillon en retard : la fréquence est rapportée à la durée réelle
+  TEST_ASSERT_TRUE(pulseCounterSample(&pc, 450, 7500, 1000));
+  TEST_ASSERT_EQUAL_UINT32(300, pc.delta);
+  TEST_ASSERT_EQUAL_UINT64(350, pc.total);
+  TEST_ASSERT_EQUAL_UINT32(200000, pc.rateMilliHz);
+}
+
+static void test_fractional_rate(void) {
+  pulseCounterReset(&pc, 0, 0);
+  TEST_ASSERT_TRUE(pulseCounterSample(&pc, 1, 3000, 3000));
+  TEST_ASSERT_EQUAL_UINT32(333, pc.rateMilliHz);  // 0,333 Hz
+}
+
+static void test_raw_counter_overflow(void) {
+  pulseCounterReset(&pc, 0xFFFFFFF0UL, 0);
+  TEST_ASSERT_TRUE(pulseCounterSample(&pc, 0x10, 1000, 1000));
+  TEST_ASSERT_EQUAL_UINT32(0x20, pc.delta);
+  TEST_ASSERT_EQUAL_UINT64(0x20, pc.total);
+}
+
+static void test_millis_overflow(void) {
+  pulseCounterReset(&pc, 0, 0xFFFFFE00UL);
+  TEST_ASSERT_FALSE(pulseCounterSample(&pc, 10, 0x100, 1000));  // 768 ms écoulées
+  TEST_ASSERT_TRUE(pulseCounterSample(&pc, 10, 0x200, 1000));   // 1024 ms
+  TEST_ASSERT_EQUAL_UINT32(10, pc.delta);
+}
+
+static void test_total_is_64_bit(void) {
+  pulseCounterReset(&pc, 0, 0);
+  uint32_t raw = 0;
+  for (int i = 1; i <= 3; i++) {
+    raw += 0x80000000UL;  // Deux débordements du compteur brut au total
+    TEST_ASSERT_TRUE(pulseCounterSample(&pc, raw, i * 1000, 1000));
+  }
+  TEST_ASSERT_EQUAL_UINT64(0x180000000ULL, pc.total);
+}
+
+static void test_reset_discards_history(void) {
+  pulseCounterReset(&pc, 0, 0);
+  TEST_ASSERT_TRUE(pulseCounterSample(&pc, 500, 1000, 1000));
+  pulseCounterReset(&pc, 500, 1000);
+  TEST_ASSERT_EQUAL_UINT64(0, pc.total);
+  TEST_ASSERT_EQUAL_UINT32(0, pc.rateMilliHz);
+  TEST_ASSERT_TRUE(pulseCounterSample(&pc, 510, 2000, 1000));
+  TEST_ASSERT_EQUAL_UINT32(10, pc.delta);  // Pas de delta parasite après reconfiguration
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_no_sample_before_interval);
+  RUN_TEST(test_delta_total_and_rate);
+  RUN_TEST(test_fractional_rate);
+  RUN_TEST(test_raw_counter_overflow);
+  RUN_TEST(test_millis_overflow);
+  RUN_TEST(test_total_is_64_bit);
+  RUN_TEST(test_reset_discards_history);
+  return UNITY_END();
+}
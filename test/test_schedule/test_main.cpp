@@ -0,0 +1,189 @@
+// Calendrier des programmations : changements d'heure, échéances manquées, horloge recalée
+#include <unity.h>
+#include "schedule.h"
+
+// Mêmes valeurs que schedule_table.h (module Arduino, non inclus ici)
+#define LEAD_SEC  1
+#define GRACE_SEC 2
+
+static TzRule paris;
+static TzRule sydney;
+
+static Schedule daily(uint32_t hour, uint32_t minute) {
+  Schedule s = {};
+  s.kind = SCHEDULE_DAILY;
+  s.weekdays = SCHEDULE_ALL_DAYS;
+  s.enabled = 1;
+  s.pin = 5;
+  s.state = 1;
+  s.timeOfDay = hour * 3600 + minute * 60;
+  return s;
+}
+
+void setUp(void) {
+  TEST_ASSERT_TRUE(tzParse("CET-1CEST,M3.5.0,M10.5.0/3", &paris));
+  TEST_ASSERT_TRUE(tzParse("AEST-10AEDT,M10.1.0,M4.1.0/3", &sydney));
+}
+void tearDown(void) {}
+
+// ----- Heure d'été / d'hiver (dates 2026 vérifiées avec la base IANA) -----
+
+static void test_offsets_cet_cest(void) {
+  TEST_ASSERT_EQUAL_INT32(3600, tzOffsetAt(&paris, 1774745999));   // 29/03 00:59:59 UTC
+  TEST_ASSERT_EQUAL_INT32(7200, tzOffsetAt(&paris, 1774746000));   // 29/03 01:00 UTC : 03:00 CEST
+  TEST_ASSERT_EQUAL_INT32(7200, tzOffsetAt(&paris, 1792889999));   // 25/10 00:59:59 UTC
+  TEST_ASSERT_EQUAL_INT32(3600, tzOffsetAt(&paris, 1792890000));
+}
+
+static void test_daily_across_spring_forward_paris(void) {
+  Schedule s = daily(7, 30);
+  // Samedi 28/03 07:30 CET (06:30 UTC), puis dimanche 29/03 07:30 CEST (05:30 UTC)
+  TEST_ASSERT_EQUAL_UINT32(1774679400, scheduleNextFire(&s, &paris, 1774679400 - 3600));
+  TEST_ASSERT_EQUAL_UINT32(1774762200, scheduleNextFire(&s, &paris, 1774679400));
+  TEST_ASSERT_EQUAL_UINT32(82800, 1774762200 - 1774679400);         // Journée de 23 h
+  TEST_ASSERT_EQUAL_UINT32(1774679400, schedulePrevFire(&s, &paris, 1774762199));
+}
+
+static void test_daily_skipped_hour_is_shifted(void) {
+  // 02:30 n'existe pas le 29/03 : exécution à 03:30 CEST
+  Schedule s = daily(2, 30);
+  TEST_ASSERT_EQUAL_UINT32(1774747800, scheduleNextFire(&s, &paris, 1774699200));
+}
+
+static void test_daily_repeated_hour_fires_once(void) {
+  // 02:30 existe deux fois le 25/10 : une seule échéance, la seconde (CET)
+  Schedule s = daily(2, 30);
+  uint32_t first = scheduleNextFire(&s, &paris, 1792888200 - 3600);
+  TEST_ASSERT_EQUAL_UINT32(1792891800, first);
+  TEST_ASSERT_EQUAL_UINT32(1792978200, scheduleNextFire(&s, &paris, first));  // Lendemain 02:30 CET
+}
+
+static void test_daily_across_aest_aedt(void) {
+  // Hémisphère sud : heure d'été du 04/10 au 05/04, à cheval sur l'année
+  Schedule s = daily(7, 0);
+  TEST_ASSERT_EQUAL_INT32(36000, tzOffsetAt(&sydney, 1790974800));  // 03/10 AEST
+  TEST_ASSERT_EQUAL_INT32(39600, tzOffsetAt(&sydney, 1791057600));  // 04/10 AEDT
+  TEST_ASSERT_EQUAL_INT32(39600, tzOffsetAt(&sydney, 1775246400));  // 04/04 AEDT
+  TEST_ASSERT_EQUAL_INT32(36000, tzOffsetAt(&sydney, 1775336400));  // 05/04 AEST
+
+  TEST_ASSERT_EQUAL_UINT32(1791057600, scheduleNextFire(&s, &sydney, 1790974800));
+  TEST_ASSERT_EQUAL_UINT32(82800, 1791057600 - 1790974800);
+  TEST_ASSERT_EQUAL_UINT32(1775336400, scheduleNextFire(&s, &sydney, 1775246400));
+  TEST_ASSERT_EQUAL_UINT32(90000, 1775336400 - 1775246400);         // Journée de 25 h
+
+  Schedule early = daily(2, 30);
+  TEST_ASSERT_EQUAL_UINT32(1791045000, scheduleNextFire(&early, &sydney, 1790974800));  // 03:30 AEDT
+  TEST_ASSERT_EQUAL_UINT32(1775320200, scheduleNextFire(&early, &sydney, 1775246400));  // Seconde 02:30
+}
+
+// ----- Décision de déclenchement -----
+
+static void test_fires_once_inside_lead_window(void) {
+  Schedule s = daily(7, 30);
+  uint32_t fire = 1774679400;
+  uint32_t next = 0, fireAt = 0;
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_IDLE, scheduleEvaluate(&s, &paris, fire - 10, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+  TEST_ASSERT_EQUAL_UINT32(fire, next);
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_FIRE, scheduleEvaluate(&s, &paris, fire - 1, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+  TEST_ASSERT_EQUAL_UINT32(fire, fireAt);
+  TEST_ASSERT_EQUAL_UINT32(fire, s.lastFired);
+  TEST_ASSERT_EQUAL_UINT32(1774762200, next);
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_IDLE, scheduleEvaluate(&s, &paris, fire, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+}
+
+static void test_missed_skip_policy(void) {
+  // Appareil éteint trois jours : les échéances passées sont ignorées, une seule fois
+  Schedule s = daily(7, 30);
+  s.lastFired = 1774679400 - 2 * 86400;
+  s.missedPolicy = SCHEDULE_MISSED_SKIP;
+  uint32_t now = 1774699200;                                        // 28/03 12:00 UTC
+  uint32_t next = 0, fireAt = 0;
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_MISSED, scheduleEvaluate(&s, &paris, now, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+  TEST_ASSERT_EQUAL_UINT32(1774679400, s.lastFired);                // La plus récente est notée
+  TEST_ASSERT_EQUAL_UINT32(1774762200, next);
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_IDLE, scheduleEvaluate(&s, &paris, now + 1, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+}
+
+static void test_missed_fire_once_catches_up_latest(void) {
+  Schedule s = daily(7, 30);
+  s.lastFired = 1774679400 - 2 * 86400;
+  s.missedPolicy = SCHEDULE_MISSED_FIRE_ONCE;
+  uint32_t now = 1774699200;
+  uint32_t next = 0, fireAt = 0;
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_CATCH_UP, scheduleEvaluate(&s, &paris, now, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+  TEST_ASSERT_EQUAL_UINT32(1774679400, fireAt);                     // Une seule exécution, la plus récente
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_IDLE, scheduleEvaluate(&s, &paris, now + 1, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_FIRE, scheduleEvaluate(&s, &paris, 1774762200, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+}
+
+static void test_late_within_grace_still_fires(void) {
+  Schedule s = daily(7, 30);
+  s.missedPolicy = SCHEDULE_MISSED_SKIP;
+  uint32_t fire = 1774679400;
+  uint32_t next = fire, fireAt = 0;                                 // Index déjà calculé
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_FIRE, scheduleEvaluate(&s, &paris, fire + GRACE_SEC, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+  TEST_ASSERT_EQUAL_UINT32(fire, fireAt);
+}
+
+// ----- Horloge recalée -----
+
+static void test_clock_step_backward_replays(void) {
+  Schedule s = daily(7, 30);
+  uint32_t fire = 1774679400;
+  uint32_t next = 0, fireAt = 0;
+  scheduleEvaluate(&s, &paris, fire - 5, LEAD_SEC, GRACE_SEC, &next, &fireAt);
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_FIRE, scheduleEvaluate(&s, &paris, fire, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+
+  // Recalage d'une heure en arrière (comme schedule_table : rembobinage puis index à recalculer)
+  uint32_t stepped = fire - 3600;
+  scheduleRewind(&s, &paris, stepped);
+  next = 0;
+  TEST_ASSERT_EQUAL_UINT32(fire - 86400, s.lastFired);
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_IDLE, scheduleEvaluate(&s, &paris, stepped, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+  TEST_ASSERT_EQUAL_UINT32(fire, next);                             // L'échéance repasse avec l'horloge
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_FIRE, scheduleEvaluate(&s, &paris, fire, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+  TEST_ASSERT_EQUAL_UINT32(fire, fireAt);
+}
+
+static void test_clock_step_backward_without_rewind_is_quiet(void) {
+  // Sans rembobinage, l'index garde l'échéance suivante : pas de double exécution ni de rafale
+  Schedule s = daily(7, 30);
+  uint32_t fire = 1774679400;
+  uint32_t next = fire, fireAt = 0;
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_FIRE, scheduleEvaluate(&s, &paris, fire, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+  TEST_ASSERT_EQUAL_UINT8(SCHEDULE_IDLE, scheduleEvaluate(&s, &paris, fire - 600, LEAD_SEC, GRACE_SEC, &next, &fireAt));
+  TEST_ASSERT_EQUAL_UINT32(1774762200, next);
+
+  // Rembobiner à un instant postérieur à la dernière échéance ne change rien
+  scheduleRewind(&s, &paris, fire + 60);
+  TEST_ASSERT_EQUAL_UINT32(fire, s.lastFired);
+}
+
+static void test_interval_prev_next(void) {
+  Schedule s = {};
+  s.kind = SCHEDULE_INTERVAL;
+  s.enabled = 1;
+  s.interval = 900;
+  s.anchor = 1774699200;
+  TEST_ASSERT_EQUAL_UINT32(s.anchor, scheduleNextFire(&s, &paris, s.anchor - 1));
+  TEST_ASSERT_EQUAL_UINT32(s.anchor + 900, scheduleNextFire(&s, &paris, s.anchor));
+  TEST_ASSERT_EQUAL_UINT32(s.anchor + 1800, schedulePrevFire(&s, &paris, s.anchor + 2699));
+  TEST_ASSERT_EQUAL_UINT32(0, schedulePrevFire(&s, &paris, s.anchor - 1));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_offsets_cet_cest);
+  RUN_TEST(test_daily_across_spring_forward_paris);
+  RUN_TEST(test_daily_skipped_hour_is_shifted);
+  RUN_TEST(test_daily_repeated_hour_fires_once);
+  RUN_TEST(test_daily_across_aest_aedt);
+  RUN_TEST(test_fires_once_inside_lead_window);
+  RUN_TEST(test_missed_skip_policy);
+  RUN_TEST(test_missed_fire_once_catches_up_latest);
+  RUN_TEST(test_late_within_grace_still_fires);
+  RUN_TEST(test_clock_step_backward_replays);
+  RUN_TEST(test_clock_step_backward_without_rewind_is_quiet);
+  RUN_TEST(test_interval_prev_next);
+  return UNITY_END();
+}
@@ -0,0 +1,233 @@
+// Journal des états de sortie sur une flash NOR simulée, avec coupures de
+// courant injectées pendant l'effacement, l'écriture de l'en-tête et celle
+// d'un enregistrement
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "state_journal.h"
+
+#define SECTORS 3
+#define GPIO_MASK ((1ULL << STATE_JOURNAL_GPIO_COUNT) - 1)
+
+// Flash NOR en mémoire : l'effacement met à 0xFF, l'écriture ne fait passer que des 1 à 0
+struct SimFlash {
+  std::vector<uint8_t> mem;
+  bool failWrites;
+  int (*onOperation)(SimFlash* f, bool erase, uint32_t offset, const uint8_t* buf, size_t len);
+};
+
+static bool flashRead(void* ctx, uint32_t offset, void* buf, size_t len) {
+  SimFlash* f = (SimFlash*)ctx;
+  if (offset + len > f->mem.size()) return false;
+  memcpy(buf, f->mem.data() + offset, len);
+  return true;
+}
+
+static void program(SimFlash* f, uint32_t offset, const uint8_t* buf, size_t len) {
+  for (size_t i = 0; i < len; i++) f->mem[offset + i] &= buf[i];
+}
+
+static bool flashWrite(void* ctx, uint32_t offset, const void* buf, size_t len) {
+  SimFlash* f = (SimFlash*)ctx;
+  if (f->failWrites || offset + len > f->mem.size()) return false;
+  if (f->onOperation) f->onOperation(f, false, offset, (const uint8_t*)buf, len);
+  program(f, offset, (const uint8_t*)buf, len);
+  return true;
+}
+
+static bool flashErase(void* ctx, uint32_t offset, size_t len) {
+  SimFlash* f = (SimFlash*)ctx;
+  if (offset % STATE_JOURNAL_SECTOR_SIZE || len % STATE_JOURNAL_SECTOR_SIZE || offset + len > f->mem.size()) return false;
+  if (f->onOperation) f->onOperation(f, true, offset, nullptr, len);
+  memset(f->mem.data() + offset, 0xFF, len);
+  return true;
+}
+
+static SimFlash flash;
+static StateJournalFlash flashOps = { flashRead, flashWrite, flashErase, &flash };
+
+static StateSnapshot snapshotFor(uint32_t i) {
+  StateSnapshot s;
+  s.known = GPIO_MASK;
+  s.states = ((uint64_t)i * 0x9E3779B1ULL) & GPIO_MASK;  // Multiplicateur impair : tous distincts
+  return s;
+}
+
+static bool sameSnapshot(const StateSnapshot& a, const StateSnapshot& b) {
+  return a.states == b.states && a.known == b.known;
+}
+
+void setUp(void) {
+  flash.mem.assign(SECTORS * STATE_JOURNAL_SECTOR_SIZE, 0xFF);
+  flash.failWrites = false;
+  flash.onOperation = nullptr;
+}
+void tearDown(void) {}
+
+static void test_blank_area_restores_nothing(void) {
+  StateJournal j;
+  StateSnapshot restored = snapshotFor(7);
+  TEST_ASSERT_FALSE(stateJournalOpen(&j, &flashOps, SECTORS, &restored));
+  TEST_ASSERT_EQUAL_UINT64(0, restored.known);
+}
+
+static void test_restores_last_commit_across_rollovers(void) {
+  StateJournal j;
+  StateSnapshot restored;
+  stateJournalOpen(&j, &flashOps, SECTORS, &restored);
+  const uint32_t total = STATE_JOURNAL_SLOTS * SECTORS + 10;   // Anneau parcouru plus d'une fois
+  for (uint32_t i = 1; i <= total; i++) {
+    StateSnapshot s = snapshotFor(i);
+    TEST_ASSERT_TRUE(stateJournalCommit(&j, &s));
+    if (i % 97 == 0 || i == total) {
+      StateJournal reopened;
+      TEST_ASSERT_TRUE(stateJournalOpen(&reopened, &flashOps, SECTORS, &restored));
+      TEST_ASSERT_TRUE(sameSnapshot(s, restored));
+      TEST_ASSERT_EQUAL_UINT32(i, reopened.seq);
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(SECTORS + 1, j.erases);
+
+  // Même état : aucune écriture
+  uint32_t commits = j.commits;
+  StateSnapshot same = snapshotFor(total);
+  TEST_ASSERT_TRUE(stateJournalCommit(&j, &same));
+  TEST_ASSERT_EQUAL_UINT32(commits, j.commits);
+}
+
+// ----- Coupures de courant -----
+// À chaque opération de la flash, l'image est copiée et l'opération n'y est
+// appliquée qu'en partie, comme si le courant était coupé à cet instant. Le
+// journal rouvert sur cette copie doit rendre le dernier état acquitté ou celui
+// en cours d'écriture, jamais un état plus ancien ni inventé, puis accepter de
+// nouvelles validations.
+
+static bool haveAcked;
+static StateSnapshot acked;        // Dernier commit ayant retourné true
+static StateSnapshot inFlight;     // Commit en cours
+static uint32_t cutsChecked;
+static uint32_t erasesCut, headersCut, recordsCut;
+
+static void checkAfterPowerCut(const SimFlash& image) {
+  SimFlash copy;
+  copy.mem = image.mem;
+  copy.failWrites = false;
+  copy.onOperation = nullptr;
+  StateJournalFlash ops = { flashRead, flashWrite, flashErase, &copy };
+
+  StateJournal j;
+  StateSnapshot restored;
+  bool found = stateJournalOpen(&j, &ops, SECTORS, &restored);
+  if (haveAcked) {
+    TEST_ASSERT_TRUE(found);
+    TEST_ASSERT_TRUE(sameSnapshot(restored, acked) || sameSnapshot(restored, inFlight));
+  } else if (found) {
+    TEST_ASSERT_TRUE(sameSnapshot(restored, inFlight));
+  }
+
+  // Le journal reste utilisable après la coupure
+  StateSnapshot next = snapshotFor(0xFFFFF);
+  TEST_ASSERT_TRUE(stateJournalCommit(&j, &next));
+  StateJournal again;
+  TEST_ASSERT_TRUE(stateJournalOpen(&again, &ops, SECTORS, &restored));
+  TEST_ASSERT_TRUE(sameSnapshot(restored, next));
+  cutsChecked++;
+}
+
+static int injectPowerCuts(SimFlash* f, bool erase, uint32_t offset, const uint8_t* buf, size_t len) {
+  SimFlash partial;
+  partial.mem = f->mem;
+  if (erase) {
+    erasesCut++;
+    // Effacement interrompu : seule une partie du secteur est revenue à 0xFF
+    const size_t done[] = { 0, 4, 12, STATE_JOURNAL_HEADER_SIZE, 1024, STATE_JOURNAL_SECTOR_SIZE - 1 };
+    for (size_t n : done) {
+      partial.mem = f->mem;
+      memset(partial.mem.data() + offset, 0xFF, n);                              // Début effacé
+      checkAfterPowerCut(partial);
+      partial.mem = f->mem;
+      memset(partial.mem.data() + offset + len - n, 0xFF, n);                    // Fin effacée
+      checkAfterPowerCut(partial);
+    }
+    return 0;
+  }
+
+  if (offset % STATE_JOURNAL_SECTOR_SIZE == 0) headersCut++;
+  else recordsCut++;
+  // Écriture interrompue : l'octet n à moitié programmé, après les octets
+  // précédents seulement, ou après tous les autres (ordre de programmation libre)
+  for (size_t n = 0; n < len; n++) {
+    uint8_t half = buf[n] | 0x0F;
+    partial.mem = f->mem;
+    program(&partial, offset, buf, n);
+    program(&partial, offset + n, &half, 1);
+    checkAfterPowerCut(partial);
+
+    partial.mem = f->mem;
+    program(&partial, offset, buf, n);
+    program(&partial, offset + n + 1, buf + n + 1, len - n - 1);
+    program(&partial, offset + n, &half, 1);
+    checkAfterPowerCut(partial);
+  }
+  return 0;
+}
+
+static void runWithPowerCuts(uint32_t commits) {
+  StateJournal j;
+  StateSnapshot restored;
+  stateJournalOpen(&j, &flashOps, SECTORS, &restored);
+  haveAcked = false;
+  flash.onOperation = injectPowerCuts;
+  for (uint32_t i = 1; i <= commits; i++) {
+    inFlight = snapshotFor(i);
+    TEST_ASSERT_TRUE(stateJournalCommit(&j, &inFlight));
+    acked = inFlight;
+    haveAcked = true;
+  }
+  flash.onOperation = nullptr;
+}
+
+static void test_power_cut_during_format(void) {
+  // Zone vierge : effacement et en-tête du premier secteur, premier enregistrement
+  cutsChecked = erasesCut = headersCut = recordsCut = 0;
+  runWithPowerCuts(2);
+  TEST_ASSERT_EQUAL_UINT32(1, erasesCut);
+  TEST_ASSERT_EQUAL_UINT32(1, headersCut);
+  TEST_ASSERT_EQUAL_UINT32(2, recordsCut);
+}
+
+static void test_power_cut_at_every_step_of_the_ring(void) {
+  // Tous les effacements, en-têtes et enregistrements de plus d'un tour d'anneau
+  cutsChecked = erasesCut = headersCut = recordsCut = 0;
+  const uint32_t commits = STATE_JOURNAL_SLOTS * SECTORS + 3;
+  runWithPowerCuts(commits);
+  TEST_ASSERT_EQUAL_UINT32(SECTORS + 1, erasesCut);
+  TEST_ASSERT_EQUAL_UINT32(SECTORS + 1, headersCut);
+  TEST_ASSERT_EQUAL_UINT32(commits, recordsCut);
+  TEST_ASSERT_GREATER_THAN(commits * STATE_JOURNAL_RECORD_SIZE, cutsChecked);
+}
+
+static void test_failed_write_is_reported(void) {
+  StateJournal j;
+  StateSnapshot restored;
+  stateJournalOpen(&j, &flashOps, SECTORS, &restored);
+  StateSnapshot first = snapshotFor(1);
+  TEST_ASSERT_TRUE(stateJournalCommit(&j, &first));
+  flash.failWrites = true;
+  StateSnapshot second = snapshotFor(2);
+  TEST_ASSERT_FALSE(stateJournalCommit(&j, &second));
+  TEST_ASSERT_EQUAL_UINT32(2, j.writeErrors);            // Emplacement suivant tenté une fois
+  flash.failWrites = false;
+  TEST_ASSERT_TRUE(stateJournalOpen(&j, &flashOps, SECTORS, &restored));
+  TEST_ASSERT_TRUE(sameSnapshot(first, restored));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_blank_area_restores_nothing);
+  RUN_TEST(test_restores_last_commit_across_rollovers);
+  RUN_TEST(test_power_cut_during_format);
+  RUN_TEST(test_power_cut_at_every_step_of_the_ring);
+  RUN_TEST(test_failed_write_is_reported);
+  return UNITY_END();
+}
@@ -0,0 +1,240 @@
+// Machine de reconnexion WiFi sur un lien simulé : statut scripté, appels
+// connect() enregistrés, paramètres du lien établi contrôlés par le test
+#include <unity.h>
+#include <string.h>
+#include "wifi_reconnect.h"
+
+#define AP_CHANNEL 6
+#define OLD_IP 0x0A01A8C0UL       // 192.168.1.10 (ordre IPAddress)
+#define NEW_IP 0x0A02A8C0UL       // 192.168.2.10 : réseau renuméroté
+
+struct MockLink {
+  uint8_t status;                 // Réponse de status()
+  bool acceptConnect;
+  int connects;
+  int scans;                      // connect(NULL)
+  int disconnects;
+  WifiLinkCache lastCache;        // Dernier cache passé à connect()
+  WifiLinkCache current;          // Lien établi
+};
+
+static MockLink link;
+
+static bool mockConnect(void* ctx, const WifiLinkCache* cache) {
+  MockLink* m = (MockLink*)ctx;
+  m->connects++;
+  if (cache == NULL) m->scans++;
+  else m->lastCache = *cache;
+  m->status = WIFI_LINK_CONNECTING;
+  return m->acceptConnect;
+}
+
+static uint8_t mockStatus(void* ctx) { return ((MockLink*)ctx)->status; }
+
+static void mockDisconnect(void* ctx) {
+  MockLink* m = (MockLink*)ctx;
+  m->disconnects++;
+  m->status = WIFI_LINK_DOWN;
+}
+
+static void mockCurrent(void* ctx, WifiLinkCache* out) { *out = ((MockLink*)ctx)->current; }
+
+static const WifiReconnectOps ops = { mockConnect, mockStatus, mockDisconnect, mockCurrent, &link };
+
+static WifiLinkCache cacheFor(uint8_t channel, uint32_t ip) {
+  WifiLinkCache c;
+  memset(&c, 0, sizeof(c));
+  const uint8_t bssid[6] = { 0x02, 0x51, 0x4D, 0x00, 0x00, 0x01 };
+  memcpy(c.bssid, bssid, sizeof(bssid));
+  c.channel = channel;
+  c.ip = ip;
+  c.gateway = (ip & 0x00FFFFFFUL) | 0x01000000UL;
+  c.subnet = 0x00FFFFFFUL;
+  c.dns = c.gateway;
+  return c;
+}
+
+// Machine en ligne avec le cache, puis lien perdu à t = 1000 ms
+static void startOnlineThenLose(WifiReconnect* rc) {
+  WifiLinkCache cache = cacheFor(AP_CHANNEL, OLD_IP);
+  wifiReconnectInit(rc, &cache);
+  link.current = cache;
+  link.status = WIFI_LINK_UP;
+  wifiReconnectLinkUp(rc, &ops, 0);
+  link.connects = link.scans = link.disconnects = 0;
+
+  link.status = WIFI_LINK_DOWN;
+  TEST_ASSERT_EQUAL(WIFI_RC_EVENT_LOST, wifiReconnectPoll(rc, &ops, 1000));
+}
+
+void setUp(void) {
+  memset(&link, 0, sizeof(link));
+  link.acceptConnect = true;
+}
+void tearDown(void) {}
+
+static void test_fast_reconnect_uses_cached_bssid_and_address(void) {
+  WifiReconnect rc;
+  startOnlineThenLose(&rc);
+  TEST_ASSERT_EQUAL(WIFI_RC_FAST, rc.state);
+  TEST_ASSERT_EQUAL(1, rc.stats.losses);
+  TEST_ASSERT_EQUAL(1, link.connects);
+  TEST_ASSERT_EQUAL(0, link.scans);
+  WifiLinkCache expected = cacheFor(AP_CHANNEL, OLD_IP);
+  TEST_ASSERT_EQUAL_MEMORY(expected.bssid, link.lastCache.bssid, 6);
+  TEST_ASSERT_EQUAL(AP_CHANNEL, link.lastCache.channel);
+  TEST_ASSERT_EQUAL_HEX32(OLD_IP, link.lastCache.ip);
+
+  TEST_ASSERT_EQUAL(WIFI_RC_EVENT_NONE, wifiReconnectPoll(&rc, &ops, 1040));
+  link.status = WIFI_LINK_UP;
+  TEST_ASSERT_EQUAL(WIFI_RC_EVENT_UP, wifiReconnectPoll(&rc, &ops, 1080));
+  TEST_ASSERT_EQUAL(WIFI_RC_ONLINE, rc.state);
+  TEST_ASSERT_EQUAL(1, rc.stats.fastOk);
+  TEST_ASSERT_EQUAL(0, rc.stats.scanOk + rc.stats.scanFailed);
+  TEST_ASSERT_EQUAL(80, rc.stats.lastLinkMs);
+  TEST_ASSERT_FALSE(rc.cacheDirty);      // Même point d'accès, même adresse
+
+  // Perte -> MQTT en ligne
+  wifiReconnectMqttOnline(&rc, 1300);
+  TEST_ASSERT_EQUAL(300, rc.stats.lastOnlineMs);
+  TEST_ASSERT_EQUAL(300, rc.stats.avgOnlineMs);
+  wifiReconnectMqttOnline(&rc, 2000);    // Déjà mesuré
+  TEST_ASSERT_EQUAL(1, rc.stats.onlineSamples);
+}
+
+static void test_fast_failure_falls_back_to_scan(void) {
+  WifiReconnect rc;
+  startOnlineThenLose(&rc);
+
+  // Point d'accès déplacé : l'association directe est refusée
+  link.current = cacheFor(11, OLD_IP);
+  link.status = WIFI_LINK_FAILED;
+  wifiReconnectPoll(&rc, &ops, 1300);
+  TEST_ASSERT_EQUAL(WIFI_RC_SCAN, rc.state);
+  TEST_ASSERT_EQUAL(1, rc.stats.fastFailed);
+  TEST_ASSERT_EQUAL(1, link.disconnects);
+  TEST_ASSERT_EQUAL(1, link.scans);
+
+  link.status = WIFI_LINK_UP;
+  TEST_ASSERT_EQUAL(WIFI_RC_EVENT_UP, wifiReconnectPoll(&rc, &ops, 2800));
+  TEST_ASSERT_EQUAL(1, rc.stats.scanOk);
+  TEST_ASSERT_EQUAL(1800, rc.stats.lastLinkMs);
+  TEST_ASSERT_TRUE(rc.cacheDirty);       // Nouveau canal appris
+  TEST_ASSERT_EQUAL(11, rc.cache.channel);
+  TEST_ASSERT_EQUAL(0, rc.fastFailures);
+}
+
+static void test_fast_timeout_falls_back_to_scan(void) {
+  WifiReconnect rc;
+  startOnlineThenLose(&rc);
+  wifiReconnectPoll(&rc, &ops, 1000 + WIFI_FAST_TIMEOUT_MS - 1);
+  TEST_ASSERT_EQUAL(WIFI_RC_FAST, rc.state);
+  wifiReconnectPoll(&rc, &ops, 1000 + WIFI_FAST_TIMEOUT_MS);
+  TEST_ASSERT_EQUAL(WIFI_RC_SCAN, rc.state);
+  TEST_ASSERT_EQUAL(1, rc.stats.fastFailed);
+  TEST_ASSERT_EQUAL(1, link.scans);
+}
+
+static void test_scan_failure_backs_off_then_retries_fast(void) {
+  WifiReconnect rc;
+  startOnlineThenLose(&rc);
+  uint32_t now = 1000;
+  uint32_t expected = WIFI_BACKOFF_MIN_MS;
+
+  for (int round = 0; round < 8; round++) {
+    // FAST refusé -> SCAN refusé, ou SCAN refusé directement
+    while (rc.state != WIFI_RC_BACKOFF) {
+      link.status = WIFI_LINK_FAILED;
+      wifiReconnectPoll(&rc, &ops, now);
+    }
+    TEST_ASSERT_EQUAL(WIFI_RC_BACKOFF, rc.state);
+    TEST_ASSERT_EQUAL(expected, rc.backoffMs);
+
+    wifiReconnectPoll(&rc, &ops, now + rc.backoffMs - 1);
+    TEST_ASSERT_EQUAL(WIFI_RC_BACKOFF, rc.state);
+    now += rc.backoffMs;
+    wifiReconnectPoll(&rc, &ops, now);
+    // Après WIFI_FAST_MAX_FAILURES échecs directs, le cache n'est plus essayé
+    TEST_ASSERT_EQUAL(round + 1 < WIFI_FAST_MAX_FAILURES ? WIFI_RC_FAST : WIFI_RC_SCAN, rc.state);
+    expected = expected * 2 < WIFI_BACKOFF_MAX_MS ? expected * 2 : WIFI_BACKOFF_MAX_MS;
+  }
+  TEST_ASSERT_EQUAL(WIFI_BACKOFF_MAX_MS, rc.backoffMs);
+  TEST_ASSERT_EQUAL(WIFI_FAST_MAX_FAILURES, rc.stats.fastFailed);
+  TEST_ASSERT_EQUAL(8, rc.stats.scanFailed);
+
+  // Retour du point d'accès par le scan : attente et cache remis à zéro
+  link.status = WIFI_LINK_UP;
+  TEST_ASSERT_EQUAL(WIFI_RC_EVENT_UP, wifiReconnectPoll(&rc, &ops, now + 1500));
+  TEST_ASSERT_EQUAL(0, rc.backoffMs);
+  TEST_ASSERT_EQUAL(0, rc.fastFailures);
+}
+
+static void test_rejected_address_falls_back_to_dhcp_on_same_bssid(void) {
+  WifiReconnect rc;
+  startOnlineThenLose(&rc);
+
+  // Réseau renuméroté : associé au BSSID du cache, adresse refusée
+  link.current = cacheFor(AP_CHANNEL, NEW_IP);
+  link.status = WIFI_LINK_ADDR_REJECTED;
+  TEST_ASSERT_EQUAL(WIFI_RC_EVENT_NONE, wifiReconnectPoll(&rc, &ops, 1500));
+  TEST_ASSERT_EQUAL(WIFI_RC_FAST, rc.state);
+  TEST_ASSERT_EQUAL(1, rc.stats.addrRejected);
+  TEST_ASSERT_EQUAL(0, rc.stats.fastFailed);
+  TEST_ASSERT_EQUAL(1, link.disconnects);
+  TEST_ASSERT_EQUAL(2, link.connects);
+  TEST_ASSERT_EQUAL(0, link.scans);
+  TEST_ASSERT_EQUAL(AP_CHANNEL, link.lastCache.channel);
+  TEST_ASSERT_EQUAL_HEX32(0, link.lastCache.ip);   // DHCP
+
+  // Délai FAST relancé pour la tentative DHCP
+  wifiReconnectPoll(&rc, &ops, 1000 + WIFI_FAST_TIMEOUT_MS);
+  TEST_ASSERT_EQUAL(WIFI_RC_FAST, rc.state);
+  link.status = WIFI_LINK_UP;
+  TEST_ASSERT_EQUAL(WIFI_RC_EVENT_UP, wifiReconnectPoll(&rc, &ops, 1100 + WIFI_FAST_TIMEOUT_MS));
+  TEST_ASSERT_EQUAL(1, rc.stats.fastOk);
+  TEST_ASSERT_EQUAL(100 + WIFI_FAST_TIMEOUT_MS, rc.stats.lastLinkMs);
+  TEST_ASSERT_TRUE(rc.cacheDirty);
+  TEST_ASSERT_EQUAL_HEX32(NEW_IP, rc.cache.ip);    // Nouvelle adresse à réutiliser
+}
+
+static void test_rejected_dhcp_address_falls_back_to_scan(void) {
+  WifiReconnect rc;
+  startOnlineThenLose(&rc);
+  link.status = WIFI_LINK_ADDR_REJECTED;
+  wifiReconnectPoll(&rc, &ops, 1500);
+  TEST_ASSERT_EQUAL(WIFI_RC_FAST, rc.state);
+
+  // Refusée encore sans adresse imposée : échec FAST ordinaire
+  link.status = WIFI_LINK_ADDR_REJECTED;
+  wifiReconnectPoll(&rc, &ops, 1600);
+  TEST_ASSERT_EQUAL(WIFI_RC_SCAN, rc.state);
+  TEST_ASSERT_EQUAL(1, rc.stats.addrRejected);
+  TEST_ASSERT_EQUAL(1, rc.stats.fastFailed);
+  TEST_ASSERT_EQUAL(1, link.scans);
+}
+
+static void test_empty_cache_starts_with_scan(void) {
+  WifiReconnect rc;
+  wifiReconnectInit(&rc, NULL);
+  wifiReconnectStart(&rc, &ops, 0);
+  TEST_ASSERT_EQUAL(WIFI_RC_SCAN, rc.state);
+  TEST_ASSERT_EQUAL(1, link.scans);
+
+  link.current = cacheFor(AP_CHANNEL, OLD_IP);
+  link.status = WIFI_LINK_UP;
+  TEST_ASSERT_EQUAL(WIFI_RC_EVENT_UP, wifiReconnectPoll(&rc, &ops, 1500));
+  TEST_ASSERT_TRUE(rc.cacheDirty);
+  TEST_ASSERT_EQUAL(AP_CHANNEL, rc.cache.channel);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fast_reconnect_uses_cached_bssid_and_address);
+  RUN_TEST(test_fast_failure_falls_back_to_scan);
+  RUN_TEST(test_fast_timeout_falls_back_to_scan);
+  RUN_TEST(test_scan_failure_backs_off_then_retries_fast);
+  RUN_TEST(test_rejected_address_falls_back_to_dhcp_on_same_bssid);
+  RUN_TEST(test_rejected_dhcp_address_falls_back_to_scan);
+  RUN_TEST(test_empty_cache_starts_with_scan);
+  return UNITY_END();
+}
@@ -12,6 +12,8 @@ import socket
 import os
 import platform
 import json
+import argparse
+import statistics
 
 # ========== CONFIGURATION ========== 
 MQTT_PORT = 1883
@@ -21,9 +23,18 @@ RELAY_NAMES = ["RelaisK1", "RelaisK2"]
 
 # Liste des devices pour les tests multi-ESP32
 ALL_DEVICES = ["laser", "lilygo"]  # Ajouter vos ESP32 ici
+# Groupe de diffusion pour les commandes synchronisées ("all" = tous les appareils)
+SYNC_GROUP = "all"
 
-# Dictionnaire pour suivre les commandes en attente de confirmation
+# Dictionnaire pour suivre les commandes en attente d'acquittement (id -> infos)
 pending_commands = {}
+command_counter = 0
+
+def next_command_id():
+    """Génère un identifiant de commande unique pour l'idempotence et les acks"""
+    global command_counter
+    command_counter += 1
+    return f"{int(time.time() * 1000) % 100000000:08d}-{command_counter}"
 
 # Mesure de latence réseau - PAR DEVICE
 device_latencies = {}  # device_name -> {'samples': [], 'avg_rtt_us': 0, 'avg_latency_us': 0, 'last_measurement': 0}
@@ -76,6 +87,11 @@ def on_connect(client, userdata, flags, reason_code, properties):
         client.subscribe("esp32/time/sync")
         print(f"✓ Abonné à: esp32/time/sync")
         
+        # S'abonner aux acquittements de commandes
+        ack_topic = f"{DEVICE_NAME}/ack"
+        client.subscribe(ack_topic)
+        print(f"✓ Abonné à: {ack_topic}")
+
         # S'abonner au topic pong pour mesurer la latence
         pong_topic = f"{DEVICE_NAME}/pong"
         client.subscribe(pong_topic)
@@ -129,6 +145,48 @@ def on_message(client, userdata, msg):
             pass
         return
 
+    # Gérer les acquittements de commandes (corrélés par identifiant)
+    if topic.endswith("/ack"):
+        try:
+            ack = json.loads(payload)
+            cmd_id = ack.get("id")
+            status = ack.get("status")
+            command_info = pending_commands.get(cmd_id)
+            if command_info is None:
+                print(f"📨 Ack {status} pour une commande inconnue: {cmd_id}")
+                return
+
+            if status == "scheduled":
+                print(f"   └── 🗓️  [{cmd_id}] {command_info['relay']} programmée (reçue par l'ESP32)")
+            elif status == "executed":
+                pending_commands.pop(cmd_id, None)
+                lateness_us = ack.get("lateness_us", 0)
+                if command_info['type'] == 'immediate':
+                    latency = (receipt_time - command_info['time']) * 1000
+                    print(f"   └── ⏱️  [{cmd_id}] {command_info['relay']} exécutée | aller-retour: {latency:.3f} ms | traitement: {lateness_us} µs")
+                else:
+                    print(f"   └── 🗓️  [{cmd_id}] {command_info['relay']} exécutée")
+                    print(f"        - Heure demandée : {ack.get('scheduled_us', 0) / 1e6:.6f}")
+                    print(f"        - Heure exécution: {ack.get('executed_us', 0) / 1e6:.6f}")
+                    print(f"        - Décalage       : {lateness_us / 1000.0:.3f} ms ({lateness_us} µs)")
+            else:
+                # duplicate / rejected
+                pending_commands.pop(cmd_id, None)
+                print(f"   └── ⚠️  [{cmd_id}] {command_info['relay']}: {status}")
+        except (json.JSONDecodeError, KeyError):
+            pass
+        return
+
+    # Instantané de tous les états (connexion ou demande sur <device>/status/get)
+    if topic == f"{DEVICE_NAME}/status":
+        try:
+            data = json.loads(payload)
+            states = ", ".join(f"{name}={value}" for name, _pin, _mode, value in data.get("ios", []))
+            print(f"📸 Instantané #{data.get('seq')} ({data.get('reason')}): {states}")
+        except (json.JSONDecodeError, ValueError, TypeError):
+            print(f"📨 Instantané mal formé: {payload}")
+        return
+
     # Gérer les messages de statut JSON
     status_prefix = f"{DEVICE_NAME}/status/"
     if topic.startswith(status_prefix):
@@ -150,30 +208,6 @@ def on_message(client, userdata, msg):
                 state_str = "ON" if state == 1 else "OFF"
                 print(f"📨 Statut reçu pour {relay_name}: {state_str} (ESP time: {esp_timestamp}.{esp_us:06d})")
 
-                # Vérifier si une commande était en attente pour ce relais
-                if relay_name in pending_commands:
-                    command_info = pending_commands.pop(relay_name)
-                    
-                    if command_info['type'] == 'immediate':
-                        send_time = command_info['time']
-                        latency = (receipt_time - send_time) * 1000
-                        print(f"   └── ⏱️  Latence de la commande immédiate: {latency:.3f} ms")
-                    
-                    elif command_info['type'] == 'scheduled':
-                        exec_at_sec = command_info['exec_at_sec']
-                        exec_at_us = command_info['exec_at_us']
-                        
-                        # Calculer le délai en microsecondes
-                        expected_time_us = (exec_at_sec * 1000000) + exec_at_us
-                        actual_time_us = (esp_timestamp * 1000000) + esp_us
-                        delay_us = actual_time_us - expected_time_us
-                        delay_ms = delay_us / 1000.0
-                        
-                        print(f"   └── 🗓️  Commande programmée exécutée:")
-                        print(f"        - Heure demandée : {exec_at_sec}.{exec_at_us:06d}")
-                        print(f"        - Heure exécution: {esp_timestamp}.{esp_us:06d}")
-                        print(f"        - Décalage       : {delay_ms:.3f} ms ({delay_us} µs)")
-            
             # Si c'est juste un nombre (inputs)
             elif isinstance(data, int):
                 state_str = "HIGH" if data == 1 else "LOW"
@@ -202,22 +236,24 @@ def set_relay(client, relay_name, state, exec_at_sec=None, exec_at_us=None):
     """Active ou désactive un relais, immédiatement ou de manière programmée"""
     topic = f"{DEVICE_NAME}/control/{relay_name}/set"
     
-    payload_data = {"state": 1 if state else 0}
+    cmd_id = next_command_id()
+    payload_data = {"state": 1 if state else 0, "id": cmd_id}
     if exec_at_sec is not None:
         payload_data["exec_at"] = exec_at_sec
         payload_data["exec_at_us"] = exec_at_us if exec_at_us is not None else 0
     
     payload = json.dumps(payload_data)
     
-    # Enregistrer les informations sur la commande pour le calcul de la latence/délai
+    # Enregistrer les informations sur la commande, l'ack de l'ESP32 la référencera par son id
     if exec_at_sec is not None:
-        pending_commands[relay_name] = {
-            'type': 'scheduled', 
+        pending_commands[cmd_id] = {
+            'type': 'scheduled',
+            'relay': relay_name,
             'exec_at_sec': exec_at_sec,
             'exec_at_us': exec_at_us if exec_at_us is not None else 0
         }
     else:
-        pending_commands[relay_name] = {'type': 'immediate', 'time': time.time()}
+        pending_commands[cmd_id] = {'type': 'immediate', 'relay': relay_name, 'time': time.time()}
 
     result = client.publish(topic, payload, qos=1)
     
@@ -232,7 +268,7 @@ def set_relay(client, relay_name, state, exec_at_sec=None, exec_at_us=None):
     else:
         print(f"✗ Erreur lors de l'envoi de la commande")
         # Si l'envoi échoue, retirer la commande des commandes en attente
-        pending_commands.pop(relay_name, None)
+        pending_commands.pop(cmd_id, None)
 
 def turn_on(client, relay_name):
     """Active un relais immédiatement"""
@@ -298,21 +334,21 @@ def synchronized_toggle_all_devices(client, relay_name="RelaisK1", delay_seconds
     print(f"\n⏰ Heure d'exécution synchronisée: {exec_time_str}.{exec_us:06d}")
     print(f"\n📤 Envoi des commandes programmées...\n")
     
-    # Envoyer la commande à tous les devices
-    for device in ALL_DEVICES:
-        topic = f"{device}/control/{relay_name}/set"
-        payload_data = {
-            "state": 1,  # ON
-            "exec_at": exec_seconds,
-            "exec_at_us": exec_us
-        }
-        payload = json.dumps(payload_data)
-        
-        result = client.publish(topic, payload, qos=1)
-        if result.rc == mqtt.MQTT_ERR_SUCCESS:
-            print(f"  ✓ Commande envoyée à {device}")
-        else:
-            print(f"  ✗ Échec d'envoi à {device}")
+    # Une seule publication sur le topic de groupe : le broker la distribue à tous les membres
+    topic = f"esp32/group/{SYNC_GROUP}/control/{relay_name}/set"
+    payload_data = {
+        "state": 1,  # ON
+        "exec_at": exec_seconds,
+        "exec_at_us": exec_us,
+        "id": next_command_id()
+    }
+    payload = json.dumps(payload_data)
+    
+    result = client.publish(topic, payload, qos=1)
+    if result.rc == mqtt.MQTT_ERR_SUCCESS:
+        print(f"  ✓ Commande envoyée au groupe '{SYNC_GROUP}'")
+    else:
+        print(f"  ✗ Échec d'envoi au groupe '{SYNC_GROUP}'")
     
     print(f"\n⏳ Attente de l'exécution ({delay_seconds}s)...")
     print(f"🎥 FILMEZ MAINTENANT pour vérifier la synchronisation !\n")
@@ -322,12 +358,8 @@ def synchronized_toggle_all_devices(client, relay_name="RelaisK1", delay_seconds
     
     # Éteindre tous les relais
     print(f"\n📤 Extinction des relais...\n")
-    for device in ALL_DEVICES:
-        topic = f"{device}/control/{relay_name}/set"
-        payload_data = {"state": 0}  # OFF
-        payload = json.dumps(payload_data)
-        client.publish(topic, payload, qos=1)
-        print(f"  ✓ {device} éteint")
+    client.publish(topic, json.dumps({"state": 0, "id": next_command_id()}), qos=1)
+    print(f"  ✓ Groupe '{SYNC_GROUP}' éteint")
     
     print(f"\n{'='*60}")
     print(f"✓ Test de synchronisation terminé")
@@ -532,11 +564,13 @@ def switch_device(client):
     client.unsubscribe(f"{old_device}/status/#")
     client.unsubscribe(f"{old_device}/availability")
     client.unsubscribe(f"{old_device}/pong")
+    client.unsubscribe(f"{old_device}/ack")
     
     # S'abonner aux nouveaux topics
     client.subscribe(f"{DEVICE_NAME}/status/#")
     client.subscribe(f"{DEVICE_NAME}/availability")
     client.subscribe(f"{DEVICE_NAME}/pong")
+    client.subscribe(f"{DEVICE_NAME}/ack")
     
     print(f"\n✓ Device changé: {old_device} → {DEVICE_NAME}")
     print(f"✓ Abonné aux nouveaux topics de {DEVICE_NAME}")
@@ -650,6 +684,289 @@ def check_and_restart_mosquitto(host, port):
             # Petite pause pour laisser le temps au broker de s'initialiser complètement
             time.sleep(3)
 
+
+# ========== BENCHMARK AUTOMATISÉ ==========
+# Mode non interactif : génère une charge reproductible (commandes à débit fixe,
+# rafales de commandes programmées, tempêtes de pings) et produit des résultats
+# JSON comparables d'une exécution à l'autre.
+
+def percentile(values, pct):
+    """Percentile par rang le plus proche (None si aucune valeur)"""
+    if not values:
+        return None
+    ordered = sorted(values)
+    rank = max(0, min(len(ordered) - 1, int(round(pct / 100.0 * len(ordered) + 0.5)) - 1))
+    return ordered[rank]
+
+def summarize(values):
+    """Statistiques d'une série de mesures en millisecondes"""
+    if not values:
+        return {"count": 0}
+    return {
+        "count": len(values),
+        "mean": round(statistics.mean(values), 3),
+        "min": round(min(values), 3),
+        "p50": round(percentile(values, 50), 3),
+        "p99": round(percentile(values, 99), 3),
+        "p999": round(percentile(values, 99.9), 3),
+        "max": round(max(values), 3),
+    }
+
+class BenchCollector:
+    """Corrèle les commandes envoyées avec les statuts, acks et pongs reçus"""
+
+    def __init__(self, devices):
+        self.lock = threading.Lock()
+        self.devices = devices
+        self.immediate_sent = {}      # (device, id) -> send_time, commandes immédiates en attente d'ack
+        self.command_latencies = []   # ms, commande -> ack "executed" de même id
+        self.acks = {}                # id -> ack
+        self.ping_sent = {}           # ping_id -> send_time
+        self.ping_rtts = []           # ms
+        self.sent = 0
+
+    def on_message(self, client, userdata, msg):
+        receipt_time = time.time()
+        parts = msg.topic.split('/')
+        device = parts[0]
+        try:
+            payload = msg.payload.decode()
+        except UnicodeDecodeError:
+            return
+
+        with self.lock:
+            if len(parts) == 2 and parts[1] == "ack":
+                try:
+                    ack = json.loads(payload)
+                except json.JSONDecodeError:
+                    return
+                ack["device"] = device
+                ack["receipt_time"] = receipt_time
+                # Corrélation par id : un statut perdu ou réordonné ne décale pas les mesures suivantes
+                if ack.get("status") == "executed":
+                    send_time = self.immediate_sent.pop((device, ack.get("id")), None)
+                    if send_time is not None:
+                        self.command_latencies.append((receipt_time - send_time) * 1000)
+                # On conserve le dernier état (scheduled puis executed) ; un même id
+                # est acquitté par chaque membre quand la commande vise un groupe
+                self.acks[(device, ack.get("id"))] = ack
+            elif len(parts) == 2 and parts[1] == "pong":
+                try:
+                    ping_id = json.loads(payload).get("ping_payload")
+                except json.JSONDecodeError:
+                    return
+                send_time = self.ping_sent.pop(ping_id, None)
+                if send_time is not None:
+                    self.ping_rtts.append((receipt_time - send_time) * 1000)
+
+    def send_command(self, client, device, relay, state, exec_at_us=None):
+        cmd_id = next_command_id()
+        payload = {"state": state, "id": cmd_id}
+        if exec_at_us is not None:
+            payload["exec_at"] = exec_at_us // 1000000
+            payload["exec_at_us"] = exec_at_us % 1000000
+        with self.lock:
+            if exec_at_us is None:
+                self.immediate_sent[(device, cmd_id)] = time.time()
+            self.sent += 1
+        client.publish(f"{device}/control/{relay}/set", json.dumps(payload), qos=1)
+        return (device, cmd_id)
+
+    def send_group_command(self, client, group, devices, relay, state, exec_at_us):
+        """Commande programmée publiée une seule fois sur le topic du groupe"""
+        cmd_id = next_command_id()
+        payload = {"state": state, "id": cmd_id,
+                   "exec_at": exec_at_us // 1000000, "exec_at_us": exec_at_us % 1000000}
+        with self.lock:
+            self.sent += 1
+        client.publish(f"esp32/group/{group}/control/{relay}/set", json.dumps(payload), qos=1)
+        return [(device, cmd_id) for device in devices]
+
+    def send_ping(self, client, device, index):
+        ping_id = f"bench_{device}_{index}_{int(time.time() * 1000000)}"
+        with self.lock:
+            self.ping_sent[ping_id] = time.time()
+        client.publish(f"{device}/ping", ping_id)
+
+def bench_ping_storm(client, collector, devices, count, rate):
+    """Rafale de pings à débit fixe vers chaque device"""
+    interval = 1.0 / rate if rate > 0 else 0
+    for i in range(count):
+        for device in devices:
+            collector.send_ping(client, device, i)
+        time.sleep(interval)
+
+def bench_command_rate(client, collector, devices, relays, rate, duration):
+    """Commandes immédiates à débit fixe (réparties sur devices et relais)"""
+    interval = 1.0 / rate
+    targets = [(d, r) for d in devices for r in relays]
+    states = {t: 0 for t in targets}
+    start = time.time()
+    next_send = start
+    index = 0
+    while time.time() - start < duration:
+        target = targets[index % len(targets)]
+        states[target] ^= 1
+        collector.send_command(client, target[0], target[1], states[target])
+        index += 1
+        next_send += interval
+        delay = next_send - time.time()
+        if delay > 0:
+            time.sleep(delay)
+    return index, time.time() - start
+
+def bench_scheduled_bursts(client, collector, devices, relays, bursts, lead_ms, spacing_ms, group=None):
+    """Rafales de commandes programmées à la même échéance sur tous les devices
+    (une publication par device, ou une seule par relais sur le topic du groupe)"""
+    burst_ids = []
+    for b in range(bursts):
+        exec_at_us = int((time.time() + lead_ms / 1000.0) * 1000000)
+        if group:
+            ids = [key for r in relays
+                   for key in collector.send_group_command(client, group, devices, r, (b + 1) % 2, exec_at_us)]
+        else:
+            ids = [collector.send_command(client, d, r, (b + 1) % 2, exec_at_us) for d in devices for r in relays]
+        burst_ids.append(ids)
+        time.sleep(spacing_ms / 1000.0)
+    return burst_ids
+
+def run_benchmark(args):
+    """Exécute le benchmark complet et retourne le dictionnaire de résultats"""
+    devices = args.devices.split(',')
+    relays = args.relays.split(',')
+
+    if args.embedded_broker:
+        from mqtt_broker import EmbeddedBroker
+        EmbeddedBroker(port=args.port).start()
+        print(f"✓ Broker intégré démarré sur le port {args.port}")
+
+    collector = BenchCollector(devices)
+    client = mqtt.Client(mqtt.CallbackAPIVersion.VERSION2, client_id=f"ESP32_Bench_{os.getpid()}")
+    client.on_message = collector.on_message
+    client.connect(args.broker, args.port, 60)
+    client.loop_start()
+    for device in devices:
+        client.subscribe(f"{device}/ack")
+        client.subscribe(f"{device}/pong")
+    time.sleep(0.5)
+
+    # Base de temps commune avant les commandes programmées
+    publish_time_now(client)
+    time.sleep(args.settle)
+
+    print(f"🏓 Tempête de pings: {args.pings} x {len(devices)} device(s) à {args.ping_rate}/s")
+    bench_ping_storm(client, collector, devices, args.pings, args.ping_rate)
+
+    print(f"⚡ Commandes immédiates: {args.rate}/s pendant {args.duration}s")
+    sent, elapsed = bench_command_rate(client, collector, devices, relays, args.rate, args.duration)
+
+    fanout = f"groupe '{args.group}'" if args.group else "par device"
+    print(f"🗓️  Rafales programmées ({fanout}): {args.bursts} x {len(devices) * len(relays)} commande(s)")
+    burst_ids = bench_scheduled_bursts(client, collector, devices, relays, args.bursts, args.lead_ms,
+                                       args.burst_spacing_ms, args.group)
+
+    # Laisser le temps aux dernières exécutions et réponses
+    time.sleep(args.lead_ms / 1000.0 + args.drain)
+    client.loop_stop()
+    client.disconnect()
+
+    with collector.lock:
+        lateness = []
+        sync_errors = []
+        missing = 0
+        for ids in burst_ids:
+            executed = [collector.acks[i] for i in ids
+                        if i in collector.acks and collector.acks[i].get("status") == "executed"]
+            missing += len(ids) - len(executed)
+            lateness.extend(a["lateness_us"] / 1000.0 for a in executed)
+            # Écart de synchronisation : dispersion des heures d'exécution d'une même rafale
+            if len(executed) > 1:
+                times = [a["executed_us"] for a in executed]
+                sync_errors.append((max(times) - min(times)) / 1000.0)
+
+        latencies = list(collector.command_latencies)
+        duplicates = sum(1 for a in collector.acks.values() if a.get("status") in ("duplicate", "rejected"))
+        results = {
+            "timestamp": int(time.time()),
+            "target": {"broker": args.broker, "port": args.port, "devices": devices, "relays": relays},
+            "params": {"rate": args.rate, "duration": args.duration, "bursts": args.bursts,
+                       "lead_ms": args.lead_ms, "pings": args.pings, "ping_rate": args.ping_rate,
+                       "group": args.group},
+            "commands_sent": sent,
+            "throughput_cmd_s": round(len(latencies) / elapsed, 2) if elapsed > 0 else 0,
+            "command_to_ack_ms": summarize(latencies),
+            "commands_lost": sent - len(latencies),
+            "scheduled_lateness_ms": summarize(lateness),
+            "scheduled_missing": missing,
+            "sync_error_ms": summarize(sync_errors),
+            "ping_rtt_ms": summarize(collector.ping_rtts),
+            "rejected_or_duplicate": duplicates,
+        }
+    return results
+
+# Métriques comparées au run de référence (plus petit = meilleur)
+REGRESSION_METRICS = [
+    ("command_to_ack_ms", "p50"), ("command_to_ack_ms", "p99"), ("command_to_ack_ms", "p999"),
+    ("scheduled_lateness_ms", "p99"), ("sync_error_ms", "p99"), ("ping_rtt_ms", "p99"),
+]
+
+def compare_with_baseline(results, baseline, tolerance):
+    """Retourne la liste des régressions par rapport à un run précédent"""
+    regressions = []
+    for section, key in REGRESSION_METRICS:
+        current = results.get(section, {}).get(key)
+        previous = baseline.get(section, {}).get(key)
+        if current is None or previous is None or previous <= 0:
+            continue
+        if current > previous * (1 + tolerance):
+            regressions.append(f"{section}.{key}: {previous} -> {current} ms")
+    if results["throughput_cmd_s"] < baseline.get("throughput_cmd_s", 0) * (1 - tolerance):
+        regressions.append(f"throughput_cmd_s: {baseline['throughput_cmd_s']} -> {results['throughput_cmd_s']}")
+    return regressions
+
+def bench_main(args):
+    results = run_benchmark(args)
+    output = json.dumps(results, indent=2)
+    print(output)
+    with open(args.output, "w") as f:
+        f.write(output + "\n")
+    print(f"✓ Résultats écrits dans {args.output}")
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        regressions = compare_with_baseline(results, baseline, args.tolerance)
+        if regressions:
+            print("❌ Régressions détectées:")
+            for r in regressions:
+                print(f"   - {r}")
+            return 1
+        print("✅ Aucune régression par rapport à la référence")
+    return 0
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="Test MQTT interactif et benchmark de l'ESP32 IO Controller")
+    parser.add_argument("--bench", action="store_true", help="Mode benchmark non interactif")
+    parser.add_argument("--broker", default="127.0.0.1", help="Adresse du broker")
+    parser.add_argument("--port", type=int, default=MQTT_PORT)
+    parser.add_argument("--embedded-broker", action="store_true", help="Démarrer le broker intégré (mqtt_broker.py)")
+    parser.add_argument("--devices", default=",".join(ALL_DEVICES), help="Devices, séparés par des virgules")
+    parser.add_argument("--relays", default=",".join(RELAY_NAMES), help="Relais, séparés par des virgules")
+    parser.add_argument("--rate", type=float, default=20.0, help="Commandes immédiates par seconde")
+    parser.add_argument("--duration", type=float, default=10.0, help="Durée de la phase de commandes (s)")
+    parser.add_argument("--bursts", type=int, default=10, help="Nombre de rafales programmées")
+    parser.add_argument("--lead-ms", type=int, default=500, help="Avance des commandes programmées (ms)")
+    parser.add_argument("--burst-spacing-ms", type=int, default=300, help="Espacement des rafales (ms)")
+    parser.add_argument("--group", default=None, help="Rafales publiées sur esp32/group/<group>/... (ex: all)")
+    parser.add_argument("--pings", type=int, default=50, help="Pings par device")
+    parser.add_argument("--ping-rate", type=float, default=50.0, help="Pings par seconde")
+    parser.add_argument("--settle", type=float, default=1.0, help="Attente après la synchro de temps (s)")
+    parser.add_argument("--drain", type=float, default=2.0, help="Attente des dernières réponses (s)")
+    parser.add_argument("--output", default="bench_results.json", help="Fichier de résultats JSON")
+    parser.add_argument("--baseline", help="Résultats de référence pour détecter les régressions")
+    parser.add_argument("--tolerance", type=float, default=0.2, help="Tolérance de régression (0.2 = +20%%)")
+    return parser.parse_args()
+
 # ========== PROGRAMME PRINCIPAL ========== 
 def main():
     """Fonction principale"""
@@ -794,4 +1111,7 @@ def main():
             pass
 
 if __name__ == "__main__":
+    cli_args = parse_args()
+    if cli_args.bench:
+        sys.exit(bench_main(cli_args))
     main()